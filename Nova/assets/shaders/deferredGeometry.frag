@@ -10,10 +10,25 @@ in flat uint vsMaterialIndex;
 in vec3 vsPosition;
 in vec3 vsNormal;
 // in vec2 vsTexCoord;
+#ifdef NV_LOD_FADE
+in flat uint vsLODFade;
+
+// 4x4 ordered dither thresholds
+const float DITHER_THRESHOLDS[16] = float[16](
+	0.03125, 0.53125, 0.15625, 0.65625,
+	0.78125, 0.28125, 0.90625, 0.40625,
+	0.21875, 0.71875, 0.09375, 0.59375,
+	0.96875, 0.46875, 0.84375, 0.34375);
+#endif
 
 layout(location=0) out vec4 outColor;
+#ifdef NV_COMPACT_GBUFFER
+// position is reconstructed from depth, normal is stored in octahedral encoding
+layout(location=1) out vec2 outNormal;
+#else
 layout(location=1) out vec3 outPosition;
 layout(location=2) out vec3 outNormal;
+#endif
 // layout(location=3) out vec2 outTexCoord;
 
 layout(std430, binding = 1) buffer sMaterialData
@@ -21,12 +36,36 @@ layout(std430, binding = 1) buffer sMaterialData
 	Material materialData[];
 };
 
+#ifdef NV_COMPACT_GBUFFER
+vec2 EncodeOctahedral(vec3 n)
+{
+	n /= abs(n.x) + abs(n.y) + abs(n.z);
+	vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * signs;
+}
+#endif
+
 void main()
 {
+#ifdef NV_LOD_FADE
+	// instance fading between two levels of detail is drawn with both, each keeps complementary pixels of the pattern
+	if (vsLODFade != 0u)
+	{
+		ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+		bool isKept = DITHER_THRESHOLDS[pixel.y * 4 + pixel.x] < float(vsLODFade & 0xFFu) / 255.0;
+		if (isKept == ((vsLODFade & 0x100u) != 0u))
+			discard;
+	}
+#endif
+
 	Material material = materialData[vsMaterialIndex];
 
 	outColor = vec4(material.color.rgb, material.specularIntensity);
+#ifdef NV_COMPACT_GBUFFER
+	outNormal = EncodeOctahedral(normalize(vsNormal));
+#else
 	outPosition = vsPosition;
 	outNormal = normalize(vsNormal);
+#endif
 	// outTexCoord = vsTexCoord;
 }
\ No newline at end of file
@@ -0,0 +1,42 @@
+#version 450 core
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in uint inInstanceIndex;
+
+struct InstanceData
+{
+	mat4 transform;
+	mat3 normalTransform;
+	uint materialIndex;
+};
+
+out flat uint vsMaterialIndex;
+out vec3 vsPosition;
+out vec3 vsNormal;
+
+layout(std140) uniform uCameraData
+{
+	mat4 cameraView;
+	mat4 cameraProjection;
+	vec3 cameraPosition;
+};
+
+layout(std430, binding = 0) readonly buffer sInstanceData
+{
+	InstanceData instances[];
+};
+
+void main()
+{
+	InstanceData instance = instances[inInstanceIndex];
+
+	vsMaterialIndex = instance.materialIndex;
+
+	vec4 worldPos = instance.transform * vec4(inPosition, 1.0);
+	vsPosition = worldPos.xyz;
+
+	vsNormal = normalize(instance.normalTransform * inNormal);
+
+	gl_Position = cameraProjection * cameraView * worldPos;
+}
\ No newline at end of file
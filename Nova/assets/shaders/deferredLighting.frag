@@ -13,16 +13,25 @@ struct DirLight
     vec3 direction;
 };
 
+#ifdef NV_COMPACT_GBUFFER
+layout(location=2) out vec4 outColor;
+#else
 layout(location=3) out vec4 outColor;
+#endif
 
 in vec2 vsTexCoord;
 
 layout(binding=0) uniform sampler2D uGBufferAlbedoSpecular;
+#ifdef NV_COMPACT_GBUFFER
+layout(binding=1) uniform sampler2D uGBufferNormal;
+layout(binding=2) uniform sampler2D uGBufferDepth;
+uniform mat4 uInverseViewProjection;
+#else
 layout(binding=1) uniform sampler2D uGBufferPosition;
 layout(binding=2) uniform sampler2D uGBufferNormal;
+#endif
 uniform float uAmbient;
 uniform float uShininess;
-uniform uint uPointLightsCount;
 uniform uint uDirLightsCount;
 
 layout(std140) uniform uCameraData
@@ -32,24 +41,80 @@ layout(std140) uniform uCameraData
 	vec3 cameraPosition;
 };
 
+layout(std430, binding = 2) readonly buffer sDirLightsBuffer
+{
+    DirLight dirLights[];
+};
+
+// point lights are either evaluated here from cluster lists, or drawn separately as light volumes
+#ifndef NV_LIGHT_VOLUMES
+uniform vec2 uClusterTileScale;
+uniform float uClusterDepthScale;
+uniform float uClusterDepthBias;
+
 layout(std430, binding = 1) readonly buffer sPointLightsBuffer
 {
 	PointLight pointLights[];
 };
 
-layout(std430, binding = 2) readonly buffer sDirLightsBuffer
+layout(std430, binding = 3) readonly buffer sClusterLightCounts
 {
-    DirLight dirLights[];
+	uint clusterLightCounts[];
+};
+
+layout(std430, binding = 4) readonly buffer sClusterLightIndices
+{
+	uint clusterLightIndices[];
 };
 
+// clusters are screen tiles split into exponentially distributed depth slices
+uint GetClusterIndex(vec3 position)
+{
+	float viewDepth = max(-(cameraView * vec4(position, 1.0)).z, 1e-4);
+	uint slice = uint(clamp(log(viewDepth) * uClusterDepthScale + uClusterDepthBias, 0.0, float(NV_CLUSTER_COUNT_Z - 1)));
+	uvec2 tile = min(uvec2(gl_FragCoord.xy * uClusterTileScale), uvec2(NV_CLUSTER_COUNT_X - 1, NV_CLUSTER_COUNT_Y - 1));
+
+	return tile.x + NV_CLUSTER_COUNT_X * (tile.y + NV_CLUSTER_COUNT_Y * slice);
+}
+#endif
+
+#ifdef NV_COMPACT_GBUFFER
+vec3 DecodeOctahedral(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+	return normalize(n);
+}
+
+vec3 ReconstructPosition(vec2 texCoord, float depth)
+{
+	vec4 position = uInverseViewProjection * vec4(vec3(texCoord, depth) * 2.0 - 1.0, 1.0);
+	return position.xyz / position.w;
+}
+#endif
+
 void main()
 {
-    vec3 fragPos = texture(uGBufferPosition, vsTexCoord).xyz;
-    vec3 normal = normalize(texture(uGBufferNormal, vsTexCoord).xyz);
     vec4 albedoSpecular = texture(uGBufferAlbedoSpecular, vsTexCoord);
-
     vec3 lighting = albedoSpecular.rgb * uAmbient;
 
+#ifdef NV_COMPACT_GBUFFER
+    // nothing was drawn, normal attachment isn't cleared, so it holds garbage
+    float depth = texture(uGBufferDepth, vsTexCoord).r;
+    if (depth == 1.0)
+    {
+        outColor = vec4(lighting, 1.0);
+        return;
+    }
+
+    vec3 fragPos = ReconstructPosition(vsTexCoord, depth);
+    vec3 normal = DecodeOctahedral(texture(uGBufferNormal, vsTexCoord).xy);
+#else
+    vec3 fragPos = texture(uGBufferPosition, vsTexCoord).xyz;
+    vec3 normal = normalize(texture(uGBufferNormal, vsTexCoord).xyz);
+#endif
+
     vec3 viewDir = normalize(cameraPosition - fragPos);
 
     for (uint i = 0; i < uDirLightsCount; i++)
@@ -73,9 +138,15 @@ void main()
         lighting += diffuse + specular;
     }
 
-    for (uint i = 0; i < uPointLightsCount; i++)
+#ifndef NV_LIGHT_VOLUMES
+    // only lights which touch cluster of this fragment are evaluated
+    uint clusterIndex = GetClusterIndex(fragPos);
+    uint clusterLightsCount = clusterLightCounts[clusterIndex];
+    uint clusterLightsOffset = clusterIndex * NV_MAX_LIGHTS_PER_CLUSTER;
+
+    for (uint i = 0; i < clusterLightsCount; i++)
     {
-        PointLight light = pointLights[i];
+        PointLight light = pointLights[clusterLightIndices[clusterLightsOffset + i]];
 
         vec3 lightVec = light.position - fragPos;
         float dist = length(lightVec);
@@ -105,6 +176,7 @@ void main()
             lighting += (diffuse + specular) * attenuation;
         }
     }
+#endif
 
     outColor = vec4(lighting, 1.0);
 }
\ No newline at end of file
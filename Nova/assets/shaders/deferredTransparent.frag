@@ -24,11 +24,17 @@ in vec3 vsPosition;
 in vec3 vsNormal;
 // in vec2 vsTexCoord;
 
+#ifdef NV_COMPACT_GBUFFER
+layout(location=2) out vec4 outColor;
+#else
 layout(location=3) out vec4 outColor;
+#endif
 
 uniform float uAmbient;
 uniform float uShininess;
-uniform uint uPointLightsCount;
+uniform vec2 uClusterTileScale;
+uniform float uClusterDepthScale;
+uniform float uClusterDepthBias;
 uniform uint uDirLightsCount;
 
 layout(std140) uniform uCameraData
@@ -53,6 +59,26 @@ layout(std430, binding = 3) readonly buffer sDirLightsBuffer
     DirLight dirLights[];
 };
 
+layout(std430, binding = 4) readonly buffer sClusterLightCounts
+{
+	uint clusterLightCounts[];
+};
+
+layout(std430, binding = 5) readonly buffer sClusterLightIndices
+{
+	uint clusterLightIndices[];
+};
+
+// clusters are screen tiles split into exponentially distributed depth slices
+uint GetClusterIndex(vec3 position)
+{
+	float viewDepth = max(-(cameraView * vec4(position, 1.0)).z, 1e-4);
+	uint slice = uint(clamp(log(viewDepth) * uClusterDepthScale + uClusterDepthBias, 0.0, float(NV_CLUSTER_COUNT_Z - 1)));
+	uvec2 tile = min(uvec2(gl_FragCoord.xy * uClusterTileScale), uvec2(NV_CLUSTER_COUNT_X - 1, NV_CLUSTER_COUNT_Y - 1));
+
+	return tile.x + NV_CLUSTER_COUNT_X * (tile.y + NV_CLUSTER_COUNT_Y * slice);
+}
+
 void main()
 {
 	Material material = materialData[vsMaterialIndex];
@@ -85,9 +111,15 @@ void main()
         lighting += diffuse + specular;
     }
 
-    for (uint i = 0; i < uPointLightsCount; i++)
+#ifndef NV_DIRECTIONAL_LIGHTS_ONLY
+    // only lights which touch cluster of this fragment are evaluated
+    uint clusterIndex = GetClusterIndex(vsPosition);
+    uint clusterLightsCount = clusterLightCounts[clusterIndex];
+    uint clusterLightsOffset = clusterIndex * NV_MAX_LIGHTS_PER_CLUSTER;
+
+    for (uint i = 0; i < clusterLightsCount; i++)
     {
-        PointLight light = pointLights[i];
+        PointLight light = pointLights[clusterLightIndices[clusterLightsOffset + i]];
 
         vec3 lightVec = light.position - vsPosition;
         float dist = length(lightVec);
@@ -117,6 +149,7 @@ void main()
             lighting += (diffuse + specular) * attenuation;
         }
     }
+#endif
 
 	outColor = vec4(lighting, material.color.a);
 }
\ No newline at end of file
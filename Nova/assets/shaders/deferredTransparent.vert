@@ -3,9 +3,18 @@
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 // layout(location = 2) in vec2 inTexCoord;
+#ifdef NV_COMPACT_INSTANCE_DATA
+// bits 0-21 hold material index, bit 22 is set when transform has uniform scale
+layout(location = 3) in uint inPackedData;
+layout(location = 4) in vec4 inTransformRows[3];
+
+const uint MATERIAL_INDEX_MASK = 0x3FFFFFu;
+const uint UNIFORM_SCALE_BIT = 0x400000u;
+#else
 layout(location = 3) in uint inMaterialIndex;
 layout(location = 4) in mat4 inTransform;
 layout(location = 8) in mat3 inNormalTransform;
+#endif
 
 out flat uint vsMaterialIndex;
 out vec3 vsPosition;
@@ -21,7 +30,26 @@ layout(std140) uniform uCameraData
 
 void main()
 {
+#ifdef NV_COMPACT_INSTANCE_DATA
+	mat4 inTransform = transpose(mat4(inTransformRows[0], inTransformRows[1], inTransformRows[2], vec4(0.0, 0.0, 0.0, 1.0)));
+	mat3 linearTransform = mat3(inTransform);
+
+	// uniformly scaled transforms can be used for normals as is, others use cofactors, which are
+	// inverse transpose scaled by determinant
+	mat3 inNormalTransform = linearTransform;
+	if ((inPackedData & UNIFORM_SCALE_BIT) == 0u)
+	{
+		mat3 cofactors = mat3(
+			cross(linearTransform[1], linearTransform[2]),
+			cross(linearTransform[2], linearTransform[0]),
+			cross(linearTransform[0], linearTransform[1]));
+		inNormalTransform = cofactors * sign(dot(linearTransform[0], cofactors[0]));
+	}
+
+	vsMaterialIndex = inPackedData & MATERIAL_INDEX_MASK;
+#else
 	vsMaterialIndex = inMaterialIndex;
+#endif
 
 	vec4 worldPos = inTransform * vec4(inPosition, 1.0);
 	vsPosition = worldPos.xyz;
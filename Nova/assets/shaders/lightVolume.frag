@@ -0,0 +1,106 @@
+#version 450 core
+
+struct PointLight
+{
+	vec4 color;
+	vec3 position;
+	float radius;
+};
+
+in flat uint vsLightIndex;
+
+#ifdef NV_COMPACT_GBUFFER
+layout(location=2) out vec4 outColor;
+#else
+layout(location=3) out vec4 outColor;
+#endif
+
+layout(binding=0) uniform sampler2D uGBufferAlbedoSpecular;
+#ifdef NV_COMPACT_GBUFFER
+layout(binding=1) uniform sampler2D uGBufferNormal;
+layout(binding=2) uniform sampler2D uGBufferDepth;
+uniform mat4 uInverseViewProjection;
+#else
+layout(binding=1) uniform sampler2D uGBufferPosition;
+layout(binding=2) uniform sampler2D uGBufferNormal;
+#endif
+uniform float uShininess;
+
+layout(std140) uniform uCameraData
+{
+	mat4 cameraView;
+	mat4 cameraProjection;
+	vec3 cameraPosition;
+};
+
+layout(std430, binding = 1) readonly buffer sPointLightsBuffer
+{
+	PointLight pointLights[];
+};
+
+#ifdef NV_COMPACT_GBUFFER
+vec3 DecodeOctahedral(vec2 e)
+{
+	vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+	return normalize(n);
+}
+
+vec3 ReconstructPosition(vec2 texCoord, float depth)
+{
+	vec4 position = uInverseViewProjection * vec4(vec3(texCoord, depth) * 2.0 - 1.0, 1.0);
+	return position.xyz / position.w;
+}
+#endif
+
+void main()
+{
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+#ifdef NV_COMPACT_GBUFFER
+	float depth = texelFetch(uGBufferDepth, texel, 0).r;
+	if (depth == 1.0)
+		discard;
+
+	vec3 fragPos = ReconstructPosition(gl_FragCoord.xy / vec2(textureSize(uGBufferDepth, 0)), depth);
+#else
+	vec3 fragPos = texelFetch(uGBufferPosition, texel, 0).xyz;
+#endif
+	PointLight light = pointLights[vsLightIndex];
+
+	vec3 lightVec = light.position - fragPos;
+	float dist = length(lightVec);
+
+	// corners of the volume are outside of light radius
+	if (dist >= light.radius)
+		discard;
+
+#ifdef NV_COMPACT_GBUFFER
+	vec3 normal = DecodeOctahedral(texelFetch(uGBufferNormal, texel, 0).xy);
+#else
+	vec3 normal = normalize(texelFetch(uGBufferNormal, texel, 0).xyz);
+#endif
+	vec4 albedoSpecular = texelFetch(uGBufferAlbedoSpecular, texel, 0);
+
+	vec3 l = normalize(lightVec);
+	vec3 v = normalize(cameraPosition - fragPos);
+	vec3 h = normalize(l + v);
+
+	// Smooth radius attenuation
+	float x = dist / light.radius;
+	float attenuation = max(1.0 - x * x, 0.0);
+	attenuation *= attenuation;
+
+	// diffuse
+	float nDotL = max(dot(normal, l), 0.0);
+	vec3 diffuse = nDotL * albedoSpecular.rgb * light.color.rgb * light.color.a;
+
+	// specular
+	vec3 specular =
+		pow(max(dot(normal, h), 0.0), uShininess) *
+		albedoSpecular.a *
+		light.color.rgb *
+		light.color.a;
+
+	outColor = vec4((diffuse + specular) * attenuation, 0.0);
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#version 450 core
+
+struct PointLight
+{
+	vec4 color;
+	vec3 position;
+	float radius;
+};
+
+// unit cube with counter-clockwise faces, it's drawn with front faces culled
+const vec3 cCubeVertices[36] = {
+	vec3(1.0, -1.0, -1.0), vec3(1.0, 1.0, -1.0), vec3(1.0, 1.0, 1.0),
+	vec3(1.0, -1.0, -1.0), vec3(1.0, 1.0, 1.0), vec3(1.0, -1.0, 1.0),
+	vec3(-1.0, -1.0, -1.0), vec3(-1.0, -1.0, 1.0), vec3(-1.0, 1.0, 1.0),
+	vec3(-1.0, -1.0, -1.0), vec3(-1.0, 1.0, 1.0), vec3(-1.0, 1.0, -1.0),
+	vec3(-1.0, 1.0, -1.0), vec3(-1.0, 1.0, 1.0), vec3(1.0, 1.0, 1.0),
+	vec3(-1.0, 1.0, -1.0), vec3(1.0, 1.0, 1.0), vec3(1.0, 1.0, -1.0),
+	vec3(-1.0, -1.0, -1.0), vec3(1.0, -1.0, -1.0), vec3(1.0, -1.0, 1.0),
+	vec3(-1.0, -1.0, -1.0), vec3(1.0, -1.0, 1.0), vec3(-1.0, -1.0, 1.0),
+	vec3(-1.0, -1.0, 1.0), vec3(1.0, -1.0, 1.0), vec3(1.0, 1.0, 1.0),
+	vec3(-1.0, -1.0, 1.0), vec3(1.0, 1.0, 1.0), vec3(-1.0, 1.0, 1.0),
+	vec3(-1.0, -1.0, -1.0), vec3(-1.0, 1.0, -1.0), vec3(1.0, 1.0, -1.0),
+	vec3(-1.0, -1.0, -1.0), vec3(1.0, 1.0, -1.0), vec3(1.0, -1.0, -1.0),
+};
+
+out flat uint vsLightIndex;
+
+layout(std140) uniform uCameraData
+{
+	mat4 cameraView;
+	mat4 cameraProjection;
+	vec3 cameraPosition;
+};
+
+layout(std430, binding = 1) readonly buffer sPointLightsBuffer
+{
+	PointLight pointLights[];
+};
+
+void main()
+{
+	PointLight light = pointLights[gl_InstanceID];
+	vec3 position = light.position + cCubeVertices[gl_VertexID] * light.radius;
+
+	gl_Position = cameraProjection * cameraView * vec4(position, 1.0);
+	vsLightIndex = gl_InstanceID;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+
+namespace Nova::Benchmark
+{
+    /// @brief Keeps result of benchmarked code observable, so optimizer can't remove the work.
+    template<typename T>
+    inline void DoNotOptimize(const T& value) noexcept
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        static volatile const T* sink;
+        sink = &value;
+#endif
+    }
+
+    /// @brief Runs function given number of times and returns fastest run in seconds.
+    ///
+    /// Fastest run is reported instead of mean, as it is least affected by scheduling and frequency scaling noise.
+    template<typename Function>
+    double Measure(int repetitions, Function&& function)
+    {
+        auto best = std::numeric_limits<double>::max();
+        for (int i = 0; i < repetitions; i++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            const auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double>(end - start).count());
+        }
+        return best;
+    }
+
+    inline void Report(const char* name, double seconds, double items, const char* itemName) noexcept
+    {
+        std::printf("%-40s %10.3f ms %12.2f M%s/s\n", name, seconds * 1e3, items / seconds * 1e-6, itemName);
+    }
+}
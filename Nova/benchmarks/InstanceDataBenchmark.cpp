@@ -0,0 +1,88 @@
+#include "Benchmark.hpp"
+#include <Nova/graphics/InstanceData.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/matrix.hpp>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Nova;
+
+static std::vector<InstanceData> GenerateInstances(size_t count)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> scale(0.25f, 4.0f);
+    std::uniform_int_distribution<uint32_t> material(0, 1023);
+
+    std::vector<InstanceData> instances(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto rotation = glm::normalize(glm::quat(component(random), component(random), component(random), component(random)));
+        const auto uniformScale = scale(random);
+        const auto transform =
+            glm::translate(glm::mat4(1.0f), glm::vec3(position(random), position(random), position(random))) *
+            glm::mat4_cast(rotation) *
+            glm::scale(glm::mat4(1.0f), i % 2 == 0 ? glm::vec3(uniformScale) : glm::vec3(scale(random), scale(random), scale(random)));
+
+        instances[i] = InstanceData {
+            .MaterialIndex = material(random),
+            .Transform = transform,
+            .NormalTransform = glm::transpose(glm::inverse(glm::mat3(transform))),
+        };
+    }
+    return instances;
+}
+
+int main()
+{
+    constexpr int c_Repetitions = 20;
+
+    std::printf("InstanceData %zu bytes, CompactInstanceData %zu bytes per instance\n", sizeof(InstanceData), sizeof(CompactInstanceData));
+
+    for (const size_t count : { 4096, 65536, 1048576 })
+    {
+        const auto instances = GenerateInstances(count);
+        std::vector<InstanceData> fullBuffer(count);
+        std::vector<CompactInstanceData> compactBuffer(count);
+
+        std::printf("\n%zu instances, %.2f MB full, %.2f MB compact\n",
+            count,
+            double(count * sizeof(InstanceData)) * 1e-6,
+            double(count * sizeof(CompactInstanceData)) * 1e-6);
+
+        // mirrors gather done by renderer, which writes each batch into instance buffer in sorted order
+        const auto fullTime = Benchmark::Measure(c_Repetitions, [&]
+        {
+            auto instanceData = fullBuffer.data();
+            for (const auto& instance : instances)
+                *instanceData++ = instance;
+            Benchmark::DoNotOptimize(fullBuffer.data());
+        });
+        Benchmark::Report("full gather", fullTime, double(count), "instances");
+
+        const auto compactTime = Benchmark::Measure(c_Repetitions, [&]
+        {
+            auto instanceData = compactBuffer.data();
+            for (const auto& instance : instances)
+                *instanceData++ = PackCompactInstanceData(instance);
+            Benchmark::DoNotOptimize(compactBuffer.data());
+        });
+        Benchmark::Report("compact gather and pack", compactTime, double(count), "instances");
+
+        size_t uniformScaleCount = 0;
+        for (const auto& instance : compactBuffer)
+            uniformScaleCount += (instance.PackedData & c_CompactUniformScaleBit) != 0;
+
+        std::printf(
+            "written %.2f GB/s full, %.2f GB/s compact, %zu of %zu flagged as uniform scale\n",
+            double(count * sizeof(InstanceData)) / fullTime * 1e-9,
+            double(count * sizeof(CompactInstanceData)) / compactTime * 1e-9,
+            uniformScaleCount,
+            count);
+    }
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include "Benchmark.hpp"
+#include <Nova/graphics/Renderer.hpp>
+#include <Nova/graphics/Window.hpp>
+#include <Nova/debug/Log.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Nova;
+
+constexpr int c_Width = 1280;
+constexpr int c_Height = 720;
+constexpr int c_GridSize = 64;
+constexpr float c_GroundSize = 100.0f;
+constexpr int c_WarmupFrames = 16;
+constexpr int c_MeasuredFrames = 64;
+
+// ground plane covering whole viewport, so that every pixel is shaded
+static Model CreateGround()
+{
+    std::vector<ModelVertex> vertices;
+    std::vector<GLuint> indices;
+
+    for (int z = 0; z <= c_GridSize; z++)
+    {
+        for (int x = 0; x <= c_GridSize; x++)
+        {
+            const auto u = (float)x / c_GridSize;
+            const auto v = (float)z / c_GridSize;
+            vertices.push_back(ModelVertex {
+                .Position = glm::vec3((u - 0.5f) * c_GroundSize, 0.0f, (v - 0.5f) * c_GroundSize),
+                .Normal = glm::vec3(0.0f, 1.0f, 0.0f),
+                .TextureCoords = glm::vec2(u, v),
+            });
+        }
+    }
+
+    for (GLuint z = 0; z < c_GridSize; z++)
+    {
+        for (GLuint x = 0; x < c_GridSize; x++)
+        {
+            const auto i = z * (c_GridSize + 1) + x;
+            indices.insert(indices.end(), { i, i + c_GridSize + 1, i + 1, i + 1, i + c_GridSize + 1, i + c_GridSize + 2 });
+        }
+    }
+
+    return Model(1, Renderer::CreateMesh(vertices, indices), ModelBounds::FromVertices(vertices));
+}
+
+struct FrameTimes
+{
+    double GPUMilliseconds;
+    double CPUMilliseconds;
+};
+
+static FrameTimes MeasureLighting(size_t lightCount, float radius, GLuint query)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-0.5f * c_GroundSize, 0.5f * c_GroundSize);
+    std::uniform_real_distribution<float> color(0.2f, 1.0f);
+
+    std::vector<glm::vec3> positions(lightCount);
+    std::vector<glm::vec4> colors(lightCount);
+    for (size_t i = 0; i < lightCount; i++)
+    {
+        positions[i] = glm::vec3(position(random), 0.5f, position(random));
+        colors[i] = glm::vec4(color(random), color(random), color(random), 1.0f);
+    }
+
+    const auto view = glm::lookAt(glm::vec3(0.0f, 30.0f, 40.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const auto projection = glm::perspective(glm::radians(60.0f), (float)c_Width / c_Height, 0.1f, 200.0f);
+
+    FrameTimes times {};
+    for (int frame = 0; frame < c_WarmupFrames + c_MeasuredFrames; frame++)
+    {
+        Renderer::SetCamera(view, projection, glm::vec3(0.0f, 30.0f, 40.0f));
+        for (size_t i = 0; i < lightCount; i++)
+            Renderer::AddPointLight(colors[i], positions[i], radius);
+
+        const auto seconds = Benchmark::Measure(1, [&]
+        {
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            Renderer::Draw(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+            glEndQuery(GL_TIME_ELAPSED);
+            glFinish();
+        });
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+
+        if (frame >= c_WarmupFrames)
+        {
+            times.GPUMilliseconds += (double)elapsed * 1e-6 / c_MeasuredFrames;
+            times.CPUMilliseconds += seconds * 1e3 / c_MeasuredFrames;
+        }
+    }
+    return times;
+}
+
+// renderer state is global and initialized once per process, so each run measures one strategy,
+// run it from output directory, where shaders are copied
+int main(int argc, char** argv)
+{
+    const auto useLightVolumes = argc > 1 && std::strcmp(argv[1], "volumes") == 0;
+    if (argc > 1 && !useLightVolumes && std::strcmp(argv[1], "clustered") != 0)
+    {
+        std::printf("Usage: %s [clustered|volumes]\n", argv[0]);
+        return 1;
+    }
+
+    NV_LOG_INITIALIZE(std::nullopt);
+
+    Window::Initialize_(WindowSettings {
+        .Width = c_Width,
+        .Height = c_Height,
+        .Title = "LightingBenchmark",
+    });
+    Renderer::_Initialize(
+        c_Width,
+        c_Height,
+        Window::GetLoaderFunc_(),
+        RendererSettings {
+            .MaxPointLights = 4096,
+            .Lighting = useLightVolumes ? LightingStrategy::LightVolumes : LightingStrategy::Clustered,
+        });
+    Renderer::SetDisplaySize(c_Width, c_Height);
+
+    {
+        const auto ground = CreateGround();
+        const auto material = Renderer::CreateMaterial(Material { .Color = glm::vec4(0.8f, 0.8f, 0.8f, 1.0f), .SpecularIntensity = 0.5f });
+        const auto instance = Renderer::CreateInstance(&ground, material, glm::mat4(1.0f));
+
+        GLuint query;
+        glGenQueries(1, &query);
+
+        std::printf("%s lighting, %dx%d, average of %d frames\n", useLightVolumes ? "Light volume" : "Clustered", c_Width, c_Height, c_MeasuredFrames);
+        std::printf("%8s %8s %12s %12s\n", "lights", "radius", "GPU ms", "CPU ms");
+
+        for (const size_t lightCount : { 64, 256, 1024, 4096 })
+        {
+            for (const float radius : { 1.0f, 4.0f, 16.0f })
+            {
+                const auto times = MeasureLighting(lightCount, radius, query);
+                std::printf("%8zu %8.1f %12.3f %12.3f\n", lightCount, radius, times.GPUMilliseconds, times.CPUMilliseconds);
+            }
+        }
+
+        glDeleteQueries(1, &query);
+        Renderer::DestroyInstance(instance);
+        Renderer::DestroyMaterial(material);
+        Renderer::DestroyMesh(*ground.GetMesh());
+    }
+
+    Renderer::_Shutdown();
+    Window::Shutdown_();
+
+    return 0;
+}
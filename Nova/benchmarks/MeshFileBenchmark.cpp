@@ -0,0 +1,84 @@
+#include "Benchmark.hpp"
+#include "ObjAsset.hpp"
+#include <Nova/assets/MeshFile.hpp>
+#include <Nova/assets/MeshOptimizer.hpp>
+#include <Nova/assets/ObjImporter.hpp>
+#include <Nova/core/ThreadPool.hpp>
+#include <Nova/debug/Log.hpp>
+#include <cstdio>
+#include <filesystem>
+
+using namespace Nova;
+
+// sums vertex positions, so that every page of a mapped file is actually read
+static float TouchVertices(std::span<const ModelVertex> vertices) noexcept
+{
+    auto sum = 0.0f;
+    for (const auto& vertex : vertices)
+        sum += vertex.Position.x;
+    return sum;
+}
+
+// loads the same asset from OBJ file given as the first argument, or generated sphere, and from .nvmesh file
+// converted from it, which is what editor does on first and on every later run
+int main(int argc, char** argv)
+{
+    constexpr int c_Repetitions = 10;
+
+    NV_LOG_INITIALIZE(std::nullopt);
+
+    const auto isGenerated = argc < 2;
+    const auto objFilepath = isGenerated
+        ? std::filesystem::temp_directory_path() / "NovaMeshFileBenchmark.obj"
+        : std::filesystem::path(argv[1]);
+    const auto meshFilepath = std::filesystem::temp_directory_path() / "NovaMeshFileBenchmark.nvmesh";
+
+    if (isGenerated)
+        Benchmark::WriteSphereObj(objFilepath, 1024);
+
+    ThreadPool threadPool;
+    ConvertObjToMeshFile(objFilepath, meshFilepath, &threadPool);
+
+    const auto objSize = (double)std::filesystem::file_size(objFilepath);
+    const auto meshSize = (double)std::filesystem::file_size(meshFilepath);
+    std::printf("OBJ %.2f MB, .nvmesh %.2f MB, %zu worker threads\n", objSize * 1e-6, meshSize * 1e-6, threadPool.GetWorkerCount());
+
+    const auto objTime = Benchmark::Measure(c_Repetitions, [&]
+    {
+        const auto mesh = OptimizeMesh(ImportObj(objFilepath, &threadPool));
+        Benchmark::DoNotOptimize(TouchVertices(mesh.Vertices));
+    });
+    Benchmark::Report("OBJ import and optimize", objTime, objSize, "B");
+
+    const auto parseTime = Benchmark::Measure(c_Repetitions, [&]
+    {
+        const auto vertices = ImportObj(objFilepath, &threadPool);
+        Benchmark::DoNotOptimize(TouchVertices(vertices));
+    });
+    Benchmark::Report("OBJ import only", parseTime, objSize, "B");
+
+    const auto verifiedTime = Benchmark::Measure(c_Repetitions, [&]
+    {
+        const MeshFile meshFile(meshFilepath);
+        Benchmark::DoNotOptimize(TouchVertices(meshFile.GetVertices()));
+    });
+    Benchmark::Report(".nvmesh load with checksum", verifiedTime, meshSize, "B");
+
+    const auto unverifiedTime = Benchmark::Measure(c_Repetitions, [&]
+    {
+        const MeshFile meshFile(meshFilepath, false);
+        Benchmark::DoNotOptimize(TouchVertices(meshFile.GetVertices()));
+    });
+    Benchmark::Report(".nvmesh load without checksum", unverifiedTime, meshSize, "B");
+
+    std::printf(
+        ".nvmesh loads %.1fx faster than OBJ import with optimization, %.1fx faster than parsing alone\n",
+        objTime / verifiedTime,
+        parseTime / verifiedTime);
+
+    std::filesystem::remove(meshFilepath);
+    if (isGenerated)
+        std::filesystem::remove(objFilepath);
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <format>
+#include <numbers>
+
+namespace Nova::Benchmark
+{
+    /// @brief Writes UV sphere with positions, texture coordinates and normals as OBJ file, quads are split into triangles.
+    ///
+    /// Output only depends on segment count, so results of runs on different machines parse the same bytes.
+    inline void WriteSphereObj(const std::filesystem::path& filepath, int segments)
+    {
+        std::ofstream file(filepath, std::ios::binary);
+        const auto rings = segments / 2;
+
+        for (int ring = 0; ring <= rings; ring++)
+        {
+            const auto theta = std::numbers::pi * ring / rings;
+            for (int segment = 0; segment <= segments; segment++)
+            {
+                const auto phi = 2.0 * std::numbers::pi * segment / segments;
+                const auto x = std::sin(theta) * std::cos(phi);
+                const auto y = std::cos(theta);
+                const auto z = std::sin(theta) * std::sin(phi);
+
+                file << std::format("v {:.6f} {:.6f} {:.6f}\n", x, y, z);
+                file << std::format("vt {:.6f} {:.6f}\n", (double)segment / segments, (double)ring / rings);
+                file << std::format("vn {:.6f} {:.6f} {:.6f}\n", x, y, z);
+            }
+        }
+
+        for (int ring = 0; ring < rings; ring++)
+        {
+            for (int segment = 0; segment < segments; segment++)
+            {
+                const auto a = ring * (segments + 1) + segment + 1;
+                const auto b = a + segments + 1;
+                file << std::format("f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", a, b, a + 1);
+                file << std::format("f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", a + 1, b, b + 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#include "Benchmark.hpp"
+#include "ObjAsset.hpp"
+#include <Nova/assets/ObjImporter.hpp>
+#include <Nova/core/ThreadPool.hpp>
+#include <Nova/debug/Log.hpp>
+#include <cstdio>
+#include <filesystem>
+
+using namespace Nova;
+
+// parses OBJ file given as the first argument, or generated sphere of fixed size when there is none
+int main(int argc, char** argv)
+{
+    constexpr int c_Repetitions = 10;
+
+    NV_LOG_INITIALIZE(std::nullopt);
+
+    const auto isGenerated = argc < 2;
+    const auto filepath = isGenerated
+        ? std::filesystem::temp_directory_path() / "NovaObjImporterBenchmark.obj"
+        : std::filesystem::path(argv[1]);
+
+    if (isGenerated)
+        Benchmark::WriteSphereObj(filepath, 1024);
+
+    const auto fileSize = (double)std::filesystem::file_size(filepath);
+    std::printf("%s, %.2f MB\n", filepath.string().c_str(), fileSize * 1e-6);
+
+    size_t vertexCount = 0;
+    const auto serialTime = Benchmark::Measure(c_Repetitions, [&]
+    {
+        const auto vertices = ImportObj(filepath);
+        vertexCount = vertices.size();
+        Benchmark::DoNotOptimize(vertices.data());
+    });
+    Benchmark::Report("ImportObj", serialTime, fileSize, "B");
+
+    ThreadPool threadPool;
+    const auto parallelTime = Benchmark::Measure(c_Repetitions, [&]
+    {
+        const auto vertices = ImportObj(filepath, &threadPool);
+        Benchmark::DoNotOptimize(vertices.data());
+    });
+    Benchmark::Report("ImportObj with thread pool", parallelTime, fileSize, "B");
+
+    std::printf("%zu vertices, %zu worker threads\n", vertexCount, threadPool.GetWorkerCount());
+
+    if (isGenerated)
+        std::filesystem::remove(filepath);
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "Benchmark.hpp"
+#include <Nova/graphics/OcclusionCuller.hpp>
+#include <Nova/core/ThreadPool.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <array>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Nova;
+
+constexpr int32_t c_Width = 512;
+constexpr int32_t c_Height = 256;
+constexpr size_t c_SphereCount = 16384;
+
+static const std::array<glm::vec3, 8> c_BoxVertices {
+    glm::vec3(-1.0f, -1.0f, -1.0f),
+    glm::vec3(1.0f, -1.0f, -1.0f),
+    glm::vec3(1.0f, 1.0f, -1.0f),
+    glm::vec3(-1.0f, 1.0f, -1.0f),
+    glm::vec3(-1.0f, -1.0f, 1.0f),
+    glm::vec3(1.0f, -1.0f, 1.0f),
+    glm::vec3(1.0f, 1.0f, 1.0f),
+    glm::vec3(-1.0f, 1.0f, 1.0f),
+};
+
+constexpr std::array<uint32_t, 36> c_BoxIndices {
+    0, 1, 2, 0, 2, 3,
+    4, 6, 5, 4, 7, 6,
+    0, 4, 5, 0, 5, 1,
+    3, 2, 6, 3, 6, 7,
+    0, 3, 7, 0, 7, 4,
+    1, 5, 6, 1, 6, 2,
+};
+
+// boxes of varying size in front of the camera, spheres scattered behind and between them
+static std::vector<glm::mat4> GenerateOccluders(size_t count, std::mt19937& random)
+{
+    std::uniform_real_distribution<float> x(-15.0f, 15.0f);
+    std::uniform_real_distribution<float> y(-6.0f, 6.0f);
+    std::uniform_real_distribution<float> z(-30.0f, -10.0f);
+    std::uniform_real_distribution<float> size(0.5f, 3.0f);
+
+    std::vector<glm::mat4> transforms;
+    for (size_t i = 0; i < count; i++)
+        transforms.push_back(glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(x(random), y(random), z(random))), glm::vec3(size(random))));
+    return transforms;
+}
+
+int main()
+{
+    constexpr int c_Repetitions = 20;
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> sphereX(-30.0f, 30.0f);
+    std::uniform_real_distribution<float> sphereY(-12.0f, 12.0f);
+    std::uniform_real_distribution<float> sphereZ(-60.0f, -15.0f);
+    std::uniform_real_distribution<float> sphereRadius(0.1f, 1.0f);
+
+    std::vector<float> centerX, centerY, centerZ, radii;
+    for (size_t i = 0; i < c_SphereCount; i++)
+    {
+        centerX.push_back(sphereX(random));
+        centerY.push_back(sphereY(random));
+        centerZ.push_back(sphereZ(random));
+        radii.push_back(sphereRadius(random));
+    }
+    const BoundingSphereBatch spheres { centerX, centerY, centerZ, radii };
+
+    const auto viewProjection = glm::perspective(glm::radians(60.0f), (float)c_Width / c_Height, 0.1f, 100.0f);
+
+    ThreadPool threadPool;
+    OcclusionCuller culler(c_Width, c_Height);
+
+    std::printf("%dx%d depth buffer, %zu spheres, %zu worker threads\n", c_Width, c_Height, c_SphereCount, threadPool.GetWorkerCount());
+
+    for (const size_t occluderCount : { 16, 128, 1024 })
+    {
+        const auto transforms = GenerateOccluders(occluderCount, random);
+
+        culler.Clear();
+        for (const auto& transform : transforms)
+            culler.AddOccluder(c_BoxVertices, c_BoxIndices, transform);
+
+        std::printf("\n%zu box occluders\n", occluderCount);
+
+        const auto triangleCount = double(occluderCount * c_BoxIndices.size() / 3);
+        const auto serialTime = Benchmark::Measure(c_Repetitions, [&] { culler.Rasterize(viewProjection); });
+        Benchmark::Report("Rasterize", serialTime, triangleCount, "triangles");
+
+        const auto parallelTime = Benchmark::Measure(c_Repetitions, [&] { culler.Rasterize(viewProjection, &threadPool); });
+        Benchmark::Report("Rasterize with thread pool", parallelTime, triangleCount, "triangles");
+
+        std::vector<uint32_t> indices;
+        size_t occludedCount = 0;
+        const auto testTime = Benchmark::Measure(c_Repetitions, [&]
+        {
+            indices.resize(c_SphereCount);
+            for (uint32_t i = 0; i < c_SphereCount; i++)
+                indices[i] = i;
+            occludedCount = culler.RemoveOccluded(spheres, indices);
+        });
+        Benchmark::Report("RemoveOccluded", testTime, double(c_SphereCount), "spheres");
+
+        std::printf("%zu triangles set up, %zu of %zu spheres occluded\n", culler.GetTriangleCount(), occludedCount, c_SphereCount);
+    }
+
+    return 0;
+}
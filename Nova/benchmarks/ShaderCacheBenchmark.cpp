@@ -0,0 +1,134 @@
+#include "Benchmark.hpp"
+#include <Nova/graphics/Renderer.hpp>
+#include <Nova/graphics/ShaderCache.hpp>
+#include <Nova/graphics/Window.hpp>
+#include <Nova/debug/Log.hpp>
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+using namespace Nova;
+
+constexpr int c_Repetitions = 5;
+
+static constexpr std::array<std::string_view, 1> c_LODFadeDefines { "NV_LOD_FADE" };
+static constexpr std::array<std::string_view, 1> c_CompactInstanceDefines { "NV_COMPACT_INSTANCE_DATA" };
+static constexpr std::array<std::string_view, 1> c_CompactGBufferDefines { "NV_COMPACT_GBUFFER" };
+
+struct ProgramSource
+{
+    std::string_view Name;
+    std::array<ShaderStageSource, 2> Stages;
+};
+
+// variants of renderer programs which don't need cluster grid defines
+static const std::array<ProgramSource, 5> c_Programs {
+    ProgramSource { "Basic", {
+        ShaderStageSource { .Type = ShaderType::Vertex, .Filepath = "./assets/shaders/basic.vert" },
+        ShaderStageSource { .Type = ShaderType::Fragment, .Filepath = "./assets/shaders/basic.frag" },
+    } },
+    ProgramSource { "DeferredGeometry", {
+        ShaderStageSource { .Type = ShaderType::Vertex, .Filepath = "./assets/shaders/deferredGeometry.vert" },
+        ShaderStageSource { .Type = ShaderType::Fragment, .Filepath = "./assets/shaders/deferredGeometry.frag" },
+    } },
+    ProgramSource { "DeferredGeometryLODFade", {
+        ShaderStageSource { .Type = ShaderType::Vertex, .Filepath = "./assets/shaders/deferredGeometry.vert", .Defines = c_LODFadeDefines },
+        ShaderStageSource { .Type = ShaderType::Fragment, .Filepath = "./assets/shaders/deferredGeometry.frag", .Defines = c_LODFadeDefines },
+    } },
+    ProgramSource { "DeferredGeometryCompact", {
+        ShaderStageSource { .Type = ShaderType::Vertex, .Filepath = "./assets/shaders/deferredGeometry.vert", .Defines = c_CompactInstanceDefines },
+        ShaderStageSource { .Type = ShaderType::Fragment, .Filepath = "./assets/shaders/deferredGeometry.frag", .Defines = c_CompactGBufferDefines },
+    } },
+    ProgramSource { "LightVolume", {
+        ShaderStageSource { .Type = ShaderType::Vertex, .Filepath = "./assets/shaders/lightVolume.vert" },
+        ShaderStageSource { .Type = ShaderType::Fragment, .Filepath = "./assets/shaders/lightVolume.frag" },
+    } },
+};
+
+static void LoadPrograms(ShaderCache& cache)
+{
+    // programs are deleted right away, driver calls can't be optimized out anyway
+    for (const auto& program : c_Programs)
+        cache.LoadProgram(program.Name, program.Stages);
+}
+
+// issues every program before waiting for any, so the driver can compile them in parallel
+static void LoadProgramsConcurrently(ShaderCache& cache)
+{
+    std::vector<PendingCachedProgram> pending;
+    pending.reserve(c_Programs.size());
+    for (const auto& program : c_Programs)
+        pending.push_back(cache.BeginLoadProgram(program.Name, program.Stages));
+
+    for (auto& program : pending)
+        cache.FinishLoadProgram(program);
+}
+
+// compares compilation from source with loading of cached binaries, run it from output directory,
+// where shaders are copied. Drivers with their own shader cache make compilation look cheaper than on first launch.
+int main()
+{
+    NV_LOG_INITIALIZE(std::nullopt);
+
+    Window::Initialize_(WindowSettings {
+        .Width = 640,
+        .Height = 360,
+        .Title = "ShaderCacheBenchmark",
+    });
+    if (!gladLoadGL(Window::GetLoaderFunc_()))
+    {
+        std::printf("Failed to load OpenGL functions\n");
+        return 1;
+    }
+
+    const RendererInfo rendererInfo {
+        .VendorName = reinterpret_cast<const char*>(glGetString(GL_VENDOR)),
+        .RendererName = reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+        .Version = reinterpret_cast<const char*>(glGetString(GL_VERSION)),
+        .GLSLVersion = reinterpret_cast<const char*>(glGetString(GL_SHADING_LANGUAGE_VERSION)),
+    };
+    std::printf("%.*s, %.*s\n", (int)rendererInfo.RendererName.size(), rendererInfo.RendererName.data(), (int)rendererInfo.Version.size(), rendererInfo.Version.data());
+
+    const auto programCount = (double)c_Programs.size();
+    {
+        ShaderCache disabledCache;
+        Benchmark::Report("Compile", Benchmark::Measure(c_Repetitions, [&] { LoadPrograms(disabledCache); }), programCount, "programs");
+        Benchmark::Report("Compile concurrently", Benchmark::Measure(c_Repetitions, [&] { LoadProgramsConcurrently(disabledCache); }), programCount, "programs");
+    }
+
+    const auto directory = std::filesystem::temp_directory_path() / "NovaShaderCacheBenchmark";
+    {
+        ShaderCache cache(directory, rendererInfo);
+        if (!cache.IsEnabled())
+        {
+            std::printf("Shader cache is not available\n");
+        }
+        else
+        {
+            // includes removing files of the previous repetition, which is small next to compilation
+            const auto missTime = Benchmark::Measure(c_Repetitions, [&]
+            {
+                cache.Clear(true);
+                LoadProgramsConcurrently(cache);
+            });
+            Benchmark::Report("Compile and store", missTime, programCount, "programs");
+
+            const auto hitTime = Benchmark::Measure(c_Repetitions, [&] { LoadPrograms(cache); });
+            Benchmark::Report("Load cached binaries", hitTime, programCount, "programs");
+
+            const auto& stats = cache.GetStats();
+            std::printf("%u hits, %u misses, %u rejected\n", stats.Hits, stats.Misses, stats.Rejected);
+
+            cache.Clear(true);
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+
+    Window::Shutdown_();
+
+    return 0;
+}
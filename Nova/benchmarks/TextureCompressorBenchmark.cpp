@@ -0,0 +1,115 @@
+#include "Benchmark.hpp"
+#include <Nova/assets/TextureCompressor.hpp>
+#include <Nova/core/ThreadPool.hpp>
+#include <Nova/debug/Log.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace Nova;
+
+// smooth gradients with noise, so that both endpoint fitting and flat blocks are exercised
+static Image GenerateImage(uint32_t size)
+{
+    Image image;
+    image.Width = size;
+    image.Height = size;
+    image.Pixels.resize(GetImageSize(image));
+
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int> noise(-8, 8);
+
+    for (uint32_t y = 0; y < size; y++)
+    {
+        for (uint32_t x = 0; x < size; x++)
+        {
+            const auto u = (float)x / size;
+            const auto v = (float)y / size;
+            const std::array<float, 4> values = {
+                255.0f * u,
+                255.0f * v,
+                127.5f + 127.5f * std::sin(12.0f * (u + v)),
+                // alpha stays above BC1 punch-through threshold, which would turn texels black
+                136.0f + 119.0f * (1.0f - u * v),
+            };
+
+            auto* pixel = &image.Pixels[((size_t)y * size + x) * 4];
+            for (size_t i = 0; i < 4; i++)
+                pixel[i] = (uint8_t)std::clamp((int)values[i] + noise(random), 0, 255);
+        }
+    }
+
+    return image;
+}
+
+static const char* GetFormatName(BlockFormat format)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1: return "BC1";
+    case BlockFormat::BC3: return "BC3";
+    case BlockFormat::BC5: return "BC5";
+    case BlockFormat::BC7: return "BC7";
+    }
+    return "?";
+}
+
+static const char* GetQualityName(CompressionQuality quality)
+{
+    switch (quality)
+    {
+    case CompressionQuality::Fast: return "Fast";
+    case CompressionQuality::Normal: return "Normal";
+    case CompressionQuality::High: return "High";
+    }
+    return "?";
+}
+
+// compresses image given as the first argument, or generated 1024x1024 image when there is none
+int main(int argc, char** argv)
+{
+    constexpr int c_Repetitions = 3;
+
+    NV_LOG_INITIALIZE(std::nullopt);
+
+    const auto image = argc < 2 ? GenerateImage(1024) : LoadImageFile(argv[1]);
+    const auto pixelCount = (double)image.Width * image.Height;
+    std::printf("%ux%u image\n", image.Width, image.Height);
+
+    ThreadPool threadPool;
+
+    for (const auto format : { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC5, BlockFormat::BC7 })
+    {
+        for (const auto quality : { CompressionQuality::Fast, CompressionQuality::Normal, CompressionQuality::High })
+        {
+            char name[64];
+            std::snprintf(name, sizeof(name), "%s %s", GetFormatName(format), GetQualityName(quality));
+
+            CompressedImage compressed;
+            const auto time = Benchmark::Measure(c_Repetitions, [&]
+            {
+                compressed = CompressImage(image, format, quality);
+                Benchmark::DoNotOptimize(compressed.Blocks.data());
+            });
+            Benchmark::Report(name, time, pixelCount, "P");
+
+            const auto parallelTime = Benchmark::Measure(c_Repetitions, [&]
+            {
+                const auto result = CompressImage(image, format, quality, &threadPool);
+                Benchmark::DoNotOptimize(result.Blocks.data());
+            });
+            std::snprintf(name, sizeof(name), "%s %s with thread pool", GetFormatName(format), GetQualityName(quality));
+            Benchmark::Report(name, parallelTime, pixelCount, "P");
+
+            // BC5 only keeps red and green, BC1 alpha is a single bit and would dominate the error
+            const auto channelCount = format == BlockFormat::BC5 ? 2u : format == BlockFormat::BC1 ? 3u : 4u;
+            std::printf("    PSNR %.2f dB\n", ComputePSNR(image, DecompressImage(compressed, format), channelCount));
+        }
+    }
+
+    std::printf("%zu worker threads\n", threadPool.GetWorkerCount());
+
+    return 0;
+}
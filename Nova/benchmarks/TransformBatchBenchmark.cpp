@@ -0,0 +1,148 @@
+#include "Benchmark.hpp"
+#include <Nova/core/TransformBatch.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Nova;
+
+struct TransformData
+{
+    std::vector<float> PositionX, PositionY, PositionZ;
+    std::vector<float> RotationX, RotationY, RotationZ, RotationW;
+    std::vector<float> ScaleX, ScaleY, ScaleZ;
+
+    TransformBatch GetBatch() const noexcept
+    {
+        return { PositionX, PositionY, PositionZ, RotationX, RotationY, RotationZ, RotationW, ScaleX, ScaleY, ScaleZ };
+    }
+};
+
+// half of objects get uniform scale, which is the common case in scenes and takes shortcut in batched path
+static TransformData GenerateTransforms(size_t count)
+{
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> component(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> scale(0.25f, 4.0f);
+
+    TransformData data;
+    for (size_t i = 0; i < count; i++)
+    {
+        const auto rotation = glm::normalize(glm::quat(component(random), component(random), component(random), component(random)));
+        const auto uniformScale = scale(random);
+        const auto uniform = i % 2 == 0;
+
+        data.PositionX.push_back(position(random));
+        data.PositionY.push_back(position(random));
+        data.PositionZ.push_back(position(random));
+        data.RotationX.push_back(rotation.x);
+        data.RotationY.push_back(rotation.y);
+        data.RotationZ.push_back(rotation.z);
+        data.RotationW.push_back(rotation.w);
+        data.ScaleX.push_back(uniformScale);
+        data.ScaleY.push_back(uniform ? uniformScale : scale(random));
+        data.ScaleZ.push_back(uniform ? uniformScale : scale(random));
+    }
+    return data;
+}
+
+static void BuildReferenceMatrices(const TransformData& data, std::span<glm::mat4> transforms, std::span<glm::mat3> normalTransforms) noexcept
+{
+    for (size_t i = 0; i < transforms.size(); i++)
+    {
+        const glm::quat rotation(data.RotationW[i], data.RotationX[i], data.RotationY[i], data.RotationZ[i]);
+        transforms[i] =
+            glm::translate(glm::mat4(1.0f), glm::vec3(data.PositionX[i], data.PositionY[i], data.PositionZ[i])) *
+            glm::mat4_cast(rotation) *
+            glm::scale(glm::mat4(1.0f), glm::vec3(data.ScaleX[i], data.ScaleY[i], data.ScaleZ[i]));
+        normalTransforms[i] = glm::transpose(glm::inverse(glm::mat3(transforms[i])));
+    }
+}
+
+// batched normal matrices are only correct up to positive scale, so directions of transformed normals are compared
+static float GetMaxNormalError(std::span<const glm::mat3> reference, std::span<const glm::mat3> tested) noexcept
+{
+    const glm::vec3 normal = glm::normalize(glm::vec3(0.3f, -0.5f, 0.8f));
+    auto maxError = 0.0f;
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        const auto expected = glm::normalize(reference[i] * normal);
+        const auto actual = glm::normalize(tested[i] * normal);
+        maxError = std::max(maxError, glm::length(expected - actual));
+    }
+    return maxError;
+}
+
+static float GetMaxTransformError(std::span<const glm::mat4> reference, std::span<const glm::mat4> tested) noexcept
+{
+    auto maxError = 0.0f;
+    for (size_t i = 0; i < reference.size(); i++)
+    {
+        for (int column = 0; column < 4; column++)
+        {
+            const auto difference = glm::abs(reference[i][column] - tested[i][column]);
+            maxError = std::max({ maxError, difference.x, difference.y, difference.z, difference.w });
+        }
+    }
+    return maxError;
+}
+
+int main()
+{
+    constexpr int c_Repetitions = 20;
+
+#if defined(__AVX2__)
+    std::printf("BuildTransformMatrices path: AVX2\n");
+#else
+    std::printf("BuildTransformMatrices path: scalar\n");
+#endif
+
+    for (const size_t count : { 1024, 16384, 262144 })
+    {
+        const auto data = GenerateTransforms(count);
+        std::vector<glm::mat4> referenceTransforms(count);
+        std::vector<glm::mat3> referenceNormalTransforms(count);
+        std::vector<glm::mat4> transforms(count);
+        std::vector<glm::mat3> normalTransforms(count);
+        std::vector<glm::mat3> cofactorNormalTransforms(count);
+
+        std::printf("\n%zu objects\n", count);
+
+        const auto referenceTime = Benchmark::Measure(c_Repetitions, [&]
+        {
+            BuildReferenceMatrices(data, referenceTransforms, referenceNormalTransforms);
+            Benchmark::DoNotOptimize(referenceNormalTransforms.data());
+        });
+        Benchmark::Report("glm translate * rotate * scale, inverse", referenceTime, double(count), "objects");
+
+        const auto batchTime = Benchmark::Measure(c_Repetitions, [&]
+        {
+            BuildTransformMatrices(data.GetBatch(), transforms, normalTransforms);
+            Benchmark::DoNotOptimize(normalTransforms.data());
+        });
+        Benchmark::Report("BuildTransformMatrices", batchTime, double(count), "objects");
+
+        const auto cofactorTime = Benchmark::Measure(c_Repetitions, [&]
+        {
+            BuildNormalMatrices(referenceTransforms, cofactorNormalTransforms);
+            Benchmark::DoNotOptimize(cofactorNormalTransforms.data());
+        });
+        Benchmark::Report("BuildNormalMatrices", cofactorTime, double(count), "objects");
+
+        std::printf(
+            "speedup %.2fx, max transform error %g, max normal error %g (batched) %g (cofactors)\n",
+            referenceTime / batchTime,
+            GetMaxTransformError(referenceTransforms, transforms),
+            GetMaxNormalError(referenceNormalTransforms, normalTransforms),
+            GetMaxNormalError(referenceNormalTransforms, cofactorNormalTransforms));
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <Nova/core/File.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <filesystem>
+#include <span>
+#include <vector>
+#include <string_view>
+#include <format>
+#include <stdexcept>
+#include <type_traits>
+#include <cstring>
+#include <cstdint>
+#include <xxhash.h>
+
+namespace Nova
+{
+    /// Every section of an asset file starts at a multiple of this, so that it can be read in place from the mapping.
+    constexpr size_t c_AssetFileAlignment = 16;
+
+    /// @brief Kind of binary asset file, such as .nvmesh or .nvtex. Name starts error messages, for example "Mesh".
+    struct AssetFileType
+    {
+        std::string_view Name;
+        uint32_t Magic;
+        uint32_t Version;
+    };
+
+    constexpr uint64_t AlignAssetFileOffset(uint64_t offset) noexcept
+    {
+        return (offset + c_AssetFileAlignment - 1) / c_AssetFileAlignment * c_AssetFileAlignment;
+    }
+
+    /// @brief Copies header from the start of the file and checks its magic and version. Header starts with
+    /// Magic and Version and has a Checksum of everything after it, which is verified when verifyChecksum is set.
+    ///
+    /// Sections are read in place from the mapping, so files are only valid for little-endian hosts with this layout.
+    template <typename Header>
+    Header ReadAssetFileHeader(std::span<const std::byte> data, const AssetFileType& type, bool verifyChecksum)
+    {
+        static_assert(std::is_trivially_copyable_v<Header>);
+        static_assert(sizeof(Header) % c_AssetFileAlignment == 0);
+
+        Header header;
+        if (data.size() < sizeof(header))
+            throw std::runtime_error(std::format("{} file is too small.", type.Name));
+
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (header.Magic != type.Magic)
+            throw std::runtime_error(std::format("{} file has unknown magic number.", type.Name));
+
+        if (header.Version != type.Version)
+            throw std::runtime_error(std::format("{} file version is not supported.", type.Name));
+
+        if (verifyChecksum)
+        {
+            NV_PROFILE_SCOPE("VerifyChecksum");
+
+            if (XXH3_64bits(data.data() + sizeof(header), data.size() - sizeof(header)) != header.Checksum)
+                throw std::runtime_error(std::format("{} file checksum doesn't match.", type.Name));
+        }
+
+        return header;
+    }
+
+    /// @brief Array of count elements at offset, which has to be aligned and lie within the file.
+    template <typename T>
+    std::span<const T> GetAssetFileSection(
+        std::span<const std::byte> data,
+        uint64_t offset,
+        uint64_t count,
+        const AssetFileType& type,
+        std::string_view sectionName)
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+
+        if (offset % c_AssetFileAlignment != 0 || offset > data.size() || count > (data.size() - offset) / sizeof(T))
+            throw std::runtime_error(std::format("{} file {} is out of bounds.", type.Name, sectionName));
+
+        return { reinterpret_cast<const T*>(data.data() + offset), (size_t)count };
+    }
+
+    /// @brief Checksums data after the header, stores header at the start of data and replaces the file atomically,
+    /// so that the file can be mapped by another process or streamed from at the same time.
+    template <typename Header>
+    void WriteAssetFile(const std::filesystem::path& filepath, Header header, std::vector<std::byte>& data)
+    {
+        static_assert(std::is_trivially_copyable_v<Header>);
+
+        header.Checksum = XXH3_64bits(data.data() + sizeof(header), data.size() - sizeof(header));
+        std::memcpy(data.data(), &header, sizeof(header));
+
+        File::WriteAtomically(filepath, data);
+    }
+}
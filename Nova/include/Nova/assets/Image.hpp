@@ -0,0 +1,37 @@
+#pragma once
+#include <filesystem>
+#include <vector>
+#include <cstdint>
+
+namespace Nova
+{
+    /// @brief RGBA8 pixels stored row by row from the top, without padding.
+    struct Image
+    {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        std::vector<uint8_t> Pixels;
+    };
+
+    enum class MipFilter
+    {
+        /// Average of 2x2 texels, cheap but prone to aliasing.
+        Box,
+        /// Kaiser-windowed sinc over 6x6 texels, keeps smaller levels sharper.
+        Kaiser,
+    };
+
+    /// @brief Decodes PNG, JPEG, TGA, BMP, PSD, GIF, HDR, PIC or PNM file into RGBA8 image.
+    Image LoadImageFile(const std::filesystem::path& filepath);
+
+    /// @brief Builds full mip chain down to 1x1, base image becomes level 0.
+    ///
+    /// Levels are filtered in floating point, color channels of sRGB images are filtered in linear space
+    /// and alpha is always treated as linear.
+    std::vector<Image> GenerateMipChain(Image&& image, MipFilter filter, bool isSRGB);
+
+    constexpr size_t GetImageSize(const Image& image) noexcept
+    {
+        return (size_t)image.Width * image.Height * 4;
+    }
+}
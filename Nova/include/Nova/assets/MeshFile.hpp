@@ -0,0 +1,71 @@
+#pragma once
+#include <Nova/assets/Model.hpp>
+#include <Nova/assets/AssetFile.hpp>
+#include <Nova/core/MappedFile.hpp>
+#include <filesystem>
+#include <span>
+#include <cstdint>
+#include <xxhash.h>
+
+namespace Nova
+{
+    class ThreadPool;
+
+    /// @brief Fixed-size header at the start of .nvmesh file. Offsets are in bytes from the start of the file
+    /// and every stream is aligned to c_AssetFileAlignment, checksum covers everything after the header.
+    struct MeshFileHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t VertexCount;
+        uint32_t IndexCount;
+        uint32_t LODCount;
+        uint32_t VertexStride;
+        ModelBounds Bounds;
+        uint64_t VertexOffset;
+        uint64_t IndexOffset;
+        uint64_t LODOffset;
+        XXH64_hash_t Checksum;
+    };
+
+    constexpr uint32_t c_MeshFileMagic = 0x48534D4E; // "NMSH"
+    constexpr uint32_t c_MeshFileVersion = 1;
+
+    /// @brief Mesh stored in memory-mapped .nvmesh file. Streams are spans into the mapping, so they can be passed
+    /// straight to Renderer::CreateMesh or Buffer without copying them on CPU. File has to outlive the spans.
+    class MeshFile
+    {
+    public:
+        MeshFile() = default;
+
+        /// Checksum verification reads the whole file, it can be skipped for files which were just written.
+        /// Indices are checked against vertex count instead then, so that a damaged file can't index past vertices.
+        explicit MeshFile(const std::filesystem::path& filepath, bool verifyChecksum = true);
+
+        constexpr std::span<const ModelVertex> GetVertices() const noexcept { return vertices_; }
+        constexpr std::span<const GLuint> GetIndices() const noexcept { return indices_; }
+        constexpr std::span<const ModelLOD> GetLODs() const noexcept { return lods_; }
+        constexpr const ModelBounds& GetBounds() const noexcept { return bounds_; }
+
+    private:
+        MappedFile file_;
+        std::span<const ModelVertex> vertices_;
+        std::span<const GLuint> indices_;
+        std::span<const ModelLOD> lods_;
+        ModelBounds bounds_ {};
+    };
+
+    /// @brief Writes indexed mesh as .nvmesh file, bounds are computed from vertices.
+    /// Throws when any index is out of vertex range.
+    void WriteMeshFile(
+        const std::filesystem::path& filepath,
+        std::span<const ModelVertex> vertices,
+        std::span<const GLuint> indices,
+        std::span<const ModelLOD> lods = {});
+
+    /// @brief Imports OBJ file, welds and optimizes it and writes the result as .nvmesh file.
+    void ConvertObjToMeshFile(
+        const std::filesystem::path& objFilepath,
+        const std::filesystem::path& meshFilepath,
+        ThreadPool* threadPool = nullptr);
+}
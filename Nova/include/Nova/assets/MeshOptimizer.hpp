@@ -0,0 +1,57 @@
+#pragma once
+#include <Nova/assets/Model.hpp>
+#include <glad/gl.h>
+#include <vector>
+#include <span>
+#include <cstdint>
+
+namespace Nova
+{
+    /// @brief Post-transform vertex cache efficiency of an index list, simulated with FIFO cache.
+    struct VertexCacheStatistics
+    {
+        float ACMR; // average cache misses per triangle, 3 without any reuse, about 0.5 for regular grids
+        float ATVR; // average transforms per vertex, 1 when every vertex is transformed once
+    };
+
+    struct OptimizedMesh
+    {
+        std::vector<ModelVertex> Vertices;
+        std::vector<GLuint> Indices;
+        VertexCacheStatistics Before;
+        VertexCacheStatistics After;
+    };
+
+    constexpr uint32_t DefaultVertexCacheSize = 16;
+
+    /// @brief Merges bitwise identical vertices and returns index of every input vertex in uniqueVertices.
+    std::vector<GLuint> WeldVertices(
+        std::span<const ModelVertex> vertices,
+        std::vector<ModelVertex>& uniqueVertices);
+
+    /// @brief Reorders triangles for post-transform cache locality with Tipsify, which fans around recently
+    /// used vertices and runs in linear time. Triangles keep their winding.
+    void OptimizeVertexCache(
+        std::span<GLuint> indices,
+        size_t vertexCount,
+        uint32_t cacheSize = DefaultVertexCacheSize);
+
+    /// @brief Reorders vertices by first use in indices, so that vertex fetch reads memory sequentially.
+    /// Vertices not referenced by any index are removed.
+    void OptimizeVertexFetch(
+        std::span<GLuint> indices,
+        std::vector<ModelVertex>& vertices);
+
+    VertexCacheStatistics AnalyzeVertexCache(
+        std::span<const GLuint> indices,
+        size_t vertexCount,
+        uint32_t cacheSize = DefaultVertexCacheSize);
+
+    /// @brief Turns triangle list of separate vertices, as expanded from face corners, into optimized indexed mesh.
+    /// Triangles which collapse to a line or a point after welding are dropped.
+    OptimizedMesh OptimizeMesh(std::span<const ModelVertex> vertices);
+
+    OptimizedMesh OptimizeMesh(
+        std::span<const ModelVertex> vertices,
+        std::span<const GLuint> indices);
+}
@@ -1,8 +1,10 @@
 #pragma once
-#include <Nova/graphics/opengl/Buffer.hpp>
+#include <Nova/graphics/MeshAllocator.hpp>
 #include <vector>
 #include <optional>
+#include <span>
 #include <glad/gl.h>
+#include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 
 namespace Nova
@@ -14,32 +16,76 @@ namespace Nova
 		glm::vec2 TextureCoords;
 	};
 
+	struct BoundingBox
+	{
+		glm::vec3 Min;
+		glm::vec3 Max;
+	};
+
+	struct BoundingSphere
+	{
+		glm::vec3 Center;
+		float Radius;
+	};
+
+	struct ModelBounds
+	{
+		BoundingBox Box;
+		BoundingSphere Sphere;
+
+		static ModelBounds FromVertices(std::span<const ModelVertex> vertices) noexcept;
+	};
+
+	/// @brief Range of model's indices drawn at one level of detail. Level is used while diameter of model's
+	/// projected bounding sphere, relative to viewport height, is at least MinScreenSize.
+	struct ModelLOD
+	{
+		GLuint FirstIndex;
+		GLuint IndexCount;
+		float MinScreenSize;
+	};
+
+	/// @brief Model references mesh sub-allocated from renderer's shared geometry buffers and never owns it.
+	///
+	/// Every constructor follows the same rule: mesh stays allocated until it's released with Renderer::DestroyMesh,
+	/// so the code which created the model, directly or from vertices, destroys its mesh once no model uses it.
+	/// Copies reference the same mesh.
 	class Model
 	{
 	public:
 		Model() = default;
-		
-		Model(size_t id, Buffer&& modelDataBuffer)
-			: id_(id),
-			  modelBuffer_(std::move(modelDataBuffer)),
-			  indexBuffer_(std::nullopt) { }
 
-		Model(size_t id, Buffer&& modelDataBuffer, Buffer&& indexBuffer)
-			: id_(id),
-			  modelBuffer_(std::move(modelDataBuffer)),
-			  indexBuffer_(std::move(indexBuffer)) { }
+		/// Uploads vertices into a new mesh with Renderer::CreateMesh, vertices are drawn in order.
+		Model(size_t id, std::span<const ModelVertex> vertices);
+
+		/// Uploads vertices and indices into a new mesh with Renderer::CreateMesh.
+		Model(size_t id, std::span<const ModelVertex> vertices, std::span<const GLuint> indices);
+
+		/// Indices of all levels share vertices and are stored one after another, levels go from the most detailed one
+		/// and their thresholds have to decrease, the last level is used for any smaller size.
+		Model(
+			size_t id,
+			std::span<const ModelVertex> vertices,
+			std::span<const GLuint> indices,
+			std::span<const ModelLOD> lods);
+
+		/// LOD index ranges are relative to mesh's indices.
+		Model(
+			size_t id,
+			MeshHandle mesh,
+			const ModelBounds& bounds,
+			std::span<const ModelLOD> lods = {});
 
 		constexpr size_t GetID() const noexcept { return id_; }
-		constexpr const Buffer& GetModelDataBuffer() const noexcept { return modelBuffer_; }
-		constexpr const std::optional<Nova::Buffer>& GetIndexBuffer() const noexcept { return indexBuffer_; }
-		constexpr bool UsesIndexBuffer() const noexcept { return indexBuffer_.has_value(); }
-		constexpr size_t GetIndexDataSize() const noexcept { return indexBuffer_.has_value() ? indexBuffer_.value().GetSize() : 0; }
-		constexpr size_t GetModelDataSize() const noexcept { return modelBuffer_.GetSize(); }
 		constexpr GLenum GetPrimitiveMode() const noexcept { return primitiveMode_; }
+		constexpr const ModelBounds& GetBounds() const noexcept { return bounds_; }
+		constexpr std::span<const ModelLOD> GetLODs() const noexcept { return lods_; }
+		constexpr const std::optional<MeshHandle>& GetMesh() const noexcept { return mesh_; }
 
 	private:
-		std::optional<Nova::Buffer> indexBuffer_;
-		Nova::Buffer modelBuffer_;
+		ModelBounds bounds_;
+		std::vector<ModelLOD> lods_;
+		std::optional<MeshHandle> mesh_;
 		GLenum primitiveMode_ = GL_TRIANGLES;
 		size_t id_;
 	};
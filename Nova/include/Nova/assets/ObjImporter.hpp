@@ -0,0 +1,23 @@
+#pragma once
+#include <Nova/assets/Model.hpp>
+#include <filesystem>
+#include <vector>
+
+namespace Nova
+{
+    class ThreadPool;
+
+    constexpr size_t DefaultObjChunkSize = 1 << 20;
+
+    /// @brief Imports geometry of Wavefront OBJ file as triangle list with a separate vertex for every face corner,
+    /// OptimizeMesh turns it into indexed mesh.
+    ///
+    /// File is memory-mapped and split into line aligned chunks, which are parsed in parallel by workers of threadPool
+    /// if given. Polygons are triangulated as fans, negative (relative) indices are supported, corners without texture
+    /// coordinates get zeros and faces without normals get flat normals. Materials, groups, lines and points are ignored.
+    /// Result doesn't depend on chunk size or on how chunks are distributed between workers.
+    std::vector<ModelVertex> ImportObj(
+        const std::filesystem::path& filepath,
+        ThreadPool* threadPool = nullptr,
+        size_t chunkSize = DefaultObjChunkSize);
+}
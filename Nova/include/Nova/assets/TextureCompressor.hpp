@@ -0,0 +1,62 @@
+#pragma once
+#include <Nova/assets/Image.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace Nova
+{
+    class ThreadPool;
+
+    /// @brief Block compression formats, every block encodes 4x4 texels.
+    enum class BlockFormat : uint32_t
+    {
+        /// RGB with 1-bit alpha, 8 bytes per block.
+        BC1,
+        /// RGB with interpolated alpha, 16 bytes per block.
+        BC3,
+        /// Two independent channels taken from red and green, 16 bytes per block, meant for normal maps.
+        BC5,
+        /// RGBA, 16 bytes per block. Only single subset mode 6 is used, which trades quality of blocks
+        /// with several distinct colors for speed.
+        BC7,
+    };
+
+    enum class CompressionQuality : uint32_t
+    {
+        /// Endpoints from the bounding box diagonal along which channels of the block change together.
+        Fast,
+        /// Endpoints along principal axis of the block, refined once by least squares.
+        Normal,
+        /// Like Normal with more refinement passes, BC7 tries every parity bit combination.
+        High,
+    };
+
+    /// @brief Block compressed image, blocks are stored row by row from the top.
+    struct CompressedImage
+    {
+        uint32_t Width = 0;
+        uint32_t Height = 0;
+        std::vector<uint8_t> Blocks;
+    };
+
+    constexpr uint32_t GetBlockSize(BlockFormat format) noexcept
+    {
+        return format == BlockFormat::BC1 ? 8 : 16;
+    }
+
+    /// @brief Encodes RGBA8 image, edge texels are repeated to fill partial blocks.
+    ///
+    /// Values are encoded as they are, sRGB images are compressed in sRGB space. Rows of blocks are spread over the pool.
+    CompressedImage CompressImage(
+        const Image& image,
+        BlockFormat format,
+        CompressionQuality quality,
+        ThreadPool* threadPool = nullptr);
+
+    /// @brief Decodes image produced by CompressImage, BC7 blocks have to use mode 6.
+    /// Channels missing from BC5 are decoded as 0 for blue and 255 for alpha.
+    Image DecompressImage(const CompressedImage& image, BlockFormat format);
+
+    /// @brief Peak signal-to-noise ratio in dB over the first channelCount channels, infinite for identical images.
+    double ComputePSNR(const Image& reference, const Image& image, uint32_t channelCount = 4);
+}
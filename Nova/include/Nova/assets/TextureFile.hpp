@@ -0,0 +1,93 @@
+#pragma once
+#include <Nova/assets/TextureCompressor.hpp>
+#include <Nova/assets/AssetFile.hpp>
+#include <Nova/core/MappedFile.hpp>
+#include <Nova/graphics/opengl/GL.hpp>
+#include <filesystem>
+#include <span>
+#include <cstdint>
+#include <xxhash.h>
+
+namespace Nova
+{
+    class ThreadPool;
+
+    /// @brief Fixed-size header at the start of .nvtex file. Level table and level data offsets are in bytes
+    /// from the start of the file, every one is aligned to c_AssetFileAlignment, checksum covers everything after the header.
+    struct TextureFileHeader
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        BlockFormat Format;
+        uint32_t IsSRGB;
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t LevelCount;
+        uint32_t Reserved;
+        uint64_t LevelOffset;
+        XXH64_hash_t Checksum;
+    };
+
+    struct TextureFileLevel
+    {
+        uint32_t Width;
+        uint32_t Height;
+        uint64_t Offset;
+        uint64_t Size;
+    };
+
+    constexpr uint32_t c_TextureFileMagic = 0x58544E4E; // "NNTX"
+    constexpr uint32_t c_TextureFileVersion = 1;
+
+    struct TextureCompressionSettings
+    {
+        BlockFormat Format = BlockFormat::BC7;
+        CompressionQuality Quality = CompressionQuality::Normal;
+        MipFilter Filter = MipFilter::Kaiser;
+        /// Mips are filtered in linear space and texture is sampled through sRGB format, ignored for BC5.
+        bool IsSRGB = true;
+    };
+
+    /// @brief Block compressed texture with full mip chain stored in memory-mapped .nvtex file.
+    /// Level data is uploaded straight from the mapping.
+    class TextureFile
+    {
+    public:
+        TextureFile() = default;
+
+        /// Checksum verification reads the whole file, it can be skipped for files which were just written.
+        explicit TextureFile(const std::filesystem::path& filepath, bool verifyChecksum = true);
+
+        /// @brief Creates immutable texture with all levels, caller owns it and deletes it with glDeleteTextures.
+        GLuint CreateTexture() const;
+
+        std::span<const std::byte> GetLevelData(uint32_t level) const;
+
+        constexpr std::span<const TextureFileLevel> GetLevels() const noexcept { return levels_; }
+        constexpr BlockFormat GetFormat() const noexcept { return format_; }
+        constexpr bool IsSRGB() const noexcept { return isSRGB_; }
+
+    private:
+        MappedFile file_;
+        std::span<const TextureFileLevel> levels_;
+        BlockFormat format_ = BlockFormat::BC7;
+        bool isSRGB_ = false;
+    };
+
+    InternalFormat GetCompressedInternalFormat(BlockFormat format, bool isSRGB) noexcept;
+
+    /// @brief Writes compressed mip chain as .nvtex file, level i has to be max(1, size >> i) of the first one.
+    void WriteTextureFile(
+        const std::filesystem::path& filepath,
+        std::span<const CompressedImage> levels,
+        BlockFormat format,
+        bool isSRGB);
+
+    /// @brief Loads image, generates its mip chain, compresses every level and writes the result as .nvtex file.
+    /// Compression throughput and quality of the base level are logged.
+    void ConvertImageToTextureFile(
+        const std::filesystem::path& imageFilepath,
+        const std::filesystem::path& textureFilepath,
+        const TextureCompressionSettings& settings = {},
+        ThreadPool* threadPool = nullptr);
+}
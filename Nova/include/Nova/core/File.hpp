@@ -2,6 +2,8 @@
 #include <filesystem>
 #include <utility>
 #include <string_view>
+#include <span>
+#include <cstddef>
 
 namespace Nova::File
 {
@@ -14,4 +16,9 @@ namespace Nova::File
 
 	std::pair<std::unique_ptr<uint8_t[]>, size_t> ReadBinary(
 		const std::filesystem::path& filepath);
+
+	/// @brief Writes data next to the destination and renames it over it, so readers never see a partially written file.
+	void WriteAtomically(
+		const std::filesystem::path& filepath,
+		std::span<const std::byte> data);
 }
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <cstddef>
+
+namespace Nova
+{
+	/// @brief Read-only view of whole file mapped into memory, pages are loaded by the OS on first access.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+
+		explicit MappedFile(const std::filesystem::path& filepath);
+
+		MappedFile(MappedFile&& other) noexcept;
+
+		MappedFile(const MappedFile&) = delete;
+
+		~MappedFile() noexcept;
+
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		std::span<const std::byte> GetData() const noexcept { return { data_, size_ }; }
+
+		std::string_view GetText() const noexcept { return { reinterpret_cast<const char*>(data_), size_ }; }
+
+		constexpr size_t GetSize() const noexcept { return size_; }
+
+	private:
+		void Unmap() noexcept;
+
+		const std::byte* data_ = nullptr;
+		size_t size_ = 0;
+	};
+}
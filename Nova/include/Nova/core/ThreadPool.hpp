@@ -0,0 +1,56 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+namespace Nova
+{
+    /// @brief Fixed set of worker threads executing data parallel loops.
+    ///
+    /// Calling thread takes part in every loop, so a pool without workers runs loops serially.
+    /// Loops are executed one at a time, ParallelFor calls from several threads are serialized.
+    class ThreadPool
+    {
+    public:
+        /// @brief Creates pool with one worker less than hardware threads, calling thread being the last one.
+        ThreadPool();
+
+        explicit ThreadPool(size_t workerCount);
+
+        ThreadPool(const ThreadPool&) = delete;
+
+        ~ThreadPool() noexcept;
+
+        /// @brief Calls function for every index in [0, count) and returns once all calls have finished.
+        /// First exception thrown by any call is rethrown after the loop, remaining indices are still processed.
+        void ParallelFor(size_t count, const std::function<void(size_t)>& function);
+
+        size_t GetWorkerCount() const noexcept { return workers_.size(); }
+
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+    private:
+        void WorkerLoop(std::stop_token stopToken);
+
+        void RunIndices(const std::function<void(size_t)>& function, size_t count) noexcept;
+
+        std::vector<std::jthread> workers_;
+        std::mutex submitMutex_;
+
+        // state of the current loop, guarded by mutex_ except for the index counter
+        std::mutex mutex_;
+        std::condition_variable_any loopStarted_;
+        std::condition_variable loopFinished_;
+        const std::function<void(size_t)>* function_ = nullptr;
+        size_t count_ = 0;
+        uint64_t generation_ = 0;
+        size_t activeWorkers_ = 0;
+        std::exception_ptr exception_;
+        std::atomic<size_t> nextIndex_ = 0;
+    };
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <span>
+
+namespace Nova
+{
+    /// @brief Translation, rotation (unit quaternion) and scale of many objects stored as separate component arrays.
+    struct TransformBatch
+    {
+        std::span<const float> PositionX;
+        std::span<const float> PositionY;
+        std::span<const float> PositionZ;
+        std::span<const float> RotationX;
+        std::span<const float> RotationY;
+        std::span<const float> RotationZ;
+        std::span<const float> RotationW;
+        std::span<const float> ScaleX;
+        std::span<const float> ScaleY;
+        std::span<const float> ScaleZ;
+    };
+
+    /// @brief Builds model and normal matrices of whole batch, eight objects at a time when AVX2 is available.
+    ///
+    /// Normal matrices are only correct up to a positive scale factor, shaders are expected to normalize transformed normals.
+    /// That allows objects with uniform positive scale to use their rotation matrix directly, other objects use R * S^-1,
+    /// so a general matrix inverse is never computed.
+    void BuildTransformMatrices(
+        const TransformBatch& batch,
+        std::span<glm::mat4> transforms,
+        std::span<glm::mat3> normalTransforms) noexcept;
+
+    /// @brief Builds normal matrices of arbitrary affine transforms from cofactors of their upper 3x3 part.
+    ///
+    /// Cofactor matrix equals inverse transpose scaled by determinant, only its sign is applied, so no division is needed.
+    /// Like BuildTransformMatrices, results are correct up to a positive scale factor.
+    void BuildNormalMatrices(
+        std::span<const glm::mat4> transforms,
+        std::span<glm::mat3> normalTransforms) noexcept;
+}
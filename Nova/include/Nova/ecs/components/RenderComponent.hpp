@@ -5,5 +5,5 @@
 struct RenderComponent
 {
     Nova::Model* Model;
-    Nova::Material* Material;
+    Nova::MaterialHandle Material;
 };
\ No newline at end of file
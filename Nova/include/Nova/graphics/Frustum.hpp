@@ -0,0 +1,40 @@
+#pragma once
+#include <Nova/assets/Model.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <array>
+#include <vector>
+#include <span>
+#include <cstdint>
+
+namespace Nova
+{
+    /// @brief Bounding spheres stored as separate component arrays, so that they can be tested several at a time.
+    struct BoundingSphereBatch
+    {
+        std::span<const float> CenterX;
+        std::span<const float> CenterY;
+        std::span<const float> CenterZ;
+        std::span<const float> Radius;
+    };
+
+    class Frustum
+    {
+    public:
+        Frustum() = default;
+
+        /// @brief Extracts normalized clipping planes from view-projection matrix.
+        explicit Frustum(const glm::mat4& viewProjection) noexcept;
+
+        bool Intersects(const BoundingSphere& sphere) const noexcept;
+
+        /// @brief Appends indices of spheres intersecting the frustum to visibleIndices.
+        /// @return Number of visible spheres.
+        size_t CullSpheres(const BoundingSphereBatch& spheres, std::vector<uint32_t>& visibleIndices) const;
+
+        constexpr const std::array<glm::vec4, 6>& GetPlanes() const noexcept { return planes_; }
+
+    private:
+        std::array<glm::vec4, 6> planes_ {};
+    };
+}
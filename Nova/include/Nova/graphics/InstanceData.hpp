@@ -0,0 +1,34 @@
+#pragma once
+#include <glm/vec4.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <cstdint>
+
+namespace Nova
+{
+    /// @brief Default per-instance data uploaded to instance buffer.
+    struct InstanceData
+    {
+        uint32_t MaterialIndex;
+        glm::mat4 Transform;
+        glm::mat3 NormalTransform;
+    };
+
+    /// @brief Opt-in instance format, rows of 3x4 affine transform followed by packed material index and flags,
+    /// normal transform is derived in vertex shader.
+    struct CompactInstanceData
+    {
+        glm::vec4 TransformRows[3];
+        uint32_t PackedData;
+    };
+
+    constexpr uint32_t c_CompactMaterialIndexBits = 22;
+    constexpr uint32_t c_CompactMaterialIndexMask = (1u << c_CompactMaterialIndexBits) - 1;
+    constexpr uint32_t c_CompactUniformScaleBit = 1u << 22;
+    constexpr uint32_t c_LODFadeShift = 23; // bits 23-30 of material index hold weight of cross-faded level of detail
+    constexpr uint32_t c_LODFadeInvertBit = 1u << 31; // set on the coarser level, which keeps complementary pixels
+    constexpr uint32_t c_LODFadeMask = ~((1u << c_LODFadeShift) - 1);
+
+    /// @brief Converts instance to compact format, flagging transforms made of rotation and uniform scale.
+    CompactInstanceData PackCompactInstanceData(const InstanceData& instance) noexcept;
+}
@@ -2,6 +2,7 @@
 #include <cstdint>
 #include <cstring>
 #include <glm/vec4.hpp>
+#include <Nova/core/Utility.hpp>
 
 namespace Nova
 {
@@ -16,4 +17,10 @@ namespace Nova
 	{
 		return a.Color == b.Color && a.SpecularIntensity == b.SpecularIntensity;
 	}
+
+	/// @brief Index of material registered in renderer's material table.
+	struct MaterialHandle : public StrongTypedef<MaterialHandle, uint32_t>
+	{
+		using StrongTypedef::StrongTypedef;
+	};
 }
\ No newline at end of file
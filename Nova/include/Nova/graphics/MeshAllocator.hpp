@@ -0,0 +1,107 @@
+#pragma once
+#include <Nova/core/Utility.hpp>
+#include <Nova/graphics/opengl/Buffer.hpp>
+#include <glad/gl.h>
+#include <vector>
+#include <map>
+#include <set>
+#include <span>
+#include <string_view>
+#include <cstdint>
+
+namespace Nova
+{
+    /// @brief Stable handle of mesh stored in MeshAllocator, it stays valid across defragmentation.
+    struct MeshHandle : public StrongTypedef<MeshHandle, uint32_t>
+    {
+        using StrongTypedef::StrongTypedef;
+    };
+
+    /// @brief Location of mesh's data in shared buffers. Indices are relative to BaseVertex.
+    struct MeshRange
+    {
+        GLuint BaseVertex;
+        GLuint VertexCount;
+        GLuint BaseIndex;
+        GLuint IndexCount;
+    };
+
+    /// @brief Packs vertex and index data of many meshes into one vertex and one index buffer,
+    /// so that all of them can be drawn with a single vertex array binding.
+    ///
+    /// Free space of each buffer is a list of ranges, allocation takes the smallest range that fits and freed ranges
+    /// merge with their neighbours. Buffers double when they run out of space. Defragment packs live meshes
+    /// to the start of new buffers, data is only copied on GPU.
+    class MeshAllocator
+    {
+    public:
+        MeshAllocator() = default;
+
+        MeshAllocator(GLsizei vertexStride, GLuint initialVertexCount, GLuint initialIndexCount);
+
+        /// @brief Reserves space without writing it, data is expected to be copied into returned range.
+        /// Throws when a buffer would exceed its maximum size, nothing stays reserved then.
+        MeshHandle Allocate(GLuint vertexCount, GLuint indexCount);
+
+        /// @brief Reserves space and uploads vertices, which have size of vertex stride, and indices.
+        MeshHandle Allocate(const void* vertices, GLuint vertexCount, std::span<const GLuint> indices);
+
+        void Free(MeshHandle handle);
+
+        /// @brief Tells whether mesh of given size fits into free space, so that allocating it doesn't replace buffers.
+        bool Fits(GLuint vertexCount, GLuint indexCount) const noexcept;
+
+        /// @brief Moves all live meshes to the start of new buffers, which removes every gap between them.
+        void Defragment();
+
+        /// @brief Part of buffer capacity lost in gaps between meshes, the larger one of vertex and index buffer.
+        float GetFragmentation() const noexcept;
+
+        /// @brief Tells whether handle refers to an allocated mesh, which wasn't freed since.
+        bool IsLive(MeshHandle handle) const noexcept;
+
+        /// @brief Throws when the mesh was freed or handle doesn't come from this allocator.
+        const MeshRange& GetRange(MeshHandle handle) const;
+
+        /// @brief Changes whenever buffers are replaced or meshes move, so that users can rebind buffers
+        /// and refresh offsets they copied.
+        constexpr uint32_t GetVersion() const noexcept { return version_; }
+
+        constexpr const Buffer& GetVertexBuffer() const noexcept { return vertices_.Data; }
+        constexpr const Buffer& GetIndexBuffer() const noexcept { return indices_.Data; }
+
+        void Delete() noexcept;
+
+    private:
+        struct Pool
+        {
+            Buffer Data;
+            std::string_view DebugName;
+            GLsizei ElementSize = 0;
+            GLuint Capacity = 0;
+            std::map<GLuint, GLuint> FreeByOffset; // offset -> size
+            std::set<std::pair<GLuint, GLuint>> FreeBySize; // (size, offset), used for best fit
+
+            GLuint Allocate(GLuint count);
+            bool Fits(GLuint count) const noexcept;
+            void Grow(GLuint count);
+            void AddFreeRange(GLuint offset, GLuint count); // merges range with adjacent free ranges
+            void RemoveFreeRange(std::map<GLuint, GLuint>::iterator range);
+            GLuint GetGapCount() const noexcept;
+        };
+
+        struct Mesh
+        {
+            MeshRange Range;
+            bool IsLive;
+        };
+
+        void CompactPool(Pool& pool, GLuint MeshRange::* offset, GLuint MeshRange::* count);
+
+        Pool vertices_;
+        Pool indices_;
+        std::vector<Mesh> meshes_;
+        std::vector<uint32_t> freeHandles_;
+        uint32_t version_ = 0;
+    };
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <Nova/graphics/Frustum.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+#include <vector>
+#include <span>
+#include <cstdint>
+
+namespace Nova
+{
+    class ThreadPool;
+
+    /// @brief Conservative CPU occlusion culling against a low resolution depth buffer of designated occluders.
+    ///
+    /// Occluder triangles are binned into screen tiles, which are rasterized in parallel, several pixels per instruction
+    /// when SSE2 or AVX is available. Every tile also keeps the farthest depth of its pixels, so bounds behind
+    /// a fully covered tile are rejected without reading pixels. Nothing here touches OpenGL.
+    ///
+    /// Occluders only write pixels they cover entirely, with the farthest depth they have within the pixel, while bounds
+    /// are tested against every pixel they touch, so visible objects are never culled. In turn, pixels along edges
+    /// shared by occluder triangles stay empty, so occluders should be made of few large triangles.
+    class OcclusionCuller
+    {
+    public:
+        static constexpr int32_t TileWidth = 32;
+        static constexpr int32_t TileHeight = 16;
+
+        OcclusionCuller() = default;
+
+        /// @brief Size is rounded up to whole tiles.
+        OcclusionCuller(int32_t width, int32_t height);
+
+        /// @brief Removes occluders of the previous frame.
+        void Clear() noexcept;
+
+        /// @brief Adds triangle list to rasterize, vertex and index data are only referenced and have to stay alive
+        /// until Rasterize. Triangles are rasterized from both sides, so single sided walls and floors occlude too.
+        void AddOccluder(
+            std::span<const glm::vec3> vertices,
+            std::span<const uint32_t> indices,
+            const glm::mat4& transform);
+
+        /// @brief Rasterizes all occluders into depth buffer, distributing tiles between workers of threadPool if given.
+        /// Triangles reaching in front of the near plane are skipped, which never hides anything visible.
+        void Rasterize(const glm::mat4& viewProjection, ThreadPool* threadPool = nullptr);
+
+        /// @brief Tells whether any part of sphere's screen space bounds is not behind rasterized occluders.
+        bool IsVisible(const BoundingSphere& sphere) const noexcept;
+
+        /// @brief Removes indices of occluded spheres from indices, keeping order of the rest.
+        /// @return Number of removed indices.
+        size_t RemoveOccluded(const BoundingSphereBatch& spheres, std::vector<uint32_t>& indices) const;
+
+        /// @brief Window space depth of every pixel, rows go from the bottom of the screen, 1 where nothing was rasterized.
+        constexpr std::span<const float> GetDepth() const noexcept { return depth_; }
+
+        constexpr int32_t GetWidth() const noexcept { return width_; }
+        constexpr int32_t GetHeight() const noexcept { return height_; }
+        constexpr size_t GetOccluderCount() const noexcept { return occluders_.size(); }
+        constexpr size_t GetTriangleCount() const noexcept { return triangles_.size(); }
+
+    private:
+        struct Occluder
+        {
+            std::span<const glm::vec3> Vertices;
+            std::span<const uint32_t> Indices;
+            glm::mat4 Transform;
+        };
+
+        // edge functions and depth plane are evaluated at pixel centers as a * x + b * y + c,
+        // both are already offset by half a pixel for conservative rasterization
+        struct ScreenTriangle
+        {
+            glm::vec3 Edges[3];
+            glm::vec3 DepthPlane;
+            int32_t MinX;
+            int32_t MinY;
+            int32_t MaxX;
+            int32_t MaxY;
+        };
+
+        void SetupTriangles(const glm::mat4& viewProjection);
+
+        void RasterizeTile(size_t tileIndex) noexcept;
+
+        bool IsRectVisible(int32_t minX, int32_t minY, int32_t maxX, int32_t maxY, float nearestDepth) const noexcept;
+
+        std::vector<Occluder> occluders_;
+        std::vector<glm::vec4> clipPositions_;
+        std::vector<ScreenTriangle> triangles_;
+        std::vector<std::vector<uint32_t>> tileTriangles_;
+        std::vector<float> tileMaxDepth_;
+        std::vector<float> depth_;
+        glm::mat4 viewProjection_ { 1.0f };
+        int32_t width_ = 0;
+        int32_t height_ = 0;
+        int32_t tileCountX_ = 0;
+        int32_t tileCountY_ = 0;
+    };
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <vector>
+#include <span>
+#include <bit>
+#include <cstdint>
+
+namespace Nova
+{
+    struct RenderQueueEntry
+    {
+        uint64_t Key;
+        uint32_t PayloadIndex;
+    };
+
+    /// @brief Layouts of 64-bit render queue keys, from the most significant bits:
+    /// state-major: pass (4 bits) | model slot (20 bits) | material (16 bits) | quantized depth (24 bits),
+    /// depth-major: pass (4 bits) | quantized depth (24 bits) | model slot (20 bits) | material (16 bits).
+    /// Pass always occupies the top bits, so that every pass is a contiguous range of sorted queue.
+    namespace RenderSortKey
+    {
+        constexpr uint32_t PassBits = 4;
+        constexpr uint32_t ModelBits = 20;
+        constexpr uint32_t MaterialBits = 16;
+        constexpr uint32_t DepthBits = 24;
+
+        constexpr uint32_t DepthShift = 0;
+        constexpr uint32_t MaterialShift = DepthShift + DepthBits;
+        constexpr uint32_t ModelShift = MaterialShift + MaterialBits;
+        constexpr uint32_t PassShift = ModelShift + ModelBits;
+
+        constexpr uint32_t DepthMajorMaterialShift = 0;
+        constexpr uint32_t DepthMajorModelShift = DepthMajorMaterialShift + MaterialBits;
+        constexpr uint32_t DepthMajorDepthShift = DepthMajorModelShift + ModelBits;
+
+        static_assert(PassShift + PassBits == 64);
+        static_assert(DepthMajorDepthShift + DepthBits == PassShift);
+
+        constexpr uint64_t Mask(uint32_t bits) noexcept { return (uint64_t(1) << bits) - 1; }
+
+        constexpr uint32_t MaxModels = uint32_t(1) << ModelBits;
+
+        /// @brief Quantizes non-negative distance so that ordering of the result matches ordering of distances.
+        /// Positive IEEE-754 floats compare the same way as their bit patterns, so no depth range is needed.
+        constexpr uint32_t QuantizeDepth(float distance) noexcept
+        {
+            const auto bits = std::bit_cast<uint32_t>(distance > 0.0f ? distance : 0.0f);
+            return bits >> (32 - DepthBits);
+        }
+
+        constexpr uint32_t InvertDepth(uint32_t quantizedDepth) noexcept
+        {
+            return (uint32_t)(~quantizedDepth & Mask(DepthBits));
+        }
+
+        constexpr uint64_t Make(uint32_t pass, uint32_t model, uint32_t material, uint32_t depth) noexcept
+        {
+            return ((uint64_t(pass) & Mask(PassBits)) << PassShift) |
+                ((uint64_t(model) & Mask(ModelBits)) << ModelShift) |
+                ((uint64_t(material) & Mask(MaterialBits)) << MaterialShift) |
+                ((uint64_t(depth) & Mask(DepthBits)) << DepthShift);
+        }
+
+        constexpr uint64_t MakeDepthMajor(uint32_t pass, uint32_t depth, uint32_t model, uint32_t material) noexcept
+        {
+            return ((uint64_t(pass) & Mask(PassBits)) << PassShift) |
+                ((uint64_t(depth) & Mask(DepthBits)) << DepthMajorDepthShift) |
+                ((uint64_t(model) & Mask(ModelBits)) << DepthMajorModelShift) |
+                ((uint64_t(material) & Mask(MaterialBits)) << DepthMajorMaterialShift);
+        }
+
+        constexpr uint32_t GetPass(uint64_t key) noexcept { return (uint32_t)((key >> PassShift) & Mask(PassBits)); }
+        constexpr uint32_t GetModel(uint64_t key) noexcept { return (uint32_t)((key >> ModelShift) & Mask(ModelBits)); }
+        constexpr uint32_t GetDepthMajorModel(uint64_t key) noexcept { return (uint32_t)((key >> DepthMajorModelShift) & Mask(ModelBits)); }
+    }
+
+    /// @brief Sorts entries by key with LSD radix sort, 8 bits per pass.
+    /// Passes over bytes which have the same value in every key are skipped.
+    void RadixSort(std::vector<RenderQueueEntry>& entries, std::vector<RenderQueueEntry>& scratch);
+
+    /// @brief Flat list of sort keys referencing payloads stored in one contiguous arena.
+    /// Storage is kept between frames, so steady state submission does not allocate.
+    template <typename TPayload>
+    class RenderQueue
+    {
+    public:
+        void Push(uint64_t key, const TPayload& payload)
+        {
+            entries_.push_back(RenderQueueEntry { key, (uint32_t)payloads_.size() });
+            payloads_.push_back(payload);
+        }
+
+        void Sort() { RadixSort(entries_, scratch_); }
+
+        void Clear() noexcept
+        {
+            entries_.clear();
+            payloads_.clear();
+        }
+
+        constexpr std::span<const RenderQueueEntry> GetEntries() const noexcept { return entries_; }
+        constexpr const TPayload& GetPayload(const RenderQueueEntry& entry) const noexcept { return payloads_[entry.PayloadIndex]; }
+        constexpr size_t GetSize() const noexcept { return entries_.size(); }
+        constexpr bool IsEmpty() const noexcept { return entries_.empty(); }
+
+    private:
+        std::vector<RenderQueueEntry> entries_;
+        std::vector<RenderQueueEntry> scratch_;
+        std::vector<TPayload> payloads_;
+    };
+}
@@ -7,13 +7,21 @@
 #include <Nova/graphics/Rect.hpp>
 #include <Nova/graphics/Material.hpp>
 #include <Nova/graphics/RendererSettings.hpp>
+#include <Nova/graphics/MeshAllocator.hpp>
+#include <Nova/graphics/UploadQueue.hpp>
+#include <Nova/graphics/ShaderCache.hpp>
+#include <Nova/graphics/TextureStreamer.hpp>
 #include <Nova/assets/Model.hpp>
 #include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
+#include <glm/mat3x3.hpp>
 #include <glm/mat4x4.hpp>
 #include <utility>
 #include <filesystem>
 #include <optional>
+#include <memory>
+#include <span>
 
 namespace Nova
 {
@@ -32,6 +40,8 @@ namespace Nova
 		Points = GL_POINT,
 	};
 
+	/// @brief Render targets exposed by GetRenderTextureID. With compact G-buffer, Position has no texture
+	/// and Normal is octahedral-encoded.
 	enum class RenderTexture
 	{
 		Color = 0,
@@ -41,13 +51,79 @@ namespace Nova
 		Output = 4,
 	};
 
+	/// @brief Stable handle of instance retained by renderer between frames.
+	struct InstanceHandle : public StrongTypedef<InstanceHandle, uint32_t>
+	{
+		using StrongTypedef::StrongTypedef;
+	};
+
 	namespace Renderer
 	{
+		NV_API MaterialHandle CreateMaterial(const Material& material);
+
+		NV_API void UpdateMaterial(MaterialHandle handle, const Material& material);
+
+		/// @brief Material can't be destroyed while retained instances use it, they have to be destroyed or switched
+		/// to another material first.
+		NV_API void DestroyMaterial(MaterialHandle handle);
+
+		NV_API const Material& GetMaterial(MaterialHandle handle);
+
+		/// @brief Largest part of viewport height covered by visible instances using material in the last frame,
+		/// for example to request texture resolution. With GPU culling, retained instances are measured by the cull
+		/// shader and their sizes lag one frame behind.
+		NV_API float GetMaterialScreenSize(MaterialHandle handle);
+
+		/// @brief Streamed texture is requested every frame at screen size of the material, nullopt detaches it.
+		/// Texture has to be detached from all materials before it's unloaded. Requires texture streaming enabled
+		/// in RendererSettings.
+		NV_API void SetMaterialTexture(MaterialHandle handle, std::optional<StreamedTextureHandle> texture);
+
+		/// Mesh is sub-allocated from renderer's shared geometry buffers. Models only reference it, so it stays
+		/// allocated until DestroyMesh, which is also how meshes of models created from vertices are released.
+		///
+		/// Data is copied into the buffers by upload thread and the next frame waits for the copy on GPU before drawing.
+		/// Spans have to stay valid until then, which dataOwner guarantees by being kept alive with the upload,
+		/// for example memory-mapped file they point into. Without owner data is copied on CPU first.
+		NV_API MeshHandle CreateMesh(
+			std::span<const ModelVertex> vertices,
+			std::span<const GLuint> indices,
+			std::shared_ptr<const void> dataOwner = nullptr);
+
+		NV_API void DestroyMesh(MeshHandle mesh);
+
 		NV_API void Render(
 			const Model* model,
-			const Material& material,
+			MaterialHandle material,
 			const glm::mat4& transform);
 
+		/// Normal transform may be scaled by any positive factor, see BuildTransformMatrices.
+		NV_API void Render(
+			const Model* model,
+			MaterialHandle material,
+			const glm::mat4& transform,
+			const glm::mat3& normalTransform);
+
+		/// Retained instances are drawn every frame until destroyed, only changes are uploaded to GPU.
+		NV_API InstanceHandle CreateInstance(
+			const Model* model,
+			MaterialHandle material,
+			const glm::mat4& transform);
+
+		/// Occluders are simplified meshes rasterized on CPU when software occlusion culling is enabled, instances
+		/// submitted with Render behind them aren't drawn. Like Render, occluders are submitted every frame,
+		/// vertex and index data are only referenced and have to stay alive until Draw.
+		NV_API void AddOccluder(
+			std::span<const glm::vec3> vertices,
+			std::span<const GLuint> indices,
+			const glm::mat4& transform);
+
+		NV_API void SetInstanceTransform(InstanceHandle instance, const glm::mat4& transform);
+
+		NV_API void SetInstanceMaterial(InstanceHandle instance, MaterialHandle material);
+
+		NV_API void DestroyInstance(InstanceHandle instance);
+
 		NV_API void SetCamera(
 			const glm::mat4& view,
 			const glm::mat4& projection,
@@ -65,6 +141,15 @@ namespace Nova
 
 		NV_API const RendererInfo& GetInfo() noexcept;
 
+		/// Counts loads of renderer's own programs since initialization.
+		NV_API const ShaderCacheStats& GetShaderCacheStats() noexcept;
+
+		/// Buffers and textures uploaded through the queue are created on renderer's upload thread.
+		NV_API UploadQueue& GetUploadQueue() noexcept;
+
+		/// Textures are updated once per frame after culling, only available with texture streaming enabled.
+		NV_API TextureStreamer& GetTextureStreamer() noexcept;
+
 		NV_API void SetDisplaySize(int width, int height) noexcept;
 
 		/*NV_API void BeginFrame(int displayWidth, int displayHeight);
@@ -1,15 +1,34 @@
 #pragma once
+#include <Nova/graphics/TextureStreamer.hpp>
 #include <glad/gl.h>
 #include <filesystem>
 #include <optional>
 
 namespace Nova
 {
+    enum class LightingStrategy
+    {
+        Clustered, // point lights are binned into clusters, full screen pass evaluates lights of each pixel's cluster
+        LightVolumes, // every point light is drawn as a bounding box, which shades only pixels inside of it
+    };
+
     struct RendererSettings
     {
         std::optional<std::filesystem::path> ShaderCacheDirectory = std::nullopt;
-        GLuint MaxPointLights = 32;
+        GLuint MaxPointLights = 1024;
+        // upper bound of point lights evaluated by a single pixel, lights over it are dropped from the cluster,
+        // which is reported by Renderer::OverflowedClusters profile counter and a warning
+        GLuint MaxLightsPerCluster = 128;
+        LightingStrategy Lighting = LightingStrategy::Clustered;
+        bool UseGPUCulling = false; // retained opaque instances are culled and their draw commands written by compute shaders
+        bool UseOcclusionCulling = false; // with GPU culling, retained instances hidden behind depth of previous frame are skipped
+        bool UseSoftwareOcclusionCulling = false; // instances submitted with Render are tested against occluders rasterized on CPU
+        bool UseCompactGBuffer = false; // reconstruct positions from depth and store octahedral normals, which halves G-buffer size
         GLuint MaxDirectionalLights = 2;
-        GLuint MaxMaterials = 64;
+        GLuint MaxMaterials = 64; // initial capacity of material table, it grows when more materials are created
+        bool UseCompactInstanceData = false; // stream 52 instead of 104 bytes per instance, normal transforms are derived in shaders
+        float LODFadeRange = 0.0f; // fraction below each LOD threshold over which levels cross-fade with dithering, 0 switches at once
+        bool UseTextureStreaming = false; // renderer owns a texture streamer, which streams textures of materials by their screen size
+        TextureStreamerSettings TextureStreaming = {};
     };
 }
\ No newline at end of file
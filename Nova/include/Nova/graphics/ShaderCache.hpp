@@ -3,53 +3,107 @@
 #include <filesystem>
 #include <string_view>
 #include <string>
-#include <functional>
+#include <span>
 #include <chrono>
-#include <concepts>
+#include <initializer_list>
 #include <unordered_map>
-#include <type_traits>
 #include <optional>
-#include <nlohmann/json.hpp>
 #include <xxhash.h>
 
 namespace Nova
 {
+    struct RendererInfo;
+
+    struct ShaderStageSource
+    {
+        ShaderType Type;
+        std::filesystem::path Filepath;
+        std::span<const std::string_view> Defines = {};
+    };
+
     struct CachedProgram
     {
         std::string Name;
+        XXH64_hash_t Key;
         GLenum BinaryType;
         std::chrono::system_clock::time_point CreatedAt;
         XXH64_hash_t Hash;
     };
 
+    struct ShaderCacheStats
+    {
+        uint32_t Hits = 0;
+        uint32_t Misses = 0;
+        /// Cached binaries which were corrupted or rejected by the driver, each of them also counts as a miss.
+        uint32_t Rejected = 0;
+    };
+
+    /// @brief Program started by ShaderCache::BeginLoadProgram, which is ready right away when its binary was cached.
+    struct PendingCachedProgram
+    {
+        PendingShaderProgram Program;
+        std::string Name;
+        XXH64_hash_t Key = 0;
+        bool IsCached = false;
+
+        bool IsReady() const noexcept { return Program.IsReady(); }
+    };
+
+    /// @brief Stores linked program binaries on disk, keyed by content instead of by name.
+    ///
+    /// Key of a program covers its preprocessed stage sources and defines, GPU vendor, renderer and driver version
+    /// and binary formats supported by the driver, so editing a shader or updating the driver simply misses the cache.
+    /// Programs which miss are compiled from source and stored, binary and registry files are replaced atomically.
     class ShaderCache
     {
     public:
-        ShaderCache();
+        /// @brief Creates disabled cache, which compiles every program from source.
+        ShaderCache() = default;
 
-        ShaderCache(const std::filesystem::path &directory);
-
-        ~ShaderCache() noexcept;
+        /// @brief Creates cache in given directory. When the directory can't be created or the driver doesn't support
+        /// program binaries, a warning is logged and the cache stays disabled.
+        ShaderCache(const std::filesystem::path &directory, const RendererInfo &rendererInfo);
 
         void Clear(bool removeData) noexcept;
 
-        bool IsProgramCached(const std::string_view name) noexcept;
+        /// @brief Loads cached binary of program built from given stages, or compiles and caches it.
+        /// Name only labels the entry, entry of the same name with a different key is replaced.
+        ShaderProgram LoadProgram(const std::string_view name, std::span<const ShaderStageSource> stages);
 
-        ShaderProgram LoadCachedProgram(const std::string_view name);
+        ShaderProgram LoadProgram(const std::string_view name, std::initializer_list<ShaderStageSource> stages)
+        {
+            return LoadProgram(name, std::span(stages.begin(), stages.size()));
+        }
 
-        ShaderProgram LoadCachedProgram(const std::string_view name, std::function<ShaderProgram(void)> fallback);
+        /// @brief Like LoadProgram, but program which missed the cache is only issued to the driver, without waiting
+        /// for it. Starting every program before finishing any lets driver compile them in parallel.
+        PendingCachedProgram BeginLoadProgram(const std::string_view name, std::span<const ShaderStageSource> stages);
 
-        void CacheProgram(ShaderProgram &program, const std::string_view name);
+        PendingCachedProgram BeginLoadProgram(const std::string_view name, std::initializer_list<ShaderStageSource> stages)
+        {
+            return BeginLoadProgram(name, std::span(stages.begin(), stages.size()));
+        }
 
-        void SetDirectory(const std::filesystem::path &directory);
+        /// @brief Waits for program started by BeginLoadProgram and caches it, when it missed the cache.
+        ShaderProgram FinishLoadProgram(PendingCachedProgram &pending);
 
-        std::filesystem::path GetCachedProgramFilepath(const std::string_view name);
+        bool IsProgramCached(XXH64_hash_t key) const noexcept;
 
+        constexpr bool IsEnabled() const noexcept { return m_IsEnabled; }
+        constexpr const ShaderCacheStats &GetStats() const noexcept { return m_Stats; }
         constexpr const std::filesystem::path &GetDirectory() const noexcept { return m_Directory; }
 
     private:
-        std::unordered_map<std::string, CachedProgram, StringHash, std::equal_to<>> m_CachedPrograms;
+        std::filesystem::path GetCachedProgramFilepath(XXH64_hash_t key) const;
+
+        std::optional<ShaderProgram> TryLoadCachedProgram(const std::string_view name, XXH64_hash_t key);
+
+        void CacheProgram(ShaderProgram &program, const std::string_view name, XXH64_hash_t key);
+
+        std::unordered_map<XXH64_hash_t, CachedProgram> m_CachedPrograms;
         std::filesystem::path m_Directory = ".";
-        bool m_IsEnabled = true;
+        std::string m_DriverKey;
+        ShaderCacheStats m_Stats;
+        bool m_IsEnabled = false;
     };
 }
@@ -0,0 +1,134 @@
+#pragma once
+#include <Nova/core/Utility.hpp>
+#include <Nova/assets/Image.hpp>
+#include <Nova/graphics/opengl/RingBuffer.hpp>
+#include <glad/gl.h>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <vector>
+#include <deque>
+#include <cstdint>
+
+namespace Nova
+{
+    /// @brief Handle of texture managed by TextureStreamer.
+    struct StreamedTextureHandle : public StrongTypedef<StreamedTextureHandle, uint32_t>
+    {
+        using StrongTypedef::StrongTypedef;
+    };
+
+    struct TextureStreamerSettings
+    {
+        /// Video memory which resident mip levels of all textures may take.
+        size_t MemoryBudget = 256ull << 20;
+        /// Upload volume per frame, staging ring holds this much for every frame in flight.
+        GLsizeiptr StagingSizePerFrame = 8 << 20;
+        /// Levels which fit into this size are resident whenever texture is loaded.
+        uint32_t ResidentTailSize = 64;
+        size_t DecoderThreadCount = 2;
+        MipFilter Filter = MipFilter::Kaiser;
+    };
+
+    /// @brief Loads 2D textures in the background and keeps only mip levels which are visible resident on GPU.
+    ///
+    /// Images are decoded and their mip chains generated on decoder threads, CPU copy of all levels is kept
+    /// so that finer levels can be streamed in again. Every frame textures request the on-screen size they reach,
+    /// Update then picks the finest useful level of each texture, coarsens the least visible textures until
+    /// everything fits into memory budget and streams at most one finer level per texture through persistent
+    /// staging ring. Levels which are no longer needed are dropped right away.
+    ///
+    /// Texture object is replaced whenever its resident levels change, so its ID has to be queried every frame.
+    class TextureStreamer
+    {
+    public:
+        explicit TextureStreamer(const TextureStreamerSettings& settings = {});
+
+        TextureStreamer(const TextureStreamer&) = delete;
+
+        ~TextureStreamer() noexcept;
+
+        StreamedTextureHandle Load(const std::filesystem::path& filepath, bool isSRGB = true);
+
+        void Unload(StreamedTextureHandle handle);
+
+        /// @brief Reports size of surface using texture as part of viewport height, for example screen size
+        /// of a material from Renderer::GetMaterialScreenSize. The largest size reported within a frame is used.
+        void Request(StreamedTextureHandle handle, float screenSize);
+
+        /// @brief Finishes decoded loads, updates residency and records uploads, has to be called once per frame.
+        void Update(int viewportHeight);
+
+        /// @brief Zero until the coarsest levels are streamed in.
+        GLuint GetTextureID(StreamedTextureHandle handle) const;
+
+        /// @brief Finest resident level, equal to level count while nothing is resident.
+        uint32_t GetResidentLevel(StreamedTextureHandle handle) const;
+
+        constexpr size_t GetResidentSize() const noexcept { return residentSize_; }
+
+        TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    private:
+        struct StreamedTexture
+        {
+            std::vector<Image> Levels;
+            GLuint ID = 0;
+            uint32_t ResidentLevel = 0;
+            uint32_t TargetLevel = 0;
+            uint32_t TailLevel = 0;
+            uint32_t Generation = 0;
+            float RequestedSize = 0.0f;
+            bool IsSRGB = false;
+            bool IsLive = false;
+        };
+
+        struct DecodeJob
+        {
+            uint32_t Index;
+            uint32_t Generation;
+            std::filesystem::path Filepath;
+            bool IsSRGB;
+        };
+
+        struct DecodedTexture
+        {
+            uint32_t Index;
+            uint32_t Generation;
+            std::filesystem::path Filepath;
+            std::vector<Image> Levels;
+            std::exception_ptr Exception;
+        };
+
+        StreamedTexture& GetTexture(StreamedTextureHandle handle);
+
+        const StreamedTexture& GetTexture(StreamedTextureHandle handle) const;
+
+        void FinishDecodedTextures();
+
+        void SelectTargetLevels(int viewportHeight);
+
+        void StreamLevels();
+
+        // replaces texture object with one whose finest level is baseLevel, levels present in both are copied on GPU
+        void Reallocate(StreamedTexture& texture, uint32_t baseLevel);
+
+        void UploadLevel(const StreamedTexture& texture, uint32_t level);
+
+        void DecoderLoop(std::stop_token stopToken);
+
+        TextureStreamerSettings settings_;
+        RingBuffer staging_;
+        std::vector<StreamedTexture> textures_;
+        std::vector<uint32_t> freeTextures_;
+        size_t residentSize_ = 0;
+
+        std::mutex mutex_;
+        std::condition_variable_any jobSubmitted_;
+        std::deque<DecodeJob> decodeJobs_;
+        std::vector<DecodedTexture> decodedTextures_;
+        std::vector<std::jthread> decoders_;
+    };
+}
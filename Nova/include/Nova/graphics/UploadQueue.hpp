@@ -0,0 +1,115 @@
+#pragma once
+#include <Nova/core/Utility.hpp>
+#include <Nova/graphics/opengl/Buffer.hpp>
+#include <Nova/graphics/opengl/Sync.hpp>
+#include <Nova/graphics/opengl/GL.hpp>
+#include <glad/gl.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <unordered_map>
+#include <memory>
+#include <deque>
+#include <vector>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+
+struct GLFWwindow;
+
+namespace Nova
+{
+    /// @brief Handle of upload submitted to UploadQueue, it's released when result is acquired.
+    struct UploadHandle : public StrongTypedef<UploadHandle, uint32_t>
+    {
+        using StrongTypedef::StrongTypedef;
+    };
+
+    /// @brief Base level pixels of 2D texture, remaining levels are generated when LevelCount is above one.
+    struct TextureUpload
+    {
+        InternalFormat Format;
+        GLsizei Width;
+        GLsizei Height;
+        GLsizei LevelCount = 1;
+        GLenum PixelFormat = GL_RGBA;
+        GLenum PixelType = GL_UNSIGNED_BYTE;
+        std::span<const std::byte> Pixels;
+    };
+
+    /// @brief Part of an existing buffer, which is overwritten with Data.
+    struct BufferRegionUpload
+    {
+        GLuint Destination;
+        GLintptr Offset;
+        std::span<const std::byte> Data;
+    };
+
+    /// @brief Creates or writes buffers and textures on worker thread, which owns hidden OpenGL context sharing objects
+    /// with the window's one.
+    ///
+    /// Commands of every upload are followed by a fence. Acquiring an upload waits on CPU only until the worker
+    /// has issued its commands, after that main context's command stream waits for the fence on GPU. Data passed
+    /// to uploads is only referenced and has to stay alive until the upload is complete or acquired.
+    class UploadQueue
+    {
+    public:
+        /// Has to be created and destroyed on main thread, because GLFW creates windows only there.
+        explicit UploadQueue(GLFWwindow* sharedWindow);
+
+        UploadQueue(const UploadQueue&) = delete;
+
+        ~UploadQueue() noexcept;
+
+        UploadHandle UploadBuffer(std::span<const std::byte> data);
+
+        UploadHandle UploadTexture(const TextureUpload& texture);
+
+        /// @brief Writes regions of buffers created on main thread, data is copied on GPU from staging buffers.
+        /// Destinations mustn't be deleted or written by main context before the upload is acquired.
+        UploadHandle UploadBufferRegions(std::vector<BufferRegionUpload> regions);
+
+        /// @brief Checks without blocking whether GPU has finished the upload.
+        bool IsComplete(UploadHandle handle);
+
+        /// @brief Returns buffer created by UploadBuffer, it can be used by commands issued after this call.
+        Buffer AcquireBuffer(UploadHandle handle);
+
+        /// @brief Returns texture created by UploadTexture, it can be used by commands issued after this call.
+        GLuint AcquireTexture(UploadHandle handle);
+
+        /// @brief Makes commands issued after this call see regions written by UploadBufferRegions.
+        void AcquireBufferRegions(UploadHandle handle);
+
+        UploadQueue& operator=(const UploadQueue&) = delete;
+
+    private:
+        struct Upload
+        {
+            std::function<void(Upload&)> Job;
+            Buffer ResultBuffer;
+            GLuint ResultTexture = 0;
+            Sync Fence;
+            std::exception_ptr Exception;
+            bool IsIssued = false;
+        };
+
+        UploadHandle Submit(std::function<void(Upload&)> job);
+
+        // waits until upload is issued, makes GPU wait for it and releases its handle
+        std::unique_ptr<Upload> Acquire(UploadHandle handle);
+
+        void WorkerLoop(std::stop_token stopToken);
+
+        GLFWwindow* context_ = nullptr;
+        std::mutex mutex_;
+        std::condition_variable_any jobSubmitted_;
+        std::condition_variable jobIssued_;
+        std::deque<Upload*> pendingUploads_;
+        std::unordered_map<uint32_t, std::unique_ptr<Upload>> uploads_;
+        uint32_t nextHandle_ = 0;
+        std::jthread worker_;
+    };
+}
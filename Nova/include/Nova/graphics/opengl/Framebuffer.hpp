@@ -111,6 +111,10 @@ namespace Nova
 
 		void ClearAttachment(GLfloat depth, GLint stencil);
 
+		/// @brief Tells driver that contents of given attachments are no longer needed, which is cheaper than clearing
+		/// attachments which are going to be fully overwritten.
+		void Invalidate(std::span<const Attachment> attachments) noexcept;
+
 		constexpr const FramebufferAttachment& GetAttachment(size_t index) const { return attachments_[index]; }
 
 		Framebuffer& operator=(const Framebuffer&) = delete;
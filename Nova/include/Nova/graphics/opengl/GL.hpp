@@ -253,6 +253,14 @@ namespace Nova
         RGBA16UI = GL_RGBA16UI,
         RGBA32I = GL_RGBA32I,
         RGBA32UI = GL_RGBA32UI,
+        CompressedRedRGTC1 = GL_COMPRESSED_RED_RGTC1,
+        CompressedRGRGTC2 = GL_COMPRESSED_RG_RGTC2,
+        CompressedRGBABPTC = GL_COMPRESSED_RGBA_BPTC_UNORM,
+        CompressedSRGBAlphaBPTC = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,
+        CompressedRGBAS3TCDXT1 = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+        CompressedRGBAS3TCDXT5 = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+        CompressedSRGBAlphaS3TCDXT1 = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT,
+        CompressedSRGBAlphaS3TCDXT5 = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,
     };
 
     enum class Attachment : GLenum
@@ -421,6 +429,7 @@ namespace Nova
         CopyWriteBuffer = GL_COPY_WRITE_BUFFER,
         DispatchIndirectBuffer = GL_DISPATCH_INDIRECT_BUFFER,
         DrawIndirectBuffer = GL_DRAW_INDIRECT_BUFFER,
+        ParameterBuffer = GL_PARAMETER_BUFFER_ARB,
         ElementArrayBuffer = GL_ELEMENT_ARRAY_BUFFER,
         PixelPackBuffer = GL_PIXEL_PACK_BUFFER,
         PixelUnpackBUffer = GL_PIXEL_UNPACK_BUFFER,
@@ -990,6 +999,45 @@ namespace Nova
             glTextureStorage2D(texture, levels, (GLenum)internalformat, width, height);
         }
 
+        /// @brief Specify a two-dimensional texture subimage.
+        ///
+        /// https://registry.khronos.org/OpenGL-Refpages/gl4/html/glTexSubImage2D.xhtml
+        /// @param texture Specifies the texture object name.
+        /// @param level Specifies the level-of-detail number. Level 0 is the base image level.
+        /// @param width Specifies the width of the texture subimage.
+        /// @param height Specifies the height of the texture subimage.
+        /// @param format Specifies the format of the pixel data.
+        /// @param type Specifies the data type of the pixel data.
+        /// @param pixels Specifies a pointer to the image data in memory.
+        inline void TextureSubImage2D(GLuint texture, GLint level, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels) noexcept
+        {
+            glTextureSubImage2D(texture, level, 0, 0, width, height, format, type, pixels);
+        }
+
+        /// @brief Specify a two-dimensional texture subimage in a compressed format.
+        ///
+        /// https://registry.khronos.org/OpenGL-Refpages/gl4/html/glCompressedTexSubImage2D.xhtml
+        /// @param texture Specifies the texture object name.
+        /// @param level Specifies the level-of-detail number. Level 0 is the base image level.
+        /// @param width Specifies the width of the texture subimage.
+        /// @param height Specifies the height of the texture subimage.
+        /// @param format Specifies the format of the compressed image data stored at address data.
+        /// @param imageSize Specifies the number of unsigned bytes of image data starting at the address specified by data.
+        /// @param data Specifies a pointer to the compressed image data in memory.
+        inline void CompressedTextureSubImage2D(GLuint texture, GLint level, GLsizei width, GLsizei height, InternalFormat format, GLsizei imageSize, const void* data) noexcept
+        {
+            glCompressedTextureSubImage2D(texture, level, 0, 0, width, height, (GLenum)format, imageSize, data);
+        }
+
+        /// @brief Generate mipmaps for a specified texture object.
+        ///
+        /// https://registry.khronos.org/OpenGL-Refpages/gl4/html/glGenerateMipmap.xhtml
+        /// @param texture Specifies the texture object name.
+        inline void GenerateTextureMipmap(GLuint texture) noexcept
+        {
+            glGenerateTextureMipmap(texture);
+        }
+
         /// @brief enable or disable writing into the depth buffer
         ///
         /// https://registry.khronos.org/OpenGL-Refpages/gl4/html/glDepthMask.xhtml
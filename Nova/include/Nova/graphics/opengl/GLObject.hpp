@@ -1,6 +1,7 @@
 #pragma once
 #include <glad/gl.h>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <string_view>
 #include <stdexcept>
@@ -17,6 +18,8 @@ namespace Nova
 		static void DeleteAll() noexcept;
 
 	private:
+		// objects are also created by upload thread
+		static inline std::mutex s_ObjectIDsMutex;
 		static inline std::map<GLenum, std::vector<GLuint>> s_ObjectIDs;
 	};
 
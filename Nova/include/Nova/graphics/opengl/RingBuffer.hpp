@@ -0,0 +1,98 @@
+#pragma once
+#include <Nova/graphics/opengl/PersistentMappedBuffer.hpp>
+#include <Nova/graphics/opengl/Sync.hpp>
+#include <deque>
+#include <vector>
+#include <span>
+#include <string>
+#include <cstring>
+
+namespace Nova
+{
+    constexpr size_t RingBufferDefaultFramesInFlight = 3;
+
+    struct RingAllocation
+    {
+        void* Data;
+        GLuint BufferID;
+        GLintptr Offset;
+        GLsizeiptr Size;
+
+        template <typename T>
+        constexpr T* As() const noexcept { return reinterpret_cast<T*>(Data); }
+    };
+
+    /// @brief Persistently mapped buffer sub-allocated as a ring spanning multiple frames.
+    ///
+    /// Allocations made between two calls to Fence() form a segment guarded by its own fence,
+    /// so space is reclaimed as soon as GPU finishes with given segment. If reclaiming space would
+    /// require waiting for work submitted during current frame, buffer is grown instead. Because of that,
+    /// allocations made within a single frame may live in different buffers - always use RingAllocation::BufferID
+    /// instead of caching buffer ID.
+    class RingBuffer
+    {
+    public:
+        RingBuffer() = default;
+
+        RingBuffer(const RingBuffer&) = delete;
+
+        RingBuffer(RingBuffer&&) noexcept = default;
+
+        RingBuffer(GLsizeiptr size, size_t framesInFlight = RingBufferDefaultFramesInFlight);
+
+        void BeginFrame();
+
+        RingAllocation Allocate(GLsizeiptr size, GLsizeiptr alignment = 1);
+
+        template <typename T>
+        RingAllocation Write(const std::span<const T> data)
+        {
+            const auto allocation = Allocate(data.size_bytes(), sizeof(T));
+            std::memcpy(allocation.Data, data.data(), data.size_bytes());
+
+            return allocation;
+        }
+
+        template <typename T>
+        RingAllocation Write(const std::span<T> data)
+        {
+            return Write(std::span<const T>(data));
+        }
+
+        void Commit(const RingAllocation& allocation) const noexcept;
+
+        void Fence() noexcept;
+
+        void SetDebugName(const std::string_view debugName);
+
+        constexpr GLuint GetID() const noexcept { return buffer_.GetID(); }
+
+        constexpr GLsizeiptr GetSize() const noexcept { return buffer_.GetSize(); }
+
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        RingBuffer& operator=(RingBuffer&&) noexcept = default;
+
+    private:
+        struct Segment
+        {
+            GLintptr Begin;
+            GLintptr End;
+            size_t Frame;
+            Sync Fence;
+        };
+
+        void Grow(GLsizeiptr minSize);
+
+        PersistentMappedBuffer buffer_;
+        std::vector<PersistentMappedBuffer> retiredBuffers_;
+        std::deque<Segment> segments_;
+        std::string debugName_;
+        // positions are virtual, they grow monotonically and are wrapped to buffer size on allocation
+        GLintptr head_ = 0;
+        GLintptr fenceBegin_ = 0;
+        GLsizeiptr frameDemand_ = 0;
+        size_t frame_ = 0;
+        size_t framesInFlight_ = RingBufferDefaultFramesInFlight;
+    };
+}
@@ -2,7 +2,10 @@
 #include <Nova/graphics/opengl/Buffer.hpp>
 #include <Nova/graphics/opengl/ShaderStage.hpp>
 #include <Nova/core/Utility.hpp>
+#include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
 #include <span>
 #include <string>
 #include <string_view>
@@ -24,9 +27,18 @@ namespace Nova
 
 	class ShaderProgram
 	{
+		friend class PendingShaderProgram;
+
 	public:
 		static void ReleaseShaderCompiler() noexcept;
 
+		/// @brief Whether driver compiles and links in the background, which PendingShaderProgram can poll without blocking.
+		static bool IsParallelCompileSupported() noexcept;
+
+		/// @brief Limits number of threads used by driver for background compilation, 0xFFFFFFFF lets driver pick it.
+		/// Does nothing without GL_KHR_parallel_shader_compile.
+		static void SetMaxCompilerThreads(GLuint count) noexcept;
+
 		static ShaderProgram FromBinary(
 			GLenum binaryFormat,
 			const std::span<uint8_t> binary);
@@ -76,8 +88,18 @@ namespace Nova
 
 		void SetUniform(const std::string_view name, uint32_t value) const;
 
+		void SetUniform(const std::string_view name, const glm::vec2& value) const;
+
+		void SetUniform(const std::string_view name, const glm::ivec2& value) const;
+
 		void SetUniform(const std::string_view name, const glm::vec3& value) const;
 
+		void SetUniform(const std::string_view name, const glm::vec4& value) const;
+
+		void SetUniform(const std::string_view name, const glm::mat4& value) const;
+
+		void SetUniform(const std::string_view name, std::span<const glm::vec4> values) const;
+
 		GLuint GetResourceLocation(const std::string_view name) const;
 
 		std::optional<GLuint> TryGetResourceLocation(const std::string_view name) const;
@@ -100,6 +122,65 @@ namespace Nova
 			StringHash,
 			std::equal_to<>> resources_;
 		std::optional<ProgramBinary> savedBinary_ = std::nullopt;
-		GLuint id_;
+		GLuint id_ = 0;
+	};
+
+	/// @brief Future-like handle of program which is compiled and linked in the background.
+	///
+	/// Compilation of every stage and linking are issued at construction, without waiting for any of them,
+	/// so building many programs one after another lets driver overlap their work. With GL_KHR_parallel_shader_compile,
+	/// IsReady polls completion without blocking, otherwise it always returns true and Get waits for the driver.
+	class PendingShaderProgram
+	{
+	public:
+		PendingShaderProgram() = default;
+
+		PendingShaderProgram(const PendingShaderProgram&) = delete;
+
+		PendingShaderProgram(PendingShaderProgram&& other) noexcept
+			: program_(std::exchange(other.program_, ShaderProgram())),
+			  stages_(std::move(other.stages_)),
+			  isPending_(std::exchange(other.isPending_, false)),
+			  isFailed_(std::exchange(other.isFailed_, false)) { }
+
+		/// @brief Takes ownership of stages, which are usually issued with ShaderStage::BeginFromGLSL.
+		explicit PendingShaderProgram(std::vector<ShaderStage> stages);
+
+		/// @brief Wraps program which is already built, e.g. loaded from binary, so that it's ready right away.
+		explicit PendingShaderProgram(ShaderProgram&& program) noexcept
+			: program_(std::move(program)) { }
+
+		/// @brief Program which wasn't handed over by Get is deleted together with its stages.
+		~PendingShaderProgram() noexcept;
+
+		bool IsReady() const noexcept;
+
+		/// @brief Waits for the program, when it isn't ready yet, and hands it over. Throws when any stage failed
+		/// to compile or program failed to link, in both cases its objects are deleted and every later call throws too.
+		/// Can only be called once.
+		ShaderProgram Get();
+
+		/// @brief Deletes program and its stages without waiting for them.
+		void Delete() noexcept;
+
+		PendingShaderProgram& operator=(PendingShaderProgram&& other) noexcept
+		{
+			if (this == &other)
+				return *this;
+
+			Delete();
+			program_ = std::exchange(other.program_, ShaderProgram());
+			stages_ = std::move(other.stages_);
+			isPending_ = std::exchange(other.isPending_, false);
+			isFailed_ = std::exchange(other.isFailed_, false);
+
+			return *this;
+		}
+
+	private:
+		ShaderProgram program_;
+		std::vector<ShaderStage> stages_;
+		bool isPending_ = false;
+		bool isFailed_ = false;
 	};
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <glad/gl.h>
 #include <string_view>
+#include <string>
 #include <utility>
 #include <span>
 #include <filesystem>
@@ -34,6 +35,30 @@ namespace Nova
 			ShaderType type,
 			const std::filesystem::path& filepath);
 
+		/// @brief Issues compilation without waiting for it to finish, status has to be checked with CheckCompileStatus.
+		/// Used by PendingShaderProgram, so that driver can compile stages of many programs in parallel.
+		static ShaderStage BeginFromGLSL(
+			ShaderType type,
+			const std::string_view source);
+
+		/// @brief Inserts preprocessor definitions right after #version directive, source is returned unchanged without them.
+		/// Each definition is either a name or a name followed by a value, e.g. "NV_MAX_LIGHTS 64".
+		static std::string PreprocessGLSL(
+			const std::string_view source,
+			const std::span<const std::string_view> defines);
+
+		/// @brief Compiles GLSL source with preprocessor definitions inserted right after #version directive.
+		/// Each definition is either a name or a name followed by a value, e.g. "NV_MAX_LIGHTS 64".
+		static ShaderStage FromGLSL(
+			ShaderType type,
+			const std::string_view source,
+			const std::span<const std::string_view> defines);
+
+		static ShaderStage FromGLSL(
+			ShaderType type,
+			const std::filesystem::path& filepath,
+			const std::span<const std::string_view> defines);
+
 		static ShaderStage FromBinary(
 			ShaderType type,
 			GLenum binaryType,
@@ -86,6 +111,9 @@ namespace Nova
 
 		void Delete() const noexcept { glDeleteShader(m_ID); }
 
+		/// @brief Waits for compilation and throws with compiler log, when it failed.
+		void CheckCompileStatus() const;
+
 		constexpr GLuint GetID() const noexcept { return m_ID; }
 
 	private:
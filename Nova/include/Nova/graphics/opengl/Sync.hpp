@@ -18,7 +18,8 @@ namespace Nova
         constexpr Sync(const Sync&) = delete;
 
         constexpr Sync(Sync&& other) noexcept
-            : syncHandles_(std::exchange(other.syncHandles_, {0})) { }
+            : syncHandles_(std::exchange(other.syncHandles_, {0})),
+              currentSyncIndex_(std::exchange(other.currentSyncIndex_, 0)) { }
 
         ~Sync() noexcept;
 
@@ -34,7 +35,9 @@ namespace Nova
 
         constexpr Sync& operator=(Sync&& other) noexcept
         {
-            syncHandles_ = std::exchange(other.syncHandles_, {0});
+            // handles previously owned by this object are released by destructor of the other one
+            std::swap(syncHandles_, other.syncHandles_);
+            std::swap(currentSyncIndex_, other.currentSyncIndex_);
             return *this;
         }
 
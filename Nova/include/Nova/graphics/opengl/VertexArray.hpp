@@ -56,6 +56,8 @@ namespace Nova
 
 		void BindVertexBuffer(const Buffer &buffer, GLuint bindingIndex, GLsizei stride, GLintptr offset = 0);
 
+		void BindVertexBuffer(BufferID buffer, GLuint bindingIndex, GLsizei stride, GLintptr offset = 0);
+
 		void BindVertexBuffer(const Buffer &buffer, GLuint bindingIndex, GLsizei stride, GLintptr offset, GLuint instanceDivisor);
 
 		void BindElementBuffer(const Buffer &buffer) const noexcept;
@@ -0,0 +1,257 @@
+#include <Nova/assets/Image.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <stb/stb_image.h>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NV_IMAGE_SIMD 1
+#else
+#define NV_IMAGE_SIMD 0
+#endif
+
+using namespace Nova;
+
+namespace
+{
+    // filter taps are 2x + c_KaiserTapOffset ... 2x + c_KaiserTapOffset + c_KaiserTapCount - 1 of source texels
+    constexpr int c_KaiserTapCount = 6;
+    constexpr int c_KaiserTapOffset = -2;
+    constexpr float c_KaiserRadius = 3.0f;
+    constexpr float c_KaiserBeta = 4.0f;
+
+    // image with 4 float channels per texel, every texel maps to one SIMD register
+    struct FloatImage
+    {
+        uint32_t Width;
+        uint32_t Height;
+        std::vector<float> Texels;
+
+        float* GetTexel(uint32_t x, uint32_t y) noexcept { return &Texels[((size_t)y * Width + x) * 4]; }
+        const float* GetTexel(uint32_t x, uint32_t y) const noexcept { return &Texels[((size_t)y * Width + x) * 4]; }
+    };
+
+    float BesselI0(float x) noexcept
+    {
+        float sum = 1.0f;
+        float term = 1.0f;
+        for (int i = 1; i < 16; i++)
+        {
+            const auto factor = x / (2.0f * (float)i);
+            term *= factor * factor;
+            sum += term;
+        }
+
+        return sum;
+    }
+
+    std::array<float, c_KaiserTapCount> ComputeKaiserWeights() noexcept
+    {
+        constexpr float pi = 3.14159265358979f;
+
+        std::array<float, c_KaiserTapCount> weights;
+        float sum = 0.0f;
+        for (int i = 0; i < c_KaiserTapCount; i++)
+        {
+            // distance from destination texel center in source texels, sinc is evaluated in destination texels
+            const auto distance = (float)(c_KaiserTapOffset + i) + 0.5f - 1.0f;
+            const auto t = distance * 0.5f;
+            const auto sinc = std::sin(pi * t) / (pi * t);
+            const auto ratio = distance / c_KaiserRadius;
+            const auto window = BesselI0(c_KaiserBeta * std::sqrt(std::max(1.0f - ratio * ratio, 0.0f))) / BesselI0(c_KaiserBeta);
+
+            weights[i] = sinc * window;
+            sum += weights[i];
+        }
+
+        for (auto& weight : weights)
+            weight /= sum;
+
+        return weights;
+    }
+
+    void StoreWeightedSum(float* destination, const float* const* texels, const float* weights, int count) noexcept
+    {
+#if NV_IMAGE_SIMD
+        auto sum = _mm_setzero_ps();
+        for (int i = 0; i < count; i++)
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(texels[i]), _mm_set1_ps(weights[i])));
+
+        _mm_storeu_ps(destination, sum);
+#else
+        for (int channel = 0; channel < 4; channel++)
+        {
+            float sum = 0.0f;
+            for (int i = 0; i < count; i++)
+                sum += texels[i][channel] * weights[i];
+
+            destination[channel] = sum;
+        }
+#endif
+    }
+
+    FloatImage DownsampleBox(const FloatImage& source)
+    {
+        FloatImage destination { std::max(source.Width / 2, 1u), std::max(source.Height / 2, 1u) };
+        destination.Texels.resize((size_t)destination.Width * destination.Height * 4);
+
+        // odd last row or column is dropped, one texel dimensions are averaged with themselves
+        constexpr std::array<float, 4> weights { 0.25f, 0.25f, 0.25f, 0.25f };
+        for (uint32_t y = 0; y < destination.Height; y++)
+        {
+            const auto y0 = std::min(y * 2, source.Height - 1);
+            const auto y1 = std::min(y * 2 + 1, source.Height - 1);
+            for (uint32_t x = 0; x < destination.Width; x++)
+            {
+                const auto x0 = std::min(x * 2, source.Width - 1);
+                const auto x1 = std::min(x * 2 + 1, source.Width - 1);
+                const std::array<const float*, 4> texels {
+                    source.GetTexel(x0, y0),
+                    source.GetTexel(x1, y0),
+                    source.GetTexel(x0, y1),
+                    source.GetTexel(x1, y1),
+                };
+
+                StoreWeightedSum(destination.GetTexel(x, y), texels.data(), weights.data(), 4);
+            }
+        }
+
+        return destination;
+    }
+
+    FloatImage DownsampleKaiser(const FloatImage& source)
+    {
+        static const auto weights = ComputeKaiserWeights();
+
+        const auto clampCoordinate = [](int64_t coordinate, uint32_t size)
+        {
+            return (uint32_t)std::clamp<int64_t>(coordinate, 0, (int64_t)size - 1);
+        };
+
+        // separable filter, width is reduced first
+        FloatImage horizontal { std::max(source.Width / 2, 1u), source.Height };
+        horizontal.Texels.resize((size_t)horizontal.Width * horizontal.Height * 4);
+
+        std::array<const float*, c_KaiserTapCount> texels;
+        for (uint32_t y = 0; y < horizontal.Height; y++)
+        {
+            for (uint32_t x = 0; x < horizontal.Width; x++)
+            {
+                for (int i = 0; i < c_KaiserTapCount; i++)
+                    texels[i] = source.GetTexel(clampCoordinate((int64_t)x * 2 + c_KaiserTapOffset + i, source.Width), y);
+
+                StoreWeightedSum(horizontal.GetTexel(x, y), texels.data(), weights.data(), c_KaiserTapCount);
+            }
+        }
+
+        FloatImage destination { horizontal.Width, std::max(source.Height / 2, 1u) };
+        destination.Texels.resize((size_t)destination.Width * destination.Height * 4);
+
+        for (uint32_t y = 0; y < destination.Height; y++)
+        {
+            for (uint32_t x = 0; x < destination.Width; x++)
+            {
+                for (int i = 0; i < c_KaiserTapCount; i++)
+                    texels[i] = horizontal.GetTexel(x, clampCoordinate((int64_t)y * 2 + c_KaiserTapOffset + i, horizontal.Height));
+
+                StoreWeightedSum(destination.GetTexel(x, y), texels.data(), weights.data(), c_KaiserTapCount);
+            }
+        }
+
+        return destination;
+    }
+
+    float DecodeSRGB(float value) noexcept
+    {
+        return value <= 0.04045f
+            ? value / 12.92f
+            : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float EncodeSRGB(float value) noexcept
+    {
+        return value <= 0.0031308f
+            ? value * 12.92f
+            : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    FloatImage ToFloatImage(const Image& image, bool isSRGB)
+    {
+        std::array<float, 256> colorTable;
+        for (size_t i = 0; i < colorTable.size(); i++)
+        {
+            const auto value = (float)i / 255.0f;
+            colorTable[i] = isSRGB ? DecodeSRGB(value) : value;
+        }
+
+        FloatImage result { image.Width, image.Height };
+        result.Texels.resize(image.Pixels.size());
+        for (size_t i = 0; i < image.Pixels.size(); i++)
+        {
+            result.Texels[i] = i % 4 == 3
+                ? (float)image.Pixels[i] / 255.0f
+                : colorTable[image.Pixels[i]];
+        }
+
+        return result;
+    }
+
+    Image ToImage(const FloatImage& image, bool isSRGB)
+    {
+        Image result { image.Width, image.Height };
+        result.Pixels.resize(image.Texels.size());
+        for (size_t i = 0; i < image.Texels.size(); i++)
+        {
+            // negative lobes of Kaiser filter can overshoot
+            auto value = std::clamp(image.Texels[i], 0.0f, 1.0f);
+            if (isSRGB && i % 4 != 3)
+                value = EncodeSRGB(value);
+
+            result.Pixels[i] = (uint8_t)std::lround(value * 255.0f);
+        }
+
+        return result;
+    }
+}
+
+Image Nova::LoadImageFile(const std::filesystem::path& filepath)
+{
+    NV_PROFILE_FUNC;
+
+    int width;
+    int height;
+    const auto pixels = stbi_load(filepath.string().c_str(), &width, &height, nullptr, 4);
+    if (pixels == nullptr)
+        throw std::runtime_error("Failed to load image file.");
+
+    Image image { (uint32_t)width, (uint32_t)height };
+    image.Pixels.assign(pixels, pixels + (size_t)width * height * 4);
+    stbi_image_free(pixels);
+
+    return image;
+}
+
+std::vector<Image> Nova::GenerateMipChain(Image&& image, MipFilter filter, bool isSRGB)
+{
+    NV_PROFILE_FUNC;
+
+    std::vector<Image> levels;
+    levels.reserve((size_t)std::log2(std::max({ image.Width, image.Height, 1u })) + 1);
+
+    auto current = ToFloatImage(image, isSRGB);
+    levels.push_back(std::move(image));
+
+    while (current.Width > 1 || current.Height > 1)
+    {
+        current = filter == MipFilter::Kaiser
+            ? DownsampleKaiser(current)
+            : DownsampleBox(current);
+
+        levels.push_back(ToImage(current, isSRGB));
+    }
+
+    return levels;
+}
@@ -0,0 +1,105 @@
+#include <Nova/assets/MeshFile.hpp>
+#include <Nova/assets/ObjImporter.hpp>
+#include <Nova/assets/MeshOptimizer.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <Nova/debug/Log.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+using namespace Nova;
+
+static constexpr AssetFileType c_MeshFileType {
+    .Name = "Mesh",
+    .Magic = c_MeshFileMagic,
+    .Version = c_MeshFileVersion,
+};
+
+MeshFile::MeshFile(const std::filesystem::path& filepath, bool verifyChecksum)
+    : file_(filepath)
+{
+    NV_PROFILE_FUNC;
+
+    const auto startTime = std::chrono::steady_clock::now();
+    const auto data = file_.GetData();
+
+    const auto header = ReadAssetFileHeader<MeshFileHeader>(data, c_MeshFileType, verifyChecksum);
+    if (header.VertexStride != sizeof(ModelVertex))
+        throw std::runtime_error("Mesh file vertex format doesn't match.");
+
+    vertices_ = GetAssetFileSection<ModelVertex>(data, header.VertexOffset, header.VertexCount, c_MeshFileType, "vertex stream");
+    indices_ = GetAssetFileSection<GLuint>(data, header.IndexOffset, header.IndexCount, c_MeshFileType, "index stream");
+    lods_ = GetAssetFileSection<ModelLOD>(data, header.LODOffset, header.LODCount, c_MeshFileType, "LOD table");
+    bounds_ = header.Bounds;
+
+    for (const auto& lod : lods_)
+    {
+        if ((uint64_t)lod.FirstIndex + lod.IndexCount > header.IndexCount)
+            throw std::runtime_error("Mesh file LOD index range is out of bounds.");
+    }
+
+    // writer only stores indices within vertex stream, so matching checksum already rules out invalid ones
+    if (!verifyChecksum)
+    {
+        NV_PROFILE_SCOPE("ValidateIndices");
+
+        if (std::any_of(indices_.begin(), indices_.end(), [&](GLuint index) { return index >= header.VertexCount; }))
+            throw std::runtime_error("Mesh file index is out of bounds.");
+    }
+
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    const auto megabytes = (double)data.size() / (1024.0 * 1024.0);
+    NV_LOG_INFO(
+        "Loaded mesh of {} triangles from {} ({:.1f} MB) in {:.1f} ms, {:.0f} MB/s.",
+        header.IndexCount / 3,
+        filepath.string(),
+        megabytes,
+        seconds * 1000.0,
+        seconds > 0.0 ? megabytes / seconds : 0.0);
+}
+
+void Nova::WriteMeshFile(
+    const std::filesystem::path& filepath,
+    std::span<const ModelVertex> vertices,
+    std::span<const GLuint> indices,
+    std::span<const ModelLOD> lods)
+{
+    NV_PROFILE_FUNC;
+
+    if (std::any_of(indices.begin(), indices.end(), [&](GLuint index) { return index >= vertices.size(); }))
+        throw std::runtime_error("Mesh index is out of bounds.");
+
+    // padding bytes are zeroed as well, so that files written from the same mesh are identical
+    MeshFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.Magic = c_MeshFileMagic;
+    header.Version = c_MeshFileVersion;
+    header.VertexCount = (uint32_t)vertices.size();
+    header.IndexCount = (uint32_t)indices.size();
+    header.LODCount = (uint32_t)lods.size();
+    header.VertexStride = sizeof(ModelVertex);
+    header.Bounds = ModelBounds::FromVertices(vertices);
+    header.VertexOffset = sizeof(header);
+    header.IndexOffset = AlignAssetFileOffset(header.VertexOffset + vertices.size_bytes());
+    header.LODOffset = AlignAssetFileOffset(header.IndexOffset + indices.size_bytes());
+
+    std::vector<std::byte> data(header.LODOffset + lods.size_bytes());
+    std::memcpy(data.data() + header.VertexOffset, vertices.data(), vertices.size_bytes());
+    std::memcpy(data.data() + header.IndexOffset, indices.data(), indices.size_bytes());
+    std::memcpy(data.data() + header.LODOffset, lods.data(), lods.size_bytes());
+
+    WriteAssetFile(filepath, header, data);
+}
+
+void Nova::ConvertObjToMeshFile(
+    const std::filesystem::path& objFilepath,
+    const std::filesystem::path& meshFilepath,
+    ThreadPool* threadPool)
+{
+    NV_PROFILE_FUNC;
+
+    const auto mesh = OptimizeMesh(ImportObj(objFilepath, threadPool));
+    WriteMeshFile(meshFilepath, mesh.Vertices, mesh.Indices);
+}
@@ -0,0 +1,287 @@
+#include <Nova/assets/MeshOptimizer.hpp>
+#include <Nova/core/Utility.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <Nova/debug/Log.hpp>
+#include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cstring>
+#include <stdexcept>
+
+using namespace Nova;
+
+namespace
+{
+    struct BitwiseEqual
+    {
+        bool operator()(const ModelVertex& a, const ModelVertex& b) const noexcept
+        {
+            return std::memcmp(&a, &b, sizeof(ModelVertex)) == 0;
+        }
+    };
+
+    constexpr GLuint c_NoVertex = std::numeric_limits<GLuint>::max();
+}
+
+std::vector<GLuint> Nova::WeldVertices(
+    std::span<const ModelVertex> vertices,
+    std::vector<ModelVertex>& uniqueVertices)
+{
+    NV_PROFILE_FUNC;
+
+    std::unordered_map<ModelVertex, GLuint, XXHasher<ModelVertex>, BitwiseEqual> vertexIndices;
+    vertexIndices.reserve(vertices.size());
+
+    std::vector<GLuint> indices;
+    indices.reserve(vertices.size());
+    uniqueVertices.clear();
+
+    for (const auto& vertex : vertices)
+    {
+        const auto [it, isNew] = vertexIndices.try_emplace(vertex, (GLuint)uniqueVertices.size());
+        if (isNew)
+            uniqueVertices.push_back(vertex);
+
+        indices.push_back(it->second);
+    }
+
+    return indices;
+}
+
+void Nova::OptimizeVertexCache(
+    std::span<GLuint> indices,
+    size_t vertexCount,
+    uint32_t cacheSize)
+{
+    NV_PROFILE_FUNC;
+
+    const auto triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // triangles of every vertex as one flat array, vertex v owns range [adjacencyOffsets[v], adjacencyOffsets[v + 1])
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+        liveTriangles[indices[i]]++;
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    std::inclusive_scan(liveTriangles.begin(), liveTriangles.end(), adjacencyOffsets.begin() + 1);
+
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        auto fill = std::vector<uint32_t>(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+            adjacency[fill[indices[i]]++] = (uint32_t)(i / 3);
+    }
+
+    std::vector<uint32_t> cacheTimes(vertexCount, 0);
+    std::vector<bool> isEmitted(triangleCount, false);
+    std::vector<GLuint> deadEnds;
+    std::vector<GLuint> candidates;
+    std::vector<GLuint> output;
+    output.reserve(triangleCount * 3);
+
+    // vertex is in cache while time - cacheTimes[v] <= cacheSize, starting after cacheSize makes every vertex a miss
+    uint32_t time = cacheSize + 1;
+    size_t cursor = 0;
+
+    const auto skipDeadEnd = [&]() -> GLuint
+    {
+        while (!deadEnds.empty())
+        {
+            const auto vertex = deadEnds.back();
+            deadEnds.pop_back();
+            if (liveTriangles[vertex] > 0)
+                return vertex;
+        }
+
+        for (; cursor < vertexCount; cursor++)
+        {
+            if (liveTriangles[cursor] > 0)
+                return (GLuint)cursor;
+        }
+
+        return c_NoVertex;
+    };
+
+    auto fanVertex = skipDeadEnd();
+    while (fanVertex != c_NoVertex)
+    {
+        candidates.clear();
+        for (auto a = adjacencyOffsets[fanVertex]; a < adjacencyOffsets[fanVertex + 1]; a++)
+        {
+            const auto triangle = adjacency[a];
+            if (isEmitted[triangle])
+                continue;
+
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                const auto vertex = indices[triangle * 3 + corner];
+                output.push_back(vertex);
+                deadEnds.push_back(vertex);
+                candidates.push_back(vertex);
+                liveTriangles[vertex]--;
+
+                if (time - cacheTimes[vertex] > cacheSize)
+                    cacheTimes[vertex] = time++;
+            }
+
+            isEmitted[triangle] = true;
+        }
+
+        // next fan goes around a candidate which will still be in cache after its remaining triangles are emitted,
+        // the one which entered the cache first is preferred
+        auto nextVertex = c_NoVertex;
+        int64_t bestPriority = -1;
+        for (const auto vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+                continue;
+
+            int64_t priority = 0;
+            if (time - cacheTimes[vertex] + 2 * liveTriangles[vertex] <= cacheSize)
+                priority = time - cacheTimes[vertex];
+
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                nextVertex = vertex;
+            }
+        }
+
+        fanVertex = nextVertex != c_NoVertex ? nextVertex : skipDeadEnd();
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void Nova::OptimizeVertexFetch(
+    std::span<GLuint> indices,
+    std::vector<ModelVertex>& vertices)
+{
+    NV_PROFILE_FUNC;
+
+    std::vector<GLuint> remap(vertices.size(), c_NoVertex);
+    std::vector<ModelVertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (auto& index : indices)
+    {
+        if (remap[index] == c_NoVertex)
+        {
+            remap[index] = (GLuint)reordered.size();
+            reordered.push_back(vertices[index]);
+        }
+
+        index = remap[index];
+    }
+
+    vertices = std::move(reordered);
+}
+
+VertexCacheStatistics Nova::AnalyzeVertexCache(
+    std::span<const GLuint> indices,
+    size_t vertexCount,
+    uint32_t cacheSize)
+{
+    const auto triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return { 0.0f, 0.0f };
+
+    // FIFO cache is simulated by time stamps, same as in OptimizeVertexCache
+    std::vector<uint32_t> cacheTimes(vertexCount, 0);
+    std::vector<bool> isReferenced(vertexCount, false);
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0;
+    size_t referencedCount = 0;
+
+    for (size_t i = 0; i < triangleCount * 3; i++)
+    {
+        const auto vertex = indices[i];
+        if (time - cacheTimes[vertex] > cacheSize)
+        {
+            cacheTimes[vertex] = time++;
+            misses++;
+        }
+
+        if (!isReferenced[vertex])
+        {
+            isReferenced[vertex] = true;
+            referencedCount++;
+        }
+    }
+
+    return VertexCacheStatistics {
+        .ACMR = (float)misses / (float)triangleCount,
+        .ATVR = (float)misses / (float)referencedCount,
+    };
+}
+
+// drops degenerate triangles and reorders the rest, Before statistics are left to the caller
+static void OptimizeIndexedMesh(OptimizedMesh& mesh)
+{
+    size_t keptCount = 0;
+    for (size_t i = 0; i < mesh.Indices.size(); i += 3)
+    {
+        const auto a = mesh.Indices[i];
+        const auto b = mesh.Indices[i + 1];
+        const auto c = mesh.Indices[i + 2];
+        if (a == b || b == c || c == a)
+            continue;
+
+        mesh.Indices[keptCount++] = a;
+        mesh.Indices[keptCount++] = b;
+        mesh.Indices[keptCount++] = c;
+    }
+    mesh.Indices.resize(keptCount);
+
+    OptimizeVertexCache(mesh.Indices, mesh.Vertices.size());
+    OptimizeVertexFetch(mesh.Indices, mesh.Vertices);
+
+    mesh.After = AnalyzeVertexCache(mesh.Indices, mesh.Vertices.size());
+
+    NV_LOG_INFO(
+        "Optimized mesh of {} triangles and {} vertices, ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}.",
+        mesh.Indices.size() / 3,
+        mesh.Vertices.size(),
+        mesh.Before.ACMR,
+        mesh.After.ACMR,
+        mesh.Before.ATVR,
+        mesh.After.ATVR);
+}
+
+OptimizedMesh Nova::OptimizeMesh(std::span<const ModelVertex> vertices)
+{
+    NV_PROFILE_FUNC;
+
+    OptimizedMesh mesh;
+    mesh.Indices = WeldVertices(vertices, mesh.Vertices);
+    mesh.Indices.resize(mesh.Indices.size() / 3 * 3);
+
+    // without indices every corner is transformed on its own
+    mesh.Before = VertexCacheStatistics { .ACMR = 3.0f, .ATVR = 1.0f };
+
+    OptimizeIndexedMesh(mesh);
+
+    return mesh;
+}
+
+OptimizedMesh Nova::OptimizeMesh(
+    std::span<const ModelVertex> vertices,
+    std::span<const GLuint> indices)
+{
+    NV_PROFILE_FUNC;
+
+    if (std::any_of(indices.begin(), indices.end(), [&](GLuint index) { return index >= vertices.size(); }))
+        throw std::runtime_error("Mesh index is out of bounds.");
+
+    OptimizedMesh mesh;
+    mesh.Vertices.assign(vertices.begin(), vertices.end());
+    mesh.Indices.assign(indices.begin(), indices.begin() + indices.size() / 3 * 3);
+    mesh.Before = AnalyzeVertexCache(mesh.Indices, mesh.Vertices.size());
+
+    OptimizeIndexedMesh(mesh);
+
+    return mesh;
+}
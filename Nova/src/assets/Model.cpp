@@ -0,0 +1,108 @@
+#include <Nova/assets/Model.hpp>
+#include <Nova/graphics/Renderer.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+using namespace Nova;
+
+static void ValidateLODs(std::span<const ModelLOD> lods, std::optional<size_t> indexCount)
+{
+	for (size_t i = 0; i < lods.size(); i++)
+	{
+		if (indexCount.has_value() && (size_t)lods[i].FirstIndex + lods[i].IndexCount > indexCount.value())
+			throw std::runtime_error("Model LOD index range is out of bounds.");
+
+		if (i != 0 && lods[i].MinScreenSize >= lods[i - 1].MinScreenSize)
+			throw std::runtime_error("Model LOD screen size thresholds have to decrease.");
+	}
+}
+
+ModelBounds ModelBounds::FromVertices(std::span<const ModelVertex> vertices) noexcept
+{
+	NV_PROFILE_FUNC;
+
+	if (vertices.empty())
+		return ModelBounds {
+			.Box = { glm::vec3(0.0f), glm::vec3(0.0f) },
+			.Sphere = { glm::vec3(0.0f), 0.0f },
+		};
+
+	BoundingBox box {
+		.Min = glm::vec3(std::numeric_limits<float>::max()),
+		.Max = glm::vec3(std::numeric_limits<float>::lowest()),
+	};
+
+	for (const auto& vertex : vertices)
+	{
+		box.Min = glm::min(box.Min, vertex.Position);
+		box.Max = glm::max(box.Max, vertex.Position);
+	}
+
+	// sphere is centered on the box, but its radius is fitted to the vertices which is tighter than half of box diagonal
+	const auto center = (box.Min + box.Max) * 0.5f;
+
+	float radiusSquared = 0.0f;
+	for (const auto& vertex : vertices)
+	{
+		const auto offset = vertex.Position - center;
+		radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+	}
+
+	return ModelBounds {
+		.Box = box,
+		.Sphere = { center, std::sqrt(radiusSquared) },
+	};
+}
+
+// non-indexed vertices get sequential indices, so that every mesh can be drawn with glMultiDrawElementsIndirect
+static std::vector<GLuint> CreateSequentialIndices(size_t vertexCount)
+{
+	std::vector<GLuint> indices(vertexCount);
+	std::iota(indices.begin(), indices.end(), 0u);
+
+	return indices;
+}
+
+Model::Model(size_t id, std::span<const ModelVertex> vertices)
+	: Model(id, vertices, CreateSequentialIndices(vertices.size())) { }
+
+Model::Model(size_t id, std::span<const ModelVertex> vertices, std::span<const GLuint> indices)
+	: Model(id, Renderer::CreateMesh(vertices, indices), ModelBounds::FromVertices(vertices)) { }
+
+// levels are validated before the mesh is allocated, so that a rejected model doesn't leave its mesh behind
+static MeshHandle CreateMeshWithLODs(
+	std::span<const ModelVertex> vertices,
+	std::span<const GLuint> indices,
+	std::span<const ModelLOD> lods)
+{
+	ValidateLODs(lods, indices.size());
+
+	return Renderer::CreateMesh(vertices, indices);
+}
+
+Model::Model(
+	size_t id,
+	std::span<const ModelVertex> vertices,
+	std::span<const GLuint> indices,
+	std::span<const ModelLOD> lods)
+	: Model(id, CreateMeshWithLODs(vertices, indices, lods), ModelBounds::FromVertices(vertices), lods) { }
+
+Model::Model(
+	size_t id,
+	MeshHandle mesh,
+	const ModelBounds& bounds,
+	std::span<const ModelLOD> lods)
+	: bounds_(bounds),
+	  mesh_(mesh),
+	  id_(id)
+{
+	ValidateLODs(lods, std::nullopt);
+	lods_.assign(lods.begin(), lods.end());
+}
@@ -0,0 +1,343 @@
+#include <Nova/assets/ObjImporter.hpp>
+#include <Nova/core/MappedFile.hpp>
+#include <Nova/core/ThreadPool.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <Nova/debug/Log.hpp>
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+using namespace Nova;
+
+namespace
+{
+    constexpr int32_t c_MissingIndex = std::numeric_limits<int32_t>::min();
+
+    enum RelativeIndexBits : uint8_t
+    {
+        RelativePosition = 1,
+        RelativeTextureCoords = 2,
+        RelativeNormal = 4,
+    };
+
+    // zero-based indices, relative ones are counted from the start of their chunk's list until lists are concatenated
+    struct ObjCorner
+    {
+        int32_t Position;
+        int32_t TextureCoords;
+        int32_t Normal;
+        uint8_t RelativeMask;
+    };
+
+    struct ObjChunk
+    {
+        std::string_view Text;
+        std::vector<glm::vec3> Positions;
+        std::vector<glm::vec2> TextureCoords;
+        std::vector<glm::vec3> Normals;
+        std::vector<ObjCorner> Corners; // three per triangle
+        size_t FirstPosition = 0;
+        size_t FirstTextureCoords = 0;
+        size_t FirstNormal = 0;
+        size_t FirstCorner = 0;
+    };
+
+    const char* SkipSpaces(const char* it, const char* end) noexcept
+    {
+        while (it != end && (*it == ' ' || *it == '\t'))
+            it++;
+
+        return it;
+    }
+
+    bool TryParseFloat(const char*& it, const char* end, float& value)
+    {
+        it = SkipSpaces(it, end);
+        if (it == end || *it == '#')
+            return false;
+
+        // from_chars doesn't accept explicit plus sign
+        if (*it == '+')
+            it++;
+
+        const auto [next, error] = std::from_chars(it, end, value);
+        if (error != std::errc())
+            throw std::runtime_error("Invalid number in OBJ file.");
+
+        it = next;
+        return true;
+    }
+
+    void ParseFloats(const char*& it, const char* end, float* values, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!TryParseFloat(it, end, values[i]))
+                throw std::runtime_error("Missing number in OBJ file.");
+        }
+    }
+
+    void ParseIndex(const char*& it, const char* end, size_t listSize, uint8_t relativeBit, int32_t& index, uint8_t& relativeMask)
+    {
+        int32_t value;
+        const auto [next, error] = std::from_chars(it, end, value);
+        if (error != std::errc() || value == 0)
+            throw std::runtime_error("Invalid index in OBJ file.");
+
+        it = next;
+        if (value > 0)
+        {
+            index = value - 1;
+        }
+        else
+        {
+            index = (int32_t)listSize + value;
+            relativeMask |= relativeBit;
+        }
+    }
+
+    void ParseFace(const char* it, const char* end, ObjChunk& chunk, std::vector<ObjCorner>& polygon)
+    {
+        polygon.clear();
+        while ((it = SkipSpaces(it, end)) != end && *it != '#')
+        {
+            ObjCorner corner { c_MissingIndex, c_MissingIndex, c_MissingIndex, 0 };
+            ParseIndex(it, end, chunk.Positions.size(), RelativePosition, corner.Position, corner.RelativeMask);
+
+            // v, v/vt, v//vn or v/vt/vn
+            if (it != end && *it == '/')
+            {
+                it++;
+                if (it != end && *it != '/')
+                    ParseIndex(it, end, chunk.TextureCoords.size(), RelativeTextureCoords, corner.TextureCoords, corner.RelativeMask);
+
+                if (it != end && *it == '/')
+                {
+                    it++;
+                    ParseIndex(it, end, chunk.Normals.size(), RelativeNormal, corner.Normal, corner.RelativeMask);
+                }
+            }
+
+            if (it != end && *it != ' ' && *it != '\t')
+                throw std::runtime_error("Invalid face in OBJ file.");
+
+            polygon.push_back(corner);
+        }
+
+        if (polygon.size() < 3)
+            throw std::runtime_error("OBJ face has less than three vertices.");
+
+        for (size_t i = 1; i + 1 < polygon.size(); i++)
+            chunk.Corners.insert(chunk.Corners.end(), { polygon[0], polygon[i], polygon[i + 1] });
+    }
+
+    void ParseLine(const char* it, const char* end, ObjChunk& chunk, std::vector<ObjCorner>& polygon)
+    {
+        it = SkipSpaces(it, end);
+        if (end - it < 2)
+            return;
+
+        const auto isSpace = [](char c) { return c == ' ' || c == '\t'; };
+
+        if (it[0] == 'v' && isSpace(it[1]))
+        {
+            // optional w or vertex colors after position are ignored
+            auto& position = chunk.Positions.emplace_back();
+            it += 2;
+            ParseFloats(it, end, &position.x, 3);
+        }
+        else if (it[0] == 'v' && it[1] == 't' && end - it > 2 && isSpace(it[2]))
+        {
+            auto& textureCoords = chunk.TextureCoords.emplace_back(0.0f);
+            it += 3;
+            ParseFloats(it, end, &textureCoords.x, 1);
+            TryParseFloat(it, end, textureCoords.y);
+        }
+        else if (it[0] == 'v' && it[1] == 'n' && end - it > 2 && isSpace(it[2]))
+        {
+            auto& normal = chunk.Normals.emplace_back();
+            it += 3;
+            ParseFloats(it, end, &normal.x, 3);
+        }
+        else if (it[0] == 'f' && isSpace(it[1]))
+        {
+            ParseFace(it + 2, end, chunk, polygon);
+        }
+    }
+
+    void ParseChunk(ObjChunk& chunk)
+    {
+        NV_PROFILE_FUNC;
+
+        std::vector<ObjCorner> polygon;
+
+        auto it = chunk.Text.data();
+        const auto end = it + chunk.Text.size();
+        while (it != end)
+        {
+            auto lineEnd = static_cast<const char*>(std::memchr(it, '\n', end - it));
+            const auto next = lineEnd != nullptr ? lineEnd + 1 : end;
+            if (lineEnd == nullptr)
+                lineEnd = end;
+
+            if (lineEnd != it && lineEnd[-1] == '\r')
+                lineEnd--;
+
+            ParseLine(it, lineEnd, chunk, polygon);
+            it = next;
+        }
+    }
+
+    template <typename T>
+    const T* ResolveIndex(int32_t index, bool isRelative, size_t chunkFirst, const std::vector<T>& values)
+    {
+        if (index == c_MissingIndex)
+            return nullptr;
+
+        const auto resolved = (int64_t)index + (isRelative ? (int64_t)chunkFirst : 0);
+        if (resolved < 0 || resolved >= (int64_t)values.size())
+            throw std::runtime_error("OBJ face references vertex which doesn't exist.");
+
+        return &values[(size_t)resolved];
+    }
+
+    void AssembleChunk(
+        const ObjChunk& chunk,
+        const std::vector<glm::vec3>& positions,
+        const std::vector<glm::vec2>& textureCoords,
+        const std::vector<glm::vec3>& normals,
+        std::vector<ModelVertex>& vertices)
+    {
+        NV_PROFILE_FUNC;
+
+        for (size_t i = 0; i < chunk.Corners.size(); i += 3)
+        {
+            auto triangle = &vertices[chunk.FirstCorner + i];
+            bool hasAllNormals = true;
+
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                const auto& objCorner = chunk.Corners[i + corner];
+                const auto position = ResolveIndex(objCorner.Position, objCorner.RelativeMask & RelativePosition, chunk.FirstPosition, positions);
+                const auto textureCoord = ResolveIndex(objCorner.TextureCoords, objCorner.RelativeMask & RelativeTextureCoords, chunk.FirstTextureCoords, textureCoords);
+                const auto normal = ResolveIndex(objCorner.Normal, objCorner.RelativeMask & RelativeNormal, chunk.FirstNormal, normals);
+
+                triangle[corner] = ModelVertex {
+                    .Position = *position,
+                    .Normal = normal != nullptr ? *normal : glm::vec3(0.0f),
+                    .TextureCoords = textureCoord != nullptr ? *textureCoord : glm::vec2(0.0f),
+                };
+                hasAllNormals &= normal != nullptr;
+            }
+
+            if (hasAllNormals)
+                continue;
+
+            const auto faceNormal = glm::cross(
+                triangle[1].Position - triangle[0].Position,
+                triangle[2].Position - triangle[0].Position);
+            const auto length = glm::length(faceNormal);
+            for (size_t corner = 0; corner < 3; corner++)
+                triangle[corner].Normal = length > 0.0f ? faceNormal / length : glm::vec3(0.0f);
+        }
+    }
+}
+
+std::vector<ModelVertex> Nova::ImportObj(
+    const std::filesystem::path& filepath,
+    ThreadPool* threadPool,
+    size_t chunkSize)
+{
+    NV_PROFILE_FUNC;
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    const MappedFile file(filepath);
+    const auto text = file.GetText();
+
+    const auto parallelFor = [&](size_t count, const std::function<void(size_t)>& function)
+    {
+        if (threadPool != nullptr)
+        {
+            threadPool->ParallelFor(count, function);
+            return;
+        }
+
+        for (size_t i = 0; i < count; i++)
+            function(i);
+    };
+
+    if (chunkSize == 0)
+        throw std::runtime_error("OBJ chunk size must not be zero.");
+
+    // chunk boundaries are moved forward to the next line start, so that no line is split
+    std::vector<ObjChunk> chunks;
+    size_t chunkStart = 0;
+    while (chunkStart < text.size())
+    {
+        auto chunkEnd = chunkStart + std::min(chunkSize, text.size() - chunkStart);
+        if (chunkEnd < text.size())
+        {
+            const auto lineEnd = text.find('\n', chunkEnd - 1);
+            chunkEnd = lineEnd != std::string_view::npos ? lineEnd + 1 : text.size();
+        }
+
+        chunks.emplace_back().Text = text.substr(chunkStart, chunkEnd - chunkStart);
+        chunkStart = chunkEnd;
+    }
+
+    parallelFor(chunks.size(), [&](size_t i) { ParseChunk(chunks[i]); });
+
+    size_t positionCount = 0;
+    size_t textureCoordsCount = 0;
+    size_t normalCount = 0;
+    size_t cornerCount = 0;
+    for (auto& chunk : chunks)
+    {
+        chunk.FirstPosition = positionCount;
+        chunk.FirstTextureCoords = textureCoordsCount;
+        chunk.FirstNormal = normalCount;
+        chunk.FirstCorner = cornerCount;
+        positionCount += chunk.Positions.size();
+        textureCoordsCount += chunk.TextureCoords.size();
+        normalCount += chunk.Normals.size();
+        cornerCount += chunk.Corners.size();
+    }
+
+    if (positionCount > (size_t)std::numeric_limits<int32_t>::max())
+        throw std::runtime_error("OBJ file has too many vertices.");
+
+    std::vector<glm::vec3> positions(positionCount);
+    std::vector<glm::vec2> textureCoords(textureCoordsCount);
+    std::vector<glm::vec3> normals(normalCount);
+    parallelFor(
+        chunks.size(),
+        [&](size_t i)
+        {
+            const auto& chunk = chunks[i];
+            std::copy(chunk.Positions.begin(), chunk.Positions.end(), positions.begin() + chunk.FirstPosition);
+            std::copy(chunk.TextureCoords.begin(), chunk.TextureCoords.end(), textureCoords.begin() + chunk.FirstTextureCoords);
+            std::copy(chunk.Normals.begin(), chunk.Normals.end(), normals.begin() + chunk.FirstNormal);
+        });
+
+    std::vector<ModelVertex> vertices(cornerCount);
+    parallelFor(chunks.size(), [&](size_t i) { AssembleChunk(chunks[i], positions, textureCoords, normals, vertices); });
+
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    const auto megabytes = (double)text.size() / (1024.0 * 1024.0);
+    NV_LOG_INFO(
+        "Imported {} triangles from {} ({:.1f} MB) in {:.1f} ms, {:.0f} MB/s.",
+        cornerCount / 3,
+        filepath.string(),
+        megabytes,
+        seconds * 1000.0,
+        seconds > 0.0 ? megabytes / seconds : 0.0);
+
+    return vertices;
+}
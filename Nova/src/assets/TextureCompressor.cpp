@@ -0,0 +1,858 @@
+#include <Nova/assets/TextureCompressor.hpp>
+#include <Nova/core/ThreadPool.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NV_BLOCK_SIMD 1
+#else
+#define NV_BLOCK_SIMD 0
+#endif
+
+using namespace Nova;
+
+namespace
+{
+    constexpr uint32_t c_BlockTexelCount = 16;
+    constexpr uint32_t c_AllTexelsMask = 0xFFFF;
+
+    constexpr std::array<float, 4> c_ColorWeights { 1.0f, 1.0f, 1.0f, 0.0f };
+    constexpr std::array<float, 4> c_ColorAlphaWeights { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    // interpolation weights of palette entries, in the order in which indices address them
+    constexpr std::array<float, 4> c_FourColorWeights { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    constexpr std::array<float, 4> c_ThreeColorWeights { 0.0f, 1.0f, 0.5f, 0.0f };
+    constexpr std::array<float, 8> c_AlphaWeights { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+    constexpr std::array<uint32_t, 16> c_BC7IndexWeights { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // texels of one block as floats in [0, 255], every texel maps to one SIMD register
+    struct Block
+    {
+        alignas(16) float Texels[c_BlockTexelCount][4];
+    };
+
+    struct Palette
+    {
+        alignas(16) float Entries[16][4];
+        uint32_t Size;
+    };
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(uint8_t* data) noexcept
+            : data_(data)
+        {
+        }
+
+        // destination bits have to be zero
+        void Write(uint32_t value, uint32_t bitCount) noexcept
+        {
+            for (uint32_t i = 0; i < bitCount; i++, position_++)
+                data_[position_ / 8] |= (uint8_t)(((value >> i) & 1) << (position_ % 8));
+        }
+
+    private:
+        uint8_t* data_;
+        uint32_t position_ = 0;
+    };
+
+    class BitReader
+    {
+    public:
+        explicit BitReader(const uint8_t* data) noexcept
+            : data_(data)
+        {
+        }
+
+        uint32_t Read(uint32_t bitCount) noexcept
+        {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < bitCount; i++, position_++)
+                value |= (uint32_t)((data_[position_ / 8] >> (position_ % 8)) & 1) << i;
+
+            return value;
+        }
+
+    private:
+        const uint8_t* data_;
+        uint32_t position_ = 0;
+    };
+
+    uint32_t GetRefinementCount(CompressionQuality quality) noexcept
+    {
+        switch (quality)
+        {
+        case CompressionQuality::Fast:
+            return 0;
+        case CompressionQuality::Normal:
+            return 1;
+        default:
+            return 4;
+        }
+    }
+
+    void LoadBlock(const Image& image, uint32_t blockX, uint32_t blockY, Block& block) noexcept
+    {
+        for (uint32_t y = 0; y < 4; y++)
+        {
+            const auto sourceY = std::min(blockY * 4 + y, image.Height - 1);
+            for (uint32_t x = 0; x < 4; x++)
+            {
+                const auto sourceX = std::min(blockX * 4 + x, image.Width - 1);
+                const auto pixel = &image.Pixels[((size_t)sourceY * image.Width + sourceX) * 4];
+                for (uint32_t channel = 0; channel < 4; channel++)
+                    block.Texels[y * 4 + x][channel] = (float)pixel[channel];
+            }
+        }
+    }
+
+    float GetSquaredDistance(const float* a, const float* b, const float* weights) noexcept
+    {
+#if NV_BLOCK_SIMD
+        const auto difference = _mm_sub_ps(_mm_loadu_ps(a), _mm_loadu_ps(b));
+        const auto squared = _mm_mul_ps(_mm_mul_ps(difference, difference), _mm_loadu_ps(weights));
+        const auto pairs = _mm_add_ps(squared, _mm_movehl_ps(squared, squared));
+
+        return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+#else
+        float sum = 0.0f;
+        for (int channel = 0; channel < 4; channel++)
+            sum += (a[channel] - b[channel]) * (a[channel] - b[channel]) * weights[channel];
+
+        return sum;
+#endif
+    }
+
+    // picks the closest palette entry for every texel in mask and returns the total error, other indices are kept
+    float FindIndices(const Block& block, uint32_t texelMask, const Palette& palette, const float* weights, uint8_t* indices) noexcept
+    {
+        float error = 0.0f;
+        for (uint32_t i = 0; i < c_BlockTexelCount; i++)
+        {
+            if ((texelMask >> i & 1) == 0)
+                continue;
+
+            auto closestDistance = std::numeric_limits<float>::max();
+            for (uint32_t entry = 0; entry < palette.Size; entry++)
+            {
+                const auto distance = GetSquaredDistance(block.Texels[i], palette.Entries[entry], weights);
+                if (distance < closestDistance)
+                {
+                    closestDistance = distance;
+                    indices[i] = (uint8_t)entry;
+                }
+            }
+
+            error += closestDistance;
+        }
+
+        return error;
+    }
+
+    // endpoints of segment through texels in mask along their bounding box diagonal or principal axis,
+    // channels with zero weight are left at their mean
+    void FitEndpoints(
+        const Block& block,
+        uint32_t texelMask,
+        const float* weights,
+        CompressionQuality quality,
+        float* endpoint0,
+        float* endpoint1) noexcept
+    {
+        float mean[4] {};
+        float minimum[4] { 255.0f, 255.0f, 255.0f, 255.0f };
+        float maximum[4] {};
+        float count = 0.0f;
+        for (uint32_t i = 0; i < c_BlockTexelCount; i++)
+        {
+            if ((texelMask >> i & 1) == 0)
+                continue;
+
+            for (int channel = 0; channel < 4; channel++)
+            {
+                mean[channel] += block.Texels[i][channel];
+                minimum[channel] = std::min(minimum[channel], block.Texels[i][channel]);
+                maximum[channel] = std::max(maximum[channel], block.Texels[i][channel]);
+            }
+            count++;
+        }
+
+        float axis[4];
+        int widestChannel = 0;
+        for (int channel = 0; channel < 4; channel++)
+        {
+            mean[channel] /= count;
+            axis[channel] = weights[channel] > 0.0f ? maximum[channel] - minimum[channel] : 0.0f;
+            if (axis[channel] > axis[widestChannel])
+                widestChannel = channel;
+        }
+
+        // of the box diagonals, the one along which channels rise or fall together with the widest channel is taken,
+        // so that a channel going down while others go up doesn't put all texels far off the segment
+        for (int channel = 0; channel < 4; channel++)
+        {
+            float correlation = 0.0f;
+            for (uint32_t i = 0; i < c_BlockTexelCount; i++)
+            {
+                if ((texelMask >> i & 1) != 0)
+                    correlation += (block.Texels[i][channel] - mean[channel]) * (block.Texels[i][widestChannel] - mean[widestChannel]);
+            }
+
+            if (correlation < 0.0f)
+                axis[channel] = -axis[channel];
+        }
+
+        if (quality != CompressionQuality::Fast)
+        {
+            float covariance[4][4] {};
+            for (uint32_t i = 0; i < c_BlockTexelCount; i++)
+            {
+                if ((texelMask >> i & 1) == 0)
+                    continue;
+
+                for (int row = 0; row < 4; row++)
+                {
+                    for (int column = 0; column < 4; column++)
+                    {
+                        covariance[row][column] += weights[row] * weights[column]
+                            * (block.Texels[i][row] - mean[row]) * (block.Texels[i][column] - mean[column]);
+                    }
+                }
+            }
+
+            // power iteration from the bounding box diagonal converges to the principal axis in a few steps
+            for (int iteration = 0; iteration < 8; iteration++)
+            {
+                float next[4] {};
+                float length = 0.0f;
+                for (int row = 0; row < 4; row++)
+                {
+                    for (int column = 0; column < 4; column++)
+                        next[row] += covariance[row][column] * axis[column];
+
+                    length = std::max(length, std::abs(next[row]));
+                }
+
+                if (length == 0.0f)
+                    break;
+
+                for (int channel = 0; channel < 4; channel++)
+                    axis[channel] = next[channel] / length;
+            }
+        }
+
+        float lengthSquared = 0.0f;
+        for (int channel = 0; channel < 4; channel++)
+            lengthSquared += axis[channel] * axis[channel];
+
+        float minimumT = 0.0f;
+        float maximumT = 0.0f;
+        if (lengthSquared > 0.0f)
+        {
+            minimumT = std::numeric_limits<float>::max();
+            maximumT = std::numeric_limits<float>::lowest();
+            for (uint32_t i = 0; i < c_BlockTexelCount; i++)
+            {
+                if ((texelMask >> i & 1) == 0)
+                    continue;
+
+                float t = 0.0f;
+                for (int channel = 0; channel < 4; channel++)
+                    t += (block.Texels[i][channel] - mean[channel]) * axis[channel];
+
+                minimumT = std::min(minimumT, t / lengthSquared);
+                maximumT = std::max(maximumT, t / lengthSquared);
+            }
+        }
+
+        for (int channel = 0; channel < 4; channel++)
+        {
+            endpoint0[channel] = std::clamp(mean[channel] + minimumT * axis[channel], 0.0f, 255.0f);
+            endpoint1[channel] = std::clamp(mean[channel] + maximumT * axis[channel], 0.0f, 255.0f);
+        }
+    }
+
+    // least squares endpoints for fixed indices, returns false when indices don't determine both endpoints
+    bool RefineEndpoints(
+        const Block& block,
+        uint32_t texelMask,
+        const uint8_t* indices,
+        const float* indexWeights,
+        float* endpoint0,
+        float* endpoint1) noexcept
+    {
+        float weight00 = 0.0f;
+        float weight01 = 0.0f;
+        float weight11 = 0.0f;
+        float sum0[4] {};
+        float sum1[4] {};
+        for (uint32_t i = 0; i < c_BlockTexelCount; i++)
+        {
+            if ((texelMask >> i & 1) == 0)
+                continue;
+
+            const auto weight = indexWeights[indices[i]];
+            const auto inverseWeight = 1.0f - weight;
+            weight00 += inverseWeight * inverseWeight;
+            weight01 += inverseWeight * weight;
+            weight11 += weight * weight;
+            for (int channel = 0; channel < 4; channel++)
+            {
+                sum0[channel] += inverseWeight * block.Texels[i][channel];
+                sum1[channel] += weight * block.Texels[i][channel];
+            }
+        }
+
+        const auto determinant = weight00 * weight11 - weight01 * weight01;
+        if (std::abs(determinant) < 1e-6f)
+            return false;
+
+        for (int channel = 0; channel < 4; channel++)
+        {
+            endpoint0[channel] = std::clamp((weight11 * sum0[channel] - weight01 * sum1[channel]) / determinant, 0.0f, 255.0f);
+            endpoint1[channel] = std::clamp((weight00 * sum1[channel] - weight01 * sum0[channel]) / determinant, 0.0f, 255.0f);
+        }
+
+        return true;
+    }
+
+    uint16_t QuantizeColor565(const float* color) noexcept
+    {
+        const auto r = (uint32_t)std::lround(color[0] * 31.0f / 255.0f);
+        const auto g = (uint32_t)std::lround(color[1] * 63.0f / 255.0f);
+        const auto b = (uint32_t)std::lround(color[2] * 31.0f / 255.0f);
+
+        return (uint16_t)(r << 11 | g << 5 | b);
+    }
+
+    std::array<int, 3> DecodeColor565(uint16_t color) noexcept
+    {
+        const auto r = color >> 11 & 31;
+        const auto g = color >> 5 & 63;
+        const auto b = color & 31;
+
+        return { r << 3 | r >> 2, g << 2 | g >> 4, b << 3 | b >> 2 };
+    }
+
+    // palette as the decoder builds it, ordering of endpoints selects between four colors and three colors
+    // with transparent black
+    std::array<std::array<int, 4>, 4> BuildColorPalette(uint16_t color0, uint16_t color1, bool isFourColorBlock) noexcept
+    {
+        const auto rgb0 = DecodeColor565(color0);
+        const auto rgb1 = DecodeColor565(color1);
+
+        std::array<std::array<int, 4>, 4> palette;
+        for (int channel = 0; channel < 3; channel++)
+        {
+            palette[0][channel] = rgb0[channel];
+            palette[1][channel] = rgb1[channel];
+            palette[2][channel] = isFourColorBlock
+                ? (2 * rgb0[channel] + rgb1[channel]) / 3
+                : (rgb0[channel] + rgb1[channel]) / 2;
+            palette[3][channel] = isFourColorBlock
+                ? (rgb0[channel] + 2 * rgb1[channel]) / 3
+                : 0;
+        }
+        palette[0][3] = palette[1][3] = palette[2][3] = 255;
+        palette[3][3] = isFourColorBlock ? 255 : 0;
+
+        return palette;
+    }
+
+    std::array<int, 8> BuildAlphaPalette(int alpha0, int alpha1) noexcept
+    {
+        std::array<int, 8> palette { alpha0, alpha1 };
+        if (alpha0 > alpha1)
+        {
+            for (int i = 2; i < 8; i++)
+                palette[i] = ((8 - i) * alpha0 + (i - 1) * alpha1) / 7;
+        }
+        else
+        {
+            for (int i = 2; i < 6; i++)
+                palette[i] = ((6 - i) * alpha0 + (i - 1) * alpha1) / 5;
+
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        return palette;
+    }
+
+    // BC1 block, or color half of BC3 block which is always decoded with four colors
+    void EncodeColorBlock(const Block& block, CompressionQuality quality, bool allowTransparency, uint8_t* output) noexcept
+    {
+        uint32_t opaqueMask = c_AllTexelsMask;
+        if (allowTransparency)
+        {
+            for (uint32_t i = 0; i < c_BlockTexelCount; i++)
+            {
+                if (block.Texels[i][3] < 128.0f)
+                    opaqueMask &= ~(1u << i);
+            }
+        }
+
+        std::array<uint8_t, c_BlockTexelCount> indices {};
+        uint16_t color0 = 0;
+        uint16_t color1 = 0;
+        if (opaqueMask != 0)
+        {
+            // three color mode is needed only for its transparent entry
+            const auto useFourColors = opaqueMask == c_AllTexelsMask;
+
+            float endpoint0[4];
+            float endpoint1[4];
+            FitEndpoints(block, opaqueMask, c_ColorWeights.data(), quality, endpoint0, endpoint1);
+
+            const auto refinementCount = GetRefinementCount(quality);
+            auto bestError = std::numeric_limits<float>::max();
+            std::array<uint8_t, c_BlockTexelCount> candidateIndices {};
+            for (uint32_t iteration = 0;; iteration++)
+            {
+                auto candidate0 = QuantizeColor565(endpoint0);
+                auto candidate1 = QuantizeColor565(endpoint1);
+                if (useFourColors ? candidate0 < candidate1 : candidate0 > candidate1)
+                    std::swap(candidate0, candidate1);
+
+                // equal endpoints fall back to three colors, all of them are the same color anyway
+                const auto isFourColorBlock = candidate0 > candidate1;
+                const auto colors = BuildColorPalette(candidate0, candidate1, isFourColorBlock);
+
+                Palette palette { .Size = 3 };
+                for (uint32_t entry = 0; entry < 4; entry++)
+                {
+                    for (uint32_t channel = 0; channel < 4; channel++)
+                        palette.Entries[entry][channel] = (float)colors[entry][channel];
+                }
+
+                if (isFourColorBlock)
+                    palette.Size = 4;
+
+                const auto error = FindIndices(block, opaqueMask, palette, c_ColorWeights.data(), candidateIndices.data());
+                if (error < bestError)
+                {
+                    bestError = error;
+                    color0 = candidate0;
+                    color1 = candidate1;
+                    indices = candidateIndices;
+                }
+
+                const auto& indexWeights = isFourColorBlock ? c_FourColorWeights : c_ThreeColorWeights;
+                if (iteration == refinementCount
+                    || !RefineEndpoints(block, opaqueMask, candidateIndices.data(), indexWeights.data(), endpoint0, endpoint1))
+                    break;
+            }
+        }
+
+        for (uint32_t i = 0; i < c_BlockTexelCount; i++)
+        {
+            if ((opaqueMask >> i & 1) == 0)
+                indices[i] = 3;
+        }
+
+        BitWriter writer(output);
+        writer.Write(color0, 16);
+        writer.Write(color1, 16);
+        for (const auto index : indices)
+            writer.Write(index, 2);
+    }
+
+    // BC4 block encoding one channel, used for alpha of BC3 and both channels of BC5
+    void EncodeChannelBlock(const Block& block, uint32_t channel, CompressionQuality quality, uint8_t* output) noexcept
+    {
+        auto minimum = 255.0f;
+        auto maximum = 0.0f;
+        for (const auto& texel : block.Texels)
+        {
+            minimum = std::min(minimum, texel[channel]);
+            maximum = std::max(maximum, texel[channel]);
+        }
+
+        std::array<uint8_t, c_BlockTexelCount> indices {};
+        auto alpha0 = (int)maximum;
+        auto alpha1 = (int)minimum;
+        if (alpha0 != alpha1)
+        {
+            float endpoint0[4] {};
+            float endpoint1[4] {};
+            endpoint0[channel] = maximum;
+            endpoint1[channel] = minimum;
+
+            const auto refinementCount = GetRefinementCount(quality);
+            auto bestError = std::numeric_limits<float>::max();
+            std::array<uint8_t, c_BlockTexelCount> candidateIndices {};
+            for (uint32_t iteration = 0;; iteration++)
+            {
+                auto candidate0 = (int)std::lround(endpoint0[channel]);
+                auto candidate1 = (int)std::lround(endpoint1[channel]);
+                if (candidate0 < candidate1)
+                    std::swap(candidate0, candidate1);
+
+                // eight value mode needs strictly ordered endpoints
+                if (candidate0 == candidate1)
+                {
+                    if (candidate0 < 255)
+                        candidate0++;
+                    else
+                        candidate1--;
+                }
+
+                const auto values = BuildAlphaPalette(candidate0, candidate1);
+
+                float error = 0.0f;
+                for (uint32_t i = 0; i < c_BlockTexelCount; i++)
+                {
+                    auto closestDistance = std::numeric_limits<float>::max();
+                    for (uint32_t entry = 0; entry < values.size(); entry++)
+                    {
+                        const auto difference = block.Texels[i][channel] - (float)values[entry];
+                        if (difference * difference < closestDistance)
+                        {
+                            closestDistance = difference * difference;
+                            candidateIndices[i] = (uint8_t)entry;
+                        }
+                    }
+
+                    error += closestDistance;
+                }
+
+                if (error < bestError)
+                {
+                    bestError = error;
+                    alpha0 = candidate0;
+                    alpha1 = candidate1;
+                    indices = candidateIndices;
+                }
+
+                if (iteration == refinementCount
+                    || !RefineEndpoints(block, c_AllTexelsMask, candidateIndices.data(), c_AlphaWeights.data(), endpoint0, endpoint1))
+                    break;
+            }
+        }
+
+        BitWriter writer(output);
+        writer.Write((uint32_t)alpha0, 8);
+        writer.Write((uint32_t)alpha1, 8);
+        for (const auto index : indices)
+            writer.Write(index, 3);
+    }
+
+    // 7-bit value of every channel of endpoint with shared lowest bit
+    std::array<uint32_t, 4> QuantizeBC7Endpoint(const float* endpoint, uint32_t parityBit) noexcept
+    {
+        std::array<uint32_t, 4> values;
+        for (int channel = 0; channel < 4; channel++)
+            values[channel] = (uint32_t)std::clamp<long>(std::lround((endpoint[channel] - (float)parityBit) * 0.5f), 0, 127);
+
+        return values;
+    }
+
+    float GetBC7QuantizationError(const float* endpoint, uint32_t parityBit) noexcept
+    {
+        const auto values = QuantizeBC7Endpoint(endpoint, parityBit);
+
+        float error = 0.0f;
+        for (int channel = 0; channel < 4; channel++)
+        {
+            const auto difference = (float)(values[channel] << 1 | parityBit) - endpoint[channel];
+            error += difference * difference;
+        }
+
+        return error;
+    }
+
+    Palette BuildBC7Palette(const std::array<uint32_t, 4>& values0, uint32_t parityBit0, const std::array<uint32_t, 4>& values1, uint32_t parityBit1) noexcept
+    {
+        Palette palette { .Size = 16 };
+        for (uint32_t entry = 0; entry < 16; entry++)
+        {
+            const auto weight = c_BC7IndexWeights[entry];
+            for (int channel = 0; channel < 4; channel++)
+            {
+                const auto value0 = values0[channel] << 1 | parityBit0;
+                const auto value1 = values1[channel] << 1 | parityBit1;
+                palette.Entries[entry][channel] = (float)(((64 - weight) * value0 + weight * value1 + 32) >> 6);
+            }
+        }
+
+        return palette;
+    }
+
+    // mode 6, one subset with RGBA endpoints of 7 bits plus parity bit and 4-bit indices
+    void EncodeBC7Block(const Block& block, CompressionQuality quality, uint8_t* output) noexcept
+    {
+        float endpoint0[4];
+        float endpoint1[4];
+        FitEndpoints(block, c_AllTexelsMask, c_ColorAlphaWeights.data(), quality, endpoint0, endpoint1);
+
+        std::array<uint32_t, 4> values0 {};
+        std::array<uint32_t, 4> values1 {};
+        uint32_t parityBit0 = 0;
+        uint32_t parityBit1 = 0;
+        std::array<uint8_t, c_BlockTexelCount> indices {};
+
+        const auto refinementCount = GetRefinementCount(quality);
+        auto bestError = std::numeric_limits<float>::max();
+        std::array<uint8_t, c_BlockTexelCount> candidateIndices {};
+        for (uint32_t iteration = 0;; iteration++)
+        {
+            // parity bits are chosen by endpoint error alone, unless all combinations are tried
+            const auto tryCandidate = [&](uint32_t candidateParityBit0, uint32_t candidateParityBit1)
+            {
+                const auto candidate0 = QuantizeBC7Endpoint(endpoint0, candidateParityBit0);
+                const auto candidate1 = QuantizeBC7Endpoint(endpoint1, candidateParityBit1);
+                const auto palette = BuildBC7Palette(candidate0, candidateParityBit0, candidate1, candidateParityBit1);
+
+                const auto error = FindIndices(block, c_AllTexelsMask, palette, c_ColorAlphaWeights.data(), candidateIndices.data());
+                if (error < bestError)
+                {
+                    bestError = error;
+                    values0 = candidate0;
+                    values1 = candidate1;
+                    parityBit0 = candidateParityBit0;
+                    parityBit1 = candidateParityBit1;
+                    indices = candidateIndices;
+                }
+            };
+
+            if (quality == CompressionQuality::High)
+            {
+                for (uint32_t parityBits = 0; parityBits < 4; parityBits++)
+                    tryCandidate(parityBits & 1, parityBits >> 1);
+            }
+            else
+            {
+                tryCandidate(
+                    GetBC7QuantizationError(endpoint0, 1) < GetBC7QuantizationError(endpoint0, 0) ? 1 : 0,
+                    GetBC7QuantizationError(endpoint1, 1) < GetBC7QuantizationError(endpoint1, 0) ? 1 : 0);
+            }
+
+            if (iteration == refinementCount)
+                break;
+
+            // refinement starts from indices of the best candidate so far
+            float indexWeights[16];
+            for (uint32_t entry = 0; entry < 16; entry++)
+                indexWeights[entry] = (float)c_BC7IndexWeights[entry] / 64.0f;
+
+            if (!RefineEndpoints(block, c_AllTexelsMask, indices.data(), indexWeights, endpoint0, endpoint1))
+                break;
+        }
+
+        // highest bit of the first index is implicitly zero
+        if (indices[0] >= 8)
+        {
+            std::swap(values0, values1);
+            std::swap(parityBit0, parityBit1);
+            for (auto& index : indices)
+                index = (uint8_t)(15 - index);
+        }
+
+        BitWriter writer(output);
+        writer.Write(1u << 6, 7);
+        for (int channel = 0; channel < 4; channel++)
+        {
+            writer.Write(values0[channel], 7);
+            writer.Write(values1[channel], 7);
+        }
+        writer.Write(parityBit0, 1);
+        writer.Write(parityBit1, 1);
+
+        writer.Write(indices[0], 3);
+        for (uint32_t i = 1; i < c_BlockTexelCount; i++)
+            writer.Write(indices[i], 4);
+    }
+
+    // writes decoded texels of one block, those outside of image are skipped
+    void StoreBlock(Image& image, uint32_t blockX, uint32_t blockY, const std::array<std::array<int, 4>, c_BlockTexelCount>& texels) noexcept
+    {
+        for (uint32_t y = 0; y < 4 && blockY * 4 + y < image.Height; y++)
+        {
+            for (uint32_t x = 0; x < 4 && blockX * 4 + x < image.Width; x++)
+            {
+                const auto pixel = &image.Pixels[((size_t)(blockY * 4 + y) * image.Width + blockX * 4 + x) * 4];
+                for (uint32_t channel = 0; channel < 4; channel++)
+                    pixel[channel] = (uint8_t)texels[y * 4 + x][channel];
+            }
+        }
+    }
+
+    void DecodeColorBlock(const uint8_t* data, bool isBC1, std::array<std::array<int, 4>, c_BlockTexelCount>& texels) noexcept
+    {
+        BitReader reader(data);
+        const auto color0 = (uint16_t)reader.Read(16);
+        const auto color1 = (uint16_t)reader.Read(16);
+        const auto palette = BuildColorPalette(color0, color1, !isBC1 || color0 > color1);
+
+        for (auto& texel : texels)
+            texel = palette[reader.Read(2)];
+    }
+
+    void DecodeChannelBlock(const uint8_t* data, uint32_t channel, std::array<std::array<int, 4>, c_BlockTexelCount>& texels) noexcept
+    {
+        BitReader reader(data);
+        const auto alpha0 = (int)reader.Read(8);
+        const auto alpha1 = (int)reader.Read(8);
+        const auto palette = BuildAlphaPalette(alpha0, alpha1);
+
+        for (auto& texel : texels)
+            texel[channel] = palette[reader.Read(3)];
+    }
+
+    void DecodeBC7Block(const uint8_t* data, std::array<std::array<int, 4>, c_BlockTexelCount>& texels)
+    {
+        BitReader reader(data);
+        if (reader.Read(7) != 1u << 6)
+            throw std::runtime_error("Only BC7 blocks in mode 6 can be decoded.");
+
+        std::array<uint32_t, 4> values0;
+        std::array<uint32_t, 4> values1;
+        for (int channel = 0; channel < 4; channel++)
+        {
+            values0[channel] = reader.Read(7);
+            values1[channel] = reader.Read(7);
+        }
+
+        const auto parityBit0 = reader.Read(1);
+        const auto parityBit1 = reader.Read(1);
+        const auto palette = BuildBC7Palette(values0, parityBit0, values1, parityBit1);
+
+        for (uint32_t i = 0; i < c_BlockTexelCount; i++)
+        {
+            const auto index = reader.Read(i == 0 ? 3 : 4);
+            for (int channel = 0; channel < 4; channel++)
+                texels[i][channel] = (int)palette.Entries[index][channel];
+        }
+    }
+}
+
+CompressedImage Nova::CompressImage(
+    const Image& image,
+    BlockFormat format,
+    CompressionQuality quality,
+    ThreadPool* threadPool)
+{
+    NV_PROFILE_FUNC;
+
+    const auto blockCountX = (image.Width + 3) / 4;
+    const auto blockCountY = (image.Height + 3) / 4;
+    const auto blockSize = GetBlockSize(format);
+
+    CompressedImage result { image.Width, image.Height };
+    result.Blocks.resize((size_t)blockCountX * blockCountY * blockSize);
+
+    const auto compressRow = [&](size_t blockY)
+    {
+        Block block;
+        for (uint32_t blockX = 0; blockX < blockCountX; blockX++)
+        {
+            LoadBlock(image, blockX, (uint32_t)blockY, block);
+
+            const auto output = &result.Blocks[(blockY * blockCountX + blockX) * blockSize];
+            switch (format)
+            {
+            case BlockFormat::BC1:
+                EncodeColorBlock(block, quality, true, output);
+                break;
+            case BlockFormat::BC3:
+                EncodeChannelBlock(block, 3, quality, output);
+                EncodeColorBlock(block, quality, false, output + 8);
+                break;
+            case BlockFormat::BC5:
+                EncodeChannelBlock(block, 0, quality, output);
+                EncodeChannelBlock(block, 1, quality, output + 8);
+                break;
+            case BlockFormat::BC7:
+                EncodeBC7Block(block, quality, output);
+                break;
+            }
+        }
+    };
+
+    if (threadPool != nullptr)
+    {
+        threadPool->ParallelFor(blockCountY, compressRow);
+    }
+    else
+    {
+        for (uint32_t blockY = 0; blockY < blockCountY; blockY++)
+            compressRow(blockY);
+    }
+
+    return result;
+}
+
+Image Nova::DecompressImage(const CompressedImage& image, BlockFormat format)
+{
+    NV_PROFILE_FUNC;
+
+    const auto blockCountX = (image.Width + 3) / 4;
+    const auto blockCountY = (image.Height + 3) / 4;
+    const auto blockSize = GetBlockSize(format);
+    if (image.Blocks.size() != (size_t)blockCountX * blockCountY * blockSize)
+        throw std::runtime_error("Compressed image size doesn't match its dimensions.");
+
+    Image result { image.Width, image.Height };
+    result.Pixels.resize(GetImageSize(result));
+
+    std::array<std::array<int, 4>, c_BlockTexelCount> texels;
+    for (uint32_t blockY = 0; blockY < blockCountY; blockY++)
+    {
+        for (uint32_t blockX = 0; blockX < blockCountX; blockX++)
+        {
+            const auto data = &image.Blocks[((size_t)blockY * blockCountX + blockX) * blockSize];
+            switch (format)
+            {
+            case BlockFormat::BC1:
+                DecodeColorBlock(data, true, texels);
+                break;
+            case BlockFormat::BC3:
+                DecodeColorBlock(data + 8, false, texels);
+                DecodeChannelBlock(data, 3, texels);
+                break;
+            case BlockFormat::BC5:
+                texels.fill({ 0, 0, 0, 255 });
+                DecodeChannelBlock(data, 0, texels);
+                DecodeChannelBlock(data + 8, 1, texels);
+                break;
+            case BlockFormat::BC7:
+                DecodeBC7Block(data, texels);
+                break;
+            }
+
+            StoreBlock(result, blockX, blockY, texels);
+        }
+    }
+
+    return result;
+}
+
+double Nova::ComputePSNR(const Image& reference, const Image& image, uint32_t channelCount)
+{
+    if (reference.Width != image.Width || reference.Height != image.Height || reference.Pixels.size() != image.Pixels.size())
+        throw std::runtime_error("Compared images differ in size.");
+
+    double squaredErrorSum = 0.0;
+    for (size_t i = 0; i < reference.Pixels.size(); i++)
+    {
+        if (i % 4 >= channelCount)
+            continue;
+
+        const auto difference = (double)reference.Pixels[i] - (double)image.Pixels[i];
+        squaredErrorSum += difference * difference;
+    }
+
+    if (squaredErrorSum == 0.0)
+        return std::numeric_limits<double>::infinity();
+
+    const auto meanSquaredError = squaredErrorSum / ((double)reference.Width * reference.Height * channelCount);
+
+    return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
@@ -0,0 +1,220 @@
+#include <Nova/assets/TextureFile.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <Nova/debug/Log.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+using namespace Nova;
+
+static constexpr AssetFileType c_TextureFileType {
+    .Name = "Texture",
+    .Magic = c_TextureFileMagic,
+    .Version = c_TextureFileVersion,
+};
+
+static constexpr const char* GetFormatName(BlockFormat format) noexcept
+{
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        return "BC1";
+    case BlockFormat::BC3:
+        return "BC3";
+    case BlockFormat::BC5:
+        return "BC5";
+    default:
+        return "BC7";
+    }
+}
+
+TextureFile::TextureFile(const std::filesystem::path& filepath, bool verifyChecksum)
+    : file_(filepath)
+{
+    NV_PROFILE_FUNC;
+
+    const auto data = file_.GetData();
+
+    const auto header = ReadAssetFileHeader<TextureFileHeader>(data, c_TextureFileType, verifyChecksum);
+    if (header.Format > BlockFormat::BC7)
+        throw std::runtime_error("Texture file block format is not supported.");
+
+    // chain of a texture with storage allocated by glTexStorage2D can't be longer than down to 1x1
+    if (header.LevelCount > 0
+        && (header.Width == 0
+            || header.Height == 0
+            || header.LevelCount > (uint32_t)std::bit_width(std::max(header.Width, header.Height))))
+        throw std::runtime_error("Texture file level count doesn't match its dimensions.");
+
+    levels_ = GetAssetFileSection<TextureFileLevel>(data, header.LevelOffset, header.LevelCount, c_TextureFileType, "level table");
+    format_ = header.Format;
+    isSRGB_ = header.IsSRGB != 0;
+
+    const auto blockSize = GetBlockSize(format_);
+    for (uint32_t i = 0; i < levels_.size(); i++)
+    {
+        const auto& level = levels_[i];
+        if (level.Width != std::max(header.Width >> i, 1u) || level.Height != std::max(header.Height >> i, 1u))
+            throw std::runtime_error("Texture file level dimensions don't form a mip chain.");
+
+        GetAssetFileSection<std::byte>(data, level.Offset, level.Size, c_TextureFileType, "level data");
+
+        if (level.Size != (uint64_t)((level.Width + 3) / 4) * ((level.Height + 3) / 4) * blockSize)
+            throw std::runtime_error("Texture file level size doesn't match its dimensions.");
+    }
+}
+
+GLuint TextureFile::CreateTexture() const
+{
+    NV_PROFILE_FUNC;
+
+    if (levels_.empty())
+        throw std::runtime_error("Texture file has no levels.");
+
+    // BC1 and BC3 aren't part of core profile, although every desktop driver exposes them
+    if ((format_ == BlockFormat::BC1 || format_ == BlockFormat::BC3)
+        && (!GLAD_GL_EXT_texture_compression_s3tc || (isSRGB_ && !GLAD_GL_EXT_texture_sRGB)))
+        throw std::runtime_error("S3TC texture compression is not supported.");
+
+    const auto internalFormat = GetCompressedInternalFormat(format_, isSRGB_);
+    const auto id = GL::CreateTexture(TextureTarget::Texture2D);
+    GL::TextureStorage2D(id, (GLsizei)levels_.size(), internalFormat, (GLsizei)levels_[0].Width, (GLsizei)levels_[0].Height);
+
+    for (uint32_t level = 0; level < levels_.size(); level++)
+    {
+        const auto data = GetLevelData(level);
+        GL::CompressedTextureSubImage2D(
+            id,
+            (GLint)level,
+            (GLsizei)levels_[level].Width,
+            (GLsizei)levels_[level].Height,
+            internalFormat,
+            (GLsizei)data.size(),
+            data.data());
+    }
+
+    return id;
+}
+
+std::span<const std::byte> TextureFile::GetLevelData(uint32_t level) const
+{
+    if (level >= levels_.size())
+        throw std::runtime_error("Texture file level is out of range.");
+
+    return file_.GetData().subspan(levels_[level].Offset, levels_[level].Size);
+}
+
+InternalFormat Nova::GetCompressedInternalFormat(BlockFormat format, bool isSRGB) noexcept
+{
+    switch (format)
+    {
+    case BlockFormat::BC1:
+        return isSRGB ? InternalFormat::CompressedSRGBAlphaS3TCDXT1 : InternalFormat::CompressedRGBAS3TCDXT1;
+    case BlockFormat::BC3:
+        return isSRGB ? InternalFormat::CompressedSRGBAlphaS3TCDXT5 : InternalFormat::CompressedRGBAS3TCDXT5;
+    case BlockFormat::BC5:
+        return InternalFormat::CompressedRGRGTC2;
+    default:
+        return isSRGB ? InternalFormat::CompressedSRGBAlphaBPTC : InternalFormat::CompressedRGBABPTC;
+    }
+}
+
+void Nova::WriteTextureFile(
+    const std::filesystem::path& filepath,
+    std::span<const CompressedImage> levels,
+    BlockFormat format,
+    bool isSRGB)
+{
+    NV_PROFILE_FUNC;
+
+    // same rules as the reader checks, so that no file is written which couldn't be loaded
+    if (!levels.empty() && levels.size() > (size_t)std::bit_width(std::max(levels[0].Width, levels[0].Height)))
+        throw std::runtime_error("Texture has more levels than its mip chain.");
+
+    for (size_t i = 1; i < levels.size(); i++)
+    {
+        if (levels[i].Width != std::max(levels[0].Width >> i, 1u) || levels[i].Height != std::max(levels[0].Height >> i, 1u))
+            throw std::runtime_error("Texture levels don't form a mip chain.");
+    }
+
+    TextureFileHeader header {
+        .Magic = c_TextureFileMagic,
+        .Version = c_TextureFileVersion,
+        .Format = format,
+        .IsSRGB = isSRGB && format != BlockFormat::BC5,
+        .Width = levels.empty() ? 0 : levels[0].Width,
+        .Height = levels.empty() ? 0 : levels[0].Height,
+        .LevelCount = (uint32_t)levels.size(),
+        .Reserved = 0,
+        .LevelOffset = sizeof(header),
+    };
+
+    std::vector<TextureFileLevel> levelTable(levels.size());
+    auto offset = AlignAssetFileOffset(header.LevelOffset + levelTable.size() * sizeof(TextureFileLevel));
+    for (size_t i = 0; i < levels.size(); i++)
+    {
+        levelTable[i] = TextureFileLevel {
+            .Width = levels[i].Width,
+            .Height = levels[i].Height,
+            .Offset = offset,
+            .Size = levels[i].Blocks.size(),
+        };
+        offset = AlignAssetFileOffset(offset + levels[i].Blocks.size());
+    }
+
+    std::vector<std::byte> data(offset);
+    std::memcpy(data.data() + header.LevelOffset, levelTable.data(), levelTable.size() * sizeof(TextureFileLevel));
+    for (size_t i = 0; i < levels.size(); i++)
+        std::memcpy(data.data() + levelTable[i].Offset, levels[i].Blocks.data(), levels[i].Blocks.size());
+
+    WriteAssetFile(filepath, header, data);
+}
+
+void Nova::ConvertImageToTextureFile(
+    const std::filesystem::path& imageFilepath,
+    const std::filesystem::path& textureFilepath,
+    const TextureCompressionSettings& settings,
+    ThreadPool* threadPool)
+{
+    NV_PROFILE_FUNC;
+
+    // normal maps stored as BC5 hold vectors, not colors
+    const auto isSRGB = settings.IsSRGB && settings.Format != BlockFormat::BC5;
+    const auto levels = GenerateMipChain(LoadImageFile(imageFilepath), settings.Filter, isSRGB);
+
+    const auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<CompressedImage> compressedLevels;
+    compressedLevels.reserve(levels.size());
+
+    double megapixels = 0.0;
+    for (const auto& level : levels)
+    {
+        compressedLevels.push_back(CompressImage(level, settings.Format, settings.Quality, threadPool));
+        megapixels += (double)level.Width * level.Height / 1'000'000.0;
+    }
+
+    const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    // BC5 keeps only red and green
+    const auto psnr = ComputePSNR(
+        levels[0],
+        DecompressImage(compressedLevels[0], settings.Format),
+        settings.Format == BlockFormat::BC5 ? 2 : 4);
+
+    NV_LOG_INFO(
+        "Compressed {}x{} texture {} with {} levels to {} in {:.1f} ms, {:.1f} MP/s, base level PSNR {:.2f} dB.",
+        levels[0].Width,
+        levels[0].Height,
+        imageFilepath.string(),
+        levels.size(),
+        GetFormatName(settings.Format),
+        seconds * 1000.0,
+        seconds > 0.0 ? megapixels / seconds : 0.0,
+        psnr);
+
+    WriteTextureFile(textureFilepath, compressedLevels, settings.Format, isSRGB);
+}
@@ -96,13 +96,18 @@ void Application::Initialize(const ApplicationSettings &settings)
     NV_PROFILE_SET_ENABLED(true);
     NV_PROFILE_BEGIN_SESSION("./NovaProfileSession.json");
 
+    // application wide cache directory applies unless renderer settings name their own
+    auto rendererSettings = settings.RendererSettings;
+    if (!rendererSettings.ShaderCacheDirectory.has_value() && !settings.ShaderCacheDirectory.empty())
+        rendererSettings.ShaderCacheDirectory = settings.ShaderCacheDirectory;
+
     Dotnet::Initialize_(settings.DotnetSettings);
     Window::Initialize_(settings.WindowSettings);
     Renderer::_Initialize(
         Window::GetWidth(),
         Window::GetHeight(),
         Window::GetLoaderFunc_(),
-        settings.RendererSettings);
+        rendererSettings);
 
     s_IsInitialized = true;
 }
@@ -1,6 +1,8 @@
 #include <Nova/core/File.hpp>
 #include <Nova/core/Memory.hpp>
 #include <Nova/debug/Profile.hpp>
+#include <fstream>
+#include <stdexcept>
 
 using namespace Nova;
 
@@ -53,4 +55,38 @@ std::pair<std::unique_ptr<uint8_t[]>, size_t> File::ReadBinary(
 	const std::filesystem::path& filepath)
 {
 	return Read(filepath, "rbS");
+}
+
+void File::WriteAtomically(
+	const std::filesystem::path& filepath,
+	std::span<const std::byte> data)
+{
+	NV_PROFILE_FUNC;
+
+	auto temporaryFilepath = filepath;
+	temporaryFilepath += ".tmp";
+
+	// partially written temporary file is removed, so that failed writes don't leave anything behind
+	const auto fail = [&](const char* message)
+	{
+		std::error_code error;
+		std::filesystem::remove(temporaryFilepath, error);
+		throw std::runtime_error(message);
+	};
+
+	std::ofstream output(temporaryFilepath, std::ios::binary | std::ios::trunc);
+	if (!output.is_open())
+		fail("Failed to open file for writing.");
+
+	output.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)data.size());
+
+	// buffered data is only flushed by close, so errors like a full disk show up after it
+	output.close();
+	if (output.fail())
+		fail("Failed to write file.");
+
+	std::error_code error;
+	std::filesystem::rename(temporaryFilepath, filepath, error);
+	if (error)
+		fail("Failed to replace file.");
 }
\ No newline at end of file
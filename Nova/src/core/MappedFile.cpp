@@ -0,0 +1,120 @@
+#include <Nova/core/MappedFile.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <stdexcept>
+#include <utility>
+
+#ifdef NV_WINDOWS
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace Nova;
+
+MappedFile::MappedFile(const std::filesystem::path& filepath)
+{
+	NV_PROFILE_FUNC;
+
+#ifdef NV_WINDOWS
+	const auto file = CreateFileW(
+		filepath.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Failed to open file.");
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		throw std::runtime_error("Failed to read file size.");
+	}
+
+	size_ = (size_t)fileSize.QuadPart;
+	if (size_ == 0)
+	{
+		CloseHandle(file);
+		return;
+	}
+
+	// mapped view keeps mapping and file alive, so both handles can be closed right away
+	const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr)
+		throw std::runtime_error("Failed to map file.");
+
+	data_ = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	CloseHandle(mapping);
+	if (data_ == nullptr)
+		throw std::runtime_error("Failed to map file.");
+#else
+	const auto file = open(filepath.c_str(), O_RDONLY);
+	if (file < 0)
+		throw std::runtime_error("Failed to open file.");
+
+	struct stat fileStatus;
+	if (fstat(file, &fileStatus) != 0)
+	{
+		close(file);
+		throw std::runtime_error("Failed to read file size.");
+	}
+
+	size_ = (size_t)fileStatus.st_size;
+	if (size_ == 0)
+	{
+		close(file);
+		return;
+	}
+
+	const auto data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (data == MAP_FAILED)
+		throw std::runtime_error("Failed to map file.");
+
+	madvise(data, size_, MADV_WILLNEED);
+	data_ = static_cast<const std::byte*>(data);
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: data_(std::exchange(other.data_, nullptr)),
+	  size_(std::exchange(other.size_, 0)) { }
+
+MappedFile::~MappedFile() noexcept
+{
+	Unmap();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Unmap();
+		data_ = std::exchange(other.data_, nullptr);
+		size_ = std::exchange(other.size_, 0);
+	}
+
+	return *this;
+}
+
+void MappedFile::Unmap() noexcept
+{
+	if (data_ == nullptr)
+		return;
+
+#ifdef NV_WINDOWS
+	UnmapViewOfFile(data_);
+#else
+	munmap(const_cast<std::byte*>(data_), size_);
+#endif
+
+	data_ = nullptr;
+	size_ = 0;
+}
@@ -0,0 +1,120 @@
+#include <Nova/core/ThreadPool.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <algorithm>
+#include <utility>
+
+using namespace Nova;
+
+ThreadPool::ThreadPool()
+    : ThreadPool(std::max(std::thread::hardware_concurrency(), 1u) - 1)
+{
+}
+
+ThreadPool::ThreadPool(size_t workerCount)
+{
+    workers_.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; i++)
+        workers_.emplace_back([this](std::stop_token stopToken) { WorkerLoop(stopToken); });
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+    for (auto& worker : workers_)
+        worker.request_stop();
+
+    // workers are joined by their destructors, wait of each one is interrupted by its stop request
+    workers_.clear();
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& function)
+{
+    NV_PROFILE_FUNC;
+
+    if (count == 0)
+        return;
+
+    if (workers_.empty() || count == 1)
+    {
+        for (size_t i = 0; i < count; i++)
+            function(i);
+
+        return;
+    }
+
+    std::lock_guard submitLock(submitMutex_);
+
+    {
+        // a worker which woke up too late for the previous loop may still be looking at its counter
+        std::unique_lock lock(mutex_);
+        loopFinished_.wait(lock, [this] { return activeWorkers_ == 0; });
+
+        function_ = &function;
+        count_ = count;
+        exception_ = nullptr;
+        nextIndex_.store(0, std::memory_order_relaxed);
+        generation_++;
+    }
+    loopStarted_.notify_all();
+
+    RunIndices(function, count);
+
+    std::exception_ptr exception;
+    {
+        // every index has been taken by now, so the loop is finished once no worker is running
+        std::unique_lock lock(mutex_);
+        loopFinished_.wait(lock, [this] { return activeWorkers_ == 0; });
+
+        function_ = nullptr;
+        exception = std::exchange(exception_, nullptr);
+    }
+
+    if (exception)
+        std::rethrow_exception(exception);
+}
+
+void ThreadPool::WorkerLoop(std::stop_token stopToken)
+{
+    uint64_t seenGeneration = 0;
+
+    while (true)
+    {
+        const std::function<void(size_t)>* function;
+        size_t count;
+        {
+            std::unique_lock lock(mutex_);
+            if (!loopStarted_.wait(lock, stopToken, [&] { return generation_ != seenGeneration; }))
+                return;
+
+            seenGeneration = generation_;
+            function = function_;
+            count = count_;
+            activeWorkers_++;
+        }
+
+        if (function)
+            RunIndices(*function, count);
+
+        {
+            std::lock_guard lock(mutex_);
+            activeWorkers_--;
+        }
+        loopFinished_.notify_all();
+    }
+}
+
+void ThreadPool::RunIndices(const std::function<void(size_t)>& function, size_t count) noexcept
+{
+    for (auto i = nextIndex_.fetch_add(1, std::memory_order_relaxed); i < count; i = nextIndex_.fetch_add(1, std::memory_order_relaxed))
+    {
+        try
+        {
+            function(i);
+        }
+        catch (...)
+        {
+            std::lock_guard lock(mutex_);
+            if (!exception_)
+                exception_ = std::current_exception();
+        }
+    }
+}
@@ -0,0 +1,212 @@
+#include <Nova/core/TransformBatch.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/geometric.hpp>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+using namespace Nova;
+
+static void BuildTransformMatrix(const TransformBatch& batch, size_t i, glm::mat4& transform, glm::mat3& normalTransform) noexcept
+{
+    const auto rotation = glm::mat3_cast(glm::quat(batch.RotationW[i], batch.RotationX[i], batch.RotationY[i], batch.RotationZ[i]));
+    const glm::vec3 scale(batch.ScaleX[i], batch.ScaleY[i], batch.ScaleZ[i]);
+
+    transform[0] = glm::vec4(rotation[0] * scale.x, 0.0f);
+    transform[1] = glm::vec4(rotation[1] * scale.y, 0.0f);
+    transform[2] = glm::vec4(rotation[2] * scale.z, 0.0f);
+    transform[3] = glm::vec4(batch.PositionX[i], batch.PositionY[i], batch.PositionZ[i], 1.0f);
+
+    // inverse of negative uniform scale flips normals, so mirrored objects can't use rotation directly
+    if (scale.x > 0.0f && scale.x == scale.y && scale.y == scale.z)
+    {
+        normalTransform = rotation;
+    }
+    else
+    {
+        normalTransform[0] = rotation[0] / scale.x;
+        normalTransform[1] = rotation[1] / scale.y;
+        normalTransform[2] = rotation[2] / scale.z;
+    }
+}
+
+static glm::mat3 BuildNormalMatrix(const glm::mat4& transform) noexcept
+{
+    const glm::vec3 c0(transform[0]);
+    const glm::vec3 c1(transform[1]);
+    const glm::vec3 c2(transform[2]);
+
+    const glm::mat3 cofactors(
+        glm::cross(c1, c2),
+        glm::cross(c2, c0),
+        glm::cross(c0, c1));
+
+    return glm::dot(c0, cofactors[0]) < 0.0f ? -cofactors : cofactors;
+}
+
+void Nova::BuildTransformMatrices(
+    const TransformBatch& batch,
+    std::span<glm::mat4> transforms,
+    std::span<glm::mat3> normalTransforms) noexcept
+{
+    NV_PROFILE_FUNC;
+
+    const auto count = transforms.size();
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    const auto one = _mm256_set1_ps(1.0f);
+    const auto two = _mm256_set1_ps(2.0f);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        const auto x = _mm256_loadu_ps(&batch.RotationX[i]);
+        const auto y = _mm256_loadu_ps(&batch.RotationY[i]);
+        const auto z = _mm256_loadu_ps(&batch.RotationZ[i]);
+        const auto w = _mm256_loadu_ps(&batch.RotationW[i]);
+        const auto sx = _mm256_loadu_ps(&batch.ScaleX[i]);
+        const auto sy = _mm256_loadu_ps(&batch.ScaleY[i]);
+        const auto sz = _mm256_loadu_ps(&batch.ScaleZ[i]);
+
+        const auto xx = _mm256_mul_ps(x, x);
+        const auto yy = _mm256_mul_ps(y, y);
+        const auto zz = _mm256_mul_ps(z, z);
+        const auto xy = _mm256_mul_ps(x, y);
+        const auto xz = _mm256_mul_ps(x, z);
+        const auto yz = _mm256_mul_ps(y, z);
+        const auto wx = _mm256_mul_ps(w, x);
+        const auto wy = _mm256_mul_ps(w, y);
+        const auto wz = _mm256_mul_ps(w, z);
+
+        // rotation matrix of unit quaternion, stored column by column
+        const __m256 rotation[9] {
+            _mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one),
+            _mm256_mul_ps(two, _mm256_add_ps(xy, wz)),
+            _mm256_mul_ps(two, _mm256_sub_ps(xz, wy)),
+            _mm256_mul_ps(two, _mm256_sub_ps(xy, wz)),
+            _mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one),
+            _mm256_mul_ps(two, _mm256_add_ps(yz, wx)),
+            _mm256_mul_ps(two, _mm256_add_ps(xz, wy)),
+            _mm256_mul_ps(two, _mm256_sub_ps(yz, wx)),
+            _mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one),
+        };
+
+        // results are computed as structure of arrays and transposed into matrices on store
+        alignas(32) float model[9][8];
+        const __m256 scale[3] { sx, sy, sz };
+        for (int element = 0; element < 9; element++)
+            _mm256_store_ps(model[element], _mm256_mul_ps(rotation[element], scale[element / 3]));
+
+        // same as in scalar path, negative scale has to go through inverse, so that mirrored normals aren't flipped
+        const auto isUniform = _mm256_and_ps(
+            _mm256_cmp_ps(sx, _mm256_setzero_ps(), _CMP_GT_OQ),
+            _mm256_and_ps(
+                _mm256_cmp_ps(sx, sy, _CMP_EQ_OQ),
+                _mm256_cmp_ps(sy, sz, _CMP_EQ_OQ)));
+
+        alignas(32) float normal[9][8];
+        if (_mm256_movemask_ps(isUniform) == 0xFF)
+        {
+            for (int element = 0; element < 9; element++)
+                _mm256_store_ps(normal[element], rotation[element]);
+        }
+        else
+        {
+            const __m256 inverseScale[3] {
+                _mm256_div_ps(one, sx),
+                _mm256_div_ps(one, sy),
+                _mm256_div_ps(one, sz),
+            };
+
+            // lanes with uniform positive scale keep their rotation, so results match scalar path exactly
+            for (int element = 0; element < 9; element++)
+            {
+                _mm256_store_ps(
+                    normal[element],
+                    _mm256_blendv_ps(_mm256_mul_ps(rotation[element], inverseScale[element / 3]), rotation[element], isUniform));
+            }
+        }
+
+        for (int lane = 0; lane < 8; lane++)
+        {
+            auto& transform = transforms[i + lane];
+            transform[0] = glm::vec4(model[0][lane], model[1][lane], model[2][lane], 0.0f);
+            transform[1] = glm::vec4(model[3][lane], model[4][lane], model[5][lane], 0.0f);
+            transform[2] = glm::vec4(model[6][lane], model[7][lane], model[8][lane], 0.0f);
+            transform[3] = glm::vec4(batch.PositionX[i + lane], batch.PositionY[i + lane], batch.PositionZ[i + lane], 1.0f);
+
+            auto& normalTransform = normalTransforms[i + lane];
+            normalTransform[0] = glm::vec3(normal[0][lane], normal[1][lane], normal[2][lane]);
+            normalTransform[1] = glm::vec3(normal[3][lane], normal[4][lane], normal[5][lane]);
+            normalTransform[2] = glm::vec3(normal[6][lane], normal[7][lane], normal[8][lane]);
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+        BuildTransformMatrix(batch, i, transforms[i], normalTransforms[i]);
+}
+
+void Nova::BuildNormalMatrices(
+    std::span<const glm::mat4> transforms,
+    std::span<glm::mat3> normalTransforms) noexcept
+{
+    NV_PROFILE_FUNC;
+
+    const auto count = transforms.size();
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    // matrices are stored one after another, so each element of 8 consecutive matrices is gathered with stride of 16 floats
+    const auto matrixOffsets = _mm256_setr_epi32(0, 16, 32, 48, 64, 80, 96, 112);
+    const auto signMask = _mm256_set1_ps(-0.0f);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        const auto base = reinterpret_cast<const float*>(&transforms[i]);
+        const auto load = [&](int column, int row)
+        {
+            return _mm256_i32gather_ps(base, _mm256_add_epi32(matrixOffsets, _mm256_set1_epi32(column * 4 + row)), 4);
+        };
+
+        const __m256 c0[3] { load(0, 0), load(0, 1), load(0, 2) };
+        const __m256 c1[3] { load(1, 0), load(1, 1), load(1, 2) };
+        const __m256 c2[3] { load(2, 0), load(2, 1), load(2, 2) };
+
+        const auto cross = [](const __m256* a, const __m256* b, __m256* result)
+        {
+            result[0] = _mm256_fmsub_ps(a[1], b[2], _mm256_mul_ps(a[2], b[1]));
+            result[1] = _mm256_fmsub_ps(a[2], b[0], _mm256_mul_ps(a[0], b[2]));
+            result[2] = _mm256_fmsub_ps(a[0], b[1], _mm256_mul_ps(a[1], b[0]));
+        };
+
+        __m256 cofactors[9];
+        cross(c1, c2, &cofactors[0]);
+        cross(c2, c0, &cofactors[3]);
+        cross(c0, c1, &cofactors[6]);
+
+        const auto determinant = _mm256_fmadd_ps(
+            c0[0],
+            cofactors[0],
+            _mm256_fmadd_ps(c0[1], cofactors[1], _mm256_mul_ps(c0[2], cofactors[2])));
+        const auto determinantSign = _mm256_and_ps(determinant, signMask);
+
+        alignas(32) float normal[9][8];
+        for (int element = 0; element < 9; element++)
+            _mm256_store_ps(normal[element], _mm256_xor_ps(cofactors[element], determinantSign));
+
+        for (int lane = 0; lane < 8; lane++)
+        {
+            auto& normalTransform = normalTransforms[i + lane];
+            normalTransform[0] = glm::vec3(normal[0][lane], normal[1][lane], normal[2][lane]);
+            normalTransform[1] = glm::vec3(normal[3][lane], normal[4][lane], normal[5][lane]);
+            normalTransform[2] = glm::vec3(normal[6][lane], normal[7][lane], normal[8][lane]);
+        }
+    }
+#endif
+
+    for (; i < count; i++)
+        normalTransforms[i] = BuildNormalMatrix(transforms[i]);
+}
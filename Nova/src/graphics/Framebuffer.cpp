@@ -263,4 +263,14 @@ void Framebuffer::ClearAttachment(GLint stencil)
 void Framebuffer::ClearAttachment(GLfloat depth, GLint stencil)
 {
 	glClearNamedFramebufferfi(id_, GL_DEPTH_STENCIL, 0, depth, stencil);
+}
+
+void Framebuffer::Invalidate(std::span<const Attachment> attachments) noexcept
+{
+	NV_PROFILE_FUNC;
+
+	glInvalidateNamedFramebufferData(
+		id_,
+		(GLsizei)attachments.size(),
+		reinterpret_cast<const GLenum*>(attachments.data()));
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include <Nova/graphics/Frustum.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <glm/geometric.hpp>
+#include <bit>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define NV_FRUSTUM_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NV_FRUSTUM_SIMD_WIDTH 4
+#else
+#define NV_FRUSTUM_SIMD_WIDTH 1
+#endif
+
+using namespace Nova;
+
+Frustum::Frustum(const glm::mat4& viewProjection) noexcept
+{
+    // Gribb-Hartmann extraction, glm matrices are column-major so rows have to be gathered manually
+    const auto row = [&](int index)
+    {
+        return glm::vec4(
+            viewProjection[0][index],
+            viewProjection[1][index],
+            viewProjection[2][index],
+            viewProjection[3][index]);
+    };
+
+    const auto x = row(0);
+    const auto y = row(1);
+    const auto z = row(2);
+    const auto w = row(3);
+
+    planes_ = {
+        w + x, // left
+        w - x, // right
+        w + y, // bottom
+        w - y, // top
+        w + z, // near
+        w - z, // far
+    };
+
+    // normalized planes give true signed distances, which can be compared against sphere radius
+    for (auto& plane : planes_)
+    {
+        const auto length = glm::length(glm::vec3(plane));
+        if (length > 0.0f)
+            plane /= length;
+    }
+}
+
+bool Frustum::Intersects(const BoundingSphere& sphere) const noexcept
+{
+    for (const auto& plane : planes_)
+    {
+        if (glm::dot(glm::vec3(plane), sphere.Center) + plane.w < -sphere.Radius)
+            return false;
+    }
+
+    return true;
+}
+
+static void AppendVisibleIndices(uint32_t mask, uint32_t baseIndex, std::vector<uint32_t>& visibleIndices)
+{
+    while (mask != 0)
+    {
+        visibleIndices.push_back(baseIndex + (uint32_t)std::countr_zero(mask));
+        mask &= mask - 1;
+    }
+}
+
+size_t Frustum::CullSpheres(const BoundingSphereBatch& spheres, std::vector<uint32_t>& visibleIndices) const
+{
+    NV_PROFILE_FUNC;
+
+    const auto count = spheres.Radius.size();
+    const auto initialSize = visibleIndices.size();
+    size_t i = 0;
+
+#if NV_FRUSTUM_SIMD_WIDTH == 8
+    for (; i + 8 <= count; i += 8)
+    {
+        const auto cx = _mm256_loadu_ps(&spheres.CenterX[i]);
+        const auto cy = _mm256_loadu_ps(&spheres.CenterY[i]);
+        const auto cz = _mm256_loadu_ps(&spheres.CenterZ[i]);
+        const auto negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.Radius[i]));
+
+        auto inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const auto& plane : planes_)
+        {
+            auto distance = _mm256_add_ps(
+                _mm256_mul_ps(cx, _mm256_set1_ps(plane.x)),
+                _mm256_set1_ps(plane.w));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(cy, _mm256_set1_ps(plane.y)));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(cz, _mm256_set1_ps(plane.z)));
+
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+
+        AppendVisibleIndices((uint32_t)_mm256_movemask_ps(inside), (uint32_t)i, visibleIndices);
+    }
+#elif NV_FRUSTUM_SIMD_WIDTH == 4
+    for (; i + 4 <= count; i += 4)
+    {
+        const auto cx = _mm_loadu_ps(&spheres.CenterX[i]);
+        const auto cy = _mm_loadu_ps(&spheres.CenterY[i]);
+        const auto cz = _mm_loadu_ps(&spheres.CenterZ[i]);
+        const auto negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.Radius[i]));
+
+        auto inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const auto& plane : planes_)
+        {
+            auto distance = _mm_add_ps(
+                _mm_mul_ps(cx, _mm_set1_ps(plane.x)),
+                _mm_set1_ps(plane.w));
+            distance = _mm_add_ps(distance, _mm_mul_ps(cy, _mm_set1_ps(plane.y)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(cz, _mm_set1_ps(plane.z)));
+
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+
+        AppendVisibleIndices((uint32_t)_mm_movemask_ps(inside), (uint32_t)i, visibleIndices);
+    }
+#endif
+
+    // remaining spheres which don't fill a whole vector
+    for (; i < count; i++)
+    {
+        const BoundingSphere sphere {
+            .Center = glm::vec3(spheres.CenterX[i], spheres.CenterY[i], spheres.CenterZ[i]),
+            .Radius = spheres.Radius[i],
+        };
+
+        if (Intersects(sphere))
+            visibleIndices.push_back((uint32_t)i);
+    }
+
+    return visibleIndices.size() - initialSize;
+}
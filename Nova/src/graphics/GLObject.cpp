@@ -21,17 +21,20 @@ static TReturn GetSizeChecked(const TContainer &container) noexcept
 
 void _GLObjectBase::RegisterObject(GLenum objType, GLuint id) noexcept
 {
+	std::lock_guard lock(s_ObjectIDsMutex);
 	s_ObjectIDs[objType].emplace_back(id);
 }
 
 void _GLObjectBase::UnregisterObject(GLenum objType, GLuint id) noexcept
 {
+	std::lock_guard lock(s_ObjectIDsMutex);
 	auto &objects = s_ObjectIDs[objType];
 	objects.erase(std::remove(objects.begin(), objects.end(), id));
 }
 
 void _GLObjectBase::DeleteAll() noexcept
 {
+	std::lock_guard lock(s_ObjectIDsMutex);
 	for (const auto &[objType, objectsList] : s_ObjectIDs)
 	{
 		// We can't really do anything about overflows at this point
@@ -0,0 +1,30 @@
+#include <Nova/graphics/InstanceData.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+
+using namespace Nova;
+
+CompactInstanceData Nova::PackCompactInstanceData(const InstanceData& instance) noexcept
+{
+    const glm::vec3 c0(instance.Transform[0]);
+    const glm::vec3 c1(instance.Transform[1]);
+    const glm::vec3 c2(instance.Transform[2]);
+
+    // orthogonal columns of equal length mean rotation combined with uniform scale
+    const auto lengthSquared = glm::dot(c0, c0);
+    const auto tolerance = lengthSquared * 1e-4f;
+    const auto isUniformScale =
+        glm::abs(glm::dot(c1, c1) - lengthSquared) <= tolerance &&
+        glm::abs(glm::dot(c2, c2) - lengthSquared) <= tolerance &&
+        glm::abs(glm::dot(c0, c1)) <= tolerance &&
+        glm::abs(glm::dot(c1, c2)) <= tolerance &&
+        glm::abs(glm::dot(c2, c0)) <= tolerance;
+
+    const auto rows = glm::transpose(instance.Transform);
+
+    return CompactInstanceData {
+        .TransformRows = { rows[0], rows[1], rows[2] },
+        .PackedData = (instance.MaterialIndex & (c_CompactMaterialIndexMask | c_LODFadeMask)) |
+            (isUniformScale ? c_CompactUniformScaleBit : 0u),
+    };
+}
@@ -0,0 +1,304 @@
+#include <Nova/graphics/MeshAllocator.hpp>
+#include <Nova/graphics/opengl/GL.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+using namespace Nova;
+
+MeshAllocator::MeshAllocator(GLsizei vertexStride, GLuint initialVertexCount, GLuint initialIndexCount)
+{
+    vertices_.DebugName = "MeshVertexBuffer";
+    vertices_.ElementSize = vertexStride;
+    indices_.DebugName = "MeshIndexBuffer";
+    indices_.ElementSize = sizeof(GLuint);
+
+    for (auto [pool, capacity] : { std::pair(&vertices_, initialVertexCount), std::pair(&indices_, initialIndexCount) })
+    {
+        pool->Capacity = std::max(capacity, 1u);
+        pool->Data = Buffer((GLsizeiptr)pool->Capacity * pool->ElementSize);
+        pool->Data.SetDebugName(pool->DebugName);
+        pool->AddFreeRange(0, pool->Capacity);
+    }
+}
+
+MeshHandle MeshAllocator::Allocate(GLuint vertexCount, GLuint indexCount)
+{
+    NV_PROFILE_FUNC;
+
+    const auto vertexCapacity = vertices_.Capacity;
+    const auto indexCapacity = indices_.Capacity;
+
+    const auto baseVertex = vertices_.Allocate(vertexCount);
+    GLuint baseIndex = 0;
+    try
+    {
+        baseIndex = indices_.Allocate(indexCount);
+    }
+    catch (...)
+    {
+        // vertex buffer may have already grown, users still have to rebind it
+        vertices_.AddFreeRange(baseVertex, vertexCount);
+        if (vertices_.Capacity != vertexCapacity)
+            version_++;
+        throw;
+    }
+
+    if (vertices_.Capacity != vertexCapacity || indices_.Capacity != indexCapacity)
+        version_++;
+
+    const Mesh mesh {
+        .Range = MeshRange {
+            .BaseVertex = baseVertex,
+            .VertexCount = vertexCount,
+            .BaseIndex = baseIndex,
+            .IndexCount = indexCount,
+        },
+        .IsLive = true,
+    };
+
+    if (!freeHandles_.empty())
+    {
+        const auto index = freeHandles_.back();
+        freeHandles_.pop_back();
+        meshes_[index] = mesh;
+        return MeshHandle(index);
+    }
+
+    meshes_.push_back(mesh);
+    return MeshHandle((uint32_t)meshes_.size() - 1);
+}
+
+MeshHandle MeshAllocator::Allocate(const void* vertices, GLuint vertexCount, std::span<const GLuint> indices)
+{
+    NV_PROFILE_FUNC;
+
+    const auto handle = Allocate(vertexCount, (GLuint)indices.size());
+    const auto& range = GetRange(handle);
+
+    // buffers have immutable storage without client writes, so data goes through a temporary buffer
+    const auto upload = [](const Pool& pool, const void* data, GLuint offset, GLuint count)
+    {
+        if (count == 0)
+            return;
+
+        const auto size = (GLsizeiptr)count * pool.ElementSize;
+        Buffer uploadBuffer(size, false, false, data);
+        GL::CopyNamedBufferSubData(
+            (GLuint)uploadBuffer.GetID(),
+            (GLuint)pool.Data.GetID(),
+            0,
+            (GLintptr)offset * pool.ElementSize,
+            size);
+        uploadBuffer.Delete();
+    };
+
+    upload(vertices_, vertices, range.BaseVertex, range.VertexCount);
+    upload(indices_, indices.data(), range.BaseIndex, range.IndexCount);
+
+    return handle;
+}
+
+void MeshAllocator::Free(MeshHandle handle)
+{
+    if ((uint32_t)handle >= meshes_.size())
+        throw std::runtime_error("Invalid mesh handle.");
+
+    auto& mesh = meshes_[(uint32_t)handle];
+    if (!mesh.IsLive)
+        throw std::runtime_error("Mesh was already freed.");
+
+    vertices_.AddFreeRange(mesh.Range.BaseVertex, mesh.Range.VertexCount);
+    indices_.AddFreeRange(mesh.Range.BaseIndex, mesh.Range.IndexCount);
+    mesh.IsLive = false;
+    freeHandles_.push_back((uint32_t)handle);
+}
+
+bool MeshAllocator::Fits(GLuint vertexCount, GLuint indexCount) const noexcept
+{
+    return vertices_.Fits(vertexCount) && indices_.Fits(indexCount);
+}
+
+bool MeshAllocator::IsLive(MeshHandle handle) const noexcept
+{
+    return (uint32_t)handle < meshes_.size() && meshes_[(uint32_t)handle].IsLive;
+}
+
+const MeshRange& MeshAllocator::GetRange(MeshHandle handle) const
+{
+    if (!IsLive(handle))
+        throw std::runtime_error("Mesh was freed or its handle is invalid.");
+
+    return meshes_[(uint32_t)handle].Range;
+}
+
+void MeshAllocator::Defragment()
+{
+    NV_PROFILE_FUNC;
+
+    CompactPool(vertices_, &MeshRange::BaseVertex, &MeshRange::VertexCount);
+    CompactPool(indices_, &MeshRange::BaseIndex, &MeshRange::IndexCount);
+    version_++;
+}
+
+float MeshAllocator::GetFragmentation() const noexcept
+{
+    return std::max(
+        (float)vertices_.GetGapCount() / (float)std::max(vertices_.Capacity, 1u),
+        (float)indices_.GetGapCount() / (float)std::max(indices_.Capacity, 1u));
+}
+
+void MeshAllocator::Delete() noexcept
+{
+    vertices_.Data.Delete();
+    indices_.Data.Delete();
+}
+
+void MeshAllocator::CompactPool(Pool& pool, GLuint MeshRange::* offset, GLuint MeshRange::* count)
+{
+    std::vector<MeshRange*> ranges;
+    for (auto& mesh : meshes_)
+    {
+        if (mesh.IsLive && mesh.Range.*count != 0)
+            ranges.push_back(&mesh.Range);
+    }
+
+    // meshes keep their relative order, so copies read the old buffer sequentially
+    std::sort(
+        ranges.begin(),
+        ranges.end(),
+        [&](const MeshRange* a, const MeshRange* b) { return a->*offset < b->*offset; });
+
+    Buffer newData((GLsizeiptr)pool.Capacity * pool.ElementSize);
+    newData.SetDebugName(pool.DebugName);
+
+    GLuint packedOffset = 0;
+    for (const auto range : ranges)
+    {
+        GL::CopyNamedBufferSubData(
+            (GLuint)pool.Data.GetID(),
+            (GLuint)newData.GetID(),
+            (GLintptr)(range->*offset) * pool.ElementSize,
+            (GLintptr)packedOffset * pool.ElementSize,
+            (GLsizeiptr)(range->*count) * pool.ElementSize);
+
+        range->*offset = packedOffset;
+        packedOffset += range->*count;
+    }
+
+    pool.Data.Delete();
+    pool.Data = std::move(newData);
+
+    pool.FreeByOffset.clear();
+    pool.FreeBySize.clear();
+    pool.AddFreeRange(packedOffset, pool.Capacity - packedOffset);
+}
+
+GLuint MeshAllocator::Pool::Allocate(GLuint count)
+{
+    if (count == 0)
+        return 0;
+
+    if (!Fits(count))
+        Grow(count);
+
+    const auto [size, offset] = *FreeBySize.lower_bound({ count, 0u });
+    RemoveFreeRange(FreeByOffset.find(offset));
+    if (size > count)
+        AddFreeRange(offset + count, size - count);
+
+    return offset;
+}
+
+bool MeshAllocator::Pool::Fits(GLuint count) const noexcept
+{
+    return count == 0 || FreeBySize.lower_bound({ count, 0u }) != FreeBySize.end();
+}
+
+void MeshAllocator::Pool::Grow(GLuint count)
+{
+    NV_PROFILE_FUNC;
+
+    // free range at the end of buffer is extended, so it only has to grow by what that range lacks
+    GLuint tailSize = 0;
+    if (!FreeByOffset.empty())
+    {
+        const auto& [lastOffset, lastSize] = *FreeByOffset.rbegin();
+        if (lastOffset + lastSize == Capacity)
+            tailSize = lastSize;
+    }
+
+    const auto requiredCapacity = (uint64_t)Capacity + count - tailSize;
+    auto newCapacity = std::max((uint64_t)Capacity, (uint64_t)1);
+    while (newCapacity < requiredCapacity)
+        newCapacity *= 2;
+
+    if (newCapacity > std::numeric_limits<GLuint>::max() ||
+        newCapacity * ElementSize > (uint64_t)std::numeric_limits<GLsizeiptr>::max())
+        throw std::runtime_error("Mesh buffer exceeds maximum size.");
+
+    Buffer newData((GLsizeiptr)newCapacity * ElementSize);
+    newData.SetDebugName(DebugName);
+    GL::CopyNamedBufferSubData(
+        (GLuint)Data.GetID(),
+        (GLuint)newData.GetID(),
+        0,
+        0,
+        (GLsizeiptr)Capacity * ElementSize);
+
+    Data.Delete();
+    Data = std::move(newData);
+
+    const auto oldCapacity = Capacity;
+    Capacity = (GLuint)newCapacity;
+    AddFreeRange(oldCapacity, Capacity - oldCapacity);
+}
+
+void MeshAllocator::Pool::AddFreeRange(GLuint offset, GLuint count)
+{
+    if (count == 0)
+        return;
+
+    const auto next = FreeByOffset.lower_bound(offset);
+    if (next != FreeByOffset.end() && next->first == offset + count)
+    {
+        count += next->second;
+        RemoveFreeRange(next);
+    }
+
+    const auto after = FreeByOffset.lower_bound(offset);
+    if (after != FreeByOffset.begin())
+    {
+        const auto previous = std::prev(after);
+        if (previous->first + previous->second == offset)
+        {
+            offset = previous->first;
+            count += previous->second;
+            RemoveFreeRange(previous);
+        }
+    }
+
+    FreeByOffset.emplace(offset, count);
+    FreeBySize.emplace(count, offset);
+}
+
+void MeshAllocator::Pool::RemoveFreeRange(std::map<GLuint, GLuint>::iterator range)
+{
+    FreeBySize.erase({ range->second, range->first });
+    FreeByOffset.erase(range);
+}
+
+GLuint MeshAllocator::Pool::GetGapCount() const noexcept
+{
+    GLuint freeCount = 0;
+    for (const auto& [offset, size] : FreeByOffset)
+    {
+        // free space at the end of buffer isn't a gap, new meshes use it without any waste
+        if (offset + size != Capacity)
+            freeCount += size;
+    }
+
+    return freeCount;
+}
@@ -0,0 +1,455 @@
+#include <Nova/graphics/OcclusionCuller.hpp>
+#include <Nova/core/ThreadPool.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <glm/common.hpp>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define NV_OCCLUSION_SIMD_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define NV_OCCLUSION_SIMD_WIDTH 4
+#else
+#define NV_OCCLUSION_SIMD_WIDTH 1
+#endif
+
+using namespace Nova;
+
+namespace
+{
+    // minimal wrapper of float vector and its comparison masks, so that rasterization and tests are written only once
+#if NV_OCCLUSION_SIMD_WIDTH == 8
+    struct FloatLanes
+    {
+        static constexpr int32_t Count = 8;
+
+        __m256 Value;
+
+        static FloatLanes Broadcast(float value) noexcept { return { _mm256_set1_ps(value) }; }
+        static FloatLanes Ramp() noexcept { return { _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f) }; }
+        static FloatLanes Load(const float* data) noexcept { return { _mm256_loadu_ps(data) }; }
+        void Store(float* data) const noexcept { _mm256_storeu_ps(data, Value); }
+
+        friend FloatLanes operator+(FloatLanes a, FloatLanes b) noexcept { return { _mm256_add_ps(a.Value, b.Value) }; }
+        friend FloatLanes operator*(FloatLanes a, FloatLanes b) noexcept { return { _mm256_mul_ps(a.Value, b.Value) }; }
+        friend FloatLanes operator&(FloatLanes a, FloatLanes b) noexcept { return { _mm256_and_ps(a.Value, b.Value) }; }
+        friend FloatLanes Min(FloatLanes a, FloatLanes b) noexcept { return { _mm256_min_ps(a.Value, b.Value) }; }
+        friend FloatLanes Max(FloatLanes a, FloatLanes b) noexcept { return { _mm256_max_ps(a.Value, b.Value) }; }
+        friend FloatLanes GreaterEqual(FloatLanes a, FloatLanes b) noexcept { return { _mm256_cmp_ps(a.Value, b.Value, _CMP_GE_OQ) }; }
+        friend FloatLanes Select(FloatLanes mask, FloatLanes a, FloatLanes b) noexcept { return { _mm256_blendv_ps(b.Value, a.Value, mask.Value) }; }
+        friend uint32_t MoveMask(FloatLanes mask) noexcept { return (uint32_t)_mm256_movemask_ps(mask.Value); }
+
+        friend float HorizontalMax(FloatLanes a) noexcept
+        {
+            const auto halves = _mm_max_ps(_mm256_castps256_ps128(a.Value), _mm256_extractf128_ps(a.Value, 1));
+            const auto pairs = _mm_max_ps(halves, _mm_movehl_ps(halves, halves));
+            return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+        }
+    };
+#elif NV_OCCLUSION_SIMD_WIDTH == 4
+    struct FloatLanes
+    {
+        static constexpr int32_t Count = 4;
+
+        __m128 Value;
+
+        static FloatLanes Broadcast(float value) noexcept { return { _mm_set1_ps(value) }; }
+        static FloatLanes Ramp() noexcept { return { _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f) }; }
+        static FloatLanes Load(const float* data) noexcept { return { _mm_loadu_ps(data) }; }
+        void Store(float* data) const noexcept { _mm_storeu_ps(data, Value); }
+
+        friend FloatLanes operator+(FloatLanes a, FloatLanes b) noexcept { return { _mm_add_ps(a.Value, b.Value) }; }
+        friend FloatLanes operator*(FloatLanes a, FloatLanes b) noexcept { return { _mm_mul_ps(a.Value, b.Value) }; }
+        friend FloatLanes operator&(FloatLanes a, FloatLanes b) noexcept { return { _mm_and_ps(a.Value, b.Value) }; }
+        friend FloatLanes Min(FloatLanes a, FloatLanes b) noexcept { return { _mm_min_ps(a.Value, b.Value) }; }
+        friend FloatLanes Max(FloatLanes a, FloatLanes b) noexcept { return { _mm_max_ps(a.Value, b.Value) }; }
+        friend FloatLanes GreaterEqual(FloatLanes a, FloatLanes b) noexcept { return { _mm_cmpge_ps(a.Value, b.Value) }; }
+        friend uint32_t MoveMask(FloatLanes mask) noexcept { return (uint32_t)_mm_movemask_ps(mask.Value); }
+
+        // SSE2 has no blend, so lanes are combined bitwise
+        friend FloatLanes Select(FloatLanes mask, FloatLanes a, FloatLanes b) noexcept
+        {
+            return { _mm_or_ps(_mm_and_ps(mask.Value, a.Value), _mm_andnot_ps(mask.Value, b.Value)) };
+        }
+
+        friend float HorizontalMax(FloatLanes a) noexcept
+        {
+            const auto pairs = _mm_max_ps(a.Value, _mm_movehl_ps(a.Value, a.Value));
+            return _mm_cvtss_f32(_mm_max_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+        }
+    };
+#else
+    struct FloatLanes
+    {
+        static constexpr int32_t Count = 1;
+
+        float Value;
+
+        static FloatLanes Broadcast(float value) noexcept { return { value }; }
+        static FloatLanes Ramp() noexcept { return { 0.0f }; }
+        static FloatLanes Load(const float* data) noexcept { return { *data }; }
+        void Store(float* data) const noexcept { *data = Value; }
+
+        friend FloatLanes operator+(FloatLanes a, FloatLanes b) noexcept { return { a.Value + b.Value }; }
+        friend FloatLanes operator*(FloatLanes a, FloatLanes b) noexcept { return { a.Value * b.Value }; }
+        friend FloatLanes Min(FloatLanes a, FloatLanes b) noexcept { return { std::min(a.Value, b.Value) }; }
+        friend FloatLanes Max(FloatLanes a, FloatLanes b) noexcept { return { std::max(a.Value, b.Value) }; }
+        friend float HorizontalMax(FloatLanes a) noexcept { return a.Value; }
+
+        // masks keep all bits set or clear like SIMD comparisons do
+        friend FloatLanes operator&(FloatLanes a, FloatLanes b) noexcept
+        {
+            return { std::bit_cast<float>(std::bit_cast<uint32_t>(a.Value) & std::bit_cast<uint32_t>(b.Value)) };
+        }
+
+        friend FloatLanes GreaterEqual(FloatLanes a, FloatLanes b) noexcept
+        {
+            return { std::bit_cast<float>(a.Value >= b.Value ? ~0u : 0u) };
+        }
+
+        friend FloatLanes Select(FloatLanes mask, FloatLanes a, FloatLanes b) noexcept
+        {
+            return std::bit_cast<uint32_t>(mask.Value) != 0 ? a : b;
+        }
+
+        friend uint32_t MoveMask(FloatLanes mask) noexcept { return std::bit_cast<uint32_t>(mask.Value) >> 31; }
+    };
+#endif
+
+    static_assert(OcclusionCuller::TileWidth % FloatLanes::Count == 0);
+}
+
+// geometry between the camera and the near plane is clipped away on GPU, so it can't hide anything
+static bool IsInFrontOfNearPlane(const glm::vec4& clipPosition) noexcept
+{
+    return clipPosition.w <= 0.0f || clipPosition.z < -clipPosition.w;
+}
+
+OcclusionCuller::OcclusionCuller(int32_t width, int32_t height)
+    : tileCountX_((std::max(width, 1) + TileWidth - 1) / TileWidth),
+      tileCountY_((std::max(height, 1) + TileHeight - 1) / TileHeight)
+{
+    width_ = tileCountX_ * TileWidth;
+    height_ = tileCountY_ * TileHeight;
+
+    depth_.assign((size_t)width_ * height_, 1.0f);
+    tileMaxDepth_.assign((size_t)tileCountX_ * tileCountY_, 1.0f);
+    tileTriangles_.resize(tileMaxDepth_.size());
+}
+
+void OcclusionCuller::Clear() noexcept
+{
+    occluders_.clear();
+}
+
+void OcclusionCuller::AddOccluder(
+    std::span<const glm::vec3> vertices,
+    std::span<const uint32_t> indices,
+    const glm::mat4& transform)
+{
+    occluders_.emplace_back(
+        Occluder {
+            .Vertices = vertices,
+            .Indices = indices,
+            .Transform = transform,
+        });
+}
+
+void OcclusionCuller::SetupTriangles(const glm::mat4& viewProjection)
+{
+    NV_PROFILE_FUNC;
+
+    triangles_.clear();
+    for (auto& triangles : tileTriangles_)
+        triangles.clear();
+
+    const glm::vec2 screenScale(width_ * 0.5f, height_ * 0.5f);
+
+    for (const auto& occluder : occluders_)
+    {
+        const auto transform = viewProjection * occluder.Transform;
+
+        clipPositions_.resize(occluder.Vertices.size());
+        for (size_t i = 0; i < occluder.Vertices.size(); i++)
+            clipPositions_[i] = transform * glm::vec4(occluder.Vertices[i], 1.0f);
+
+        for (size_t i = 0; i + 2 < occluder.Indices.size(); i += 3)
+        {
+            const glm::vec4 clip[3] {
+                clipPositions_[occluder.Indices[i]],
+                clipPositions_[occluder.Indices[i + 1]],
+                clipPositions_[occluder.Indices[i + 2]],
+            };
+
+            if (IsInFrontOfNearPlane(clip[0]) || IsInFrontOfNearPlane(clip[1]) || IsInFrontOfNearPlane(clip[2]))
+                continue;
+
+            glm::vec3 screen[3];
+            for (int vertex = 0; vertex < 3; vertex++)
+            {
+                const auto ndc = glm::vec3(clip[vertex]) / clip[vertex].w;
+                screen[vertex] = glm::vec3((glm::vec2(ndc) + 1.0f) * screenScale, ndc.z * 0.5f + 0.5f);
+            }
+
+            auto area = (screen[1].x - screen[0].x) * (screen[2].y - screen[0].y)
+                - (screen[2].x - screen[0].x) * (screen[1].y - screen[0].y);
+            if (std::abs(area) < 1e-6f)
+                continue;
+
+            // clockwise triangles are flipped, so that inside of every triangle has non-negative edge functions
+            if (area < 0.0f)
+            {
+                std::swap(screen[1], screen[2]);
+                area = -area;
+            }
+
+            // pixels whose centers may lie inside of the triangle, clamped before conversion to keep far off-screen
+            // vertices in range of integers
+            const auto minCenter = glm::min(glm::min(glm::vec2(screen[0]), glm::vec2(screen[1])), glm::vec2(screen[2])) - 0.5f;
+            const auto maxCenter = glm::max(glm::max(glm::vec2(screen[0]), glm::vec2(screen[1])), glm::vec2(screen[2])) - 0.5f;
+            if (maxCenter.x < 0.0f || maxCenter.y < 0.0f || minCenter.x > (float)(width_ - 1) || minCenter.y > (float)(height_ - 1))
+                continue;
+
+            ScreenTriangle triangle;
+            triangle.MinX = (int32_t)std::ceil(std::max(minCenter.x, 0.0f));
+            triangle.MinY = (int32_t)std::ceil(std::max(minCenter.y, 0.0f));
+            triangle.MaxX = (int32_t)std::floor(std::min(maxCenter.x, (float)(width_ - 1)));
+            triangle.MaxY = (int32_t)std::floor(std::min(maxCenter.y, (float)(height_ - 1)));
+            if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY)
+                continue;
+
+            // edges are moved inwards by half of pixel's extent along their normal, so that edge functions at pixel centers
+            // stay non-negative only for pixels the triangle covers entirely, partially covered pixels may show objects behind
+            for (int edge = 0; edge < 3; edge++)
+            {
+                const auto& a = screen[edge];
+                const auto& b = screen[(edge + 1) % 3];
+                const glm::vec2 normal(a.y - b.y, b.x - a.x);
+                triangle.Edges[edge] = glm::vec3(normal, a.x * b.y - a.y * b.x - 0.5f * (std::abs(normal.x) + std::abs(normal.y)));
+            }
+
+            // window space depth is affine in screen space, its plane goes through all three vertices and is moved
+            // to the farthest depth the triangle has within a pixel
+            const auto d1 = screen[1] - screen[0];
+            const auto d2 = screen[2] - screen[0];
+            const auto depthDX = (d1.z * d2.y - d2.z * d1.y) / area;
+            const auto depthDY = (d2.z * d1.x - d1.z * d2.x) / area;
+            triangle.DepthPlane = glm::vec3(
+                depthDX,
+                depthDY,
+                screen[0].z - depthDX * screen[0].x - depthDY * screen[0].y + 0.5f * (std::abs(depthDX) + std::abs(depthDY)));
+
+            const auto triangleIndex = (uint32_t)triangles_.size();
+            triangles_.push_back(triangle);
+
+            for (auto tileY = triangle.MinY / TileHeight; tileY <= triangle.MaxY / TileHeight; tileY++)
+            {
+                for (auto tileX = triangle.MinX / TileWidth; tileX <= triangle.MaxX / TileWidth; tileX++)
+                    tileTriangles_[(size_t)tileY * tileCountX_ + tileX].push_back(triangleIndex);
+            }
+        }
+    }
+}
+
+void OcclusionCuller::Rasterize(const glm::mat4& viewProjection, ThreadPool* threadPool)
+{
+    NV_PROFILE_FUNC;
+
+    viewProjection_ = viewProjection;
+    SetupTriangles(viewProjection);
+
+    const auto tileCount = tileMaxDepth_.size();
+    if (threadPool)
+    {
+        threadPool->ParallelFor(tileCount, [this](size_t tileIndex) { RasterizeTile(tileIndex); });
+    }
+    else
+    {
+        for (size_t tileIndex = 0; tileIndex < tileCount; tileIndex++)
+            RasterizeTile(tileIndex);
+    }
+
+    NV_PROFILE_COUNTER("OcclusionCuller::Triangles", (float)triangles_.size());
+}
+
+void OcclusionCuller::RasterizeTile(size_t tileIndex) noexcept
+{
+    const auto tileMinX = (int32_t)(tileIndex % tileCountX_) * TileWidth;
+    const auto tileMinY = (int32_t)(tileIndex / tileCountX_) * TileHeight;
+    const auto tileMaxX = tileMinX + TileWidth - 1;
+    const auto tileMaxY = tileMinY + TileHeight - 1;
+
+    for (auto y = tileMinY; y <= tileMaxY; y++)
+        std::fill_n(&depth_[(size_t)y * width_ + tileMinX], TileWidth, 1.0f);
+
+    const auto zero = FloatLanes::Broadcast(0.0f);
+    const auto laneCenters = FloatLanes::Ramp() + FloatLanes::Broadcast(0.5f);
+
+    for (const auto triangleIndex : tileTriangles_[tileIndex])
+    {
+        const auto& triangle = triangles_[triangleIndex];
+        const auto minY = std::max(triangle.MinY, tileMinY);
+        const auto maxY = std::min(triangle.MaxY, tileMaxY);
+        const auto maxX = std::min(triangle.MaxX, tileMaxX);
+
+        // blocks start at multiples of lane count, pixels of a block outside of bounds fail edge tests anyway
+        auto minX = std::max(triangle.MinX, tileMinX);
+        minX -= minX % FloatLanes::Count;
+
+        const FloatLanes edgeDX[3] {
+            FloatLanes::Broadcast(triangle.Edges[0].x),
+            FloatLanes::Broadcast(triangle.Edges[1].x),
+            FloatLanes::Broadcast(triangle.Edges[2].x),
+        };
+        const auto depthDX = FloatLanes::Broadcast(triangle.DepthPlane.x);
+
+        for (auto y = minY; y <= maxY; y++)
+        {
+            const auto centerY = (float)y + 0.5f;
+            const float rowEdges[3] {
+                triangle.Edges[0].y * centerY + triangle.Edges[0].z,
+                triangle.Edges[1].y * centerY + triangle.Edges[1].z,
+                triangle.Edges[2].y * centerY + triangle.Edges[2].z,
+            };
+            const auto rowDepth = triangle.DepthPlane.y * centerY + triangle.DepthPlane.z;
+            auto row = &depth_[(size_t)y * width_];
+
+            for (auto x = minX; x <= maxX; x += FloatLanes::Count)
+            {
+                const auto centerX = FloatLanes::Broadcast((float)x) + laneCenters;
+                const auto inside = GreaterEqual(centerX * edgeDX[0] + FloatLanes::Broadcast(rowEdges[0]), zero)
+                    & GreaterEqual(centerX * edgeDX[1] + FloatLanes::Broadcast(rowEdges[1]), zero)
+                    & GreaterEqual(centerX * edgeDX[2] + FloatLanes::Broadcast(rowEdges[2]), zero);
+
+                if (MoveMask(inside) == 0)
+                    continue;
+
+                const auto depth = centerX * depthDX + FloatLanes::Broadcast(rowDepth);
+                const auto current = FloatLanes::Load(row + x);
+                Select(inside, Min(current, depth), current).Store(row + x);
+            }
+        }
+    }
+
+    auto maxDepth = FloatLanes::Broadcast(0.0f);
+    for (auto y = tileMinY; y <= tileMaxY; y++)
+    {
+        const auto row = &depth_[(size_t)y * width_];
+        for (auto x = tileMinX; x <= tileMaxX; x += FloatLanes::Count)
+            maxDepth = Max(maxDepth, FloatLanes::Load(row + x));
+    }
+
+    tileMaxDepth_[tileIndex] = HorizontalMax(maxDepth);
+}
+
+bool OcclusionCuller::IsRectVisible(int32_t minX, int32_t minY, int32_t maxX, int32_t maxY, float nearestDepth) const noexcept
+{
+    const auto nearest = FloatLanes::Broadcast(nearestDepth);
+    const auto laneX = FloatLanes::Ramp();
+    const auto rectMinX = FloatLanes::Broadcast((float)minX);
+    const auto rectMaxX = FloatLanes::Broadcast((float)maxX);
+    const auto firstX = minX - minX % FloatLanes::Count;
+
+    for (auto y = minY; y <= maxY; y++)
+    {
+        const auto row = &depth_[(size_t)y * width_];
+        for (auto x = firstX; x <= maxX; x += FloatLanes::Count)
+        {
+            const auto pixelX = FloatLanes::Broadcast((float)x) + laneX;
+            const auto inRect = GreaterEqual(pixelX, rectMinX) & GreaterEqual(rectMaxX, pixelX);
+
+            // a pixel whose occluders are not nearer than the bounds may show the object
+            if (MoveMask(inRect & GreaterEqual(FloatLanes::Load(row + x), nearest)) != 0)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+bool OcclusionCuller::IsVisible(const BoundingSphere& sphere) const noexcept
+{
+    if (width_ == 0)
+        return true;
+
+    glm::vec2 minScreen(std::numeric_limits<float>::max());
+    glm::vec2 maxScreen(std::numeric_limits<float>::lowest());
+    float nearestDepth = 1.0f;
+
+    // projected corners of the sphere's bounding box enclose its screen space bounds
+    for (int corner = 0; corner < 8; corner++)
+    {
+        const glm::vec3 offset(
+            (corner & 1) != 0 ? sphere.Radius : -sphere.Radius,
+            (corner & 2) != 0 ? sphere.Radius : -sphere.Radius,
+            (corner & 4) != 0 ? sphere.Radius : -sphere.Radius);
+
+        const auto clip = viewProjection_ * glm::vec4(sphere.Center + offset, 1.0f);
+        if (IsInFrontOfNearPlane(clip))
+            return true;
+
+        const auto ndc = glm::vec3(clip) / clip.w;
+        const auto screen = (glm::vec2(ndc) + 1.0f) * glm::vec2(width_ * 0.5f, height_ * 0.5f);
+        minScreen = glm::min(minScreen, screen);
+        maxScreen = glm::max(maxScreen, screen);
+        nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+    }
+
+    // bounds outside of the screen cover no pixels
+    if (maxScreen.x < 0.0f || maxScreen.y < 0.0f || minScreen.x >= (float)width_ || minScreen.y >= (float)height_)
+        return false;
+
+    // every pixel the bounds touch is tested, including partially covered ones on their border
+    const auto minX = (int32_t)std::floor(std::max(minScreen.x, 0.0f));
+    const auto minY = (int32_t)std::floor(std::max(minScreen.y, 0.0f));
+    const auto maxX = (int32_t)std::floor(std::min(maxScreen.x, (float)(width_ - 1)));
+    const auto maxY = (int32_t)std::floor(std::min(maxScreen.y, (float)(height_ - 1)));
+
+    for (auto tileY = minY / TileHeight; tileY <= maxY / TileHeight; tileY++)
+    {
+        for (auto tileX = minX / TileWidth; tileX <= maxX / TileWidth; tileX++)
+        {
+            // every pixel of the tile is nearer than the bounds
+            if (nearestDepth > tileMaxDepth_[(size_t)tileY * tileCountX_ + tileX])
+                continue;
+
+            const auto tileMinX = tileX * TileWidth;
+            const auto tileMinY = tileY * TileHeight;
+            if (IsRectVisible(
+                std::max(minX, tileMinX),
+                std::max(minY, tileMinY),
+                std::min(maxX, tileMinX + TileWidth - 1),
+                std::min(maxY, tileMinY + TileHeight - 1),
+                nearestDepth))
+                return true;
+        }
+    }
+
+    return false;
+}
+
+size_t OcclusionCuller::RemoveOccluded(const BoundingSphereBatch& spheres, std::vector<uint32_t>& indices) const
+{
+    NV_PROFILE_FUNC;
+
+    if (triangles_.empty())
+        return 0;
+
+    const auto initialSize = indices.size();
+    std::erase_if(
+        indices,
+        [&](uint32_t index)
+        {
+            return !IsVisible(
+                BoundingSphere {
+                    .Center = glm::vec3(spheres.CenterX[index], spheres.CenterY[index], spheres.CenterZ[index]),
+                    .Radius = spheres.Radius[index],
+                });
+        });
+
+    return initialSize - indices.size();
+}
@@ -0,0 +1,55 @@
+#include <Nova/graphics/RenderQueue.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <array>
+
+using namespace Nova;
+
+void Nova::RadixSort(std::vector<RenderQueueEntry>& entries, std::vector<RenderQueueEntry>& scratch)
+{
+    NV_PROFILE_FUNC;
+
+    constexpr size_t digitCount = sizeof(uint64_t);
+    constexpr size_t bucketCount = 256;
+
+    const auto count = entries.size();
+    if (count < 2)
+        return;
+
+    // histograms of all digits are gathered in a single pass over the keys
+    std::array<std::array<uint32_t, bucketCount>, digitCount> histograms {};
+    for (const auto& entry : entries)
+    {
+        for (size_t digit = 0; digit < digitCount; digit++)
+            histograms[digit][(entry.Key >> (digit * 8)) & 0xFF]++;
+    }
+
+    scratch.resize(count);
+
+    auto* source = &entries;
+    auto* destination = &scratch;
+
+    for (size_t digit = 0; digit < digitCount; digit++)
+    {
+        auto& histogram = histograms[digit];
+
+        // every key has the same value of this digit, so the pass wouldn't change the order
+        if (histogram[(entries.front().Key >> (digit * 8)) & 0xFF] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (auto& bucket : histogram)
+        {
+            const auto bucketSize = bucket;
+            bucket = offset;
+            offset += bucketSize;
+        }
+
+        for (const auto& entry : *source)
+            (*destination)[histogram[(entry.Key >> (digit * 8)) & 0xFF]++] = entry;
+
+        std::swap(source, destination);
+    }
+
+    if (source != &entries)
+        entries.swap(scratch);
+}
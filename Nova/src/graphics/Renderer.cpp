@@ -1,7 +1,17 @@
 #include <Nova/graphics/Renderer.hpp>
+#include <Nova/graphics/Frustum.hpp>
+#include <Nova/graphics/RenderQueue.hpp>
+#include <Nova/graphics/InstanceData.hpp>
+#include <Nova/graphics/OcclusionCuller.hpp>
+#include <Nova/graphics/MeshAllocator.hpp>
+#include <Nova/graphics/UploadQueue.hpp>
+#include <Nova/graphics/ShaderCache.hpp>
+#include <Nova/graphics/TextureStreamer.hpp>
+#include <Nova/graphics/Window.hpp>
 #include <Nova/graphics/opengl/GLObject.hpp>
 #include <Nova/graphics/opengl/Buffer.hpp>
 #include <Nova/graphics/opengl/PersistentMappedBuffer.hpp>
+#include <Nova/graphics/opengl/RingBuffer.hpp>
 #include <Nova/graphics/opengl/ShaderProgram.hpp>
 #include <Nova/graphics/opengl/VertexArray.hpp>
 #include <Nova/graphics/opengl/Texture.hpp>
@@ -11,11 +21,20 @@
 #include <Nova/debug/Profile.hpp>
 #include <Nova/debug/Log.hpp>
 #include <Nova/core/Utility.hpp>
+#include <Nova/core/TransformBatch.hpp>
+#include <Nova/core/ThreadPool.hpp>
+#include <glm/matrix.hpp>
 #include <xxhash.h>
 #include <unordered_map>
+#include <array>
+#include <limits>
+#include <bit>
+#include <cmath>
 #include <stdexcept>
 #include <iostream>
 #include <format>
+#include <memory>
+#include <optional>
 
 #ifdef _DEBUG
 #define BREAK_ON_HIGH_SEVERITY(severity) assert((severity != GL_DEBUG_SEVERITY_HIGH) && "OpenGL error")
@@ -56,13 +75,6 @@ struct DataOffsets
 	GLuint IndexOffset;
 };
 
-struct InstanceData
-{
-	GLuint MaterialIndex;
-	glm::mat4 Transform;
-	glm::mat3 NormalTransform;
-};
-
 struct CameraData
 {
 	glm::mat4 ViewMatrix;
@@ -71,28 +83,262 @@ struct CameraData
 	float _Padding[1];
 };
 
-struct DrawData
+struct ModelSlot
+{
+	uint32_t Index;
+	size_t LastUsedFrame;
+};
+
+// every level of detail of a model gets its own slot, so that sorting by slot also buckets instances by level
+struct ModelSlotKey
+{
+	const Model* TargetModel;
+	uint32_t LOD;
+
+	bool operator==(const ModelSlotKey&) const noexcept = default;
+};
+
+struct ModelSlotKeyHash
+{
+	size_t operator()(const ModelSlotKey& key) const noexcept
+	{
+		return std::hash<const Model*>()(key.TargetModel) ^ (std::hash<uint32_t>()(key.LOD) * 0x9E3779B97F4A7C15ull);
+	}
+};
+
+enum class RenderPassID : uint32_t
+{
+	Opaque = 0,
+	Transparent = 1,
+};
+
+struct ModelGeometry
+{
+	DataOffsets Offsets;
+	GLuint IndexCount;
+};
+
+struct LODSelection
+{
+	uint32_t LOD;
+	GLuint FadeBits; // nonzero while instance cross-fades from the previous level
+};
+
+struct PendingInstance
+{
+	const Model* TargetModel;
+	glm::mat4 Transform;
+	glm::mat3 NormalTransform;
+	GLuint MaterialIndex;
+	bool UseTransparency;
+	bool HasNormalTransform;
+};
+
+// layout of instance data in shader storage buffers, matches std430 rules
+struct GPUInstanceData
+{
+	glm::mat4 Transform;
+	glm::vec4 NormalTransform[3];
+	GLuint MaterialIndex;
+	GLuint _Padding[3];
+};
+
+struct InstanceUpdate
+{
+	GLuint Index;
+	GLuint _Padding[3];
+	GPUInstanceData Data;
+};
+
+struct RetainedInstance
+{
+	const Model* TargetModel;
+	glm::mat4 Transform;
+	GLuint MaterialIndex;
+	bool IsAlive;
+	bool IsDirty;
+};
+
+struct RetainedBatch
+{
+	const Model* TargetModel;
+	GLuint First;
+	GLuint Count;
+};
+
+// per batch data of GPU culling, matches std430 layout of CullBatch in retainedCull.comp
+struct GPUCullBatch
+{
+	glm::vec4 BoundingSphere;
+	GLuint IndexCount;
+	GLuint BaseIndex;
+	GLint BaseVertex;
+	GLuint FirstInstance;
+	GLuint CommandOffset;
+	GLuint DrawCountIndex;
+	GLuint _Padding[2];
+};
+
+// matches std430 layout of sOcclusionState in retainedCull.comp, first three members are indirect dispatch arguments
+struct OcclusionState
+{
+	GLuint PhaseOneGroupCount[3];
+	GLuint OccludedCount;
+	GLuint VisibleCount;
+	GLuint DisoccludedCount;
+};
+
+// consecutive retained batches with the same primitive mode, drawn with a single multi draw call
+struct RetainedBatchGroup
+{
+	GLenum PrimitiveMode;
+	GLuint FirstBatch;
+	GLuint BatchCount;
+};
+
+struct DrawCommandRange
 {
-	std::vector<InstanceData> OpaqueInstanceData;
-	std::vector<InstanceData> TransparentInstanceData;
-	size_t Age;
+	GLenum PrimitiveMode;
+	GLuint InstanceBufferID;
+	GLsizei First;
+	GLsizei Count;
 };
 
 typedef size_t ModelID;
 typedef size_t MaterialID;
 
 constexpr GLuint c_ModelDataBufferBinding = 0;
+constexpr GLuint c_InstanceDataBufferBinding = 1;
+constexpr GLuint c_InstanceScatterGroupSize = 64;
+constexpr GLuint c_CullGroupSize = 64;
+constexpr GLuint c_HiZGroupSize = 8;
+constexpr size_t c_OcclusionStatsFrameCount = 2;
+constexpr size_t c_MaterialScreenSizeFrameCount = 2;
+constexpr size_t c_ClusterStatsFrameCount = 2;
 constexpr GLsizei c_ShadowMapWidth = 1024;
 constexpr GLsizei c_ShadowMapHeight = 1024;
 constexpr GLsizei c_MaxShadowCasters = 8;
+constexpr GLsizeiptr c_InitialInstanceCount = 4096;
+constexpr GLuint c_InitialRetainedInstanceCount = 4096;
+constexpr GLsizeiptr c_InitialDrawCommandCount = 1024;
+constexpr GLuint c_InitialGeometryVertexCount = 65536;
+constexpr GLuint c_InitialGeometryIndexCount = 65536 * 3;
+constexpr float c_MaxMeshFragmentation = 0.25f; // part of geometry buffers lost in gaps which triggers defragmentation
+constexpr size_t c_MaxModelSlotAge = 300; // frames
+constexpr GLuint c_ClusterCountX = 16;
+constexpr GLuint c_ClusterCountY = 9;
+constexpr GLuint c_ClusterCountZ = 24;
+constexpr GLuint c_ClusterCount = c_ClusterCountX * c_ClusterCountY * c_ClusterCountZ;
+constexpr int32_t c_SoftwareOcclusionWidth = 256;
+constexpr int32_t c_SoftwareOcclusionHeight = 128;
+
+// all visible instances of current frame, sorted by pass, model, material and depth
+static RenderQueue<InstanceData> s_RenderQueue;
+
+// models are referenced in sort keys by small slot indices, slots of models which weren't drawn for a while are recycled
+static std::unordered_map<ModelSlotKey, ModelSlot, ModelSlotKeyHash> s_ModelSlots;
+static std::vector<ModelSlotKey> s_SlotModels;
+static std::vector<uint32_t> s_FreeModelSlots;
+static size_t s_FrameIndex;
+
+// instances submitted during current frame, they reach draw data only if their world space bounding sphere is visible
+static std::vector<PendingInstance> s_PendingInstances;
+static std::vector<float> s_PendingBoundsX;
+static std::vector<float> s_PendingBoundsY;
+static std::vector<float> s_PendingBoundsZ;
+static std::vector<float> s_PendingBoundsRadius;
+static std::vector<uint32_t> s_VisibleInstances;
+static std::vector<glm::mat4> s_NormalTransformInputs;
+static std::vector<glm::mat3> s_NormalTransformOutputs;
+static Frustum s_CameraFrustum;
+
+// with software occlusion culling, frustum culled instances are also tested against occluders rasterized on CPU,
+// tiles of the occlusion buffer are rasterized by a thread pool
+static bool s_UseSoftwareOcclusionCulling;
+static OcclusionCuller s_OcclusionCuller;
+static std::unique_ptr<ThreadPool> s_ThreadPool;
+static std::unique_ptr<UploadQueue> s_UploadQueue;
+
+// shared geometry, every mesh is sub-allocated from the same buffers so that whole pass can be drawn with single vertex
+// array binding, models only reference meshes and never own them
+static MeshAllocator s_MeshAllocator;
+static uint32_t s_BoundMeshVersion;
+
+// meshes are copied into shared geometry by upload thread, their data is kept alive until the copy is acquired
+struct PendingMeshUpload
+{
+	UploadHandle Upload;
+	std::shared_ptr<const void> DataOwner;
+};
+
+static std::vector<PendingMeshUpload> s_PendingMeshUploads;
 
-static std::unordered_map<const Model*, DrawData> s_DrawData;
+// indirect draw commands recorded for currently executed pass
+static RingBuffer s_DrawCommandBuffer;
+static std::vector<DrawCommand> s_DrawCommands;
+static std::vector<DrawCommandRange> s_DrawRanges;
+static GLuint s_BoundInstanceBufferID;
 
 static RendererInfo s_RendererInfo;
 
 // materials
-static PersistentMappedBuffer s_MaterialsBuffer;
-static std::unordered_map<Material, GLuint, XXHasher<Material>> s_Materials;
+// materials live in a GPU-only table, CPU copy is the source of uploads of dirty range
+static Buffer s_MaterialsBuffer;
+static GLuint s_MaterialsCapacity;
+static std::vector<Material> s_Materials;
+static std::vector<uint32_t> s_FreeMaterials;
+static std::vector<bool> s_MaterialsAlive; // freed slots stay in the table, so handles are validated against this
+static std::vector<uint32_t> s_MaterialInstanceCounts; // retained instances referencing each material slot
+static uint32_t s_MaterialsDirtyBegin;
+static uint32_t s_MaterialsDirtyEnd;
+
+// staging memory for copies into GPU-only buffers
+static RingBuffer s_UploadBuffer;
+static GLint s_StorageBufferOffsetAlignment;
+
+// retained instances live in a persistent GPU table indexed by handle, only dirty instances are uploaded
+// and scattered into place by compute shader
+static std::vector<RetainedInstance> s_RetainedInstances;
+static std::vector<uint32_t> s_FreeRetainedInstances;
+static std::vector<uint32_t> s_DirtyRetainedInstances;
+static Buffer s_RetainedInstanceTable;
+static GLuint s_RetainedInstanceCapacity;
+
+// opaque retained instances are drawn through per model lists of table indices, which are rebuilt only
+// when an instance is created, destroyed or changes material; transparent ones are submitted every frame
+// with immediate instances, so that they're sorted together
+static std::vector<RetainedBatch> s_RetainedBatches;
+static std::vector<GLuint> s_RetainedInstanceIndices;
+static std::vector<uint32_t> s_RetainedTransparentInstances;
+static Buffer s_RetainedIndexBuffer;
+static GLuint s_BoundRetainedIndexBufferID;
+static bool s_RetainedMembershipChanged;
+
+// with GPU culling, retained opaque instances are culled by a compute pass, which also writes draw commands,
+// so the CPU doesn't touch them at all unless the scene changes
+static bool s_UseGPUCulling;
+static bool s_HasIndirectDrawCount;
+static std::vector<RetainedBatchGroup> s_RetainedBatchGroups;
+static Buffer s_CullBatchBuffer;
+static Buffer s_CullCandidateBuffer;
+static Buffer s_BatchInstanceCountBuffer;
+static Buffer s_CulledIndexBuffer;
+static Buffer s_CulledDrawCommandBuffer;
+static Buffer s_CulledDrawCountBuffer;
+
+// occlusion culling tests retained instances against a max-depth pyramid of previous frame first, occluded ones are
+// re-tested against a pyramid of the current frame's first phase and drawn if they became visible; statistics
+// of each frame are copied to a readable buffer and reported once its fence has been waited for
+static bool s_UseOcclusionCulling;
+static GLuint s_HiZTexture;
+static GLsizei s_HiZDepthWidth;
+static GLsizei s_HiZDepthHeight;
+static GLsizei s_HiZLevelCount;
+static bool s_HasHiZ;
+static glm::mat4 s_HiZViewProjection;
+static Buffer s_OcclusionStateBuffer;
+static Buffer s_OccludedCandidateBuffer;
+static Buffer s_OcclusionStatsBuffer;
 
 // lights
 static PersistentMappedBuffer s_LightsBuffer;
@@ -105,21 +351,67 @@ static DirLightData* s_DirLights;
 static GLuint s_DirLightsCount;
 static GLuint s_MaxDirLightsCount;
 
+// point lights are binned into clusters every frame, shading passes only evaluate lights of their cluster
+static Buffer s_ClusterLightCountsBuffer;
+static Buffer s_ClusterLightIndicesBuffer;
+static GLuint s_MaxLightsPerCluster;
+static std::array<std::string, 4> s_LightClusterDefines;
+static std::array<std::string_view, 4> s_LightClusterDefineViews;
+static LightingStrategy s_LightingStrategy;
+static glm::mat4 s_InverseProjection;
+static glm::mat4 s_ViewProjection;
+static glm::mat4 s_InverseViewProjection;
+static float s_ClusterNear;
+static float s_ClusterFar;
+static bool s_IsOrthographicProjection;
+static Buffer s_ClusterOverflowBuffer; // clusters which had more lights than MaxLightsPerCluster, one counter per frame in flight
+static bool s_HasReportedClusterOverflow;
+
 static PersistentMappedBuffer s_CameraDataBuffer;
 
-static PersistentMappedBuffer s_InstanceBuffer;
+static RingBuffer s_InstanceBuffer;
+static bool s_UseCompactInstanceData;
+static GLsizei s_InstanceStride;
+static ShaderCache s_ShaderCache; // disabled unless settings name a cache directory
 static ShaderProgram s_DeferredGeometryProgram;
 static ShaderProgram s_DeferredLightProgram;
 static ShaderProgram s_DeferredTransparentProgram;
+static std::optional<PendingCachedProgram> s_PendingTransparentProgram; // draws with fallback until it's finished
+static ShaderProgram s_FallbackTransparentProgram;
+static bool s_UseFallbackTransparentProgram = false;
+static ShaderProgram s_DeferredRetainedGeometryProgram;
+static ShaderProgram s_InstanceScatterProgram;
+static ShaderProgram s_RetainedCullProgram;
+static ShaderProgram s_RetainedDrawCommandsProgram;
+static ShaderProgram s_HiZFromDepthProgram;
+static ShaderProgram s_HiZDownsampleProgram;
+static ShaderProgram s_LightClusteringProgram;
+static ShaderProgram s_LightVolumeProgram;
 static VertexArray s_VertexArray;
+static VertexArray s_RetainedVertexArray;
 static Texture s_WhiteTexture;
 static Framebuffer s_Framebuffer;
-static Sync s_FrameSync; // guards materials buffer, lights buffer and camera data buffer
-static Sync s_InstanceDataSync; // guards instance data buffer between each batch draw
+static bool s_UseCompactGBuffer;
+static Sync s_FrameSync; // guards lights buffer and camera data buffer
 static GLsizei s_CurrentDisplayWidth;
 static GLsizei s_CurrentDisplayHeight;
 
 static glm::vec3 s_CameraPosition;
+static glm::vec4 s_CameraViewDepthRow;
+
+// bounding sphere at view depth d covers s_ProjectionScaleY * radius / d of viewport height
+static float s_ProjectionScaleY;
+static float s_LODFadeRange;
+static std::vector<float> s_MaterialScreenSizes; // largest screen size of visible instances of each material
+
+// GPU culling measures retained instances into a table of float bits per material, which is read back a frame later
+static Buffer s_MaterialScreenSizeBuffer;
+static Buffer s_MaterialScreenSizeReadbackBuffer;
+static bool s_HasRetainedScreenSizes; // previous frame copied its sizes into the readback buffer
+
+static std::unique_ptr<TextureStreamer> s_TextureStreamer;
+static std::vector<std::optional<StreamedTextureHandle>> s_MaterialTextures;
+static size_t s_DrawnIndexCount;
 
 static void ExecuteShadowMapPass() noexcept
 {
@@ -128,267 +420,1945 @@ static void ExecuteShadowMapPass() noexcept
 	glViewport(0, 0, c_ShadowMapWidth, c_ShadowMapHeight);
 }
 
-static GLuint GetMaterialIndex(const Material& material)
+static bool IsTransparentMaterial(const Material& material) noexcept
+{
+	return !glm::epsilonEqual(material.Color.a, 1.0f, glm::epsilon<float>());
+}
+
+static void MarkMaterialDirty(uint32_t index) noexcept
+{
+	s_MaterialsDirtyBegin = std::min(s_MaterialsDirtyBegin, index);
+	s_MaterialsDirtyEnd = std::max(s_MaterialsDirtyEnd, index + 1);
+}
+
+// both buffers hold an entry for every slot of the material table
+static void CreateMaterialScreenSizeBuffers()
+{
+	s_MaterialScreenSizeBuffer = Buffer(s_MaterialsCapacity * sizeof(GLuint));
+	s_MaterialScreenSizeBuffer.SetDebugName("MaterialScreenSizeBuffer");
+
+	const std::vector<GLuint> initialSizes(c_MaterialScreenSizeFrameCount * s_MaterialsCapacity, 0);
+	s_MaterialScreenSizeReadbackBuffer = Buffer(
+		(GLsizeiptr)(initialSizes.size() * sizeof(GLuint)),
+		false,
+		true,
+		initialSizes.data());
+	s_MaterialScreenSizeReadbackBuffer.SetDebugName("MaterialScreenSizeReadbackBuffer");
+
+	s_HasRetainedScreenSizes = false;
+}
+
+static void UploadMaterials()
 {
 	NV_PROFILE_FUNC;
 
-	const auto it = s_Materials.find(material);
-	if (it != s_Materials.end())
+	if (s_MaterialsDirtyBegin >= s_MaterialsDirtyEnd)
+		return;
+
+	if (s_Materials.size() > s_MaterialsCapacity)
 	{
-		return it->second;
+		auto newCapacity = std::max(s_MaterialsCapacity, 1u);
+		while (newCapacity < s_Materials.size())
+			newCapacity *= 2;
+
+		NV_LOG_INFO("Growing material table from {} to {} materials.", s_MaterialsCapacity, newCapacity);
+
+		// materials outside of dirty range are already on GPU, so they're copied from the old table
+		Buffer newBuffer(newCapacity * sizeof(Material));
+		GL::CopyNamedBufferSubData(
+			(GLuint)s_MaterialsBuffer.GetID(),
+			(GLuint)newBuffer.GetID(),
+			0,
+			0,
+			s_MaterialsCapacity * sizeof(Material));
+
+		s_MaterialsBuffer.Delete();
+		s_MaterialsBuffer = std::move(newBuffer);
+		s_MaterialsBuffer.SetDebugName("MaterialsBuffer");
+		s_MaterialsCapacity = newCapacity;
+
+		// sizes measured in the previous frame are dropped, the next frame measures all instances again
+		if (s_UseGPUCulling)
+		{
+			s_MaterialScreenSizeBuffer.Delete();
+			s_MaterialScreenSizeReadbackBuffer.Delete();
+			CreateMaterialScreenSizeBuffers();
+		}
 	}
-	else
-	{
-		const auto dataPtr = s_MaterialsBuffer.GetDataPtr<Material>();
-		const auto basePtr = s_MaterialsBuffer.GetBasePtr<Material>();
-		const auto materialIndex = dataPtr - basePtr;
 
-		s_MaterialsBuffer.Write(&material, sizeof(Material));
-		s_Materials.emplace(material, (GLuint)materialIndex);
+	const auto dirtyMaterials = std::span<const Material>(s_Materials).subspan(
+		s_MaterialsDirtyBegin,
+		s_MaterialsDirtyEnd - s_MaterialsDirtyBegin);
+
+	const auto staging = s_UploadBuffer.Write(dirtyMaterials);
+	s_UploadBuffer.Commit(staging);
+
+	GL::CopyNamedBufferSubData(
+		staging.BufferID,
+		(GLuint)s_MaterialsBuffer.GetID(),
+		staging.Offset,
+		s_MaterialsDirtyBegin * sizeof(Material),
+		dirtyMaterials.size_bytes());
+
+	s_UploadBuffer.Fence();
+
+	NV_PROFILE_COUNTER("Renderer::UploadedMaterials", (float)dirtyMaterials.size());
+
+	s_MaterialsDirtyBegin = std::numeric_limits<uint32_t>::max();
+	s_MaterialsDirtyEnd = 0;
+}
+
+static PendingCachedProgram CreateBasicShaderProgram()
+{
+	NV_PROFILE_FUNC;
+
+	return s_ShaderCache.BeginLoadProgram(
+		"Basic",
+		{
+			ShaderStageSource {
+				.Type = ShaderType::Vertex,
+				.Filepath = "./assets/shaders/basic.vert",
+			},
+			ShaderStageSource {
+				.Type = ShaderType::Fragment,
+				.Filepath = "./assets/shaders/basic.frag",
+			},
+		});
+}
+
+static std::span<const std::string_view> GetInstanceDataDefines() noexcept
+{
+	static constexpr std::array<std::string_view, 1> compactDefines { "NV_COMPACT_INSTANCE_DATA" };
+
+	return s_UseCompactInstanceData
+		? std::span<const std::string_view>(compactDefines)
+		: std::span<const std::string_view>();
+}
+
+static std::span<const std::string_view> GetGBufferDefines() noexcept
+{
+	static constexpr std::array<std::string_view, 1> compactDefines { "NV_COMPACT_GBUFFER" };
+
+	return s_UseCompactGBuffer
+		? std::span<const std::string_view>(compactDefines)
+		: std::span<const std::string_view>();
+}
+
+static PendingCachedProgram CreateDeferredGeometryShaderProgram()
+{
+	NV_PROFILE_FUNC;
 
-		return materialIndex;
+	// only immediate instances cross-fade between levels of detail, discard stays out of other programs,
+	// so that their early depth test isn't disabled
+	std::vector<std::string_view> vertexDefines(GetInstanceDataDefines().begin(), GetInstanceDataDefines().end());
+	std::vector<std::string_view> fragmentDefines(GetGBufferDefines().begin(), GetGBufferDefines().end());
+	if (s_LODFadeRange > 0.0f)
+	{
+		vertexDefines.push_back("NV_LOD_FADE");
+		fragmentDefines.push_back("NV_LOD_FADE");
 	}
+
+	return s_ShaderCache.BeginLoadProgram(
+		"DeferredGeometry",
+		{
+			ShaderStageSource {
+				.Type = ShaderType::Vertex,
+				.Filepath = "./assets/shaders/deferredGeometry.vert",
+				.Defines = vertexDefines,
+			},
+			ShaderStageSource {
+				.Type = ShaderType::Fragment,
+				.Filepath = "./assets/shaders/deferredGeometry.frag",
+				.Defines = fragmentDefines,
+			},
+		});
+}
+
+// cluster grid dimensions are baked into shaders, so that cluster index math folds into constants,
+// rebuilt by every initialization, as limit of lights per cluster has to match size of cluster index buffer
+static void BuildLightClusterDefines()
+{
+	s_LightClusterDefines = {
+		std::format("NV_CLUSTER_COUNT_X {}u", c_ClusterCountX),
+		std::format("NV_CLUSTER_COUNT_Y {}u", c_ClusterCountY),
+		std::format("NV_CLUSTER_COUNT_Z {}u", c_ClusterCountZ),
+		std::format("NV_MAX_LIGHTS_PER_CLUSTER {}u", s_MaxLightsPerCluster),
+	};
+
+	for (size_t i = 0; i < s_LightClusterDefines.size(); i++)
+		s_LightClusterDefineViews[i] = s_LightClusterDefines[i];
+}
+
+static std::span<const std::string_view> GetLightClusterDefines() noexcept
+{
+	return s_LightClusterDefineViews;
 }
 
-static ShaderProgram CreateBasicShaderProgram()
+// passes which shade pixels need both cluster grid and G-buffer layout
+static std::vector<std::string_view> GetShadingDefines()
+{
+	std::vector<std::string_view> defines(GetLightClusterDefines().begin(), GetLightClusterDefines().end());
+	defines.insert(defines.end(), GetGBufferDefines().begin(), GetGBufferDefines().end());
+
+	return defines;
+}
+
+static PendingCachedProgram CreateDeferredLightingShaderProgram()
 {
 	NV_PROFILE_FUNC;
 
-	return ShaderProgram({
-		ShaderStage::FromGLSL(
-			ShaderType::Vertex,
-			std::filesystem::path("./assets/shaders/basic.vert")),
-		ShaderStage::FromGLSL(
-			ShaderType::Fragment,
-			std::filesystem::path("./assets/shaders/basic.frag")),
-	});
+	// with light volumes, full screen pass only applies ambient and directional lights
+	auto defines = GetShadingDefines();
+	if (s_LightingStrategy == LightingStrategy::LightVolumes)
+		defines.push_back("NV_LIGHT_VOLUMES");
+
+	return s_ShaderCache.BeginLoadProgram(
+		"DeferredLighting",
+		{
+			ShaderStageSource {
+				.Type = ShaderType::Vertex,
+				.Filepath = "./assets/shaders/deferredLighting.vert",
+			},
+			ShaderStageSource {
+				.Type = ShaderType::Fragment,
+				.Filepath = "./assets/shaders/deferredLighting.frag",
+				.Defines = defines,
+			},
+		});
 }
 
-static ShaderProgram CreateDeferredGeometryShaderProgram()
+static PendingCachedProgram CreateLightVolumeShaderProgram()
 {
 	NV_PROFILE_FUNC;
 
-	return ShaderProgram({
-		ShaderStage::FromGLSL(
-			ShaderType::Vertex,
-			std::filesystem::path("./assets/shaders/deferredGeometry.vert")),
-		ShaderStage::FromGLSL(
-			ShaderType::Fragment,
-			std::filesystem::path("./assets/shaders/deferredGeometry.frag")),
-	});
+	return s_ShaderCache.BeginLoadProgram(
+		"LightVolume",
+		{
+			ShaderStageSource {
+				.Type = ShaderType::Vertex,
+				.Filepath = "./assets/shaders/lightVolume.vert",
+			},
+			ShaderStageSource {
+				.Type = ShaderType::Fragment,
+				.Filepath = "./assets/shaders/lightVolume.frag",
+				.Defines = GetGBufferDefines(),
+			},
+		});
 }
 
-static ShaderProgram CreateDeferredLightingShaderProgram()
+static PendingCachedProgram CreateLightClusteringShaderProgram()
 {
 	NV_PROFILE_FUNC;
 
-	return ShaderProgram({
-		ShaderStage::FromGLSL(
-			ShaderType::Vertex,
-			std::filesystem::path("./assets/shaders/deferredLighting.vert")),
-		ShaderStage::FromGLSL(
-			ShaderType::Fragment,
-			std::filesystem::path("./assets/shaders/deferredLighting.frag")),
-	});
+	return s_ShaderCache.BeginLoadProgram(
+		"LightClustering",
+		{
+			ShaderStageSource {
+				.Type = ShaderType::Compute,
+				.Filepath = "./assets/shaders/lightClustering.comp",
+				.Defines = GetLightClusterDefines(),
+			},
+		});
 }
 
-static ShaderProgram CreateDeferredTransparentShaderProgram()
+static PendingCachedProgram CreateDeferredRetainedGeometryShaderProgram()
 {
-	return ShaderProgram({
-		ShaderStage::FromGLSL(
-			ShaderType::Vertex,
-			std::filesystem::path("./assets/shaders/deferredTransparent.vert")),
-		ShaderStage::FromGLSL(
-			ShaderType::Fragment,
-			std::filesystem::path("./assets/shaders/deferredTransparent.frag")),
-	});
+	NV_PROFILE_FUNC;
+
+	return s_ShaderCache.BeginLoadProgram(
+		"DeferredRetainedGeometry",
+		{
+			ShaderStageSource {
+				.Type = ShaderType::Vertex,
+				.Filepath = "./assets/shaders/deferredGeometryRetained.vert",
+			},
+			ShaderStageSource {
+				.Type = ShaderType::Fragment,
+				.Filepath = "./assets/shaders/deferredGeometry.frag",
+				.Defines = GetGBufferDefines(),
+			},
+		});
 }
 
-static void RetrieveRendererInfo() noexcept
+static PendingCachedProgram CreateInstanceScatterShaderProgram()
 {
-	s_RendererInfo.VendorName = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
-	s_RendererInfo.RendererName = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
-	s_RendererInfo.Version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
-	s_RendererInfo.GLSLVersion = reinterpret_cast<const char*>(glGetString(GL_SHADING_LANGUAGE_VERSION));
+	NV_PROFILE_FUNC;
+
+	return s_ShaderCache.BeginLoadProgram(
+		"InstanceScatter",
+		{
+			ShaderStageSource {
+				.Type = ShaderType::Compute,
+				.Filepath = "./assets/shaders/instanceScatter.comp",
+			},
+		});
 }
 
-static glm::mat3 BuildNormalTransformMatrix(const glm::mat4& transform) noexcept
+static PendingCachedProgram CreateRetainedCullShaderProgram()
 {
 	NV_PROFILE_FUNC;
-	return glm::transpose(glm::inverse(glm::mat3(transform)));
+
+	static constexpr std::array<std::string_view, 1> occlusionDefines { "NV_OCCLUSION_CULLING" };
+
+	return s_ShaderCache.BeginLoadProgram(
+		"RetainedCull",
+		{
+			ShaderStageSource {
+				.Type = ShaderType::Compute,
+				.Filepath = "./assets/shaders/retainedCull.comp",
+				.Defines = s_UseOcclusionCulling
+					? std::span<const std::string_view>(occlusionDefines)
+					: std::span<const std::string_view>(),
+			},
+		});
 }
 
-static std::vector<InstanceData>& GetModelInstanceDataStore(const Model* model, bool useTransparency)
+static PendingCachedProgram CreateHiZBuildShaderProgram(bool fromDepth)
 {
 	NV_PROFILE_FUNC;
-	
-	const auto& it = s_DrawData.find(model);
-	if (it != s_DrawData.end())
-		return useTransparency
-			? it->second.TransparentInstanceData
-			: it->second.OpaqueInstanceData;
-	
-	const auto& [data, _] = s_DrawData.emplace(model, DrawData { .Age = 0 });
-	return useTransparency
-		? data->second.TransparentInstanceData
-		: data->second.OpaqueInstanceData;
+
+	static constexpr std::array<std::string_view, 1> fromDepthDefines { "NV_HIZ_FROM_DEPTH" };
+
+	return s_ShaderCache.BeginLoadProgram(
+		fromDepth ? "HiZFromDepth" : "HiZDownsample",
+		{
+			ShaderStageSource {
+				.Type = ShaderType::Compute,
+				.Filepath = "./assets/shaders/hiZBuild.comp",
+				.Defines = fromDepth
+					? std::span<const std::string_view>(fromDepthDefines)
+					: std::span<const std::string_view>(),
+			},
+		});
 }
 
-void Renderer::Render(
-	const Model* model,
-	const Material& material,
-	const glm::mat4& transform)
+static PendingCachedProgram CreateRetainedDrawCommandsShaderProgram()
 {
 	NV_PROFILE_FUNC;
 
-	auto& instanceDataStore = GetModelInstanceDataStore(model, !glm::epsilonEqual(material.Color.a, 1.0f, glm::epsilon<float>()));
-	instanceDataStore.emplace_back(
-		InstanceData {
-			.MaterialIndex = GetMaterialIndex(material),
-			.Transform = transform,
-			.NormalTransform = BuildNormalTransformMatrix(transform),
+	return s_ShaderCache.BeginLoadProgram(
+		"RetainedDrawCommands",
+		{
+			ShaderStageSource {
+				.Type = ShaderType::Compute,
+				.Filepath = "./assets/shaders/retainedDrawCommands.comp",
+			},
 		});
 }
 
-void Renderer::SetCamera(
-	const glm::mat4& view,
-	const glm::mat4& projection,
-	const glm::vec3& position)
+static PendingCachedProgram CreateDeferredTransparentShaderProgram()
 {
-    NV_PROFILE_FUNC;
+	return s_ShaderCache.BeginLoadProgram(
+		"DeferredTransparent",
+		{
+			ShaderStageSource {
+				.Type = ShaderType::Vertex,
+				.Filepath = "./assets/shaders/deferredTransparent.vert",
+				.Defines = GetInstanceDataDefines(),
+			},
+			ShaderStageSource {
+				.Type = ShaderType::Fragment,
+				.Filepath = "./assets/shaders/deferredTransparent.frag",
+				.Defines = GetShadingDefines(),
+			},
+		});
+}
 
-	auto cameraData = s_CameraDataBuffer.GetDataPtr<CameraData>();
-	cameraData->ViewMatrix = view;
-	cameraData->ProjectionMatrix = projection;
-	cameraData->Position = position;
+// skips clustered point lights, so that it's built quicker than the full program, which it stands in for
+static PendingCachedProgram CreateFallbackTransparentShaderProgram()
+{
+	auto defines = GetShadingDefines();
+	defines.push_back("NV_DIRECTIONAL_LIGHTS_ONLY");
 
-	s_CameraPosition = position;
+	return s_ShaderCache.BeginLoadProgram(
+		"DeferredTransparentFallback",
+		{
+			ShaderStageSource {
+				.Type = ShaderType::Vertex,
+				.Filepath = "./assets/shaders/deferredTransparent.vert",
+				.Defines = GetInstanceDataDefines(),
+			},
+			ShaderStageSource {
+				.Type = ShaderType::Fragment,
+				.Filepath = "./assets/shaders/deferredTransparent.frag",
+				.Defines = defines,
+			},
+		});
 }
 
-const RendererInfo& Renderer::GetInfo() noexcept
+static void RetrieveRendererInfo() noexcept
 {
-	return s_RendererInfo;
+	s_RendererInfo.VendorName = reinterpret_cast<const char*>(glGetString(GL_VENDOR));
+	s_RendererInfo.RendererName = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+	s_RendererInfo.Version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+	s_RendererInfo.GLSLVersion = reinterpret_cast<const char*>(glGetString(GL_SHADING_LANGUAGE_VERSION));
 }
 
-void Renderer::SetViewport(const Rect<int>& viewport) noexcept
+static uint32_t GetModelSlot(const Model* model, uint32_t lod)
 {
-    NV_PROFILE_FUNC;
-	
-	glViewport(viewport.X, viewport.Y, viewport.Width, viewport.Height);
+	const ModelSlotKey key { model, lod };
+
+	const auto it = s_ModelSlots.find(key);
+	if (it != s_ModelSlots.end())
+	{
+		it->second.LastUsedFrame = s_FrameIndex;
+		return it->second.Index;
+	}
+
+	uint32_t index;
+	if (!s_FreeModelSlots.empty())
+	{
+		index = s_FreeModelSlots.back();
+		s_FreeModelSlots.pop_back();
+		s_SlotModels[index] = key;
+	}
+	else
+	{
+		if (s_SlotModels.size() >= RenderSortKey::MaxModels)
+			throw std::runtime_error("Too many models drawn at once.");
+
+		index = (uint32_t)s_SlotModels.size();
+		s_SlotModels.push_back(key);
+	}
+
+	s_ModelSlots.emplace(key, ModelSlot { .Index = index, .LastUsedFrame = s_FrameIndex });
+
+	return index;
 }
 
-void Renderer::SetViewport(
-	const Rect<int>& viewport,
-	const Rect<int>& scissor) noexcept
+static void EvictModelSlots()
 {
-    NV_PROFILE_FUNC;
-	
-	glViewport(viewport.X, viewport.Y, viewport.Width, viewport.Height);
-	glScissor(scissor.X, scissor.Y, scissor.Width, scissor.Height);
+	NV_PROFILE_FUNC;
+
+	std::erase_if(
+		s_ModelSlots,
+		[](const auto& item)
+		{
+			const auto& [key, slot] = item;
+			if (s_FrameIndex - slot.LastUsedFrame <= c_MaxModelSlotAge)
+				return false;
+
+			s_SlotModels[slot.Index] = {};
+			s_FreeModelSlots.push_back(slot.Index);
+			return true;
+		});
+}
+
+static bool IsMaterialAlive(uint32_t index) noexcept
+{
+	return index < s_MaterialsAlive.size() && s_MaterialsAlive[index];
+}
+
+// slot of destroyed material is recycled only once no retained instance references it,
+// otherwise the next material would silently take over those instances
+static void ReleaseMaterialReference(uint32_t index)
+{
+	if (--s_MaterialInstanceCounts[index] == 0 && !s_MaterialsAlive[index])
+		s_FreeMaterials.push_back(index);
+}
+
+MaterialHandle Renderer::CreateMaterial(const Material& material)
+{
+	NV_PROFILE_FUNC;
+
+	uint32_t index;
+	if (!s_FreeMaterials.empty())
+	{
+		index = s_FreeMaterials.back();
+		s_FreeMaterials.pop_back();
+		s_Materials[index] = material;
+		s_MaterialsAlive[index] = true;
+	}
+	else
+	{
+		index = (uint32_t)s_Materials.size();
+		// fade weight of levels of detail is packed into unused bits of material index
+		if ((s_UseCompactInstanceData || s_LODFadeRange > 0.0f) && index > c_CompactMaterialIndexMask)
+			throw std::runtime_error("Too many materials for compact instance data or LOD fading.");
+
+		s_Materials.push_back(material);
+		s_MaterialsAlive.push_back(true);
+		s_MaterialInstanceCounts.push_back(0);
+	}
+
+	MarkMaterialDirty(index);
+
+	return MaterialHandle(index);
+}
+
+void Renderer::UpdateMaterial(MaterialHandle handle, const Material& material)
+{
+	const auto index = (uint32_t)handle;
+	NV_CHECK(IsMaterialAlive(index), "Invalid material handle.");
+
+	// retained instances are split into opaque and transparent ones when their lists are built
+	if (IsTransparentMaterial(s_Materials[index]) != IsTransparentMaterial(material))
+		s_RetainedMembershipChanged = true;
+
+	s_Materials[index] = material;
+	MarkMaterialDirty(index);
+}
+
+void Renderer::DestroyMaterial(MaterialHandle handle)
+{
+	const auto index = (uint32_t)handle;
+	NV_CHECK(IsMaterialAlive(index), "Invalid material handle.");
+
+	NV_CHECK(s_MaterialInstanceCounts[index] == 0, "Material is still used by retained instances.");
+
+	// freeing slot twice would hand it out to two materials
+	if (!IsMaterialAlive(index))
+		return;
+
+	// slot is only recycled, table entry stays on GPU until it's overwritten by another material,
+	// slot still referenced by retained instances is recycled when the last of them lets go of it
+	s_MaterialsAlive[index] = false;
+	if (s_MaterialInstanceCounts[index] == 0)
+		s_FreeMaterials.push_back(index);
+
+	if (index < s_MaterialTextures.size())
+		s_MaterialTextures[index].reset();
+}
+
+const Material& Renderer::GetMaterial(MaterialHandle handle)
+{
+	const auto index = (uint32_t)handle;
+	NV_CHECK(IsMaterialAlive(index), "Invalid material handle.");
+
+	return s_Materials[index];
+}
+
+float Renderer::GetMaterialScreenSize(MaterialHandle handle)
+{
+	const auto index = (uint32_t)handle;
+	NV_CHECK(IsMaterialAlive(index), "Invalid material handle.");
+
+	return index < s_MaterialScreenSizes.size()
+		? s_MaterialScreenSizes[index]
+		: 0.0f;
+}
+
+void Renderer::SetMaterialTexture(MaterialHandle handle, std::optional<StreamedTextureHandle> texture)
+{
+	const auto index = (uint32_t)handle;
+	NV_CHECK(IsMaterialAlive(index), "Invalid material handle.");
+	NV_CHECK(s_TextureStreamer != nullptr, "Texture streaming is disabled.");
+
+	if (index >= s_MaterialTextures.size())
+		s_MaterialTextures.resize(index + 1);
+
+	s_MaterialTextures[index] = texture;
+}
+
+static void SubmitInstance(
+	const Model* model,
+	MaterialHandle material,
+	const glm::mat4& transform,
+	const glm::mat3* normalTransform)
+{
+	NV_CHECK(IsMaterialAlive((uint32_t)material), "Invalid material handle.");
+
+	const auto& sphere = model->GetBounds().Sphere;
+	const auto center = transform * glm::vec4(sphere.Center, 1.0f);
+	const auto scale = std::max({
+		glm::length(glm::vec3(transform[0])),
+		glm::length(glm::vec3(transform[1])),
+		glm::length(glm::vec3(transform[2])),
+	});
+
+	s_PendingBoundsX.push_back(center.x);
+	s_PendingBoundsY.push_back(center.y);
+	s_PendingBoundsZ.push_back(center.z);
+	s_PendingBoundsRadius.push_back(sphere.Radius * scale);
+
+	s_PendingInstances.emplace_back(
+		PendingInstance {
+			.TargetModel = model,
+			.Transform = transform,
+			.NormalTransform = normalTransform ? *normalTransform : glm::mat3(),
+			.MaterialIndex = (uint32_t)material,
+			.UseTransparency = IsTransparentMaterial(s_Materials[(uint32_t)material]),
+			.HasNormalTransform = normalTransform != nullptr,
+		});
+}
+
+void Renderer::Render(
+	const Model* model,
+	MaterialHandle material,
+	const glm::mat4& transform)
+{
+	NV_PROFILE_FUNC;
+
+	SubmitInstance(model, material, transform, nullptr);
+}
+
+void Renderer::Render(
+	const Model* model,
+	MaterialHandle material,
+	const glm::mat4& transform,
+	const glm::mat3& normalTransform)
+{
+	NV_PROFILE_FUNC;
+
+	SubmitInstance(model, material, transform, &normalTransform);
+}
+
+void Renderer::AddOccluder(
+	std::span<const glm::vec3> vertices,
+	std::span<const GLuint> indices,
+	const glm::mat4& transform)
+{
+	if (s_UseSoftwareOcclusionCulling)
+		s_OcclusionCuller.AddOccluder(vertices, indices, transform);
+}
+
+static RetainedInstance& GetRetainedInstance(InstanceHandle handle)
+{
+	const auto index = (uint32_t)handle;
+	NV_CHECK(index < s_RetainedInstances.size() && s_RetainedInstances[index].IsAlive, "Invalid instance handle.");
+
+	return s_RetainedInstances[index];
+}
+
+static void MarkRetainedInstanceDirty(uint32_t index)
+{
+	auto& instance = s_RetainedInstances[index];
+	if (instance.IsDirty)
+		return;
+
+	instance.IsDirty = true;
+	s_DirtyRetainedInstances.push_back(index);
+}
+
+InstanceHandle Renderer::CreateInstance(
+	const Model* model,
+	MaterialHandle material,
+	const glm::mat4& transform)
+{
+	NV_PROFILE_FUNC;
+
+	NV_CHECK(IsMaterialAlive((uint32_t)material), "Invalid material handle.");
+
+	const RetainedInstance instance {
+		.TargetModel = model,
+		.Transform = transform,
+		.MaterialIndex = (uint32_t)material,
+		.IsAlive = true,
+		.IsDirty = false,
+	};
+
+	uint32_t index;
+	if (!s_FreeRetainedInstances.empty())
+	{
+		index = s_FreeRetainedInstances.back();
+		s_FreeRetainedInstances.pop_back();
+		s_RetainedInstances[index] = instance;
+	}
+	else
+	{
+		index = (uint32_t)s_RetainedInstances.size();
+		s_RetainedInstances.push_back(instance);
+	}
+
+	s_MaterialInstanceCounts[(uint32_t)material]++;
+	MarkRetainedInstanceDirty(index);
+	s_RetainedMembershipChanged = true;
+
+	return InstanceHandle(index);
+}
+
+void Renderer::SetInstanceTransform(InstanceHandle handle, const glm::mat4& transform)
+{
+	auto& instance = GetRetainedInstance(handle);
+	instance.Transform = transform;
+
+	MarkRetainedInstanceDirty((uint32_t)handle);
+}
+
+void Renderer::SetInstanceMaterial(InstanceHandle handle, MaterialHandle material)
+{
+	NV_CHECK(IsMaterialAlive((uint32_t)material), "Invalid material handle.");
+
+	auto& instance = GetRetainedInstance(handle);
+	if (IsTransparentMaterial(s_Materials[instance.MaterialIndex]) != IsTransparentMaterial(s_Materials[(uint32_t)material]))
+		s_RetainedMembershipChanged = true;
+
+	s_MaterialInstanceCounts[(uint32_t)material]++;
+	ReleaseMaterialReference(instance.MaterialIndex);
+	instance.MaterialIndex = (uint32_t)material;
+
+	MarkRetainedInstanceDirty((uint32_t)handle);
+}
+
+void Renderer::DestroyInstance(InstanceHandle handle)
+{
+	auto& instance = GetRetainedInstance(handle);
+	instance.IsAlive = false;
+	ReleaseMaterialReference(instance.MaterialIndex);
+
+	// table entry is left as is, it's no longer referenced once instance lists are rebuilt
+	s_FreeRetainedInstances.push_back((uint32_t)handle);
+	s_RetainedMembershipChanged = true;
+}
+
+void Renderer::SetCamera(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& position)
+{
+    NV_PROFILE_FUNC;
+
+	auto cameraData = s_CameraDataBuffer.GetDataPtr<CameraData>();
+	cameraData->ViewMatrix = view;
+	cameraData->ProjectionMatrix = projection;
+	cameraData->Position = position;
+
+	s_CameraPosition = position;
+	s_CameraFrustum = Frustum(projection * view);
+
+	// view space depth of a point is a single dot product with negated third row of view matrix
+	s_CameraViewDepthRow = -glm::vec4(view[0][2], view[1][2], view[2][2], view[3][2]);
+	s_ProjectionScaleY = projection[1][1];
+
+	s_InverseProjection = glm::inverse(projection);
+	s_ViewProjection = projection * view;
+	s_InverseViewProjection = glm::inverse(s_ViewProjection);
+
+	// depth range of cluster grid comes from projection, perspective one has z = -(n + f) / (f - n), w = -2nf / (f - n),
+	// orthographic one has z = -2 / (f - n), w = -(f + n) / (f - n) and no perspective divide
+	s_IsOrthographicProjection = projection[2][3] == 0.0f;
+	const auto clusterNear = s_IsOrthographicProjection
+		? (projection[3][2] + 1.0f) / projection[2][2]
+		: projection[3][2] / (projection[2][2] - 1.0f);
+	const auto clusterFar = s_IsOrthographicProjection
+		? (projection[3][2] - 1.0f) / projection[2][2]
+		: projection[3][2] / (projection[2][2] + 1.0f);
+
+	// slices are distributed logarithmically, so orthographic near plane at or behind the camera is clamped as well
+	s_ClusterNear = std::max(clusterNear, 1e-3f);
+	s_ClusterFar = std::max(clusterFar, s_ClusterNear * 2.0f);
+}
+
+const RendererInfo& Renderer::GetInfo() noexcept
+{
+	return s_RendererInfo;
+}
+
+const ShaderCacheStats& Renderer::GetShaderCacheStats() noexcept
+{
+	return s_ShaderCache.GetStats();
+}
+
+UploadQueue& Renderer::GetUploadQueue() noexcept
+{
+	return *s_UploadQueue;
+}
+
+TextureStreamer& Renderer::GetTextureStreamer() noexcept
+{
+	NV_CHECK(s_TextureStreamer != nullptr, "Texture streaming is disabled.");
+
+	return *s_TextureStreamer;
+}
+
+void Renderer::SetViewport(const Rect<int>& viewport) noexcept
+{
+    NV_PROFILE_FUNC;
+	
+	glViewport(viewport.X, viewport.Y, viewport.Width, viewport.Height);
+}
+
+void Renderer::SetViewport(
+	const Rect<int>& viewport,
+	const Rect<int>& scissor) noexcept
+{
+    NV_PROFILE_FUNC;
+	
+	glViewport(viewport.X, viewport.Y, viewport.Width, viewport.Height);
+	glScissor(scissor.X, scissor.Y, scissor.Width, scissor.Height);
+}
+
+void Renderer::AddPointLight(const glm::vec4& color, const glm::vec3& position, float radius)
+{
+	NV_PROFILE_FUNC;
+
+	if (s_PointLightsCount >= s_MaxPointLightsCount)
+		return;
+
+	auto& data = s_PointLights[s_PointLightsCount++];
+	data.Color = color;
+	data.Position = position;
+	data.Radius = radius;
+}
+
+void Renderer::AddDirectionalLight(const glm::vec4& color, const glm::vec3& direction)
+{
+	NV_PROFILE_FUNC;
+
+	if (s_DirLightsCount >= s_MaxDirLightsCount)
+		return;
+
+	auto& data = s_DirLights[s_DirLightsCount++];
+	data.Color = color;
+	data.Direction = direction;
+}
+
+void Renderer::SetClearColor(float r, float g, float b, float a) noexcept
+{
+	GL::ClearColor(r, g, b, a);
+}
+
+void Renderer::SetClearColor(const glm::vec4& color) noexcept
+{
+	GL::ClearColor(color);
+}
+
+void Renderer::Clear(ClearMask mask) noexcept
+{
+	NV_PROFILE_FUNC;
+
+	GL::Clear(mask);
+}
+
+void Renderer::SetPolygonMode(PolygonMode mode) noexcept
+{
+	glPolygonMode(GL_FRONT_AND_BACK, (GLenum)mode);
+}
+
+static Buffer GrowGeometryBuffer(Buffer& buffer, GLsizeiptr usedSize, GLsizeiptr requiredSize)
+{
+	NV_PROFILE_FUNC;
+
+	auto newSize = std::max(buffer.GetSize(), (GLsizeiptr)1);
+	while (newSize < requiredSize)
+		newSize *= 2;
+
+	Buffer newBuffer(newSize);
+
+	if (usedSize > 0)
+		GL::CopyNamedBufferSubData(
+			(GLuint)buffer.GetID(),
+			(GLuint)newBuffer.GetID(),
+			0,
+			0,
+			usedSize);
+
+	buffer.Delete();
+
+	return newBuffer;
+}
+
+// vertex arrays follow buffers of mesh allocator, which are replaced when they grow or get defragmented
+static void BindMeshBuffers()
+{
+	s_VertexArray.BindVertexBuffer(
+		s_MeshAllocator.GetVertexBuffer(),
+		c_ModelDataBufferBinding,
+		sizeof(ModelVertex));
+	s_VertexArray.BindElementBuffer(s_MeshAllocator.GetIndexBuffer());
+
+	s_RetainedVertexArray.BindVertexBuffer(
+		s_MeshAllocator.GetVertexBuffer(),
+		c_ModelDataBufferBinding,
+		sizeof(ModelVertex));
+	s_RetainedVertexArray.BindElementBuffer(s_MeshAllocator.GetIndexBuffer());
+
+	s_BoundMeshVersion = s_MeshAllocator.GetVersion();
+}
+
+static MeshHandle GetModelMesh(const Model* model)
+{
+	NV_CHECK(model->GetMesh().has_value(), "Model has no mesh.");
+
+	return model->GetMesh().value();
+}
+
+static ModelGeometry GetModelGeometry(const Model* model)
+{
+	const auto& range = s_MeshAllocator.GetRange(GetModelMesh(model));
+
+	return ModelGeometry {
+		.Offsets = DataOffsets {
+			.VertexOffset = range.BaseVertex,
+			.IndexOffset = range.BaseIndex,
+		},
+		.IndexCount = range.IndexCount,
+	};
+}
+
+// main context waits on GPU for copies of the upload thread, before meshes are drawn or their buffers are replaced
+static void AcquireMeshUploads()
+{
+	NV_PROFILE_FUNC;
+
+	const auto uploads = std::exchange(s_PendingMeshUploads, {});
+	for (const auto& upload : uploads)
+		s_UploadQueue->AcquireBufferRegions(upload.Upload);
+}
+
+// meshes only move between frames, so no recorded draw still refers to their old offsets
+static void DefragmentMeshes()
+{
+	NV_PROFILE_FUNC;
+
+	if (s_MeshAllocator.GetFragmentation() <= c_MaxMeshFragmentation)
+		return;
+
+	s_MeshAllocator.Defragment();
+	BindMeshBuffers();
+
+	// draw commands of GPU culling copy mesh offsets, so batches are rebuilt
+	s_RetainedMembershipChanged = true;
+}
+
+MeshHandle Renderer::CreateMesh(
+	std::span<const ModelVertex> vertices,
+	std::span<const GLuint> indices,
+	std::shared_ptr<const void> dataOwner)
+{
+	NV_PROFILE_FUNC;
+
+	// growing copies buffers on main context, which has to see every copy into them first
+	if (!s_MeshAllocator.Fits((GLuint)vertices.size(), (GLuint)indices.size()))
+		AcquireMeshUploads();
+
+	const auto mesh = s_MeshAllocator.Allocate((GLuint)vertices.size(), (GLuint)indices.size());
+	if (s_MeshAllocator.GetVersion() != s_BoundMeshVersion)
+		BindMeshBuffers();
+
+	if (dataOwner == nullptr)
+	{
+		auto data = std::make_shared<std::pair<std::vector<ModelVertex>, std::vector<GLuint>>>(
+			std::vector<ModelVertex>(vertices.begin(), vertices.end()),
+			std::vector<GLuint>(indices.begin(), indices.end()));
+		vertices = data->first;
+		indices = data->second;
+		dataOwner = std::move(data);
+	}
+
+	const auto& range = s_MeshAllocator.GetRange(mesh);
+	std::vector<BufferRegionUpload> regions {
+		BufferRegionUpload {
+			.Destination = (GLuint)s_MeshAllocator.GetVertexBuffer().GetID(),
+			.Offset = (GLintptr)range.BaseVertex * (GLintptr)sizeof(ModelVertex),
+			.Data = std::as_bytes(vertices),
+		},
+		BufferRegionUpload {
+			.Destination = (GLuint)s_MeshAllocator.GetIndexBuffer().GetID(),
+			.Offset = (GLintptr)range.BaseIndex * (GLintptr)sizeof(GLuint),
+			.Data = std::as_bytes(indices),
+		},
+	};
+
+	s_PendingMeshUploads.push_back(PendingMeshUpload {
+		.Upload = s_UploadQueue->UploadBufferRegions(std::move(regions)),
+		.DataOwner = std::move(dataOwner),
+	});
+
+	return mesh;
+}
+
+void Renderer::DestroyMesh(MeshHandle mesh)
+{
+	// space is reused right away, copies into it are ordered after draws of previous frames which read it
+	s_MeshAllocator.Free(mesh);
+}
+
+// models without levels of detail are drawn whole as their only level
+static ModelLOD GetModelLOD(const Model* model, const ModelGeometry& geometry, uint32_t lod) noexcept
+{
+	const auto lods = model->GetLODs();
+
+	return lods.empty()
+		? ModelLOD { .FirstIndex = 0, .IndexCount = geometry.IndexCount, .MinScreenSize = 0.0f }
+		: lods[lod];
+}
+
+static void AppendDrawCommand(
+	const Model* model,
+	uint32_t lod,
+	GLuint instanceCount,
+	GLuint baseInstance,
+	GLuint instanceBufferID)
+{
+	const auto& geometry = GetModelGeometry(model);
+	const auto modelLOD = GetModelLOD(model, geometry, lod);
+
+	s_DrawnIndexCount += (size_t)modelLOD.IndexCount * instanceCount;
+
+	s_DrawCommands.emplace_back(
+		DrawCommand {
+			.Count = modelLOD.IndexCount,
+			.InstanceCount = instanceCount,
+			.BaseIndex = geometry.Offsets.IndexOffset + modelLOD.FirstIndex,
+			.BaseVertex = (GLint)geometry.Offsets.VertexOffset,
+			.BaseInstance = baseInstance,
+		});
+
+	// consecutive commands using the same primitive mode and instance buffer are merged into single multi draw call
+	const auto primitiveMode = model->GetPrimitiveMode();
+	if (!s_DrawRanges.empty() &&
+		s_DrawRanges.back().PrimitiveMode == primitiveMode &&
+		s_DrawRanges.back().InstanceBufferID == instanceBufferID)
+	{
+		s_DrawRanges.back().Count++;
+	}
+	else
+	{
+		s_DrawRanges.emplace_back(
+			DrawCommandRange {
+				.PrimitiveMode = primitiveMode,
+				.InstanceBufferID = instanceBufferID,
+				.First = (GLsizei)s_DrawCommands.size() - 1,
+				.Count = 1,
+			});
+	}
+}
+
+static void RecordDrawCommand(const Model* model, uint32_t lod, const std::span<const RenderQueueEntry> entries)
+{
+	NV_PROFILE_FUNC;
+
+	if (entries.empty())
+		return;
+
+	// each batch gets its own region of instance buffer, so it never has to wait for previous batches,
+	// payloads are gathered straight into it in sorted order
+	const auto instanceAllocation = s_InstanceBuffer.Allocate(
+		entries.size() * s_InstanceStride,
+		s_InstanceStride);
+
+	if (s_UseCompactInstanceData)
+	{
+		auto instanceData = instanceAllocation.As<CompactInstanceData>();
+		for (const auto& entry : entries)
+			*instanceData++ = PackCompactInstanceData(s_RenderQueue.GetPayload(entry));
+	}
+	else
+	{
+		auto instanceData = instanceAllocation.As<InstanceData>();
+		for (const auto& entry : entries)
+			*instanceData++ = s_RenderQueue.GetPayload(entry);
+	}
+
+	s_InstanceBuffer.Commit(instanceAllocation);
+
+	NV_PROFILE_COUNTER("Renderer::InstanceBytes", (float)instanceAllocation.Size);
+
+	AppendDrawCommand(
+		model,
+		lod,
+		(GLuint)entries.size(),
+		(GLuint)(instanceAllocation.Offset / s_InstanceStride),
+		instanceAllocation.BufferID);
+}
+
+static void SubmitDrawCommands(
+	VertexArray& vertexArray,
+	GLuint& boundInstanceBufferID,
+	GLsizei instanceStride) noexcept
+{
+	NV_PROFILE_FUNC;
+
+	if (s_DrawCommands.empty())
+		return;
+
+	const auto commandsAllocation = s_DrawCommandBuffer.Write(std::span<const DrawCommand>(s_DrawCommands));
+	s_DrawCommandBuffer.Commit(commandsAllocation);
+
+	GL::BindBuffer(BufferBindTarget::DrawIndirectBuffer, commandsAllocation.BufferID);
+
+	for (const auto& range : s_DrawRanges)
+	{
+		if (range.InstanceBufferID != boundInstanceBufferID)
+		{
+			vertexArray.BindVertexBuffer(
+				BufferID(range.InstanceBufferID),
+				c_InstanceDataBufferBinding,
+				instanceStride);
+			boundInstanceBufferID = range.InstanceBufferID;
+		}
+
+		glMultiDrawElementsIndirect(
+			range.PrimitiveMode,
+			GL_UNSIGNED_INT,
+			(const void*)(commandsAllocation.Offset + range.First * sizeof(DrawCommand)),
+			range.Count,
+			sizeof(DrawCommand));
+	}
+
+	NV_PROFILE_COUNTER("Renderer::DrawCommands", (float)s_DrawCommands.size());
+
+	s_DrawCommands.clear();
+	s_DrawRanges.clear();
+
+	s_InstanceBuffer.Fence();
+	s_DrawCommandBuffer.Fence();
+}
+
+static Buffer GrowTableBuffer(Buffer& buffer, GLsizeiptr requiredSize, const std::string_view debugName)
+{
+	auto newBuffer = GrowGeometryBuffer(buffer, buffer.GetSize(), requiredSize);
+	newBuffer.SetDebugName(debugName);
+
+	NV_LOG_INFO("Grew buffer \"{}\" to {} bytes.", debugName, newBuffer.GetSize());
+
+	return newBuffer;
+}
+
+static void EnsureBufferSize(Buffer& buffer, GLsizeiptr requiredSize, const std::string_view debugName)
+{
+	if (requiredSize <= buffer.GetSize())
+		return;
+
+	// contents are rewritten before use, so unlike GrowTableBuffer nothing is copied
+	auto newSize = std::max(buffer.GetSize(), (GLsizeiptr)1);
+	while (newSize < requiredSize)
+		newSize *= 2;
+
+	buffer.Delete();
+	buffer = Buffer(newSize);
+	buffer.SetDebugName(debugName);
+}
+
+static void UploadCullBatches()
+{
+	NV_PROFILE_FUNC;
+
+	s_RetainedBatchGroups.clear();
+
+	std::vector<GPUCullBatch> cullBatches;
+	cullBatches.reserve(s_RetainedBatches.size());
+
+	for (GLuint batchIndex = 0; batchIndex < (GLuint)s_RetainedBatches.size(); batchIndex++)
+	{
+		const auto& batch = s_RetainedBatches[batchIndex];
+		const auto primitiveMode = batch.TargetModel->GetPrimitiveMode();
+
+		if (s_RetainedBatchGroups.empty() || s_RetainedBatchGroups.back().PrimitiveMode != primitiveMode)
+		{
+			s_RetainedBatchGroups.emplace_back(
+				RetainedBatchGroup {
+					.PrimitiveMode = primitiveMode,
+					.FirstBatch = batchIndex,
+					.BatchCount = 0,
+				});
+		}
+
+		auto& group = s_RetainedBatchGroups.back();
+		group.BatchCount++;
+
+		const auto& geometry = GetModelGeometry(batch.TargetModel);
+		const auto modelLOD = GetModelLOD(batch.TargetModel, geometry, 0);
+		const auto& sphere = batch.TargetModel->GetBounds().Sphere;
+
+		cullBatches.emplace_back(
+			GPUCullBatch {
+				.BoundingSphere = glm::vec4(sphere.Center, sphere.Radius),
+				.IndexCount = modelLOD.IndexCount,
+				.BaseIndex = geometry.Offsets.IndexOffset + modelLOD.FirstIndex,
+				.BaseVertex = (GLint)geometry.Offsets.VertexOffset,
+				.FirstInstance = batch.First,
+				.CommandOffset = group.FirstBatch,
+				.DrawCountIndex = (GLuint)s_RetainedBatchGroups.size() - 1,
+			});
+	}
+
+	std::vector<glm::uvec2> candidates;
+	candidates.reserve(s_RetainedInstanceIndices.size());
+	for (GLuint batchIndex = 0; batchIndex < (GLuint)s_RetainedBatches.size(); batchIndex++)
+	{
+		const auto& batch = s_RetainedBatches[batchIndex];
+		for (GLuint i = 0; i < batch.Count; i++)
+			candidates.emplace_back(s_RetainedInstanceIndices[batch.First + i], batchIndex);
+	}
+
+	EnsureBufferSize(s_CullBatchBuffer, cullBatches.size() * sizeof(GPUCullBatch), "CullBatchBuffer");
+	EnsureBufferSize(s_CullCandidateBuffer, candidates.size() * sizeof(glm::uvec2), "CullCandidateBuffer");
+	EnsureBufferSize(s_BatchInstanceCountBuffer, cullBatches.size() * sizeof(GLuint), "BatchInstanceCountBuffer");
+	EnsureBufferSize(s_CulledIndexBuffer, candidates.size() * sizeof(GLuint), "CulledIndexBuffer");
+	if (s_UseOcclusionCulling)
+		EnsureBufferSize(s_OccludedCandidateBuffer, candidates.size() * sizeof(GLuint), "OccludedCandidateBuffer");
+	EnsureBufferSize(s_CulledDrawCommandBuffer, cullBatches.size() * sizeof(DrawCommand), "CulledDrawCommandBuffer");
+	EnsureBufferSize(s_CulledDrawCountBuffer, s_RetainedBatchGroups.size() * sizeof(GLuint), "CulledDrawCountBuffer");
+
+	const auto batchStaging = s_UploadBuffer.Write(std::span<const GPUCullBatch>(cullBatches));
+	s_UploadBuffer.Commit(batchStaging);
+	GL::CopyNamedBufferSubData(
+		batchStaging.BufferID,
+		(GLuint)s_CullBatchBuffer.GetID(),
+		batchStaging.Offset,
+		0,
+		batchStaging.Size);
+
+	const auto candidateStaging = s_UploadBuffer.Write(std::span<const glm::uvec2>(candidates));
+	s_UploadBuffer.Commit(candidateStaging);
+	GL::CopyNamedBufferSubData(
+		candidateStaging.BufferID,
+		(GLuint)s_CullCandidateBuffer.GetID(),
+		candidateStaging.Offset,
+		0,
+		candidateStaging.Size);
+
+	s_UploadBuffer.Fence();
+}
+
+static void RebuildRetainedBatches()
+{
+	NV_PROFILE_FUNC;
+
+	s_RetainedMembershipChanged = false;
+
+	s_RetainedBatches.clear();
+	s_RetainedInstanceIndices.clear();
+	s_RetainedTransparentInstances.clear();
+
+	// instances are grouped by model with a sort of (model, index) pairs, so the lists are deterministic,
+	// models are ordered by primitive mode first, so that batches sharing it are adjacent
+	std::vector<std::pair<const Model*, GLuint>> opaqueInstances;
+	for (GLuint index = 0; index < (GLuint)s_RetainedInstances.size(); index++)
+	{
+		const auto& instance = s_RetainedInstances[index];
+		if (!instance.IsAlive)
+			continue;
+
+		if (IsTransparentMaterial(s_Materials[instance.MaterialIndex]))
+			s_RetainedTransparentInstances.push_back(index);
+		else
+			opaqueInstances.emplace_back(instance.TargetModel, index);
+	}
+
+	std::sort(
+		opaqueInstances.begin(),
+		opaqueInstances.end(),
+		[](const auto& a, const auto& b)
+		{
+			const auto aMode = a.first->GetPrimitiveMode();
+			const auto bMode = b.first->GetPrimitiveMode();
+			if (aMode != bMode)
+				return aMode < bMode;
+
+			return std::less<const Model*>()(a.first, b.first) || (a.first == b.first && a.second < b.second);
+		});
+
+	for (const auto& [model, index] : opaqueInstances)
+	{
+		if (s_RetainedBatches.empty() || s_RetainedBatches.back().TargetModel != model)
+		{
+			s_RetainedBatches.emplace_back(
+				RetainedBatch {
+					.TargetModel = model,
+					.First = (GLuint)s_RetainedInstanceIndices.size(),
+					.Count = 0,
+				});
+		}
+
+		s_RetainedInstanceIndices.push_back(index);
+		s_RetainedBatches.back().Count++;
+	}
+
+	if (s_RetainedInstanceIndices.empty())
+		return;
+
+	if (s_UseGPUCulling)
+	{
+		UploadCullBatches();
+		return;
+	}
+
+	const auto requiredSize = (GLsizeiptr)(s_RetainedInstanceIndices.size() * sizeof(GLuint));
+	if (requiredSize > s_RetainedIndexBuffer.GetSize())
+		s_RetainedIndexBuffer = GrowTableBuffer(s_RetainedIndexBuffer, requiredSize, "RetainedIndexBuffer");
+
+	const auto staging = s_UploadBuffer.Write(std::span<const GLuint>(s_RetainedInstanceIndices));
+	s_UploadBuffer.Commit(staging);
+
+	GL::CopyNamedBufferSubData(
+		staging.BufferID,
+		(GLuint)s_RetainedIndexBuffer.GetID(),
+		staging.Offset,
+		0,
+		requiredSize);
+
+	s_UploadBuffer.Fence();
+}
+
+static void UploadRetainedInstances()
+{
+	NV_PROFILE_FUNC;
+
+	if (s_RetainedInstances.size() > s_RetainedInstanceCapacity)
+	{
+		s_RetainedInstanceTable = GrowTableBuffer(
+			s_RetainedInstanceTable,
+			s_RetainedInstances.size() * sizeof(GPUInstanceData),
+			"RetainedInstanceTable");
+		s_RetainedInstanceCapacity = (GLuint)(s_RetainedInstanceTable.GetSize() / sizeof(GPUInstanceData));
+	}
+
+	if (s_RetainedMembershipChanged)
+		RebuildRetainedBatches();
+
+	NV_PROFILE_COUNTER("Renderer::RetainedInstanceUpdates", (float)s_DirtyRetainedInstances.size());
+
+	if (s_DirtyRetainedInstances.empty())
+		return;
+
+	s_NormalTransformInputs.clear();
+	for (const auto index : s_DirtyRetainedInstances)
+		s_NormalTransformInputs.push_back(s_RetainedInstances[index].Transform);
+
+	s_NormalTransformOutputs.resize(s_NormalTransformInputs.size());
+	BuildNormalMatrices(s_NormalTransformInputs, s_NormalTransformOutputs);
+
+	const auto updateCount = (GLuint)s_DirtyRetainedInstances.size();
+	const auto staging = s_UploadBuffer.Allocate(
+		updateCount * sizeof(InstanceUpdate),
+		s_StorageBufferOffsetAlignment);
+
+	auto update = staging.As<InstanceUpdate>();
+	for (GLuint i = 0; i < updateCount; i++)
+	{
+		const auto index = s_DirtyRetainedInstances[i];
+		auto& instance = s_RetainedInstances[index];
+		const auto& normalTransform = s_NormalTransformOutputs[i];
+
+		*update++ = InstanceUpdate {
+			.Index = index,
+			.Data = GPUInstanceData {
+				.Transform = instance.Transform,
+				.NormalTransform = {
+					glm::vec4(normalTransform[0], 0.0f),
+					glm::vec4(normalTransform[1], 0.0f),
+					glm::vec4(normalTransform[2], 0.0f),
+				},
+				.MaterialIndex = instance.MaterialIndex,
+			},
+		};
+
+		instance.IsDirty = false;
+	}
+
+	s_UploadBuffer.Commit(staging);
+
+	s_InstanceScatterProgram.SetUniform("uUpdateCount", updateCount);
+	s_InstanceScatterProgram.Use();
+
+	s_RetainedInstanceTable.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_InstanceScatterProgram.GetResourceLocation("sInstanceData"));
+	GL::BindBufferRange(
+		BufferBaseTarget::ShaderStorageBuffer,
+		s_InstanceScatterProgram.GetResourceLocation("sInstanceUpdates"),
+		staging.BufferID,
+		staging.Offset,
+		staging.Size);
+
+	glDispatchCompute((updateCount + c_InstanceScatterGroupSize - 1) / c_InstanceScatterGroupSize, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	s_UploadBuffer.Fence();
+
+	s_DirtyRetainedInstances.clear();
+}
+
+static void SubmitRetainedTransparentInstances()
+{
+	NV_PROFILE_FUNC;
+
+	for (const auto index : s_RetainedTransparentInstances)
+	{
+		const auto& instance = s_RetainedInstances[index];
+		SubmitInstance(instance.TargetModel, MaterialHandle(instance.MaterialIndex), instance.Transform, nullptr);
+	}
+}
+
+static void ClearCullCounters()
+{
+	// counters are reset on GPU, so culling doesn't need any per frame uploads
+	const GLuint zero = 0;
+	glClearNamedBufferSubData(
+		(GLuint)s_BatchInstanceCountBuffer.GetID(),
+		GL_R32UI,
+		0,
+		s_RetainedBatches.size() * sizeof(GLuint),
+		GL_RED_INTEGER,
+		GL_UNSIGNED_INT,
+		&zero);
+	glClearNamedBufferSubData(
+		(GLuint)s_CulledDrawCountBuffer.GetID(),
+		GL_R32UI,
+		0,
+		s_RetainedBatchGroups.size() * sizeof(GLuint),
+		GL_RED_INTEGER,
+		GL_UNSIGNED_INT,
+		&zero);
+}
+
+static void BindRetainedCullBuffers()
+{
+	s_RetainedInstanceTable.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_RetainedCullProgram.GetResourceLocation("sInstanceData"));
+	s_CullBatchBuffer.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_RetainedCullProgram.GetResourceLocation("sCullBatches"));
+	s_CullCandidateBuffer.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_RetainedCullProgram.GetResourceLocation("sCullCandidates"));
+	s_BatchInstanceCountBuffer.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_RetainedCullProgram.GetResourceLocation("sBatchInstanceCounts"));
+	s_CulledIndexBuffer.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_RetainedCullProgram.GetResourceLocation("sCulledInstanceIndices"));
+	s_MaterialScreenSizeBuffer.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_RetainedCullProgram.GetResourceLocation("sMaterialScreenSizes"));
+
+	if (s_UseOcclusionCulling)
+	{
+		s_OcclusionStateBuffer.Bind(
+			BindingTarget::ShaderStorageBuffer,
+			s_RetainedCullProgram.GetResourceLocation("sOcclusionState"));
+		s_OccludedCandidateBuffer.Bind(
+			BindingTarget::ShaderStorageBuffer,
+			s_RetainedCullProgram.GetResourceLocation("sOccludedCandidates"));
+	}
+}
+
+static void WriteCulledDrawCommands()
+{
+	s_RetainedDrawCommandsProgram.SetUniform("uBatchCount", (GLuint)s_RetainedBatches.size());
+	s_RetainedDrawCommandsProgram.SetUniform("uCompactCommands", (GLuint)s_HasIndirectDrawCount);
+	s_RetainedDrawCommandsProgram.Use();
+
+	s_CullBatchBuffer.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_RetainedDrawCommandsProgram.GetResourceLocation("sCullBatches"));
+	s_BatchInstanceCountBuffer.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_RetainedDrawCommandsProgram.GetResourceLocation("sBatchInstanceCounts"));
+	s_CulledDrawCommandBuffer.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_RetainedDrawCommandsProgram.GetResourceLocation("sDrawCommands"));
+	s_CulledDrawCountBuffer.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_RetainedDrawCommandsProgram.GetResourceLocation("sDrawCounts"));
+
+	glDispatchCompute(((GLuint)s_RetainedBatches.size() + c_CullGroupSize - 1) / c_CullGroupSize, 1, 1);
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+}
+
+static void ReportOcclusionStats()
+{
+	// statistics of previous frame were copied before its fence, which has already been waited for
+	const auto& stats = s_OcclusionStatsBuffer.GetDataPtr<OcclusionState>()[(s_FrameIndex + 1) % c_OcclusionStatsFrameCount];
+
+	NV_PROFILE_COUNTER("Renderer::OcclusionVisibleInstances", (float)stats.VisibleCount);
+	NV_PROFILE_COUNTER("Renderer::OccludedInstances", (float)(stats.OccludedCount - stats.DisoccludedCount));
+	NV_PROFILE_COUNTER("Renderer::DisoccludedInstances", (float)stats.DisoccludedCount);
+}
+
+// part of viewport height covered by bounding sphere, camera inside the sphere counts as infinitely large
+static float GetScreenSize(float radius, float viewDepth) noexcept
+{
+	return viewDepth > radius
+		? s_ProjectionScaleY * radius / viewDepth
+		: std::numeric_limits<float>::infinity();
+}
+
+// without GPU culling retained opaque instances are all drawn, those inside the frustum are measured on CPU
+static void MeasureRetainedInstances()
+{
+	NV_PROFILE_FUNC;
+
+	for (const auto index : s_RetainedInstanceIndices)
+	{
+		const auto& instance = s_RetainedInstances[index];
+		const auto& sphere = instance.TargetModel->GetBounds().Sphere;
+		const auto& transform = instance.Transform;
+
+		const auto center = glm::vec3(transform * glm::vec4(sphere.Center, 1.0f));
+		const auto scale = std::sqrt(std::max({
+			glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+			glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])),
+			glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2])),
+		}));
+		const auto radius = sphere.Radius * scale;
+
+		if (!s_CameraFrustum.Intersects(BoundingSphere { .Center = center, .Radius = radius }))
+			continue;
+
+		const auto viewDepth = glm::dot(s_CameraViewDepthRow, glm::vec4(center, 1.0f));
+		auto& materialScreenSize = s_MaterialScreenSizes[instance.MaterialIndex];
+		materialScreenSize = std::max(materialScreenSize, GetScreenSize(radius, viewDepth));
+	}
+}
+
+// sizes of the previous frame were copied before its fence, which has already been waited for
+static void ReadRetainedScreenSizes()
+{
+	if (!s_HasRetainedScreenSizes)
+		return;
+
+	s_HasRetainedScreenSizes = false;
+
+	const auto slot = (s_FrameIndex + 1) % c_MaterialScreenSizeFrameCount;
+	const auto* sizes = s_MaterialScreenSizeReadbackBuffer.GetDataPtr<GLuint>() + slot * s_MaterialsCapacity;
+	const auto count = std::min(s_MaterialScreenSizes.size(), (size_t)s_MaterialsCapacity);
+	for (size_t i = 0; i < count; i++)
+		s_MaterialScreenSizes[i] = std::max(s_MaterialScreenSizes[i], std::bit_cast<float>(sizes[i]));
+}
+
+static void CopyRetainedScreenSizes()
+{
+	glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+	GL::CopyNamedBufferSubData(
+		(GLuint)s_MaterialScreenSizeBuffer.GetID(),
+		(GLuint)s_MaterialScreenSizeReadbackBuffer.GetID(),
+		0,
+		(s_FrameIndex % c_MaterialScreenSizeFrameCount) * s_MaterialsCapacity * sizeof(GLuint),
+		s_MaterialsCapacity * sizeof(GLuint));
+
+	s_HasRetainedScreenSizes = true;
+}
+
+static void CullRetainedInstances()
+{
+	NV_PROFILE_FUNC;
+
+	if (!s_UseGPUCulling)
+	{
+		MeasureRetainedInstances();
+		return;
+	}
+
+	// visible retained instances are measured by culling, so their sizes are one frame behind
+	ReadRetainedScreenSizes();
+
+	if (s_RetainedBatches.empty())
+		return;
+
+	const auto candidateCount = (GLuint)s_RetainedInstanceIndices.size();
+	const GLuint zero = 0;
+
+	ClearCullCounters();
+	glClearNamedBufferData((GLuint)s_MaterialScreenSizeBuffer.GetID(), GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+	s_RetainedCullProgram.SetUniform("uCandidateCount", candidateCount);
+	s_RetainedCullProgram.SetUniform("uFrustumPlanes", std::span<const glm::vec4>(s_CameraFrustum.GetPlanes()));
+	s_RetainedCullProgram.SetUniform("uViewDepthRow", s_CameraViewDepthRow);
+	s_RetainedCullProgram.SetUniform("uProjectionScaleY", s_ProjectionScaleY);
+
+	if (s_UseOcclusionCulling)
+	{
+		ReportOcclusionStats();
+
+		// phase 1 dispatch arguments start as zero groups, which phase 0 raises while appending occluded candidates
+		const GLuint one = 1;
+		glClearNamedBufferData((GLuint)s_OcclusionStateBuffer.GetID(), GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+		glClearNamedBufferSubData(
+			(GLuint)s_OcclusionStateBuffer.GetID(),
+			GL_R32UI,
+			sizeof(GLuint),
+			2 * sizeof(GLuint),
+			GL_RED_INTEGER,
+			GL_UNSIGNED_INT,
+			&one);
+
+		s_RetainedCullProgram.SetUniform("uPhase", 0u);
+		s_RetainedCullProgram.SetUniform("uTestOcclusion", (GLuint)s_HasHiZ);
+		if (s_HasHiZ)
+		{
+			s_RetainedCullProgram.SetUniform("uHiZViewProjection", s_HiZViewProjection);
+			s_RetainedCullProgram.SetUniform("uHiZDepthSize", glm::ivec2(s_HiZDepthWidth, s_HiZDepthHeight));
+			s_RetainedCullProgram.SetUniform("uHiZLevelCount", (int32_t)s_HiZLevelCount);
+			glBindTextureUnit(0, s_HiZTexture);
+		}
+	}
+
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	s_RetainedCullProgram.Use();
+	BindRetainedCullBuffers();
+
+	glDispatchCompute((candidateCount + c_CullGroupSize - 1) / c_CullGroupSize, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	WriteCulledDrawCommands();
+
+	// with occlusion culling, instances visible in phase 1 are measured too
+	if (!s_UseOcclusionCulling)
+		CopyRetainedScreenSizes();
+
+	NV_PROFILE_COUNTER("Renderer::GPUCullCandidates", (float)candidateCount);
+}
+
+static void BuildHiZ()
+{
+	NV_PROFILE_FUNC;
+
+	const auto depthWidth = s_CurrentDisplayWidth;
+	const auto depthHeight = s_CurrentDisplayHeight;
+
+	// level 0 has half resolution of depth buffer, every level is half of the previous one rounded down
+	if (s_HiZTexture == 0 || s_HiZDepthWidth != depthWidth || s_HiZDepthHeight != depthHeight)
+	{
+		if (s_HiZTexture != 0)
+			glDeleteTextures(1, &s_HiZTexture);
+
+		const auto width = std::max(depthWidth / 2, 1);
+		const auto height = std::max(depthHeight / 2, 1);
+
+		s_HiZLevelCount = (GLsizei)std::bit_width((GLuint)std::max(width, height));
+		s_HiZTexture = GL::CreateTexture(TextureTarget::Texture2D);
+		GL::TextureStorage2D(s_HiZTexture, s_HiZLevelCount, InternalFormat::R32F, width, height);
+		s_HiZDepthWidth = depthWidth;
+		s_HiZDepthHeight = depthHeight;
+	}
+
+	const auto depthAttachmentIndex = s_UseCompactGBuffer ? 2 : 3;
+	glBindTextureUnit(0, s_Framebuffer.GetAttachment(depthAttachmentIndex).AttachmentID);
+
+	glm::ivec2 sourceSize(depthWidth, depthHeight);
+	for (GLsizei level = 0; level < s_HiZLevelCount; level++)
+	{
+		const glm::ivec2 destinationSize(std::max(sourceSize.x / 2, 1), std::max(sourceSize.y / 2, 1));
+		const auto& program = level == 0 ? s_HiZFromDepthProgram : s_HiZDownsampleProgram;
+
+		program.SetUniform("uSourceSize", sourceSize);
+		program.SetUniform("uDestinationSize", destinationSize);
+		program.Use();
+
+		if (level > 0)
+			glBindImageTexture(0, s_HiZTexture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		glBindImageTexture(1, s_HiZTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		glDispatchCompute(
+			(destinationSize.x + c_HiZGroupSize - 1) / c_HiZGroupSize,
+			(destinationSize.y + c_HiZGroupSize - 1) / c_HiZGroupSize,
+			1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		sourceSize = destinationSize;
+	}
+
+	s_HiZViewProjection = s_ViewProjection;
+	s_HasHiZ = true;
+}
+
+static void CullOccludedRetainedInstances()
+{
+	NV_PROFILE_FUNC;
+
+	// draw commands of phase 0 have been consumed, so its counters and instance lists are reused
+	ClearCullCounters();
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	s_RetainedCullProgram.SetUniform("uPhase", 1u);
+	s_RetainedCullProgram.SetUniform("uTestOcclusion", 1u);
+	s_RetainedCullProgram.SetUniform("uHiZViewProjection", s_HiZViewProjection);
+	s_RetainedCullProgram.SetUniform("uHiZDepthSize", glm::ivec2(s_HiZDepthWidth, s_HiZDepthHeight));
+	s_RetainedCullProgram.SetUniform("uHiZLevelCount", (int32_t)s_HiZLevelCount);
+	s_RetainedCullProgram.Use();
+	BindRetainedCullBuffers();
+	glBindTextureUnit(0, s_HiZTexture);
+
+	GL::BindBuffer(BufferBindTarget::DispatchIndirectBuffer, (GLuint)s_OcclusionStateBuffer.GetID());
+	glDispatchComputeIndirect(0);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	WriteCulledDrawCommands();
+
+	GL::CopyNamedBufferSubData(
+		(GLuint)s_OcclusionStateBuffer.GetID(),
+		(GLuint)s_OcclusionStatsBuffer.GetID(),
+		0,
+		(s_FrameIndex % c_OcclusionStatsFrameCount) * sizeof(OcclusionState),
+		sizeof(OcclusionState));
+
+	CopyRetainedScreenSizes();
 }
 
-void Renderer::AddPointLight(const glm::vec4& color, const glm::vec3& position, float radius)
+static void DrawCulledRetainedInstances()
 {
 	NV_PROFILE_FUNC;
 
-	if (s_PointLightsCount >= s_MaxPointLightsCount)
-		return;
+	const auto culledIndexBufferID = (GLuint)s_CulledIndexBuffer.GetID();
+	if (s_BoundRetainedIndexBufferID != culledIndexBufferID)
+	{
+		s_RetainedVertexArray.BindVertexBuffer(
+			BufferID(culledIndexBufferID),
+			c_InstanceDataBufferBinding,
+			sizeof(GLuint));
+		s_BoundRetainedIndexBufferID = culledIndexBufferID;
+	}
 
-	auto& data = s_PointLights[s_PointLightsCount++];
-	data.Color = color;
-	data.Position = position;
-	data.Radius = radius;
+	GL::BindBuffer(BufferBindTarget::DrawIndirectBuffer, (GLuint)s_CulledDrawCommandBuffer.GetID());
+	if (s_HasIndirectDrawCount)
+		GL::BindBuffer(BufferBindTarget::ParameterBuffer, (GLuint)s_CulledDrawCountBuffer.GetID());
+
+	for (GLuint groupIndex = 0; groupIndex < (GLuint)s_RetainedBatchGroups.size(); groupIndex++)
+	{
+		const auto& group = s_RetainedBatchGroups[groupIndex];
+		const auto commandsOffset = (const void*)(group.FirstBatch * sizeof(DrawCommand));
+
+		if (s_HasIndirectDrawCount)
+		{
+			glMultiDrawElementsIndirectCountARB(
+				group.PrimitiveMode,
+				GL_UNSIGNED_INT,
+				commandsOffset,
+				(GLintptr)(groupIndex * sizeof(GLuint)),
+				group.BatchCount,
+				sizeof(DrawCommand));
+		}
+		else
+		{
+			// batches without visible instances are still submitted, with zero instance count
+			glMultiDrawElementsIndirect(
+				group.PrimitiveMode,
+				GL_UNSIGNED_INT,
+				commandsOffset,
+				group.BatchCount,
+				sizeof(DrawCommand));
+		}
+	}
 }
 
-void Renderer::AddDirectionalLight(const glm::vec4& color, const glm::vec3& direction)
+static void DrawRetainedInstances()
 {
 	NV_PROFILE_FUNC;
 
-	if (s_DirLightsCount >= s_MaxDirLightsCount)
+	if (s_RetainedBatches.empty())
 		return;
 
-	auto& data = s_DirLights[s_DirLightsCount++];
-	data.Color = color;
-	data.Direction = direction;
-}
+	s_RetainedInstanceTable.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_DeferredRetainedGeometryProgram.GetResourceLocation("sInstanceData"));
 
-void Renderer::SetClearColor(float r, float g, float b, float a) noexcept
-{
-	GL::ClearColor(r, g, b, a);
+	s_RetainedVertexArray.Use();
+	s_DeferredRetainedGeometryProgram.Use();
+
+	if (s_UseGPUCulling)
+	{
+		DrawCulledRetainedInstances();
+		return;
+	}
+
+	// instanced attribute of retained vertex array is an index into the instance table
+	for (const auto& batch : s_RetainedBatches)
+	{
+		AppendDrawCommand(
+			batch.TargetModel,
+			0,
+			batch.Count,
+			batch.First,
+			(GLuint)s_RetainedIndexBuffer.GetID());
+	}
+
+	SubmitDrawCommands(s_RetainedVertexArray, s_BoundRetainedIndexBufferID, sizeof(GLuint));
 }
 
-void Renderer::SetClearColor(const glm::vec4& color) noexcept
+static LODSelection SelectModelLOD(const Model* model, float radius, float viewDepth) noexcept
 {
-	GL::ClearColor(color);
+	const auto lods = model->GetLODs();
+	if (lods.size() < 2 || viewDepth <= radius)
+		return {};
+
+	const auto screenSize = GetScreenSize(radius, viewDepth);
+
+	uint32_t lod = 0;
+	while (lod + 1 < lods.size() && screenSize < lods[lod].MinScreenSize)
+		lod++;
+
+	if (lod == 0 || s_LODFadeRange <= 0.0f)
+		return { lod, 0 };
+
+	// right below threshold of the previous level both levels are drawn with complementary dither patterns,
+	// weight of the previous level falls from 1 at its threshold to 0 at the end of fade range
+	const auto threshold = lods[lod - 1].MinScreenSize;
+	const auto fadeEnd = threshold * (1.0f - s_LODFadeRange);
+	if (screenSize < fadeEnd)
+		return { lod, 0 };
+
+	const auto weight = (screenSize - fadeEnd) / (threshold - fadeEnd);
+	const auto quantizedWeight = std::clamp((GLuint)std::lround(weight * 255.0f), 1u, 255u);
+
+	return { lod, quantizedWeight << c_LODFadeShift };
 }
 
-void Renderer::Clear(ClearMask mask) noexcept
+static void CullPendingInstances()
 {
 	NV_PROFILE_FUNC;
 
-	GL::Clear(mask);
-}
+	s_VisibleInstances.clear();
+	s_CameraFrustum.CullSpheres(
+		BoundingSphereBatch {
+			.CenterX = s_PendingBoundsX,
+			.CenterY = s_PendingBoundsY,
+			.CenterZ = s_PendingBoundsZ,
+			.Radius = s_PendingBoundsRadius,
+		},
+		s_VisibleInstances);
 
-void Renderer::SetPolygonMode(PolygonMode mode) noexcept
-{
-	glPolygonMode(GL_FRONT_AND_BACK, (GLenum)mode);
+	if (s_UseSoftwareOcclusionCulling && s_OcclusionCuller.GetOccluderCount() != 0)
+	{
+		s_OcclusionCuller.Rasterize(s_ViewProjection, s_ThreadPool.get());
+
+		const auto occludedCount = s_OcclusionCuller.RemoveOccluded(
+			BoundingSphereBatch {
+				.CenterX = s_PendingBoundsX,
+				.CenterY = s_PendingBoundsY,
+				.CenterZ = s_PendingBoundsZ,
+				.Radius = s_PendingBoundsRadius,
+			},
+			s_VisibleInstances);
+
+		NV_PROFILE_COUNTER("Renderer::SoftwareOccludedInstances", (float)occludedCount);
+	}
+	s_OcclusionCuller.Clear();
+
+	// missing normal transforms are computed in a single batch, only for instances which will actually be drawn,
+	// compact instance data doesn't carry them at all
+	s_NormalTransformInputs.clear();
+	for (const auto index : s_VisibleInstances)
+	{
+		if (!s_PendingInstances[index].HasNormalTransform && !s_UseCompactInstanceData)
+			s_NormalTransformInputs.push_back(s_PendingInstances[index].Transform);
+	}
+
+	s_NormalTransformOutputs.resize(s_NormalTransformInputs.size());
+	BuildNormalMatrices(s_NormalTransformInputs, s_NormalTransformOutputs);
+
+	s_MaterialScreenSizes.assign(s_Materials.size(), 0.0f);
+
+	auto computedNormalTransform = s_NormalTransformOutputs.begin();
+	for (const auto index : s_VisibleInstances)
+	{
+		const auto& instance = s_PendingInstances[index];
+		const auto viewDepth = glm::dot(
+			s_CameraViewDepthRow,
+			glm::vec4(s_PendingBoundsX[index], s_PendingBoundsY[index], s_PendingBoundsZ[index], 1.0f));
+
+		auto& materialScreenSize = s_MaterialScreenSizes[instance.MaterialIndex];
+		materialScreenSize = std::max(materialScreenSize, GetScreenSize(s_PendingBoundsRadius[index], viewDepth));
+
+		const auto [lod, fadeBits] = SelectModelLOD(instance.TargetModel, s_PendingBoundsRadius[index], viewDepth);
+
+		auto instanceData = InstanceData {
+			.MaterialIndex = instance.MaterialIndex,
+			.Transform = instance.Transform,
+			.NormalTransform = instance.HasNormalTransform || s_UseCompactInstanceData
+				? instance.NormalTransform
+				: *computedNormalTransform++,
+		};
+
+		// opaque instances are grouped by state and go front to back within a group to help early depth test,
+		// transparent instances of all models are ordered back to front together, so they blend correctly
+		const auto depth = RenderSortKey::QuantizeDepth(viewDepth);
+		if (instance.UseTransparency)
+		{
+			s_RenderQueue.Push(
+				RenderSortKey::MakeDepthMajor(
+					(uint32_t)RenderPassID::Transparent,
+					RenderSortKey::InvertDepth(depth),
+					GetModelSlot(instance.TargetModel, lod),
+					instance.MaterialIndex),
+				instanceData);
+			continue;
+		}
+
+		// blending of transparent pass doesn't mix with dithering, so only opaque instances cross-fade
+		if (fadeBits != 0)
+		{
+			auto fadingInstanceData = instanceData;
+			fadingInstanceData.MaterialIndex |= fadeBits;
+
+			s_RenderQueue.Push(
+				RenderSortKey::Make(
+					(uint32_t)RenderPassID::Opaque,
+					GetModelSlot(instance.TargetModel, lod - 1),
+					instance.MaterialIndex,
+					depth),
+				fadingInstanceData);
+
+			instanceData.MaterialIndex |= fadeBits | c_LODFadeInvertBit;
+		}
+
+		s_RenderQueue.Push(
+			RenderSortKey::Make(
+				(uint32_t)RenderPassID::Opaque,
+				GetModelSlot(instance.TargetModel, lod),
+				instance.MaterialIndex,
+				depth),
+			instanceData);
+	}
+
+	s_RenderQueue.Sort();
+
+	NV_PROFILE_COUNTER("Renderer::VisibleInstances", (float)s_VisibleInstances.size());
+	NV_PROFILE_COUNTER("Renderer::CulledInstances", (float)(s_PendingInstances.size() - s_VisibleInstances.size()));
+
+	s_PendingInstances.clear();
+	s_PendingBoundsX.clear();
+	s_PendingBoundsY.clear();
+	s_PendingBoundsZ.clear();
+	s_PendingBoundsRadius.clear();
 }
 
-static void DrawBatch(const Model* model, const std::span<InstanceData> instanceData) noexcept
+// textures are requested at the largest size their materials reached on screen
+static void UpdateTextureStreaming()
 {
 	NV_PROFILE_FUNC;
 
-	s_VertexArray.BindVertexBuffer(
-		model->GetModelDataBuffer(),
-		c_ModelDataBufferBinding,
-		sizeof(ModelVertex));
-
-	if (model->UsesIndexBuffer())
-		s_VertexArray.BindElementBuffer(model->GetIndexBuffer().value());
+	if (s_TextureStreamer == nullptr)
+		return;
 
-	s_InstanceDataSync.WaitClient(SyncTimeoutInfinite);
-	
-	s_InstanceBuffer.Write(instanceData);
-	s_InstanceBuffer.Commit();
+	const auto count = std::min(s_MaterialTextures.size(), s_MaterialScreenSizes.size());
+	for (size_t i = 0; i < count; i++)
+	{
+		if (s_MaterialTextures[i].has_value())
+			s_TextureStreamer->Request(*s_MaterialTextures[i], s_MaterialScreenSizes[i]);
+	}
 
-	if (model->UsesIndexBuffer())
-		glDrawElementsInstanced(
-			model->GetPrimitiveMode(),
-			model->GetIndexDataSize() / sizeof(GLuint),
-			GL_UNSIGNED_INT,
-			nullptr,
-			instanceData.size());
-	else
-		glDrawArraysInstanced(
-			model->GetPrimitiveMode(),
-			0,
-			model->GetModelDataSize() / sizeof(ModelVertex),
-			instanceData.size());
-	
-	s_InstanceDataSync.Set();
+	s_TextureStreamer->Update(s_CurrentDisplayHeight);
 }
 
-static void SortTransparentObjects(std::span<InstanceData> instanceData) noexcept
+template <typename TGetModelSlot>
+static void RecordPassDrawCommands(RenderPassID pass, TGetModelSlot getModelSlot)
 {
 	NV_PROFILE_FUNC;
 
-	std::sort(
-		instanceData.begin(),
-		instanceData.end(),
-		[](const InstanceData& a, const InstanceData& b)
-		{
-			const auto aDistance = glm::distance(glm::vec3(a.Transform[3]), s_CameraPosition);
-			const auto bDistance = glm::distance(glm::vec3(b.Transform[3]), s_CameraPosition);
-			return aDistance > bDistance;
-		});
+	const auto entries = s_RenderQueue.GetEntries();
+	const auto isBefore = [](const RenderQueueEntry& entry, uint32_t pass) { return RenderSortKey::GetPass(entry.Key) < pass; };
+
+	auto it = std::lower_bound(entries.begin(), entries.end(), (uint32_t)pass, isBefore);
+	const auto end = std::lower_bound(it, entries.end(), (uint32_t)pass + 1, isBefore);
+
+	// each run of consecutive instances of the same model becomes one draw command, which is
+	// the smallest number of draws that doesn't change the sorted order
+	while (it != end)
+	{
+		const auto modelSlot = getModelSlot(it->Key);
+		const auto runEnd = std::find_if(
+			it,
+			end,
+			[&](const RenderQueueEntry& entry) { return getModelSlot(entry.Key) != modelSlot; });
+
+		const auto& [model, lod] = s_SlotModels[modelSlot];
+		RecordDrawCommand(model, lod, std::span(it, runEnd));
+		it = runEnd;
+	}
 }
 
-static void ExecuteGeometryPass() noexcept
+static void ExecuteGeometryPass()
 {
 	NV_PROFILE_FUNC;
 
 	s_MaterialsBuffer.Bind(
-		BufferBaseTarget::ShaderStorageBuffer,
+		BindingTarget::ShaderStorageBuffer,
 		s_DeferredGeometryProgram.GetResourceLocation("sMaterialData"));
 	
 	s_CameraDataBuffer.Bind(
@@ -403,33 +2373,153 @@ static void ExecuteGeometryPass() noexcept
 	GL::Enable(EnableCap::DepthTest);
 	GL::DepthFunc(DepthFunction::Less);
 
-	for (auto& [model, drawData] : s_DrawData)
+	RecordPassDrawCommands(RenderPassID::Opaque, RenderSortKey::GetModel);
+	SubmitDrawCommands(s_VertexArray, s_BoundInstanceBufferID, s_InstanceStride);
+
+	DrawRetainedInstances();
+
+	if (s_UseOcclusionCulling && !s_RetainedBatches.empty())
+	{
+		// instances occluded in previous frame, which the depth drawn so far doesn't hide, are drawn in phase 1,
+		// the pyramid is then rebuilt from complete depth for phase 0 of the next frame
+		BuildHiZ();
+		CullOccludedRetainedInstances();
+		DrawRetainedInstances();
+		BuildHiZ();
+	}
+}
+
+static void SetLightClusterUniforms(const ShaderProgram& program)
+{
+	const auto depthScale = (float)c_ClusterCountZ / std::log(s_ClusterFar / s_ClusterNear);
+
+	program.SetUniform(
+		"uClusterTileScale",
+		glm::vec2(
+			(float)c_ClusterCountX / (float)s_CurrentDisplayWidth,
+			(float)c_ClusterCountY / (float)s_CurrentDisplayHeight));
+	program.SetUniform("uClusterDepthScale", depthScale);
+	program.SetUniform("uClusterDepthBias", -std::log(s_ClusterNear) * depthScale);
+}
+
+static void BindLightClusters(const ShaderProgram& program)
+{
+	s_ClusterLightCountsBuffer.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		program.GetResourceLocation("sClusterLightCounts"));
+	s_ClusterLightIndicesBuffer.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		program.GetResourceLocation("sClusterLightIndices"));
+}
+
+static bool HasPassEntries(RenderPassID pass) noexcept
+{
+	const auto entries = s_RenderQueue.GetEntries();
+	const auto it = std::lower_bound(
+		entries.begin(),
+		entries.end(),
+		(uint32_t)pass,
+		[](const RenderQueueEntry& entry, uint32_t pass) { return RenderSortKey::GetPass(entry.Key) < pass; });
+
+	return it != entries.end() && RenderSortKey::GetPass(it->Key) == (uint32_t)pass;
+}
+
+static void ReportClusterOverflow()
+{
+	// counter of previous frame was written before its fence, which has already been waited for
+	const auto overflowCount = s_ClusterOverflowBuffer.GetDataPtr<GLuint>()[(s_FrameIndex + 1) % c_ClusterStatsFrameCount];
+
+	NV_PROFILE_COUNTER("Renderer::OverflowedClusters", (float)overflowCount);
+
+	if (overflowCount > 0 && !s_HasReportedClusterOverflow)
 	{
-		DrawBatch(model, drawData.OpaqueInstanceData);
-		drawData.OpaqueInstanceData.clear();
+		NV_LOG_WARNING(
+			"{} light clusters exceeded limit of {} point lights, lights over the limit are not shaded. Increase RendererSettings::MaxLightsPerCluster.",
+			overflowCount,
+			s_MaxLightsPerCluster);
+		s_HasReportedClusterOverflow = true;
 	}
 }
 
-static void ExecuteLightingPass() noexcept
+static void ExecuteLightClusteringPass()
+{
+	NV_PROFILE_FUNC;
+
+	// light volumes don't need clusters, but transparent pass can't use them, so it still does
+	if (s_LightingStrategy == LightingStrategy::LightVolumes && !HasPassEntries(RenderPassID::Transparent))
+		return;
+
+	ReportClusterOverflow();
+
+	const auto statsSlot = (GLuint)(s_FrameIndex % c_ClusterStatsFrameCount);
+	const GLuint zero = 0;
+	glClearNamedBufferSubData(
+		(GLuint)s_ClusterOverflowBuffer.GetID(),
+		GL_R32UI,
+		statsSlot * sizeof(GLuint),
+		sizeof(GLuint),
+		GL_RED_INTEGER,
+		GL_UNSIGNED_INT,
+		&zero);
+
+	s_LightClusteringProgram.SetUniform("uInverseProjection", s_InverseProjection);
+	s_LightClusteringProgram.SetUniform("uClusterNear", s_ClusterNear);
+	s_LightClusteringProgram.SetUniform("uClusterFar", s_ClusterFar);
+	s_LightClusteringProgram.SetUniform("uIsOrthographic", (GLuint)s_IsOrthographicProjection);
+	s_LightClusteringProgram.SetUniform("uPointLightsCount", s_PointLightsCount);
+	s_LightClusteringProgram.SetUniform("uStatsSlot", statsSlot);
+	s_LightClusteringProgram.Use();
+
+	s_LightsBuffer.Bind(
+		BufferBaseTarget::ShaderStorageBuffer,
+		s_LightClusteringProgram.GetResourceLocation("sPointLightsBuffer"),
+		0,
+		sizeof(PointLightData) * s_MaxPointLightsCount);
+
+	s_CameraDataBuffer.Bind(
+		BufferBaseTarget::UniformBuffer,
+		s_LightClusteringProgram.GetResourceLocation("uCameraData"));
+
+	BindLightClusters(s_LightClusteringProgram);
+	s_ClusterOverflowBuffer.Bind(
+		BindingTarget::ShaderStorageBuffer,
+		s_LightClusteringProgram.GetResourceLocation("sClusterOverflow"));
+
+	glDispatchCompute(c_ClusterCountX, c_ClusterCountY, c_ClusterCountZ);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+
+	NV_PROFILE_COUNTER("Renderer::PointLights", (float)s_PointLightsCount);
+}
+
+static void ExecuteLightingPass()
 {
 	NV_PROFILE_FUNC;
 
 	s_DeferredLightProgram.SetUniform("uAmbient", 0.3f);
 	s_DeferredLightProgram.SetUniform("uShininess", 86.0f);
-	s_DeferredLightProgram.SetUniform("uPointLightsCount", s_PointLightsCount);
 	s_DeferredLightProgram.SetUniform("uDirLightsCount", s_DirLightsCount);
+	if (s_LightingStrategy == LightingStrategy::Clustered)
+		SetLightClusterUniforms(s_DeferredLightProgram);
+	if (s_UseCompactGBuffer)
+		s_DeferredLightProgram.SetUniform("uInverseViewProjection", s_InverseViewProjection);
 	s_DeferredLightProgram.Use();
 	
-	s_LightsBuffer.Bind(
-		BufferBaseTarget::ShaderStorageBuffer,
-		s_DeferredLightProgram.GetResourceLocation("sPointLightsBuffer"),
-		0,
-		sizeof(PointLightData) * s_MaxPointLightsCount);
 	s_LightsBuffer.Bind(
 		BufferBaseTarget::ShaderStorageBuffer,
 		s_DeferredLightProgram.GetResourceLocation("sDirLightsBuffer"),
 		sizeof(PointLightData) * s_MaxPointLightsCount,
 		sizeof(DirLightData) * s_MaxDirLightsCount);
+
+	if (s_LightingStrategy == LightingStrategy::Clustered)
+	{
+		s_LightsBuffer.Bind(
+			BufferBaseTarget::ShaderStorageBuffer,
+			s_DeferredLightProgram.GetResourceLocation("sPointLightsBuffer"),
+			0,
+			sizeof(PointLightData) * s_MaxPointLightsCount);
+
+		BindLightClusters(s_DeferredLightProgram);
+	}
 	
 	s_CameraDataBuffer.Bind(
 		BufferBaseTarget::UniformBuffer,
@@ -449,33 +2539,120 @@ static void ExecuteLightingPass() noexcept
 	glDrawArrays(GL_TRIANGLES, 0, 6);
 }
 
-static void ExecuteTransparentPass() noexcept
+static void ExecuteLightVolumePass()
 {
 	NV_PROFILE_FUNC;
 
-	s_DeferredTransparentProgram.SetUniform("uAmbient", 0.3f);
-	s_DeferredTransparentProgram.SetUniform("uShininess", 86.0f);
-	s_DeferredTransparentProgram.SetUniform("uPointLightsCount", s_PointLightsCount);
-	s_DeferredTransparentProgram.SetUniform("uDirLightsCount", s_DirLightsCount);
-	s_DeferredTransparentProgram.Use();
+	if (s_PointLightsCount == 0)
+		return;
 
-	s_VertexArray.Use();
+	s_LightVolumeProgram.SetUniform("uShininess", 86.0f);
+	if (s_UseCompactGBuffer)
+		s_LightVolumeProgram.SetUniform("uInverseViewProjection", s_InverseViewProjection);
+	s_LightVolumeProgram.Use();
 
-	s_CameraDataBuffer.Bind(
-		BufferBaseTarget::UniformBuffer,
-		s_DeferredTransparentProgram.GetResourceLocation("uCameraData"));
-	
 	s_LightsBuffer.Bind(
 		BufferBaseTarget::ShaderStorageBuffer,
-		s_DeferredTransparentProgram.GetResourceLocation("sPointLightsBuffer"),
+		s_LightVolumeProgram.GetResourceLocation("sPointLightsBuffer"),
 		0,
 		sizeof(PointLightData) * s_MaxPointLightsCount);
+
+	s_CameraDataBuffer.Bind(
+		BufferBaseTarget::UniformBuffer,
+		s_LightVolumeProgram.GetResourceLocation("uCameraData"));
+
+	// G-buffer textures are still bound from lighting pass, they're only read, so their attachments are masked
+	const GLuint gBufferDrawBufferCount = s_UseCompactGBuffer ? 2 : 3;
+	for (GLuint i = 0; i < gBufferDrawBufferCount; i++)
+		glColorMaski(i, GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+	// back faces pass depth test only where scene surface lies in front of them, which rejects pixels behind the volume,
+	// and they stay visible when camera is inside of the volume; clamping keeps them from being clipped by far plane.
+	// Compact G-buffer samples depth attachment for positions, so it can't be depth tested against at the same time
+	if (s_UseCompactGBuffer)
+		GL::Disable(EnableCap::DepthTest);
+	else
+		GL::Enable(EnableCap::DepthTest);
+	GL::DepthFunc(DepthFunction::GreaterEqual);
+	GL::DepthMask(false);
+	GL::Enable(EnableCap::DepthClamp);
+	glCullFace(GL_FRONT);
+
+	GL::Enable(EnableCap::Blend);
+	glBlendFunc(GL_ONE, GL_ONE);
+
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 36, s_PointLightsCount);
+
+	glCullFace(GL_BACK);
+	GL::Disable(EnableCap::DepthClamp);
+	GL::Disable(EnableCap::Blend);
+
+	for (GLuint i = 0; i < gBufferDrawBufferCount; i++)
+		glColorMaski(i, GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+	NV_PROFILE_COUNTER("Renderer::LightVolumes", (float)s_PointLightsCount);
+}
+
+// polls background build of transparent program, which is swapped in for its fallback once it's finished,
+// program which failed to build leaves the fallback in place for the rest of the session
+static void UpdatePendingTransparentProgram()
+{
+	if (!s_PendingTransparentProgram.has_value() || !s_PendingTransparentProgram->IsReady())
+		return;
+
+	try
+	{
+		s_DeferredTransparentProgram = s_ShaderCache.FinishLoadProgram(s_PendingTransparentProgram.value());
+		s_FallbackTransparentProgram.Delete();
+		s_UseFallbackTransparentProgram = false;
+	}
+	catch (const std::exception& exception)
+	{
+		NV_LOG_ERROR("Failed to build transparent shader program, keeping its fallback: {}", exception.what());
+	}
+
+	s_PendingTransparentProgram.reset();
+}
+
+static void ExecuteTransparentPass()
+{
+	NV_PROFILE_FUNC;
+
+	UpdatePendingTransparentProgram();
+
+	const auto isFallback = s_UseFallbackTransparentProgram;
+	const auto& program = isFallback ? s_FallbackTransparentProgram : s_DeferredTransparentProgram;
+
+	program.SetUniform("uAmbient", 0.3f);
+	program.SetUniform("uShininess", 86.0f);
+	program.SetUniform("uDirLightsCount", s_DirLightsCount);
+	if (!isFallback)
+		SetLightClusterUniforms(program);
+	program.Use();
+
+	s_VertexArray.Use();
+
+	s_CameraDataBuffer.Bind(
+		BufferBaseTarget::UniformBuffer,
+		program.GetResourceLocation("uCameraData"));
+	
 	s_LightsBuffer.Bind(
 		BufferBaseTarget::ShaderStorageBuffer,
-		s_DeferredTransparentProgram.GetResourceLocation("sDirLightsBuffer"),
+		program.GetResourceLocation("sDirLightsBuffer"),
 		sizeof(PointLightData) * s_MaxPointLightsCount,
 		sizeof(DirLightData) * s_MaxDirLightsCount);
 
+	if (!isFallback)
+	{
+		s_LightsBuffer.Bind(
+			BufferBaseTarget::ShaderStorageBuffer,
+			program.GetResourceLocation("sPointLightsBuffer"),
+			0,
+			sizeof(PointLightData) * s_MaxPointLightsCount);
+
+		BindLightClusters(program);
+	}
+
 	GL::Enable(EnableCap::DepthTest);
 	GL::DepthFunc(DepthFunction::LessEqual);
 	GL::DepthMask(false);
@@ -483,13 +2660,8 @@ static void ExecuteTransparentPass() noexcept
 	GL::Enable(EnableCap::Blend);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	for (auto& [model, drawData] : s_DrawData)
-	{
-		SortTransparentObjects(drawData.TransparentInstanceData);
-		DrawBatch(model, drawData.TransparentInstanceData);
-
-		drawData.TransparentInstanceData.clear();
-	}
+	RecordPassDrawCommands(RenderPassID::Transparent, RenderSortKey::GetDepthMajorModel);
+	SubmitDrawCommands(s_VertexArray, s_BoundInstanceBufferID, s_InstanceStride);
 }
 
 void Renderer::Draw(const glm::vec4& clearColor)
@@ -501,16 +2673,31 @@ void Renderer::Draw(const glm::vec4& clearColor)
 	s_Framebuffer.Resize(s_CurrentDisplayWidth, s_CurrentDisplayHeight);
 
 	s_Framebuffer.Bind();
-	s_Framebuffer.ClearAttachment(0, clearColor);
-	s_Framebuffer.ClearAttachment(1, glm::zero<glm::vec4>());
-	s_Framebuffer.ClearAttachment(2, glm::zero<glm::vec4>());
-	s_Framebuffer.ClearAttachment(3, glm::zero<glm::vec4>());
-	s_Framebuffer.ClearAttachment(1.0f, 0);
+	if (s_UseCompactGBuffer)
+	{
+		// normals of empty pixels are never read and output is fully overwritten by lighting pass,
+		// so only color, which holds background, and depth are cleared
+		constexpr std::array<Attachment, 2> invalidatedAttachments {
+			Attachment::Color1,
+			Attachment::Color3,
+		};
+
+		s_Framebuffer.Invalidate(invalidatedAttachments);
+		s_Framebuffer.ClearAttachment(0, clearColor);
+		s_Framebuffer.ClearAttachment(1.0f);
+	}
+	else
+	{
+		s_Framebuffer.ClearAttachment(0, clearColor);
+		s_Framebuffer.ClearAttachment(1, glm::zero<glm::vec4>());
+		s_Framebuffer.ClearAttachment(2, glm::zero<glm::vec4>());
+		s_Framebuffer.ClearAttachment(3, glm::zero<glm::vec4>());
+		s_Framebuffer.ClearAttachment(1.0f, 0);
+	}
 
 	s_FrameSync.WaitClient(SyncTimeoutInfinite);
 
 	s_CameraDataBuffer.Commit();
-	s_MaterialsBuffer.Commit();
 	s_LightsBuffer.Commit(
 		0,
 		sizeof(PointLightData) * s_PointLightsCount);
@@ -518,25 +2705,64 @@ void Renderer::Draw(const glm::vec4& clearColor)
 		sizeof(PointLightData) * s_MaxPointLightsCount,
 		sizeof(DirLightData) * s_DirLightsCount);
 
+	s_InstanceBuffer.BeginFrame();
+	s_DrawCommandBuffer.BeginFrame();
+	s_UploadBuffer.BeginFrame();
+
+	UploadMaterials();
+	AcquireMeshUploads();
+	DefragmentMeshes();
+	UploadRetainedInstances();
+
 	glViewport(0, 0, s_CurrentDisplayWidth, s_CurrentDisplayHeight);
 	glScissor(0, 0, s_CurrentDisplayWidth, s_CurrentDisplayHeight);
 
+	SubmitRetainedTransparentInstances();
+	CullPendingInstances();
+	CullRetainedInstances();
+	UpdateTextureStreaming();
+
+	ExecuteLightClusteringPass();
 	ExecuteGeometryPass();
 	ExecuteLightingPass();
+	if (s_LightingStrategy == LightingStrategy::LightVolumes)
+		ExecuteLightVolumePass();
 	ExecuteTransparentPass();
 
+	// draws written by GPU culling aren't known on CPU, so they aren't included
+	NV_PROFILE_COUNTER("Renderer::Triangles", (float)(s_DrawnIndexCount / 3));
+	s_DrawnIndexCount = 0;
+
 	s_FrameSync.Set();
 
 	s_Framebuffer.Unbind();
 
+	s_RenderQueue.Clear();
+	EvictModelSlots();
+	s_FrameIndex++;
+
 	s_PointLightsCount = 0;
 	s_DirLightsCount = 0;
-	s_Materials.clear();
 }
 
 GLuint Renderer::GetRenderTextureID(RenderTexture texture) noexcept
 {
-	return s_Framebuffer.GetAttachment((size_t)texture).AttachmentID;
+	if (!s_UseCompactGBuffer)
+		return s_Framebuffer.GetAttachment((size_t)texture).AttachmentID;
+
+	switch (texture)
+	{
+	case RenderTexture::Color:
+		return s_Framebuffer.GetAttachment(0).AttachmentID;
+	case RenderTexture::Normal:
+		return s_Framebuffer.GetAttachment(1).AttachmentID;
+	case RenderTexture::Depth:
+		return s_Framebuffer.GetAttachment(2).AttachmentID;
+	case RenderTexture::Output:
+		return s_Framebuffer.GetAttachment(3).AttachmentID;
+	default:
+		return 0;
+	}
 }
 
 void Renderer::DisplayFramebuffer() noexcept
@@ -561,8 +2787,23 @@ void Renderer::_Initialize(
 	s_CurrentDisplayWidth = frameWidth;
 	s_CurrentDisplayHeight = frameHeight;
 
+	s_UseCompactInstanceData = settings.UseCompactInstanceData;
+	s_InstanceStride = s_UseCompactInstanceData
+		? sizeof(CompactInstanceData)
+		: sizeof(InstanceData);
+
 	s_MaxPointLightsCount = settings.MaxPointLights;
 	s_MaxDirLightsCount = settings.MaxDirectionalLights;
+	s_MaxLightsPerCluster = std::max(settings.MaxLightsPerCluster, 1u);
+	BuildLightClusterDefines();
+	s_LightingStrategy = settings.Lighting;
+	s_UseCompactGBuffer = settings.UseCompactGBuffer;
+	s_UseGPUCulling = settings.UseGPUCulling;
+	s_UseOcclusionCulling = settings.UseOcclusionCulling && s_UseGPUCulling;
+	s_UseSoftwareOcclusionCulling = settings.UseSoftwareOcclusionCulling;
+	s_LODFadeRange = std::clamp(settings.LODFadeRange, 0.0f, 1.0f);
+	if (settings.UseOcclusionCulling && !s_UseGPUCulling)
+		NV_LOG_WARNING("Occlusion culling requires GPU culling, it won't be used.");
 
 	if (!gladLoadGL(getProcAddressFunc))
 		throw std::runtime_error("Failed to load OpenGL bindings.");
@@ -587,24 +2828,98 @@ void Renderer::_Initialize(
 	const Rect viewportRect { 0, 0, frameWidth, frameHeight };
 	SetViewport(viewportRect, viewportRect);
 
-	s_DeferredGeometryProgram = CreateDeferredGeometryShaderProgram();
-	s_DeferredLightProgram = CreateDeferredLightingShaderProgram();
-	s_DeferredTransparentProgram = CreateDeferredTransparentShaderProgram();
+	if (settings.ShaderCacheDirectory.has_value())
+		s_ShaderCache = ShaderCache(settings.ShaderCacheDirectory.value(), s_RendererInfo);
 
-	s_InstanceBuffer = PersistentMappedBuffer(
-		sizeof(InstanceData) * 512,
-		BufferAccessFlags::Writable);
+	ShaderProgram::SetMaxCompilerThreads(0xFFFFFFFF);
+
+	// every program is issued before any of them is waited for, so that driver compiles them in parallel
+	std::vector<std::pair<ShaderProgram*, PendingCachedProgram>> pendingPrograms;
+	pendingPrograms.emplace_back(&s_DeferredGeometryProgram, CreateDeferredGeometryShaderProgram());
+	pendingPrograms.emplace_back(&s_DeferredLightProgram, CreateDeferredLightingShaderProgram());
+	pendingPrograms.emplace_back(&s_DeferredRetainedGeometryProgram, CreateDeferredRetainedGeometryShaderProgram());
+	pendingPrograms.emplace_back(&s_InstanceScatterProgram, CreateInstanceScatterShaderProgram());
+	if (s_UseGPUCulling)
+	{
+		pendingPrograms.emplace_back(&s_RetainedCullProgram, CreateRetainedCullShaderProgram());
+		pendingPrograms.emplace_back(&s_RetainedDrawCommandsProgram, CreateRetainedDrawCommandsShaderProgram());
+
+		s_HasIndirectDrawCount = GLAD_GL_ARB_indirect_parameters != 0;
+		if (!s_HasIndirectDrawCount)
+			NV_LOG_WARNING("GL_ARB_indirect_parameters is not supported, culled draw commands won't be compacted.");
+	}
+	if (s_UseOcclusionCulling)
+	{
+		pendingPrograms.emplace_back(&s_HiZFromDepthProgram, CreateHiZBuildShaderProgram(true));
+		pendingPrograms.emplace_back(&s_HiZDownsampleProgram, CreateHiZBuildShaderProgram(false));
+
+		s_OcclusionStateBuffer = Buffer(sizeof(OcclusionState));
+		s_OcclusionStateBuffer.SetDebugName("OcclusionStateBuffer");
+
+		const std::array<OcclusionState, c_OcclusionStatsFrameCount> initialStats {};
+		s_OcclusionStatsBuffer = Buffer(sizeof(initialStats), false, true, initialStats.data());
+		s_OcclusionStatsBuffer.SetDebugName("OcclusionStatsBuffer");
+	}
+	pendingPrograms.emplace_back(&s_LightClusteringProgram, CreateLightClusteringShaderProgram());
+	pendingPrograms.emplace_back(&s_LightVolumeProgram, CreateLightVolumeShaderProgram());
+
+	// transparent pass can do with a simpler program, so frames don't wait for the full one to be built
+	auto transparentProgram = CreateDeferredTransparentShaderProgram();
+	if (transparentProgram.IsReady())
+	{
+		pendingPrograms.emplace_back(&s_DeferredTransparentProgram, std::move(transparentProgram));
+	}
+	else
+	{
+		s_PendingTransparentProgram = std::move(transparentProgram);
+		s_UseFallbackTransparentProgram = true;
+		pendingPrograms.emplace_back(&s_FallbackTransparentProgram, CreateFallbackTransparentShaderProgram());
+	}
+
+	for (auto& [program, pending] : pendingPrograms)
+		*program = s_ShaderCache.FinishLoadProgram(pending);
+
+	const auto& shaderCacheStats = s_ShaderCache.GetStats();
+	NV_LOG_INFO(
+		"Shader cache: {} hits, {} misses, {} rejected.",
+		shaderCacheStats.Hits,
+		shaderCacheStats.Misses,
+		shaderCacheStats.Rejected);
+
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &s_StorageBufferOffsetAlignment);
+
+	if (s_UseSoftwareOcclusionCulling)
+	{
+		s_OcclusionCuller = OcclusionCuller(c_SoftwareOcclusionWidth, c_SoftwareOcclusionHeight);
+		s_ThreadPool = std::make_unique<ThreadPool>();
+	}
+
+	s_InstanceBuffer = RingBuffer(s_InstanceStride * c_InitialInstanceCount);
 	s_InstanceBuffer.SetDebugName("InstanceBuffer");
+
+	NV_LOG_INFO(
+		"Using {} instance data, {} bytes per instance.",
+		s_UseCompactInstanceData ? "compact" : "full",
+		s_InstanceStride);
+
+	s_DrawCommandBuffer = RingBuffer(sizeof(DrawCommand) * c_InitialDrawCommandCount);
+	s_DrawCommandBuffer.SetDebugName("DrawCommandBuffer");
 	
 	s_CameraDataBuffer = PersistentMappedBuffer(
 		sizeof(CameraData),
 		BufferAccessFlags::Writable);
 	s_CameraDataBuffer.SetDebugName("CameraBuffer");
 	
-	s_MaterialsBuffer = PersistentMappedBuffer(
-		sizeof(Material) * settings.MaxMaterials,
-		BufferAccessFlags::Writable);
+	s_MaterialsCapacity = std::max(settings.MaxMaterials, 1u);
+	s_MaterialsBuffer = Buffer(sizeof(Material) * s_MaterialsCapacity);
 	s_MaterialsBuffer.SetDebugName("MaterialsBuffer");
+	s_MaterialsDirtyBegin = std::numeric_limits<uint32_t>::max();
+	s_MaterialsDirtyEnd = 0;
+	if (s_UseGPUCulling)
+		CreateMaterialScreenSizeBuffers();
+
+	s_UploadBuffer = RingBuffer(sizeof(Material) * s_MaterialsCapacity);
+	s_UploadBuffer.SetDebugName("UploadBuffer");
 
 	s_LightsBuffer = PersistentMappedBuffer(
 		sizeof(PointLightData) * settings.MaxPointLights + sizeof(DirLightData) * settings.MaxDirectionalLights,
@@ -614,6 +2929,23 @@ void Renderer::_Initialize(
 	s_PointLights = s_LightsBuffer.GetBasePtr<PointLightData>();
 	s_DirLights = s_LightsBuffer.GetBasePtr<DirLightData>(sizeof(PointLightData) * settings.MaxPointLights);
 
+	s_ClusterLightCountsBuffer = Buffer(c_ClusterCount * sizeof(GLuint));
+	s_ClusterLightCountsBuffer.SetDebugName("ClusterLightCountsBuffer");
+	s_ClusterLightIndicesBuffer = Buffer(c_ClusterCount * s_MaxLightsPerCluster * sizeof(GLuint));
+	s_ClusterLightIndicesBuffer.SetDebugName("ClusterLightIndicesBuffer");
+
+	const std::array<GLuint, c_ClusterStatsFrameCount> initialOverflowCounts {};
+	s_ClusterOverflowBuffer = Buffer(sizeof(initialOverflowCounts), false, true, initialOverflowCounts.data());
+	s_ClusterOverflowBuffer.SetDebugName("ClusterOverflowBuffer");
+	s_HasReportedClusterOverflow = false;
+
+	// default camera, until SetCamera is called
+	s_InverseProjection = glm::mat4(1.0f);
+	s_InverseViewProjection = glm::mat4(1.0f);
+	s_ClusterNear = 0.1f;
+	s_ClusterFar = 1000.0f;
+	s_IsOrthographicProjection = false;
+
 	s_VertexArray = VertexArray({
 		VertexInput {
 			.Stride = sizeof(ModelVertex),
@@ -635,67 +2967,184 @@ void Renderer::_Initialize(
 				// },
 			},
 		},
+		s_UseCompactInstanceData
+			? VertexInput {
+				.Stride = sizeof(CompactInstanceData),
+				.Descriptors = {
+					VertexDescriptor {
+						.AttributeIndex = s_DeferredGeometryProgram.GetResourceLocation("inTransformRows"),
+						.AttributeType = AttributeType::Float,
+						.Count = 4,
+						.Rows = 3,
+					},
+					VertexDescriptor {
+						.AttributeIndex = s_DeferredGeometryProgram.GetResourceLocation("inPackedData"),
+						.AttributeType = AttributeType::UnsignedInt,
+						.Count = 1,
+					},
+				},
+				.BufferID = (BufferID)s_InstanceBuffer.GetID(),
+				.InstanceDivisor = 1,
+			}
+			: VertexInput {
+				.Stride = sizeof(InstanceData),
+				.Descriptors = {
+					VertexDescriptor {
+						.AttributeIndex = s_DeferredGeometryProgram.GetResourceLocation("inMaterialIndex"),
+						.AttributeType = AttributeType::UnsignedInt,
+						.Count = 1
+					},
+					VertexDescriptor {
+						.AttributeIndex = s_DeferredGeometryProgram.GetResourceLocation("inTransform"),
+						.AttributeType = AttributeType::Float,
+						.Count = 4,
+						.Rows = 4,
+					},
+					VertexDescriptor {
+						.AttributeIndex = s_DeferredGeometryProgram.GetResourceLocation("inNormalTransform"),
+						.AttributeType = AttributeType::Float,
+						.Count = 3,
+						.Rows = 3,
+					},
+				},
+				.BufferID = (BufferID)s_InstanceBuffer.GetID(),
+				.InstanceDivisor = 1,
+			},
+	});
+
+	// instance data input is resolved to the second buffer binding (c_InstanceDataBufferBinding),
+	// it's rebound whenever instance ring buffer grows
+	s_BoundInstanceBufferID = s_InstanceBuffer.GetID();
+
+	s_RetainedInstanceCapacity = c_InitialRetainedInstanceCount;
+	s_RetainedInstanceTable = Buffer(c_InitialRetainedInstanceCount * sizeof(GPUInstanceData));
+	s_RetainedInstanceTable.SetDebugName("RetainedInstanceTable");
+
+	s_RetainedIndexBuffer = Buffer(c_InitialRetainedInstanceCount * sizeof(GLuint));
+	s_RetainedIndexBuffer.SetDebugName("RetainedIndexBuffer");
+
+	s_RetainedVertexArray = VertexArray({
 		VertexInput {
-			.Stride = sizeof(InstanceData),
+			.Stride = sizeof(ModelVertex),
 			.Descriptors = {
 				VertexDescriptor {
-					.AttributeIndex = s_DeferredGeometryProgram.GetResourceLocation("inMaterialIndex"),
-					.AttributeType = AttributeType::UnsignedInt,
-					.Count = 1
-				},
-				VertexDescriptor {
-					.AttributeIndex = s_DeferredGeometryProgram.GetResourceLocation("inTransform"),
+					.AttributeIndex = s_DeferredRetainedGeometryProgram.GetResourceLocation("inPosition"),
 					.AttributeType = AttributeType::Float,
-					.Count = 4,
-					.Rows = 4,
+					.Count = 3,
 				},
 				VertexDescriptor {
-					.AttributeIndex = s_DeferredGeometryProgram.GetResourceLocation("inNormalTransform"),
+					.AttributeIndex = s_DeferredRetainedGeometryProgram.GetResourceLocation("inNormal"),
 					.AttributeType = AttributeType::Float,
 					.Count = 3,
-					.Rows = 3,
 				},
 			},
-			.BufferID = (BufferID)s_InstanceBuffer.GetID(),
+		},
+		VertexInput {
+			.Stride = sizeof(GLuint),
+			.Descriptors = {
+				VertexDescriptor {
+					.AttributeIndex = s_DeferredRetainedGeometryProgram.GetResourceLocation("inInstanceIndex"),
+					.AttributeType = AttributeType::UnsignedInt,
+					.Count = 1,
+				},
+			},
+			.BufferID = (BufferID)s_RetainedIndexBuffer.GetID(),
 			.InstanceDivisor = 1,
 		},
 	});
+	s_BoundRetainedIndexBufferID = (GLuint)s_RetainedIndexBuffer.GetID();
 
-	s_Framebuffer = Framebuffer({
-		FramebufferAttachmentSpec {
-			.Width = frameWidth,
-			.Height = frameHeight,
-			.Format = InternalFormat::RGBA8,
-			.Flags = AttachmentFlags::DrawDest | AttachmentFlags::Resizable,
-		}, // color + specular attachment
-		FramebufferAttachmentSpec {
-			.Width = frameWidth,
-			.Height = frameHeight,
-			.Format = InternalFormat::RGB16F,
-			.Flags = AttachmentFlags::DrawDest | AttachmentFlags::Resizable,
-		}, // position attachment
-		FramebufferAttachmentSpec {
-			.Width = frameWidth,
-			.Height = frameHeight,
-			.Format = InternalFormat::RGB16F,
-			.Flags = AttachmentFlags::DrawDest | AttachmentFlags::Resizable,
-		}, // normal attachment
-		FramebufferAttachmentSpec {
-			.Width = frameWidth,
-			.Height = frameHeight,
-			.Format = InternalFormat::Depth24Stencil8,
-			.Flags = AttachmentFlags::UseRenderbuffer | AttachmentFlags::Resizable,
-		}, // depth attachment
-		FramebufferAttachmentSpec {
-			.Width = frameWidth,
-			.Height = frameHeight,
-			.Format = InternalFormat::RGB8,
-			.Flags = AttachmentFlags::DrawDest | AttachmentFlags::Resizable,
-		}, // final output
-	});
+	if (s_UseCompactGBuffer)
+	{
+		s_Framebuffer = Framebuffer({
+			FramebufferAttachmentSpec {
+				.Width = frameWidth,
+				.Height = frameHeight,
+				.Format = InternalFormat::RGBA8,
+				.Flags = AttachmentFlags::DrawDest | AttachmentFlags::Resizable,
+			}, // color + specular attachment
+			FramebufferAttachmentSpec {
+				.Width = frameWidth,
+				.Height = frameHeight,
+				.Format = InternalFormat::RG16Snorm,
+				.Flags = AttachmentFlags::DrawDest | AttachmentFlags::Resizable,
+			}, // octahedral normal attachment
+			FramebufferAttachmentSpec {
+				.Width = frameWidth,
+				.Height = frameHeight,
+				.Format = InternalFormat::DepthComponent32F,
+				.Flags = AttachmentFlags::Resizable,
+			}, // depth attachment, sampled for position reconstruction
+			FramebufferAttachmentSpec {
+				.Width = frameWidth,
+				.Height = frameHeight,
+				.Format = InternalFormat::RGB8,
+				.Flags = AttachmentFlags::DrawDest | AttachmentFlags::Resizable,
+			}, // final output
+		});
+	}
+	else
+	{
+		s_Framebuffer = Framebuffer({
+			FramebufferAttachmentSpec {
+				.Width = frameWidth,
+				.Height = frameHeight,
+				.Format = InternalFormat::RGBA8,
+				.Flags = AttachmentFlags::DrawDest | AttachmentFlags::Resizable,
+			}, // color + specular attachment
+			FramebufferAttachmentSpec {
+				.Width = frameWidth,
+				.Height = frameHeight,
+				.Format = InternalFormat::RGB16F,
+				.Flags = AttachmentFlags::DrawDest | AttachmentFlags::Resizable,
+			}, // position attachment
+			FramebufferAttachmentSpec {
+				.Width = frameWidth,
+				.Height = frameHeight,
+				.Format = InternalFormat::RGB16F,
+				.Flags = AttachmentFlags::DrawDest | AttachmentFlags::Resizable,
+			}, // normal attachment
+			FramebufferAttachmentSpec {
+				.Width = frameWidth,
+				.Height = frameHeight,
+				.Format = InternalFormat::Depth24Stencil8,
+				.Flags = s_UseOcclusionCulling
+					? AttachmentFlags::Resizable
+					: AttachmentFlags::UseRenderbuffer | AttachmentFlags::Resizable,
+			}, // depth attachment, sampled by depth pyramid build with occlusion culling
+			FramebufferAttachmentSpec {
+				.Width = frameWidth,
+				.Height = frameHeight,
+				.Format = InternalFormat::RGB8,
+				.Flags = AttachmentFlags::DrawDest | AttachmentFlags::Resizable,
+			}, // final output
+		});
+	}
+
+	s_MeshAllocator = MeshAllocator(sizeof(ModelVertex), c_InitialGeometryVertexCount, c_InitialGeometryIndexCount);
+	BindMeshBuffers();
+
+	s_UploadQueue = std::make_unique<UploadQueue>(Window::GetNativeHandle());
+
+	if (settings.UseTextureStreaming)
+		s_TextureStreamer = std::make_unique<TextureStreamer>(settings.TextureStreaming);
 }
 
 void Renderer::_Shutdown()
 {
+	// copies which haven't started are dropped together with the queue
+	s_PendingMeshUploads.clear();
+	s_UploadQueue.reset();
+
+	// program still being built in the background is abandoned
+	if (s_PendingTransparentProgram.has_value())
+		s_PendingTransparentProgram->Program.Delete();
+	s_PendingTransparentProgram.reset();
+	s_UseFallbackTransparentProgram = false;
+
+	s_MaterialTextures.clear();
+	s_TextureStreamer.reset();
+
 	_GLObjectBase::DeleteAll();
+	s_ThreadPool.reset();
 }
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include <Nova/graphics/opengl/RingBuffer.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <Nova/debug/Log.hpp>
+
+using namespace Nova;
+
+static constexpr GLintptr AlignUp(GLintptr value, GLsizeiptr alignment) noexcept
+{
+    return ((value + alignment - 1) / alignment) * alignment;
+}
+
+RingBuffer::RingBuffer(GLsizeiptr size, size_t framesInFlight)
+    : buffer_(size, BufferAccessFlags::Writable),
+      framesInFlight_(framesInFlight) { }
+
+void RingBuffer::BeginFrame()
+{
+    NV_PROFILE_FUNC;
+
+    // OpenGL keeps storage of deleted buffers alive until all commands using it are finished,
+    // so it is safe to drop retired buffers once commands from previous frame were submitted
+    retiredBuffers_.clear();
+
+    while (!segments_.empty() && segments_.front().Fence.IsSignaled())
+        segments_.pop_front();
+
+    // grow between frames, when no allocations are pending, so that the buffer can hold all frames in flight
+    const auto requiredSize = frameDemand_ * (GLsizeiptr)framesInFlight_;
+    if (requiredSize > GetSize())
+        Grow(requiredSize);
+
+    frameDemand_ = 0;
+    frame_++;
+}
+
+RingAllocation RingBuffer::Allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+    NV_PROFILE_FUNC;
+
+    const auto capacity = GetSize();
+    if (size > capacity)
+    {
+        Grow(size * (GLsizeiptr)framesInFlight_);
+        return Allocate(size, alignment);
+    }
+
+    // allocations never cross the end of the buffer, instead they skip to the beginning of the next lap
+    const auto lapBegin = head_ - head_ % capacity;
+    const auto alignedOffset = AlignUp(head_ - lapBegin, alignment);
+    const auto begin = alignedOffset + size > capacity
+        ? lapBegin + capacity
+        : lapBegin + alignedOffset;
+    const auto end = begin + size;
+
+    while (!segments_.empty() && end - segments_.front().Begin > capacity)
+    {
+        auto& segment = segments_.front();
+        if (segment.Frame == frame_ && !segment.Fence.IsSignaled())
+        {
+            // never stall in the middle of a frame, give up on this buffer and take a bigger one
+            Grow(capacity * 2);
+            return Allocate(size, alignment);
+        }
+
+        segment.Fence.WaitClient(SyncTimeoutInfinite);
+        segments_.pop_front();
+    }
+
+    if (end - fenceBegin_ > capacity)
+    {
+        // allocations which are not fenced yet don't fit in the buffer anymore
+        Grow(capacity * 2);
+        return Allocate(size, alignment);
+    }
+
+    frameDemand_ += end - head_;
+    head_ = end;
+
+    const auto offset = begin % capacity;
+
+    return RingAllocation {
+        .Data = buffer_.GetBasePtr(offset),
+        .BufferID = buffer_.GetID(),
+        .Offset = offset,
+        .Size = size,
+    };
+}
+
+void RingBuffer::Commit(const RingAllocation& allocation) const noexcept
+{
+    NV_PROFILE_FUNC;
+
+    if (allocation.Size > 0)
+        glFlushMappedNamedBufferRange(allocation.BufferID, allocation.Offset, allocation.Size);
+}
+
+void RingBuffer::Fence() noexcept
+{
+    NV_PROFILE_FUNC;
+
+    if (head_ == fenceBegin_)
+        return;
+
+    auto& segment = segments_.emplace_back(
+        Segment {
+            .Begin = fenceBegin_,
+            .End = head_,
+            .Frame = frame_,
+        });
+    segment.Fence.Set();
+
+    fenceBegin_ = head_;
+}
+
+void RingBuffer::SetDebugName(const std::string_view debugName)
+{
+    debugName_ = debugName;
+    buffer_.SetDebugName(debugName_);
+}
+
+void RingBuffer::Grow(GLsizeiptr minSize)
+{
+    NV_PROFILE_FUNC;
+
+    auto newSize = std::max(GetSize(), (GLsizeiptr)1);
+    while (newSize < minSize)
+        newSize *= 2;
+
+    NV_LOG_INFO("Growing ring buffer \"{}\" from {} to {} bytes.", debugName_, GetSize(), newSize);
+
+    // allocations already made from the old buffer stay valid until the next frame begins
+    retiredBuffers_.emplace_back(std::move(buffer_));
+    buffer_ = PersistentMappedBuffer(newSize, BufferAccessFlags::Writable);
+
+    if (!debugName_.empty())
+        buffer_.SetDebugName(debugName_);
+
+    segments_.clear();
+    head_ = 0;
+    fenceBegin_ = 0;
+}
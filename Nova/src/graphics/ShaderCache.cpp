@@ -1,15 +1,18 @@
 #include <Nova/graphics/ShaderCache.hpp>
+#include <Nova/graphics/Renderer.hpp>
 #include <Nova/debug/Profile.hpp>
+#include <Nova/debug/Log.hpp>
 #include <Nova/core/Utility.hpp>
+#include <Nova/core/File.hpp>
+#include <nlohmann/json.hpp>
 #include <stdexcept>
 #include <fstream>
+#include <format>
+#include <vector>
 
 using namespace Nova;
 
-static std::filesystem::path _GetCachedProgramFilepath(const std::filesystem::path &cacheDir, const CachedProgram &cachedProgram)
-{
-    return cacheDir / std::format("{}.bin", cachedProgram.Name);
-}
+static constexpr XXH64_hash_t c_ShaderCacheSeed = 2137;
 
 static std::filesystem::path GetCacheInfoFilepath(const std::filesystem::path &directory)
 {
@@ -22,10 +25,11 @@ static CachedProgram CachedProgramFromJSON(const nlohmann::json &json)
 
     return CachedProgram{
         .Name = json["name"],
+        .Key = std::stoull(std::string(json["key"])),
         .BinaryType = json["type"],
         .CreatedAt = std::chrono::system_clock::time_point(
             std::chrono::milliseconds(
-                (unsigned long)json["created_at"])),
+                json["created_at"].get<int64_t>())),
         .Hash = std::stoull(std::string(json["hash"])),
     };
 }
@@ -34,25 +38,30 @@ static nlohmann::json CachedProgramToJSON(const CachedProgram &cachedProgram)
 {
     return nlohmann::json{
         {"name", cachedProgram.Name},
+        {"key", std::to_string(cachedProgram.Key)},
         {"type", cachedProgram.BinaryType},
         {"created_at", std::chrono::duration_cast<std::chrono::milliseconds>(cachedProgram.CreatedAt.time_since_epoch()).count()},
         {"hash", std::to_string(cachedProgram.Hash)},
     };
 }
 
-static std::unordered_map<std::string, CachedProgram, StringHash, std::equal_to<>> ReadCacheFilepath(const std::filesystem::path &cacheDir)
+static std::unordered_map<XXH64_hash_t, CachedProgram> ReadCacheFilepath(const std::filesystem::path &cacheDir)
 {
     NV_PROFILE_FUNC;
 
-    std::unordered_map<std::string, CachedProgram, StringHash, std::equal_to<>> cachedPrograms{};
+    std::unordered_map<XXH64_hash_t, CachedProgram> cachedPrograms{};
 
     const auto cacheInfoFilepath = GetCacheInfoFilepath(cacheDir);
-    if (std::filesystem::exists(cacheInfoFilepath))
-    {
-        std::ifstream cacheInfoFile(cacheInfoFilepath);
-        if (!cacheInfoFile.is_open())
-            return cachedPrograms;
+    if (!std::filesystem::exists(cacheInfoFilepath))
+        return cachedPrograms;
 
+    std::ifstream cacheInfoFile(cacheInfoFilepath);
+    if (!cacheInfoFile.is_open())
+        return cachedPrograms;
+
+    // registry from an older version or a damaged one only costs recompilation
+    try
+    {
         nlohmann::json cacheInfoJson;
         cacheInfoFile >> cacheInfoJson;
 
@@ -61,44 +70,79 @@ static std::unordered_map<std::string, CachedProgram, StringHash, std::equal_to<
         for (const auto &cacheEntryData : cacheInfoJson)
         {
             const auto cacheEntry = CachedProgramFromJSON(cacheEntryData);
-            cachedPrograms.emplace(cacheEntry.Name, cacheEntry);
+            cachedPrograms.emplace(cacheEntry.Key, cacheEntry);
         }
     }
+    catch (const std::exception &exception)
+    {
+        NV_LOG_WARNING("Ignoring shader cache registry \"{}\": {}", cacheInfoFilepath.string(), exception.what());
+        cachedPrograms.clear();
+    }
 
     return cachedPrograms;
 }
 
 static void DumpCacheRegistry(
     const std::filesystem::path &registryFilepath,
-    const std::unordered_map<std::string, CachedProgram, StringHash, std::equal_to<>> &cachedPrograms)
+    const std::unordered_map<XXH64_hash_t, CachedProgram> &cachedPrograms)
 {
     NV_PROFILE_FUNC;
 
-    std::ofstream output(registryFilepath);
-    if (!output.is_open())
-        throw std::runtime_error("Failed to save shader cache registry.");
-
     nlohmann::json json = nlohmann::json::array();
     for (const auto &[_, entry] : cachedPrograms)
         json.push_back(CachedProgramToJSON(entry));
 
-    output << json;
+    const auto text = json.dump();
+    File::WriteAtomically(registryFilepath, std::as_bytes(std::span(text)));
 }
 
-ShaderCache::ShaderCache()
+// part of every key which changes with GPU, driver or binary formats the driver accepts
+static std::string BuildDriverKey(const RendererInfo &rendererInfo)
 {
-    ReadCacheFilepath(m_Directory);
-}
+    GLint formatsCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatsCount);
 
-ShaderCache::ShaderCache(const std::filesystem::path &directory)
-    : m_Directory(directory)
-{
-    ReadCacheFilepath(m_Directory);
+    std::vector<GLint> formats(formatsCount);
+    if (formatsCount != 0)
+        glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+
+    auto driverKey = std::format("{}\n{}\n{}\n", rendererInfo.VendorName, rendererInfo.RendererName, rendererInfo.Version);
+    for (const auto format : formats)
+        driverKey += std::format("{:x}\n", format);
+
+    return driverKey;
 }
 
-ShaderCache::~ShaderCache() noexcept
+ShaderCache::ShaderCache(const std::filesystem::path &directory, const RendererInfo &rendererInfo)
+    : m_Directory(directory),
+      m_DriverKey(BuildDriverKey(rendererInfo))
 {
-    DumpCacheRegistry(GetCacheInfoFilepath(m_Directory), m_CachedPrograms);
+    NV_PROFILE_FUNC;
+
+    if (!ShaderProgram::IsProgramBinarySupported())
+    {
+        NV_LOG_WARNING("Driver doesn't support program binaries, shader cache is disabled.");
+        return;
+    }
+
+    // cache only saves startup time, so unusable directory shouldn't keep the renderer from starting
+    std::error_code error;
+    {
+        NV_PROFILE_SCOPE("CreateCacheDirectory");
+        std::filesystem::create_directories(m_Directory, error);
+    }
+
+    if (error || !std::filesystem::is_directory(m_Directory, error))
+    {
+        NV_LOG_WARNING(
+            "Shader cache directory \"{}\" can't be used, shader cache is disabled: {}",
+            m_Directory.string(),
+            error ? error.message() : "path is not a directory");
+        return;
+    }
+
+    m_CachedPrograms = ReadCacheFilepath(m_Directory);
+    m_IsEnabled = true;
 }
 
 void ShaderCache::Clear(bool removeData) noexcept
@@ -107,107 +151,169 @@ void ShaderCache::Clear(bool removeData) noexcept
 
     if (removeData)
     {
-        for (const auto &[_, cachedProgram] : m_CachedPrograms)
-        {
-            const auto dataFilepath = _GetCachedProgramFilepath(m_Directory, cachedProgram);
-            std::filesystem::remove(dataFilepath);
-        }
+        std::error_code error;
+        for (const auto &[key, _] : m_CachedPrograms)
+            std::filesystem::remove(GetCachedProgramFilepath(key), error);
 
-        std::filesystem::remove(GetCacheInfoFilepath(m_Directory));
+        std::filesystem::remove(GetCacheInfoFilepath(m_Directory), error);
     }
 
     m_CachedPrograms.clear();
 }
 
-bool ShaderCache::IsProgramCached(const std::string_view name) noexcept
+ShaderProgram ShaderCache::LoadProgram(const std::string_view name, std::span<const ShaderStageSource> stages)
 {
-    return m_CachedPrograms.find(name) != m_CachedPrograms.end();
-}
-
-std::filesystem::path ShaderCache::GetCachedProgramFilepath(const std::string_view name)
-{
-    const auto cachedProgram = m_CachedPrograms.find(name);
-    if (cachedProgram == m_CachedPrograms.end())
-        throw std::runtime_error("Couldn't find cached shader program with given name.");
+    NV_PROFILE_FUNC;
 
-    return _GetCachedProgramFilepath(m_Directory, cachedProgram->second);
+    auto pending = BeginLoadProgram(name, stages);
+    return FinishLoadProgram(pending);
 }
 
-ShaderProgram ShaderCache::LoadCachedProgram(const std::string_view name)
+PendingCachedProgram ShaderCache::BeginLoadProgram(const std::string_view name, std::span<const ShaderStageSource> stages)
 {
     NV_PROFILE_FUNC;
 
-    const auto cachedProgram = m_CachedPrograms.find(name);
-    if (cachedProgram == m_CachedPrograms.end())
-        throw std::runtime_error("Couldn't find cached shader program with given name.");
+    std::vector<std::string> sources;
+    sources.reserve(stages.size());
+
+    // stage boundaries are part of the key, so that moving code between stages changes it
+    auto keyData = m_DriverKey;
+    for (const auto &stage : stages)
+    {
+        const auto [source, size] = File::ReadText(stage.Filepath);
+        sources.push_back(ShaderStage::PreprocessGLSL(std::string_view(source.get(), size), stage.Defines));
+
+        keyData += std::format("{:x}\n", (GLenum)stage.Type);
+        keyData += sources.back();
+        keyData += '\0';
+    }
 
-    return ShaderProgram::FromBinary(
-        cachedProgram->second.BinaryType,
-        m_Directory / std::format("{}.bin", cachedProgram->second.Name));
+    const auto key = XXH64(keyData.data(), keyData.size(), c_ShaderCacheSeed);
+    if (m_IsEnabled)
+    {
+        if (auto program = TryLoadCachedProgram(name, key))
+        {
+            m_Stats.Hits++;
+            return PendingCachedProgram{
+                .Program = PendingShaderProgram(std::move(*program)),
+                .Name = std::string(name),
+                .Key = key,
+                .IsCached = true,
+            };
+        }
+    }
+
+    m_Stats.Misses++;
+
+    std::vector<ShaderStage> compiledStages;
+    compiledStages.reserve(stages.size());
+    for (size_t i = 0; i < stages.size(); i++)
+        compiledStages.push_back(ShaderStage::BeginFromGLSL(stages[i].Type, std::string_view(sources[i])));
+
+    return PendingCachedProgram{
+        .Program = PendingShaderProgram(std::move(compiledStages)),
+        .Name = std::string(name),
+        .Key = key,
+    };
 }
 
-ShaderProgram ShaderCache::LoadCachedProgram(const std::string_view name, std::function<ShaderProgram(void)> fallback)
+ShaderProgram ShaderCache::FinishLoadProgram(PendingCachedProgram &pending)
 {
     NV_PROFILE_FUNC;
 
-    const auto cachedProgram = m_CachedPrograms.find(name);
-    if (cachedProgram == m_CachedPrograms.end())
-    {
-        auto program = fallback();
-        CacheProgram(program, name);
+    auto program = pending.Program.Get();
 
-        return program;
+    // failing to store the program only costs compilation on the next launch
+    if (m_IsEnabled && !pending.IsCached)
+    {
+        try
+        {
+            CacheProgram(program, pending.Name, pending.Key);
+        }
+        catch (const std::exception &exception)
+        {
+            NV_LOG_WARNING("Failed to cache shader program \"{}\": {}", pending.Name, exception.what());
+        }
     }
 
-    return ShaderProgram::FromBinary(
-        cachedProgram->second.BinaryType,
-        m_Directory / std::format("{}.bin", cachedProgram->second.Name));
+    return program;
+}
+
+bool ShaderCache::IsProgramCached(XXH64_hash_t key) const noexcept
+{
+    return m_CachedPrograms.find(key) != m_CachedPrograms.end();
+}
+
+std::filesystem::path ShaderCache::GetCachedProgramFilepath(XXH64_hash_t key) const
+{
+    return m_Directory / std::format("{:016x}.bin", key);
 }
 
-void ShaderCache::CacheProgram(ShaderProgram &program, const std::string_view name)
+std::optional<ShaderProgram> ShaderCache::TryLoadCachedProgram(const std::string_view name, XXH64_hash_t key)
 {
     NV_PROFILE_FUNC;
 
-    const auto [binary, binaryType] = program.GetBinary();
+    const auto cachedProgram = m_CachedPrograms.find(key);
+    if (cachedProgram == m_CachedPrograms.end())
+        return std::nullopt;
 
-    std::ofstream binaryFile(m_Directory / std::format("{}.bin", name), std::ios::binary);
-    if (!binaryFile.is_open())
-        throw std::runtime_error("Failed to open shader binary file for writing.");
+    const auto filepath = GetCachedProgramFilepath(key);
+    try
+    {
+        const auto [binary, size] = File::ReadBinary(filepath);
+        if (XXH64(binary.get(), size, c_ShaderCacheSeed) != cachedProgram->second.Hash)
+            throw std::runtime_error("Binary checksum doesn't match.");
 
+        return ShaderProgram::FromBinary(cachedProgram->second.BinaryType, binary.get(), size);
+    }
+    catch (const std::exception &exception)
     {
-        NV_PROFILE_SCOPE("WriteProgramBinary");
-        binaryFile.write((char *)binary.data(), binary.size_bytes());
+        NV_LOG_WARNING("Discarding cached shader program \"{}\": {}", name, exception.what());
     }
 
-    const auto nameStr = std::string(name);
-    CachedProgram cachedProgram{
-        .Name = nameStr,
-        .BinaryType = binaryType,
-        .CreatedAt = std::chrono::system_clock::now(),
-        .Hash = XXH64(binary.data(), binary.size_bytes(), 2137),
-    };
+    m_Stats.Rejected++;
 
-    m_CachedPrograms.insert_or_assign(nameStr, cachedProgram);
+    std::error_code error;
+    std::filesystem::remove(filepath, error);
+    m_CachedPrograms.erase(cachedProgram);
+
+    return std::nullopt;
 }
 
-void ShaderCache::SetDirectory(const std::filesystem::path &directory)
+void ShaderCache::CacheProgram(ShaderProgram &program, const std::string_view name, XXH64_hash_t key)
 {
     NV_PROFILE_FUNC;
 
-    if (directory == m_Directory)
-        return;
+    const auto [binary, binaryType] = program.GetBinary();
 
-    if (!std::filesystem::exists(directory))
     {
-        NV_PROFILE_SCOPE("CreateCacheDirectory");
-
-        if (!std::filesystem::create_directories(directory))
-            throw std::runtime_error("Failed to create shader cache directory.");
+        NV_PROFILE_SCOPE("WriteProgramBinary");
+        File::WriteAtomically(GetCachedProgramFilepath(key), std::as_bytes(binary));
     }
 
-    if (!std::filesystem::is_directory(directory))
-        throw std::runtime_error("Shader cache path is not a directory.");
+    // older versions of the same program can't be hit again, unless their sources are reverted
+    std::erase_if(
+        m_CachedPrograms,
+        [&](const auto &entry)
+        {
+            if (entry.second.Name != name || entry.first == key)
+                return false;
 
-    m_Directory = directory;
-    m_CachedPrograms = ReadCacheFilepath(directory);
+            std::error_code error;
+            std::filesystem::remove(GetCachedProgramFilepath(entry.first), error);
+
+            return true;
+        });
+
+    m_CachedPrograms.insert_or_assign(
+        key,
+        CachedProgram{
+            .Name = std::string(name),
+            .Key = key,
+            .BinaryType = binaryType,
+            .CreatedAt = std::chrono::system_clock::now(),
+            .Hash = XXH64(binary.data(), binary.size_bytes(), c_ShaderCacheSeed),
+        });
+
+    DumpCacheRegistry(GetCacheInfoFilepath(m_Directory), m_CachedPrograms);
 }
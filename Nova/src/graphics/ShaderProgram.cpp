@@ -4,7 +4,6 @@
 #include <Nova/debug/Profile.hpp>
 #include <Nova/core/Utility.hpp>
 #include <Nova/core/File.hpp>
-#include <iostream>
 #include <fstream>
 #include <array>
 #include <limits>
@@ -55,7 +54,7 @@ static void CheckProgramLinkStatus(GLuint program)
 		std::string linkMessage(linkMessageLength, '\0');
 		glGetProgramInfoLog(program, linkMessageLength, nullptr, linkMessage.data());
 
-		std::cerr << linkMessage << std::endl;
+		NV_LOG_ERROR("Failed to link shader program:\n{}.", linkMessage);
 
 		throw std::runtime_error("Failed to link shader program.");
 	}
@@ -79,6 +78,29 @@ static void CleanUpAttachedShaders(GLuint program) noexcept
 	}
 }
 
+// attaches stages and issues linking, without waiting for it
+static GLuint BeginLinkProgram(
+	const ShaderStage* stages,
+	size_t stagesCount)
+{
+	NV_PROFILE_FUNC;
+
+	const auto id = glCreateProgram();
+
+	for (const auto& stage : std::span(stages, stagesCount))
+		glAttachShader(id, stage.GetID());
+
+	// some drivers only keep binary of programs which asked for it before linking
+	glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+	{
+		NV_PROFILE_SCOPE("::LinkShaderProgram");
+		glLinkProgram(id);
+	}
+
+	return id;
+}
+
 static void NormalizeArrayResourceName(std::string &name)
 {
 	const auto bracketLocation = name.find('[');
@@ -185,6 +207,17 @@ void ShaderProgram::ReleaseShaderCompiler() noexcept
 	glReleaseShaderCompiler();
 }
 
+bool ShaderProgram::IsParallelCompileSupported() noexcept
+{
+	return GLAD_GL_KHR_parallel_shader_compile != 0;
+}
+
+void ShaderProgram::SetMaxCompilerThreads(GLuint count) noexcept
+{
+	if (IsParallelCompileSupported())
+		glMaxShaderCompilerThreadsKHR(count);
+}
+
 bool ShaderProgram::IsShaderBinarySupported() noexcept
 {
 	static auto s_SupportChecked = false;
@@ -195,8 +228,9 @@ bool ShaderProgram::IsShaderBinarySupported() noexcept
 	}
 
 	GLint formatsCount = 0;
-	glGetIntegerv(GL_SHADER_BINARY_FORMATS, &formatsCount);
+	glGetIntegerv(GL_NUM_SHADER_BINARY_FORMATS, &formatsCount);
 	s_IsSupported = formatsCount != 0;
+	s_SupportChecked = true;
 
 	return s_IsSupported;
 }
@@ -211,8 +245,9 @@ bool ShaderProgram::IsProgramBinarySupported() noexcept
 	}
 
 	GLint formatsCount = 0;
-	glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, &formatsCount);
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatsCount);
 	s_IsSupported = formatsCount != 0;
+	s_SupportChecked = true;
 
 	return s_IsSupported;
 }
@@ -257,7 +292,16 @@ ShaderProgram ShaderProgram::FromBinary(
 		binary,
 		(GLsizei)binarySize);
 
-	CheckProgramLinkStatus(program.id_);
+	// binaries from a different driver are rejected like a failed link
+	try
+	{
+		CheckProgramLinkStatus(program.id_);
+	}
+	catch (...)
+	{
+		program.Delete();
+		throw;
+	}
 
 	program.resources_ = RetrieveProgramInterface(program.id_);
 
@@ -280,15 +324,7 @@ ShaderProgram::ShaderProgram(
 {
 	NV_PROFILE_FUNC;
 
-	id_ = glCreateProgram();
-
-	for (const auto &stage : std::span(stages, stagesCount))
-		glAttachShader(id_, stage.GetID());
-
-	{
-		NV_PROFILE_SCOPE("::LinkShaderProgram");
-		glLinkProgram(id_);
-	}
+	id_ = BeginLinkProgram(stages, stagesCount);
 
 	CleanUpAttachedShaders(id_);
 	CheckProgramLinkStatus(id_);
@@ -356,8 +392,113 @@ void ShaderProgram::SetUniform(const std::string_view name, uint32_t value) cons
 	glProgramUniform1ui(id_, GetResourceLocation(name), value);
 }
 
+void ShaderProgram::SetUniform(const std::string_view name, const glm::vec2& value) const
+{
+	NV_PROFILE_FUNC;
+	glProgramUniform2f(id_, GetResourceLocation(name), value.x, value.y);
+}
+
+void ShaderProgram::SetUniform(const std::string_view name, const glm::ivec2& value) const
+{
+	NV_PROFILE_FUNC;
+	glProgramUniform2i(id_, GetResourceLocation(name), value.x, value.y);
+}
+
 void ShaderProgram::SetUniform(const std::string_view name, const glm::vec3& value) const
 {
 	NV_PROFILE_FUNC;
 	glProgramUniform3f(id_, GetResourceLocation(name), value.x, value.y, value.z);
+}
+
+void ShaderProgram::SetUniform(const std::string_view name, const glm::vec4& value) const
+{
+	NV_PROFILE_FUNC;
+	glProgramUniform4f(id_, GetResourceLocation(name), value.x, value.y, value.z, value.w);
+}
+
+void ShaderProgram::SetUniform(const std::string_view name, const glm::mat4& value) const
+{
+	NV_PROFILE_FUNC;
+	glProgramUniformMatrix4fv(id_, GetResourceLocation(name), 1, GL_FALSE, &value[0][0]);
+}
+
+void ShaderProgram::SetUniform(const std::string_view name, std::span<const glm::vec4> values) const
+{
+	NV_PROFILE_FUNC;
+	glProgramUniform4fv(id_, GetResourceLocation(name), (GLsizei)values.size(), &values.data()->x);
+}
+
+PendingShaderProgram::PendingShaderProgram(std::vector<ShaderStage> stages)
+	: stages_(std::move(stages)),
+	  isPending_(true)
+{
+	NV_PROFILE_FUNC;
+
+	program_.id_ = BeginLinkProgram(stages_.data(), stages_.size());
+}
+
+PendingShaderProgram::~PendingShaderProgram() noexcept
+{
+	Delete();
+}
+
+bool PendingShaderProgram::IsReady() const noexcept
+{
+	if (!isPending_ || !ShaderProgram::IsParallelCompileSupported())
+		return true;
+
+	// completion of linking implies completion of every attached stage
+	GLint isCompleted = GL_FALSE;
+	glGetProgramiv(program_.id_, GL_COMPLETION_STATUS_KHR, &isCompleted);
+
+	return isCompleted == GL_TRUE;
+}
+
+ShaderProgram PendingShaderProgram::Get()
+{
+	NV_PROFILE_FUNC;
+
+	// objects of failed program are already deleted, so handing out an empty program would only fail later
+	if (isFailed_)
+		throw std::runtime_error("Shader program failed to build.");
+
+	if (isPending_)
+	{
+		// stage which failed to compile only makes linking fail with a generic message, so compiler log goes first
+		try
+		{
+			for (const auto& stage : stages_)
+				stage.CheckCompileStatus();
+
+			CheckProgramLinkStatus(program_.id_);
+		}
+		catch (...)
+		{
+			Delete();
+			isFailed_ = true;
+			throw;
+		}
+
+		CleanUpAttachedShaders(program_.id_);
+		stages_.clear();
+		isPending_ = false;
+
+		program_.resources_ = RetrieveProgramInterface(program_.id_);
+	}
+
+	return std::exchange(program_, ShaderProgram());
+}
+
+void PendingShaderProgram::Delete() noexcept
+{
+	NV_PROFILE_FUNC;
+
+	if (program_.id_ != 0)
+	{
+		CleanUpAttachedShaders(program_.id_);
+		program_.Delete();
+	}
+
+	stages_.clear();
+	isPending_ = false;
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <Nova/debug/Log.hpp>
 #include <Nova/core/File.hpp>
 #include <Nova/core/Memory.hpp>
+#include <algorithm>
+#include <format>
 
 using namespace Nova;
 
@@ -56,18 +58,28 @@ ShaderStage ShaderStage::FromGLSL(
 {
 	NV_PROFILE_FUNC;
 
+	const auto stage = BeginFromGLSL(type, source);
+	CheckShaderStatus(stage.m_ID);
+
+	return stage;
+}
+
+ShaderStage ShaderStage::BeginFromGLSL(
+	ShaderType type,
+	const std::string_view source)
+{
+	NV_PROFILE_FUNC;
+
 	if (!check_fits_in<GLint>(source.size()))
 		throw std::overflow_error("Source length exceeds max allowed by OpenGL");
 
 	const auto id = glCreateShader((GLenum)type);
 
 	const auto data = source.data();
-	const auto length = source.size();
-	glShaderSource(id, 1, &data, (GLint*)&length);
+	const auto length = (GLint)source.size();
+	glShaderSource(id, 1, &data, &length);
 	glCompileShader(id);
 
-	CheckShaderStatus(id);
-
 	return ShaderStage(id);
 }
 
@@ -81,6 +93,64 @@ ShaderStage ShaderStage::FromGLSL(
 	return FromGLSL(type, std::string_view(source.get(), size));
 }
 
+std::string ShaderStage::PreprocessGLSL(
+	const std::string_view source,
+	const std::span<const std::string_view> defines)
+{
+	NV_PROFILE_FUNC;
+
+	if (defines.empty())
+		return std::string(source);
+
+	// #version has to stay the first directive, so definitions go right after it
+	const auto versionBegin = source.find("#version");
+	const auto versionEnd = versionBegin == std::string_view::npos
+		? 0
+		: std::min(source.find('\n', versionBegin), source.size() - 1) + 1;
+
+	std::string processedSource(source.substr(0, versionEnd));
+	if (!processedSource.empty() && processedSource.back() != '\n')
+		processedSource += '\n';
+
+	for (const auto define : defines)
+	{
+		processedSource += "#define ";
+		processedSource += define;
+		processedSource += '\n';
+	}
+
+	// keep line numbers in compiler messages matching the original file
+	const auto nextLine = 1 + std::count(source.begin(), source.begin() + versionEnd, '\n');
+	processedSource += std::format("#line {}\n", nextLine);
+	processedSource += source.substr(versionEnd);
+
+	return processedSource;
+}
+
+ShaderStage ShaderStage::FromGLSL(
+	ShaderType type,
+	const std::string_view source,
+	const std::span<const std::string_view> defines)
+{
+	NV_PROFILE_FUNC;
+
+	if (defines.empty())
+		return FromGLSL(type, source);
+
+	return FromGLSL(type, std::string_view(PreprocessGLSL(source, defines)));
+}
+
+ShaderStage ShaderStage::FromGLSL(
+	ShaderType type,
+	const std::filesystem::path& filepath,
+	const std::span<const std::string_view> defines)
+{
+	NV_PROFILE_FUNC;
+
+	const auto [source, size] = File::ReadText(filepath);
+	return FromGLSL(type, std::string_view(source.get(), size), defines);
+}
+
 ShaderStage ShaderStage::FromBinary(
 	ShaderType type,
 	GLenum binaryType,
@@ -197,4 +267,9 @@ ShaderStage ShaderStage::FromSPIRV(
 	SpecializeShaderStage(stage.m_ID, specializeInfo);
 
 	return stage;
+}
+
+void ShaderStage::CheckCompileStatus() const
+{
+	CheckShaderStatus(m_ID);
 }
\ No newline at end of file
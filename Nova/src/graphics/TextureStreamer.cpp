@@ -0,0 +1,431 @@
+#include <Nova/graphics/TextureStreamer.hpp>
+#include <Nova/graphics/opengl/GL.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <Nova/debug/Log.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+using namespace Nova;
+
+static size_t GetLevelsSize(const std::vector<Image>& levels, uint32_t firstLevel) noexcept
+{
+    size_t size = 0;
+    for (auto level = firstLevel; level < levels.size(); level++)
+        size += GetImageSize(levels[level]);
+
+    return size;
+}
+
+static uint32_t GetTailLevel(const std::vector<Image>& levels, uint32_t tailSize) noexcept
+{
+    uint32_t level = 0;
+    while (level + 1 < levels.size() && std::max(levels[level].Width, levels[level].Height) > tailSize)
+        level++;
+
+    return level;
+}
+
+TextureStreamer::TextureStreamer(const TextureStreamerSettings& settings)
+    : settings_(settings),
+      staging_(settings.StagingSizePerFrame * (GLsizeiptr)RingBufferDefaultFramesInFlight)
+{
+    staging_.SetDebugName("TextureStagingBuffer");
+
+    const auto decoderCount = std::max(settings.DecoderThreadCount, (size_t)1);
+    decoders_.reserve(decoderCount);
+    for (size_t i = 0; i < decoderCount; i++)
+        decoders_.emplace_back([this](std::stop_token stopToken) { DecoderLoop(stopToken); });
+}
+
+TextureStreamer::~TextureStreamer() noexcept
+{
+    {
+        std::lock_guard lock(mutex_);
+        decodeJobs_.clear();
+    }
+
+    // decoders are joined by their destructors, wait of each one is interrupted by its stop request
+    for (auto& decoder : decoders_)
+        decoder.request_stop();
+    decoders_.clear();
+
+    for (const auto& texture : textures_)
+    {
+        if (texture.ID != 0)
+            glDeleteTextures(1, &texture.ID);
+    }
+}
+
+StreamedTextureHandle TextureStreamer::Load(const std::filesystem::path& filepath, bool isSRGB)
+{
+    NV_PROFILE_FUNC;
+
+    uint32_t index;
+    if (!freeTextures_.empty())
+    {
+        index = freeTextures_.back();
+        freeTextures_.pop_back();
+    }
+    else
+    {
+        index = (uint32_t)textures_.size();
+        textures_.emplace_back();
+    }
+
+    // generation tells results of loads into a reused slot apart from results of the current one
+    auto& texture = textures_[index];
+    texture = StreamedTexture {
+        .Generation = texture.Generation + 1,
+        .IsSRGB = isSRGB,
+        .IsLive = true,
+    };
+
+    {
+        std::lock_guard lock(mutex_);
+        decodeJobs_.push_back(
+            DecodeJob {
+                .Index = index,
+                .Generation = texture.Generation,
+                .Filepath = filepath,
+                .IsSRGB = isSRGB,
+            });
+    }
+    jobSubmitted_.notify_one();
+
+    return StreamedTextureHandle(index);
+}
+
+void TextureStreamer::Unload(StreamedTextureHandle handle)
+{
+    auto& texture = GetTexture(handle);
+    if (texture.ID != 0)
+    {
+        glDeleteTextures(1, &texture.ID);
+        residentSize_ -= GetLevelsSize(texture.Levels, texture.ResidentLevel);
+    }
+
+    texture = StreamedTexture { .Generation = texture.Generation };
+    freeTextures_.push_back((uint32_t)handle);
+}
+
+void TextureStreamer::Request(StreamedTextureHandle handle, float screenSize)
+{
+    auto& texture = GetTexture(handle);
+    texture.RequestedSize = std::max(texture.RequestedSize, screenSize);
+}
+
+void TextureStreamer::Update(int viewportHeight)
+{
+    NV_PROFILE_FUNC;
+
+    staging_.BeginFrame();
+
+    FinishDecodedTextures();
+    SelectTargetLevels(viewportHeight);
+    StreamLevels();
+
+    staging_.Fence();
+
+    NV_PROFILE_COUNTER("TextureStreamer::ResidentMB", (float)residentSize_ / (1024.0f * 1024.0f));
+}
+
+GLuint TextureStreamer::GetTextureID(StreamedTextureHandle handle) const
+{
+    return GetTexture(handle).ID;
+}
+
+uint32_t TextureStreamer::GetResidentLevel(StreamedTextureHandle handle) const
+{
+    const auto& texture = GetTexture(handle);
+
+    return texture.ID != 0
+        ? texture.ResidentLevel
+        : (uint32_t)texture.Levels.size();
+}
+
+TextureStreamer::StreamedTexture& TextureStreamer::GetTexture(StreamedTextureHandle handle)
+{
+    const auto index = (uint32_t)handle;
+    if (index >= textures_.size() || !textures_[index].IsLive)
+        throw std::runtime_error("Invalid streamed texture handle.");
+
+    return textures_[index];
+}
+
+const TextureStreamer::StreamedTexture& TextureStreamer::GetTexture(StreamedTextureHandle handle) const
+{
+    const auto index = (uint32_t)handle;
+    if (index >= textures_.size() || !textures_[index].IsLive)
+        throw std::runtime_error("Invalid streamed texture handle.");
+
+    return textures_[index];
+}
+
+void TextureStreamer::FinishDecodedTextures()
+{
+    NV_PROFILE_FUNC;
+
+    std::vector<DecodedTexture> decodedTextures;
+    {
+        std::lock_guard lock(mutex_);
+        decodedTextures.swap(decodedTextures_);
+    }
+
+    for (auto& decoded : decodedTextures)
+    {
+        auto& texture = textures_[decoded.Index];
+        if (!texture.IsLive || texture.Generation != decoded.Generation)
+            continue;
+
+        if (decoded.Exception)
+        {
+            // texture stays without levels, so it's never made resident
+            try
+            {
+                std::rethrow_exception(decoded.Exception);
+            }
+            catch (const std::exception& exception)
+            {
+                NV_LOG_WARNING("Failed to load texture \"{}\": {}", decoded.Filepath.string(), exception.what());
+            }
+
+            continue;
+        }
+
+        texture.Levels = std::move(decoded.Levels);
+        texture.ResidentLevel = (uint32_t)texture.Levels.size();
+        texture.TailLevel = GetTailLevel(texture.Levels, settings_.ResidentTailSize);
+        texture.TargetLevel = texture.TailLevel;
+    }
+}
+
+void TextureStreamer::SelectTargetLevels(int viewportHeight)
+{
+    NV_PROFILE_FUNC;
+
+    // finest level needed is the smallest one which still has at least one texel per covered pixel
+    std::vector<uint32_t> neededLevels(textures_.size());
+    size_t targetSize = 0;
+    for (size_t i = 0; i < textures_.size(); i++)
+    {
+        auto& texture = textures_[i];
+        if (texture.Levels.empty())
+            continue;
+
+        auto level = texture.TailLevel;
+        if (texture.RequestedSize > 0.0f)
+        {
+            const auto pixels = texture.RequestedSize * (float)viewportHeight;
+            const auto size = std::max(texture.Levels[0].Width, texture.Levels[0].Height);
+
+            level = 0;
+            while (level < texture.TailLevel && (float)(size >> (level + 1)) >= pixels)
+                level++;
+        }
+
+        neededLevels[i] = level;
+        texture.TargetLevel = level;
+        targetSize += GetLevelsSize(texture.Levels, level);
+    }
+
+    // over budget, the most oversampled texture loses its finest level until everything fits or only tails are left
+    while (targetSize > settings_.MemoryBudget)
+    {
+        StreamedTexture* coarsened = nullptr;
+        float largestOversampling = 0.0f;
+        for (auto& texture : textures_)
+        {
+            if (texture.Levels.empty() || texture.TargetLevel >= texture.TailLevel)
+                continue;
+
+            const auto& level = texture.Levels[texture.TargetLevel];
+            const auto pixels = std::max(texture.RequestedSize * (float)viewportHeight, 1.0f);
+            const auto oversampling = (float)std::max(level.Width, level.Height) / pixels;
+            if (coarsened == nullptr || oversampling > largestOversampling)
+            {
+                coarsened = &texture;
+                largestOversampling = oversampling;
+            }
+        }
+
+        if (coarsened == nullptr)
+            break;
+
+        targetSize -= GetImageSize(coarsened->Levels[coarsened->TargetLevel]);
+        coarsened->TargetLevel++;
+    }
+
+    // levels dropped before the large ones which freed the budget are given back where they still fit
+    for (size_t i = 0; i < textures_.size(); i++)
+    {
+        auto& texture = textures_[i];
+        while (texture.TargetLevel > neededLevels[i]
+            && targetSize + GetImageSize(texture.Levels[texture.TargetLevel - 1]) <= settings_.MemoryBudget)
+        {
+            texture.TargetLevel--;
+            targetSize += GetImageSize(texture.Levels[texture.TargetLevel]);
+        }
+    }
+
+    for (auto& texture : textures_)
+        texture.RequestedSize = 0.0f;
+}
+
+void TextureStreamer::StreamLevels()
+{
+    NV_PROFILE_FUNC;
+
+    // levels are dropped before any are streamed in, so that memory is released first
+    std::vector<StreamedTexture*> streamedTextures;
+    for (auto& texture : textures_)
+    {
+        if (texture.Levels.empty())
+            continue;
+
+        if (texture.ID != 0 && texture.TargetLevel > texture.ResidentLevel)
+            Reallocate(texture, texture.TargetLevel);
+        else if (texture.TargetLevel < texture.ResidentLevel)
+            streamedTextures.push_back(&texture);
+    }
+
+    // textures missing the most levels go first
+    std::stable_sort(
+        streamedTextures.begin(),
+        streamedTextures.end(),
+        [](const StreamedTexture* a, const StreamedTexture* b)
+        {
+            return a->ResidentLevel - a->TargetLevel > b->ResidentLevel - b->TargetLevel;
+        });
+
+    GLsizeiptr uploadedSize = 0;
+    for (const auto texture : streamedTextures)
+    {
+        // tail comes in at once, finer levels one per frame
+        const auto previousLevel = texture->ResidentLevel;
+        const auto baseLevel = texture->ID == 0
+            ? texture->TailLevel
+            : previousLevel - 1;
+
+        // first upload always fits, so that a level larger than the per-frame size still makes progress
+        const auto size = (GLsizeiptr)(GetLevelsSize(texture->Levels, baseLevel) - GetLevelsSize(texture->Levels, previousLevel));
+        if (uploadedSize > 0 && uploadedSize + size > settings_.StagingSizePerFrame)
+            continue;
+
+        uploadedSize += size;
+
+        Reallocate(*texture, baseLevel);
+        for (auto level = baseLevel; level < previousLevel; level++)
+            UploadLevel(*texture, level);
+    }
+
+    if (uploadedSize > 0)
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    NV_PROFILE_COUNTER("TextureStreamer::UploadedMB", (float)uploadedSize / (1024.0f * 1024.0f));
+}
+
+void TextureStreamer::Reallocate(StreamedTexture& texture, uint32_t baseLevel)
+{
+    NV_PROFILE_FUNC;
+
+    const auto levelCount = (uint32_t)texture.Levels.size();
+    const auto& base = texture.Levels[baseLevel];
+
+    const auto id = GL::CreateTexture(TextureTarget::Texture2D);
+    GL::TextureStorage2D(
+        id,
+        (GLsizei)(levelCount - baseLevel),
+        texture.IsSRGB ? InternalFormat::SRGB8Alpha8 : InternalFormat::RGBA8,
+        (GLsizei)base.Width,
+        (GLsizei)base.Height);
+    GL::TextureParameter(id, TextureMinFilter::LinearMipmapLinear);
+    GL::TextureParameter(id, TextureMagFilter::Linear);
+
+    if (texture.ID != 0)
+    {
+        for (auto level = std::max(baseLevel, texture.ResidentLevel); level < levelCount; level++)
+        {
+            const auto& image = texture.Levels[level];
+            glCopyImageSubData(
+                texture.ID,
+                GL_TEXTURE_2D,
+                (GLint)(level - texture.ResidentLevel),
+                0,
+                0,
+                0,
+                id,
+                GL_TEXTURE_2D,
+                (GLint)(level - baseLevel),
+                0,
+                0,
+                0,
+                (GLsizei)image.Width,
+                (GLsizei)image.Height,
+                1);
+        }
+
+        // storage stays alive until commands of previous frames using it are finished
+        glDeleteTextures(1, &texture.ID);
+    }
+
+    residentSize_ += GetLevelsSize(texture.Levels, baseLevel);
+    residentSize_ -= GetLevelsSize(texture.Levels, texture.ID != 0 ? texture.ResidentLevel : levelCount);
+
+    texture.ID = id;
+    texture.ResidentLevel = baseLevel;
+}
+
+void TextureStreamer::UploadLevel(const StreamedTexture& texture, uint32_t level)
+{
+    const auto& image = texture.Levels[level];
+
+    const auto allocation = staging_.Allocate((GLsizeiptr)image.Pixels.size(), 4);
+    std::memcpy(allocation.Data, image.Pixels.data(), image.Pixels.size());
+    staging_.Commit(allocation);
+
+    // with pixel unpack buffer bound, pixel pointer is an offset into it
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, allocation.BufferID);
+    GL::TextureSubImage2D(
+        texture.ID,
+        (GLint)(level - texture.ResidentLevel),
+        (GLsizei)image.Width,
+        (GLsizei)image.Height,
+        GL_RGBA,
+        GL_UNSIGNED_BYTE,
+        reinterpret_cast<const void*>(allocation.Offset));
+}
+
+void TextureStreamer::DecoderLoop(std::stop_token stopToken)
+{
+    while (true)
+    {
+        DecodeJob job;
+        {
+            std::unique_lock lock(mutex_);
+            if (!jobSubmitted_.wait(lock, stopToken, [this] { return !decodeJobs_.empty(); }))
+                return;
+
+            job = std::move(decodeJobs_.front());
+            decodeJobs_.pop_front();
+        }
+
+        DecodedTexture decoded {
+            .Index = job.Index,
+            .Generation = job.Generation,
+            .Filepath = job.Filepath,
+        };
+
+        try
+        {
+            decoded.Levels = GenerateMipChain(LoadImageFile(job.Filepath), settings_.Filter, job.IsSRGB);
+        }
+        catch (...)
+        {
+            decoded.Exception = std::current_exception();
+        }
+
+        std::lock_guard lock(mutex_);
+        decodedTextures_.push_back(std::move(decoded));
+    }
+}
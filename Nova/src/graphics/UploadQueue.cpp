@@ -0,0 +1,213 @@
+#include <Nova/graphics/UploadQueue.hpp>
+#include <Nova/debug/Profile.hpp>
+#include <glfw/glfw3.h>
+#include <stdexcept>
+#include <utility>
+
+using namespace Nova;
+
+UploadQueue::UploadQueue(GLFWwindow* sharedWindow)
+{
+    NV_PROFILE_FUNC;
+
+    // context version and profile hints are still the ones used for the window
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    context_ = glfwCreateWindow(1, 1, "UploadContext", nullptr, sharedWindow);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_TRUE);
+
+    if (context_ == nullptr)
+        throw std::runtime_error("Failed to create upload context.");
+
+    worker_ = std::jthread([this](std::stop_token stopToken) { WorkerLoop(stopToken); });
+}
+
+UploadQueue::~UploadQueue() noexcept
+{
+    // uploads which haven't started are dropped, worker has to release its context before the window is destroyed
+    {
+        std::lock_guard lock(mutex_);
+        pendingUploads_.clear();
+    }
+    worker_.request_stop();
+    worker_.join();
+
+    // buffers which were never acquired are still released by _GLObjectBase::DeleteAll, textures aren't registered
+    for (const auto& [_, upload] : uploads_)
+    {
+        if (upload->ResultTexture != 0)
+            glDeleteTextures(1, &upload->ResultTexture);
+    }
+
+    glfwDestroyWindow(context_);
+}
+
+UploadHandle UploadQueue::UploadBuffer(std::span<const std::byte> data)
+{
+    return Submit(
+        [data](Upload& upload)
+        {
+            upload.ResultBuffer = Buffer((GLsizeiptr)data.size_bytes(), false, false, data.data());
+        });
+}
+
+UploadHandle UploadQueue::UploadTexture(const TextureUpload& texture)
+{
+    return Submit(
+        [texture](Upload& upload)
+        {
+            const auto id = GL::CreateTexture(TextureTarget::Texture2D);
+            GL::TextureStorage2D(id, texture.LevelCount, texture.Format, texture.Width, texture.Height);
+            GL::TextureSubImage2D(
+                id,
+                0,
+                texture.Width,
+                texture.Height,
+                texture.PixelFormat,
+                texture.PixelType,
+                texture.Pixels.data());
+
+            if (texture.LevelCount > 1)
+                GL::GenerateTextureMipmap(id);
+
+            upload.ResultTexture = id;
+        });
+}
+
+UploadHandle UploadQueue::UploadBufferRegions(std::vector<BufferRegionUpload> regions)
+{
+    return Submit(
+        [regions = std::move(regions)](Upload&)
+        {
+            // staging buffer can be deleted right after the copy is issued, GL keeps its storage until the copy is done
+            for (const auto& region : regions)
+            {
+                if (region.Data.empty())
+                    continue;
+
+                Buffer stagingBuffer((GLsizeiptr)region.Data.size_bytes(), false, false, region.Data.data());
+                GL::CopyNamedBufferSubData(
+                    (GLuint)stagingBuffer.GetID(),
+                    region.Destination,
+                    0,
+                    region.Offset,
+                    (GLsizeiptr)region.Data.size_bytes());
+                stagingBuffer.Delete();
+            }
+        });
+}
+
+bool UploadQueue::IsComplete(UploadHandle handle)
+{
+    std::lock_guard lock(mutex_);
+
+    const auto upload = uploads_.find((uint32_t)handle);
+    if (upload == uploads_.end())
+        throw std::runtime_error("Upload handle is invalid.");
+
+    return upload->second->IsIssued && upload->second->Fence.IsSignaled();
+}
+
+Buffer UploadQueue::AcquireBuffer(UploadHandle handle)
+{
+    return Acquire(handle)->ResultBuffer;
+}
+
+GLuint UploadQueue::AcquireTexture(UploadHandle handle)
+{
+    return Acquire(handle)->ResultTexture;
+}
+
+void UploadQueue::AcquireBufferRegions(UploadHandle handle)
+{
+    Acquire(handle);
+}
+
+UploadHandle UploadQueue::Submit(std::function<void(Upload&)> job)
+{
+    UploadHandle handle;
+    {
+        std::lock_guard lock(mutex_);
+
+        handle = UploadHandle(nextHandle_++);
+        auto& upload = uploads_.emplace((uint32_t)handle, std::make_unique<Upload>()).first->second;
+        upload->Job = std::move(job);
+        pendingUploads_.push_back(upload.get());
+    }
+    jobSubmitted_.notify_one();
+
+    return handle;
+}
+
+std::unique_ptr<UploadQueue::Upload> UploadQueue::Acquire(UploadHandle handle)
+{
+    NV_PROFILE_FUNC;
+
+    std::unique_ptr<Upload> upload;
+    {
+        std::unique_lock lock(mutex_);
+
+        const auto it = uploads_.find((uint32_t)handle);
+        if (it == uploads_.end())
+            throw std::runtime_error("Upload handle is invalid.");
+
+        // upload itself doesn't move when map rehashes while waiting
+        const auto pendingUpload = it->second.get();
+        jobIssued_.wait(lock, [pendingUpload] { return pendingUpload->IsIssued; });
+
+        upload = std::move(uploads_.extract((uint32_t)handle).mapped());
+    }
+
+    if (upload->Exception)
+        std::rethrow_exception(upload->Exception);
+
+    upload->Fence.WaitServer();
+
+    return upload;
+}
+
+void UploadQueue::WorkerLoop(std::stop_token stopToken)
+{
+    glfwMakeContextCurrent(context_);
+
+    // pixel rows of uploaded textures are tightly packed
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    while (true)
+    {
+        Upload* upload;
+        {
+            std::unique_lock lock(mutex_);
+            if (!jobSubmitted_.wait(lock, stopToken, [this] { return !pendingUploads_.empty(); }))
+                break;
+
+            upload = pendingUploads_.front();
+            pendingUploads_.pop_front();
+        }
+
+        {
+            NV_PROFILE_SCOPE("UploadQueue::RunJob");
+
+            try
+            {
+                upload->Job(*upload);
+            }
+            catch (...)
+            {
+                upload->Exception = std::current_exception();
+            }
+        }
+
+        // fence has to be flushed, otherwise main context could wait for a fence which never reaches GPU
+        upload->Fence.Set();
+        glFlush();
+
+        {
+            std::lock_guard lock(mutex_);
+            upload->Job = nullptr;
+            upload->IsIssued = true;
+        }
+        jobIssued_.notify_all();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
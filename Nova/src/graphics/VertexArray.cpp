@@ -196,7 +196,12 @@ void VertexArray::Use() const noexcept
 
 void VertexArray::BindVertexBuffer(const Buffer &buffer, GLuint bindingIndex, GLsizei stride, GLintptr offset)
 {
-	const auto& bindingEntry = m_BufferBindings.find((GLuint)buffer.GetID());
+	BindVertexBuffer(buffer.GetID(), bindingIndex, stride, offset);
+}
+
+void VertexArray::BindVertexBuffer(BufferID buffer, GLuint bindingIndex, GLsizei stride, GLintptr offset)
+{
+	const auto& bindingEntry = m_BufferBindings.find((GLuint)buffer);
 	if (bindingEntry != m_BufferBindings.end())
 	{
 		m_UsedBufferBindings.erase(
@@ -208,9 +213,9 @@ void VertexArray::BindVertexBuffer(const Buffer &buffer, GLuint bindingIndex, GL
 		// NV_LOG_WARNING("Buffer with ID {} is already bound to binding index {}. Buffer will be rebound.", (GLuint)buffer.GetID(), bindingEntry->second);
 	}
 	
-	m_BufferBindings[(GLuint)buffer.GetID()] = bindingIndex;
+	m_BufferBindings[(GLuint)buffer] = bindingIndex;
 	m_UsedBufferBindings.emplace_back(bindingIndex);
-	GL::VertexArrayVertexBuffer(m_ID, bindingIndex, (GLuint)buffer.GetID(), offset, stride);
+	GL::VertexArrayVertexBuffer(m_ID, bindingIndex, (GLuint)buffer, offset, stride);
 }
 
 void VertexArray::BindVertexBuffer(const Buffer &buffer, GLuint bindingIndex, GLsizei stride, GLintptr offset, GLuint instanceDivisor)
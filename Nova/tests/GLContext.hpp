@@ -0,0 +1,47 @@
+#pragma once
+#include <Nova/graphics/Renderer.hpp>
+#include <Nova/graphics/Window.hpp>
+#include <Nova/debug/Log.hpp>
+#include <cstdio>
+#include <exception>
+
+namespace Nova::Test
+{
+    /// @brief Exit code which CTest reports as skipped, see SKIP_RETURN_CODE in CMakeLists.txt.
+    constexpr int c_SkipResult = 77;
+
+    /// @brief Opens small window for its OpenGL context, machines without display or driver skip the test.
+    inline bool CreateGLContext(const char* title)
+    {
+        NV_LOG_INITIALIZE(std::nullopt);
+
+        try
+        {
+            Window::Initialize_(WindowSettings { .Width = 64, .Height = 64, .Title = title });
+        }
+        catch (const std::exception& exception)
+        {
+            std::printf("[SKIP] No OpenGL context: %s\n", exception.what());
+            return false;
+        }
+
+        if (!gladLoadGL(Window::GetLoaderFunc_()))
+        {
+            std::printf("[SKIP] Failed to load OpenGL functions\n");
+            Window::Shutdown_();
+            return false;
+        }
+
+        return true;
+    }
+
+    inline RendererInfo GetRendererInfo() noexcept
+    {
+        return RendererInfo {
+            .VendorName = reinterpret_cast<const char*>(glGetString(GL_VENDOR)),
+            .RendererName = reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+            .Version = reinterpret_cast<const char*>(glGetString(GL_VERSION)),
+            .GLSLVersion = reinterpret_cast<const char*>(glGetString(GL_SHADING_LANGUAGE_VERSION)),
+        };
+    }
+}
@@ -0,0 +1,149 @@
+#include "Test.hpp"
+#include "GLContext.hpp"
+#include <Nova/graphics/MeshAllocator.hpp>
+#include <array>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using namespace Nova;
+
+constexpr GLsizei c_VertexStride = sizeof(float);
+
+template<typename Function>
+static bool IsThrowing(Function&& function)
+{
+    try
+    {
+        function();
+    }
+    catch (const std::exception&)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+template<typename T>
+static std::vector<T> ReadBuffer(const Buffer& buffer, GLuint offset, GLuint count)
+{
+    std::vector<T> data(count);
+    glGetNamedBufferSubData(
+        (GLuint)buffer.GetID(),
+        (GLintptr)offset * sizeof(T),
+        (GLsizeiptr)count * sizeof(T),
+        data.data());
+
+    return data;
+}
+
+static void TestReuseAfterFree()
+{
+    MeshAllocator allocator(c_VertexStride, 64, 64);
+    const auto first = allocator.Allocate(16, 24);
+    const auto second = allocator.Allocate(16, 24);
+    const auto firstRange = allocator.GetRange(first);
+
+    allocator.Free(first);
+    NV_TEST_EXPECT(!allocator.IsLive(first));
+    NV_TEST_EXPECT(allocator.IsLive(second));
+    NV_TEST_EXPECT(IsThrowing([&] { allocator.GetRange(first); }));
+    NV_TEST_EXPECT(IsThrowing([&] { allocator.Free(first); }));
+
+    // freed range is the best fit for a mesh of the same size, handle is recycled too
+    const auto version = allocator.GetVersion();
+    const auto third = allocator.Allocate(16, 24);
+    NV_TEST_EXPECT((uint32_t)third == (uint32_t)first);
+    NV_TEST_EXPECT(allocator.GetRange(third).BaseVertex == firstRange.BaseVertex);
+    NV_TEST_EXPECT(allocator.GetRange(third).BaseIndex == firstRange.BaseIndex);
+    NV_TEST_EXPECT(allocator.GetVersion() == version);
+
+    allocator.Delete();
+}
+
+static void TestCoalescing()
+{
+    MeshAllocator allocator(c_VertexStride, 48, 48);
+    std::array<MeshHandle, 3> meshes;
+    for (auto& mesh : meshes)
+        mesh = allocator.Allocate(16, 16);
+
+    // middle range merges with both neighbours once they are freed, in either order
+    allocator.Free(meshes[0]);
+    allocator.Free(meshes[2]);
+    NV_TEST_EXPECT(allocator.GetFragmentation() > 0.0f);
+    allocator.Free(meshes[1]);
+    NV_TEST_EXPECT(allocator.GetFragmentation() == 0.0f);
+
+    // whole buffer is one free range again, so a mesh filling it fits without growing
+    NV_TEST_EXPECT(allocator.Fits(48, 48));
+    NV_TEST_EXPECT(!allocator.Fits(49, 48));
+    const auto version = allocator.GetVersion();
+    const auto whole = allocator.Allocate(48, 48);
+    NV_TEST_EXPECT(allocator.GetRange(whole).BaseVertex == 0);
+    NV_TEST_EXPECT(allocator.GetRange(whole).BaseIndex == 0);
+    NV_TEST_EXPECT(allocator.GetVersion() == version);
+
+    allocator.Delete();
+}
+
+static void TestAllocationFailure()
+{
+    MeshAllocator allocator(c_VertexStride, 32, 32);
+    const auto mesh = allocator.Allocate(16, 16);
+    const auto version = allocator.GetVersion();
+
+    constexpr auto tooLarge = std::numeric_limits<GLuint>::max();
+    NV_TEST_EXPECT(IsThrowing([&] { allocator.Allocate(tooLarge, 16); }));
+    NV_TEST_EXPECT(IsThrowing([&] { allocator.Allocate(16, tooLarge); }));
+
+    // failed allocations don't keep any space, the rest of both buffers is still free
+    NV_TEST_EXPECT(allocator.IsLive(mesh));
+    NV_TEST_EXPECT(allocator.GetVersion() == version);
+    const auto rest = allocator.Allocate(16, 16);
+    NV_TEST_EXPECT(allocator.GetRange(rest).BaseVertex == 16);
+    NV_TEST_EXPECT(allocator.GetRange(rest).BaseIndex == 16);
+    NV_TEST_EXPECT(allocator.GetVersion() == version);
+
+    allocator.Delete();
+}
+
+static void TestGrowthKeepsData()
+{
+    MeshAllocator allocator(c_VertexStride, 4, 4);
+
+    std::vector<float> vertices(4);
+    std::iota(vertices.begin(), vertices.end(), 1.0f);
+    const std::vector<GLuint> indices = { 0, 1, 2, 3 };
+    const auto first = allocator.Allocate(vertices.data(), 4, indices);
+
+    // buffers are full, next mesh replaces them
+    const auto version = allocator.GetVersion();
+    const auto second = allocator.Allocate(vertices.data(), 4, indices);
+    NV_TEST_EXPECT(allocator.GetVersion() != version);
+
+    for (const auto mesh : { first, second })
+    {
+        const auto& range = allocator.GetRange(mesh);
+        NV_TEST_EXPECT(ReadBuffer<float>(allocator.GetVertexBuffer(), range.BaseVertex, 4) == vertices);
+        NV_TEST_EXPECT(ReadBuffer<GLuint>(allocator.GetIndexBuffer(), range.BaseIndex, 4) == indices);
+    }
+
+    allocator.Delete();
+}
+
+int main()
+{
+    if (!Test::CreateGLContext("MeshAllocatorTest"))
+        return Test::c_SkipResult;
+
+    Test::Run("ReuseAfterFree", TestReuseAfterFree);
+    Test::Run("Coalescing", TestCoalescing);
+    Test::Run("AllocationFailure", TestAllocationFailure);
+    Test::Run("GrowthKeepsData", TestGrowthKeepsData);
+
+    Window::Shutdown_();
+
+    return Test::GetResult();
+}
@@ -0,0 +1,126 @@
+#include "Test.hpp"
+#include <Nova/assets/MeshFile.hpp>
+#include <Nova/core/File.hpp>
+#include <Nova/debug/Log.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace Nova;
+
+static const std::filesystem::path c_Directory = std::filesystem::temp_directory_path() / "NovaMeshFileTest";
+
+template<typename Function>
+static bool IsThrowing(Function&& function)
+{
+    try
+    {
+        function();
+    }
+    catch (const std::exception&)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+static std::vector<ModelVertex> CreateVertices()
+{
+    return {
+        ModelVertex { .Position = glm::vec3(0.0f, 0.0f, 0.0f), .Normal = glm::vec3(0.0f, 0.0f, 1.0f), .TextureCoords = glm::vec2(0.0f, 0.0f) },
+        ModelVertex { .Position = glm::vec3(1.0f, 0.0f, 0.0f), .Normal = glm::vec3(0.0f, 0.0f, 1.0f), .TextureCoords = glm::vec2(1.0f, 0.0f) },
+        ModelVertex { .Position = glm::vec3(1.0f, 1.0f, 0.0f), .Normal = glm::vec3(0.0f, 0.0f, 1.0f), .TextureCoords = glm::vec2(1.0f, 1.0f) },
+        ModelVertex { .Position = glm::vec3(0.0f, 1.0f, 0.0f), .Normal = glm::vec3(0.0f, 0.0f, 1.0f), .TextureCoords = glm::vec2(0.0f, 1.0f) },
+    };
+}
+
+static const std::vector<GLuint> c_Indices = { 0, 1, 2, 0, 2, 3 };
+
+// overwrites one index in place, checksum is left as it was
+static void CorruptIndex(const std::filesystem::path& filepath, GLuint index)
+{
+    MeshFileHeader header;
+    {
+        std::ifstream input(filepath, std::ios::binary);
+        input.read(reinterpret_cast<char*>(&header), sizeof(header));
+    }
+
+    std::fstream file(filepath, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp((std::streamoff)header.IndexOffset);
+    file.write(reinterpret_cast<const char*>(&index), sizeof(index));
+}
+
+static void TestRoundTrip()
+{
+    const auto filepath = c_Directory / "RoundTrip.nvmesh";
+    const auto vertices = CreateVertices();
+    WriteMeshFile(filepath, vertices, c_Indices);
+    NV_TEST_EXPECT(!std::filesystem::exists(c_Directory / "RoundTrip.nvmesh.tmp"));
+
+    for (const auto verifyChecksum : { true, false })
+    {
+        const MeshFile file(filepath, verifyChecksum);
+        NV_TEST_EXPECT(file.GetVertices().size() == vertices.size());
+        NV_TEST_EXPECT(std::memcmp(file.GetVertices().data(), vertices.data(), vertices.size() * sizeof(ModelVertex)) == 0);
+        NV_TEST_EXPECT(std::vector<GLuint>(file.GetIndices().begin(), file.GetIndices().end()) == c_Indices);
+        NV_TEST_EXPECT(file.GetBounds().Box.Max.x == 1.0f && file.GetBounds().Box.Max.y == 1.0f);
+    }
+}
+
+static void TestInvalidIndices()
+{
+    const auto vertices = CreateVertices();
+    const std::vector<GLuint> indices = { 0, 1, 4 };
+    NV_TEST_EXPECT(IsThrowing([&] { WriteMeshFile(c_Directory / "InvalidIndices.nvmesh", vertices, indices); }));
+    NV_TEST_EXPECT(!std::filesystem::exists(c_Directory / "InvalidIndices.nvmesh"));
+
+    // damaged file is rejected by checksum, or by index validation when checksum isn't verified
+    const auto filepath = c_Directory / "DamagedIndices.nvmesh";
+    WriteMeshFile(filepath, vertices, c_Indices);
+    CorruptIndex(filepath, (GLuint)vertices.size());
+
+    NV_TEST_EXPECT(IsThrowing([&] { MeshFile file(filepath, true); }));
+    NV_TEST_EXPECT(IsThrowing([&] { MeshFile file(filepath, false); }));
+}
+
+static void TestFailedWriteLeavesNoFile()
+{
+    const std::vector<std::byte> data(64, std::byte { 0x2A });
+
+    // directory doesn't exist, so temporary file can't be opened
+    const auto missingDirectoryPath = c_Directory / "Missing" / "File.bin";
+    NV_TEST_EXPECT(IsThrowing([&] { File::WriteAtomically(missingDirectoryPath, data); }));
+    NV_TEST_EXPECT(!std::filesystem::exists(missingDirectoryPath.parent_path()));
+
+    // file can't replace a non-empty directory, temporary file is removed after failed rename
+    const auto directoryPath = c_Directory / "Directory";
+    std::filesystem::create_directories(directoryPath / "Child");
+    NV_TEST_EXPECT(IsThrowing([&] { File::WriteAtomically(directoryPath, data); }));
+    NV_TEST_EXPECT(std::filesystem::is_directory(directoryPath));
+    NV_TEST_EXPECT(!std::filesystem::exists(c_Directory / "Directory.tmp"));
+
+    // successful write replaces previous content
+    const auto filepath = c_Directory / "File.bin";
+    File::WriteAtomically(filepath, std::vector<std::byte>(128, std::byte { 0x11 }));
+    File::WriteAtomically(filepath, data);
+    NV_TEST_EXPECT(std::filesystem::file_size(filepath) == data.size());
+    NV_TEST_EXPECT(!std::filesystem::exists(c_Directory / "File.bin.tmp"));
+}
+
+int main()
+{
+    NV_LOG_INITIALIZE(std::nullopt);
+
+    std::filesystem::remove_all(c_Directory);
+    std::filesystem::create_directories(c_Directory);
+
+    Test::Run("RoundTrip", TestRoundTrip);
+    Test::Run("InvalidIndices", TestInvalidIndices);
+    Test::Run("FailedWriteLeavesNoFile", TestFailedWriteLeavesNoFile);
+
+    std::filesystem::remove_all(c_Directory);
+
+    return Test::GetResult();
+}
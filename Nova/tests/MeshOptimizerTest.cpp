@@ -0,0 +1,205 @@
+#include "Test.hpp"
+#include <Nova/assets/MeshOptimizer.hpp>
+#include <Nova/debug/Log.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using namespace Nova;
+
+constexpr uint32_t c_GridSize = 32;
+
+using Triangle = std::array<GLuint, 3>;
+using PositionTriangle = std::array<std::array<float, 3>, 3>;
+
+static ModelVertex GetGridVertex(uint32_t x, uint32_t y)
+{
+    return ModelVertex {
+        .Position = glm::vec3((float)x, (float)y, 0.0f),
+        .Normal = glm::vec3(0.0f, 0.0f, 1.0f),
+        .TextureCoords = glm::vec2((float)x / c_GridSize, (float)y / c_GridSize),
+    };
+}
+
+// two counter-clockwise triangles per cell, cells go row by row
+static std::vector<Triangle> CreateGridTriangles()
+{
+    const auto getIndex = [](uint32_t x, uint32_t y) { return (GLuint)(y * (c_GridSize + 1) + x); };
+
+    std::vector<Triangle> triangles;
+    for (uint32_t y = 0; y < c_GridSize; y++)
+    {
+        for (uint32_t x = 0; x < c_GridSize; x++)
+        {
+            triangles.push_back({ getIndex(x, y), getIndex(x + 1, y), getIndex(x + 1, y + 1) });
+            triangles.push_back({ getIndex(x, y), getIndex(x + 1, y + 1), getIndex(x, y + 1) });
+        }
+    }
+
+    return triangles;
+}
+
+static std::vector<ModelVertex> CreateGridVertices()
+{
+    std::vector<ModelVertex> vertices;
+    for (uint32_t y = 0; y <= c_GridSize; y++)
+    {
+        for (uint32_t x = 0; x <= c_GridSize; x++)
+            vertices.push_back(GetGridVertex(x, y));
+    }
+
+    return vertices;
+}
+
+// fixed shuffle, which leaves hardly any reuse between neighbouring triangles
+static void ShuffleTriangles(std::vector<Triangle>& triangles)
+{
+    uint32_t state = 12345;
+    for (size_t i = triangles.size() - 1; i > 0; i--)
+    {
+        state = state * 1664525u + 1013904223u;
+        std::swap(triangles[i], triangles[state % (i + 1)]);
+    }
+}
+
+static std::vector<GLuint> Flatten(const std::vector<Triangle>& triangles)
+{
+    std::vector<GLuint> indices;
+    for (const auto& triangle : triangles)
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+
+    return indices;
+}
+
+// rotation keeps winding, so triangles compare equal only when they have the same corners in the same cyclic order
+template<typename T>
+static std::vector<T> NormalizeTriangles(std::vector<T> triangles)
+{
+    for (auto& triangle : triangles)
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+static std::vector<Triangle> GetTriangles(std::span<const GLuint> indices)
+{
+    std::vector<Triangle> triangles;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        triangles.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+
+    return triangles;
+}
+
+static std::vector<PositionTriangle> GetPositionTriangles(
+    std::span<const ModelVertex> vertices,
+    std::span<const GLuint> indices)
+{
+    const auto getPosition = [&](GLuint index)
+    {
+        const auto& position = vertices[index].Position;
+        return std::array<float, 3> { position.x, position.y, position.z };
+    };
+
+    std::vector<PositionTriangle> triangles;
+    for (const auto& triangle : GetTriangles(indices))
+        triangles.push_back({ getPosition(triangle[0]), getPosition(triangle[1]), getPosition(triangle[2]) });
+
+    return triangles;
+}
+
+static void TestWeldDuplicates()
+{
+    const auto gridVertices = CreateGridVertices();
+    const auto gridIndices = Flatten(CreateGridTriangles());
+
+    // every face corner is its own vertex, as expanded by OBJ importer
+    std::vector<ModelVertex> corners;
+    for (const auto index : gridIndices)
+        corners.push_back(gridVertices[index]);
+
+    std::vector<ModelVertex> uniqueVertices;
+    const auto indices = WeldVertices(corners, uniqueVertices);
+
+    NV_TEST_EXPECT(uniqueVertices.size() == gridVertices.size());
+    NV_TEST_EXPECT(indices.size() == corners.size());
+    for (size_t i = 0; i < corners.size(); i++)
+        NV_TEST_EXPECT(uniqueVertices[indices[i]].Position.x == corners[i].Position.x &&
+            uniqueVertices[indices[i]].Position.y == corners[i].Position.y);
+
+    // vertices which share position, but not normal, stay separate
+    auto flipped = gridVertices[0];
+    flipped.Normal = glm::vec3(0.0f, 0.0f, -1.0f);
+    const std::vector<ModelVertex> seam = { gridVertices[0], flipped, gridVertices[0] };
+    const auto seamIndices = WeldVertices(seam, uniqueVertices);
+
+    NV_TEST_EXPECT(uniqueVertices.size() == 2);
+    NV_TEST_EXPECT(seamIndices == std::vector<GLuint>({ 0, 1, 0 }));
+}
+
+static void TestVertexCacheImproves()
+{
+    const auto vertexCount = CreateGridVertices().size();
+    auto triangles = CreateGridTriangles();
+    ShuffleTriangles(triangles);
+    auto indices = Flatten(triangles);
+
+    const auto before = AnalyzeVertexCache(indices, vertexCount);
+    OptimizeVertexCache(indices, vertexCount);
+    const auto after = AnalyzeVertexCache(indices, vertexCount);
+
+    std::printf("ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", before.ACMR, after.ACMR, before.ATVR, after.ATVR);
+    NV_TEST_EXPECT(after.ACMR < before.ACMR);
+    NV_TEST_EXPECT(after.ACMR < 1.0f);
+    NV_TEST_EXPECT(after.ATVR < before.ATVR);
+    NV_TEST_EXPECT(after.ATVR >= 1.0f);
+}
+
+static void TestWindingPreserved()
+{
+    auto triangles = CreateGridTriangles();
+    ShuffleTriangles(triangles);
+
+    // every other triangle is flipped, so that result can't match by turning all of them the same way
+    for (size_t i = 0; i < triangles.size(); i += 2)
+        std::swap(triangles[i][1], triangles[i][2]);
+
+    auto indices = Flatten(triangles);
+    OptimizeVertexCache(indices, CreateGridVertices().size());
+    NV_TEST_EXPECT(NormalizeTriangles(GetTriangles(indices)) == NormalizeTriangles(triangles));
+
+    // whole pipeline renames vertices, so triangles are compared by positions of their corners
+    const auto vertices = CreateGridVertices();
+    const auto originalIndices = Flatten(triangles);
+    const auto mesh = OptimizeMesh(vertices, originalIndices);
+
+    NV_TEST_EXPECT(mesh.Vertices.size() == vertices.size());
+    NV_TEST_EXPECT(
+        NormalizeTriangles(GetPositionTriangles(mesh.Vertices, mesh.Indices)) ==
+        NormalizeTriangles(GetPositionTriangles(vertices, originalIndices)));
+}
+
+static void TestDegenerateTrianglesDropped()
+{
+    const std::vector<ModelVertex> corners = {
+        GetGridVertex(0, 0), GetGridVertex(1, 0), GetGridVertex(1, 1),
+        GetGridVertex(0, 0), GetGridVertex(1, 0), GetGridVertex(0, 0), // collapses to a line after welding
+    };
+
+    const auto mesh = OptimizeMesh(corners);
+    NV_TEST_EXPECT(mesh.Indices.size() == 3);
+    NV_TEST_EXPECT(mesh.Vertices.size() == 3);
+}
+
+int main()
+{
+    NV_LOG_INITIALIZE(std::nullopt);
+
+    Test::Run("WeldDuplicates", TestWeldDuplicates);
+    Test::Run("VertexCacheImproves", TestVertexCacheImproves);
+    Test::Run("WindingPreserved", TestWindingPreserved);
+    Test::Run("DegenerateTrianglesDropped", TestDegenerateTrianglesDropped);
+
+    return Test::GetResult();
+}
@@ -0,0 +1,264 @@
+#include "Test.hpp"
+#include <Nova/assets/ObjImporter.hpp>
+#include <Nova/core/ThreadPool.hpp>
+#include <Nova/debug/Log.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Nova;
+
+// every line ends up in its own chunk
+constexpr size_t c_TinyChunkSize = 1;
+constexpr size_t c_SingleChunkSize = std::numeric_limits<size_t>::max();
+
+static std::vector<ModelVertex> ImportText(
+    std::string_view text,
+    size_t chunkSize = DefaultObjChunkSize,
+    ThreadPool* threadPool = nullptr)
+{
+    const auto filepath = std::filesystem::temp_directory_path() / "NovaObjImporterTest.obj";
+    {
+        std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+        file.write(text.data(), (std::streamsize)text.size());
+    }
+
+    auto vertices = ImportObj(filepath, threadPool, chunkSize);
+    std::filesystem::remove(filepath);
+
+    return vertices;
+}
+
+static bool IsBitwiseEqual(const std::vector<ModelVertex>& a, const std::vector<ModelVertex>& b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(ModelVertex)) == 0;
+}
+
+static bool IsEqual(const glm::vec3& a, const glm::vec3& b)
+{
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+static bool IsEqual(const glm::vec2& a, const glm::vec2& b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+static std::string ReplaceLineEndings(std::string_view text)
+{
+    std::string result;
+    for (const auto c : text)
+    {
+        if (c == '\n')
+            result += '\r';
+        result += c;
+    }
+
+    return result;
+}
+
+constexpr std::string_view c_Quad =
+    "v 0 0 0\n"
+    "v 1 0 0\n"
+    "v 1 1 0\n"
+    "v 0 1 0\n"
+    "vt 0 0\n"
+    "vt 1 0\n"
+    "vt 1 1\n"
+    "vt 0 1\n"
+    "vn 0 0 1\n"
+    "f 1/1/1 2/2/1 3/3/1\n"
+    "f 1/1/1 3/3/1 4/4/1\n";
+
+static void TestNegativeIndicesAcrossChunks()
+{
+    // relative indices of the last face point into lists parsed by earlier chunks
+    constexpr std::string_view text =
+        "v 0 0 0\n"
+        "v 1 0 0\n"
+        "vt 0.5 0.25\n"
+        "v 1 1 0\n"
+        "vn 0 0 1\n"
+        "# comment between chunks\n"
+        "v 0 1 0\n"
+        "f -4/-1/-1 -3/-1/-1 -2/-1/-1\n";
+
+    for (const auto chunkSize : { c_TinyChunkSize, c_SingleChunkSize })
+    {
+        const auto vertices = ImportText(text, chunkSize);
+        NV_TEST_EXPECT(vertices.size() == 3);
+        if (vertices.size() != 3)
+            continue;
+
+        NV_TEST_EXPECT(IsEqual(vertices[0].Position, glm::vec3(0.0f, 0.0f, 0.0f)));
+        NV_TEST_EXPECT(IsEqual(vertices[1].Position, glm::vec3(1.0f, 0.0f, 0.0f)));
+        NV_TEST_EXPECT(IsEqual(vertices[2].Position, glm::vec3(1.0f, 1.0f, 0.0f)));
+        for (const auto& vertex : vertices)
+        {
+            NV_TEST_EXPECT(IsEqual(vertex.TextureCoords, glm::vec2(0.5f, 0.25f)));
+            NV_TEST_EXPECT(IsEqual(vertex.Normal, glm::vec3(0.0f, 0.0f, 1.0f)));
+        }
+    }
+
+    // relative index before the first vertex is rejected
+    bool isThrowing = false;
+    try
+    {
+        ImportText("v 0 0 0\nf -1 -2 -3\n", c_TinyChunkSize);
+    }
+    catch (const std::exception&)
+    {
+        isThrowing = true;
+    }
+    NV_TEST_EXPECT(isThrowing);
+}
+
+static void TestPolygonTriangulation()
+{
+    constexpr std::string_view text =
+        "v 0 0 0\n"
+        "v 1 0 0\n"
+        "v 2 1 0\n"
+        "v 1 2 0\n"
+        "v 0 1 0\n"
+        "f 1 2 3 4 5\n";
+
+    // polygon is split into a fan around its first corner
+    const auto vertices = ImportText(text);
+    const std::vector<glm::vec3> expected = {
+        glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(2.0f, 1.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(2.0f, 1.0f, 0.0f), glm::vec3(1.0f, 2.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 2.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+    };
+
+    NV_TEST_EXPECT(vertices.size() == expected.size());
+    for (size_t i = 0; i < std::min(vertices.size(), expected.size()); i++)
+        NV_TEST_EXPECT(IsEqual(vertices[i].Position, expected[i]));
+}
+
+static void TestMissingAttributes()
+{
+    constexpr std::string_view text =
+        "v 0 0 0\n"
+        "v 0 2 0\n"
+        "v 0 0 2\n"
+        "vt 0.5 0.5\n"
+        "vn 1 0 0\n"
+        "f 1 2 3\n"
+        "f 1/1 2/1 3/1\n"
+        "f 1//1 2//1 3//1\n";
+
+    const auto vertices = ImportText(text);
+    NV_TEST_EXPECT(vertices.size() == 9);
+    if (vertices.size() != 9)
+        return;
+
+    // faces without normals get normal of their plane, counter-clockwise corners face +x
+    for (size_t i = 0; i < 6; i++)
+        NV_TEST_EXPECT(IsEqual(vertices[i].Normal, glm::vec3(1.0f, 0.0f, 0.0f)));
+
+    for (size_t i = 0; i < 3; i++)
+        NV_TEST_EXPECT(IsEqual(vertices[i].TextureCoords, glm::vec2(0.0f, 0.0f)));
+
+    for (size_t i = 3; i < 6; i++)
+        NV_TEST_EXPECT(IsEqual(vertices[i].TextureCoords, glm::vec2(0.5f, 0.5f)));
+
+    for (size_t i = 6; i < 9; i++)
+    {
+        NV_TEST_EXPECT(IsEqual(vertices[i].TextureCoords, glm::vec2(0.0f, 0.0f)));
+        NV_TEST_EXPECT(IsEqual(vertices[i].Normal, glm::vec3(1.0f, 0.0f, 0.0f)));
+    }
+}
+
+static void TestCRLFLineEndings()
+{
+    const auto expected = ImportText(c_Quad);
+    NV_TEST_EXPECT(expected.size() == 6);
+
+    const auto crlf = ReplaceLineEndings(c_Quad);
+    NV_TEST_EXPECT(IsBitwiseEqual(ImportText(crlf), expected));
+    NV_TEST_EXPECT(IsBitwiseEqual(ImportText(crlf, c_TinyChunkSize), expected));
+}
+
+static void TestNoTrailingNewline()
+{
+    const auto expected = ImportText(c_Quad);
+
+    auto text = std::string(c_Quad);
+    text.pop_back();
+    NV_TEST_EXPECT(IsBitwiseEqual(ImportText(text), expected));
+    NV_TEST_EXPECT(IsBitwiseEqual(ImportText(text, c_TinyChunkSize), expected));
+
+    // last line of CRLF file without newline only ends with carriage return in some exporters
+    text += '\r';
+    NV_TEST_EXPECT(IsBitwiseEqual(ImportText(text), expected));
+}
+
+// grid of quads, every other row referencing its vertices with relative indices and without texture coordinates
+static std::string CreateGridObj(int size)
+{
+    std::string text;
+    for (int y = 0; y <= size; y++)
+    {
+        for (int x = 0; x <= size; x++)
+        {
+            text += "v " + std::to_string(x * 0.125) + " " + std::to_string(y * 0.25) + " " + std::to_string((x ^ y) & 7) + "\n";
+            text += "vt " + std::to_string((double)x / size) + " " + std::to_string((double)y / size) + "\n";
+        }
+    }
+
+    const auto vertexCount = (size + 1) * (size + 1);
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            const auto a = y * (size + 1) + x + 1;
+            const auto b = a + size + 1;
+            if (y % 2 == 0)
+            {
+                text += "f " + std::to_string(a) + "/" + std::to_string(a) + " " + std::to_string(a + 1) + "/" +
+                    std::to_string(a + 1) + " " + std::to_string(b + 1) + "/" + std::to_string(b + 1) + " " +
+                    std::to_string(b) + "/" + std::to_string(b) + "\n";
+            }
+            else
+            {
+                const auto relative = [&](int index) { return std::to_string(index - vertexCount - 1); };
+                text += "f " + relative(a) + " " + relative(a + 1) + " " + relative(b + 1) + " " + relative(b) + "\n";
+            }
+        }
+    }
+
+    return text;
+}
+
+static void TestParallelMatchesSingleChunk()
+{
+    const auto text = CreateGridObj(48);
+    const auto expected = ImportText(text, c_SingleChunkSize);
+    NV_TEST_EXPECT(expected.size() == 48 * 48 * 6);
+
+    ThreadPool threadPool(4);
+    for (const auto chunkSize : { (size_t)1, (size_t)100, (size_t)4096 })
+    {
+        NV_TEST_EXPECT(IsBitwiseEqual(ImportText(text, chunkSize), expected));
+        NV_TEST_EXPECT(IsBitwiseEqual(ImportText(text, chunkSize, &threadPool), expected));
+    }
+}
+
+int main()
+{
+    NV_LOG_INITIALIZE(std::nullopt);
+
+    Test::Run("NegativeIndicesAcrossChunks", TestNegativeIndicesAcrossChunks);
+    Test::Run("PolygonTriangulation", TestPolygonTriangulation);
+    Test::Run("MissingAttributes", TestMissingAttributes);
+    Test::Run("CRLFLineEndings", TestCRLFLineEndings);
+    Test::Run("NoTrailingNewline", TestNoTrailingNewline);
+    Test::Run("ParallelMatchesSingleChunk", TestParallelMatchesSingleChunk);
+
+    return Test::GetResult();
+}
@@ -0,0 +1,138 @@
+#include "Test.hpp"
+#include <Nova/graphics/OcclusionCuller.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+using namespace Nova;
+
+constexpr int32_t c_Width = 128;
+constexpr int32_t c_Height = 64;
+
+// with this projection and viewport, view space x maps to pixel (x + 1) * 64 and y to (y + 1) * 32
+static const glm::mat4 c_Orthographic = glm::ortho(-1.0f, 1.0f, -1.0f, 1.0f, 0.1f, 100.0f);
+
+constexpr std::array<uint32_t, 6> c_QuadIndices { 0, 1, 2, 0, 2, 3 };
+
+struct Quad
+{
+    std::array<glm::vec3, 4> Vertices;
+
+    Quad(float minX, float minY, float maxX, float maxY, float z)
+        : Vertices {
+            glm::vec3(minX, minY, z),
+            glm::vec3(maxX, minY, z),
+            glm::vec3(maxX, maxY, z),
+            glm::vec3(minX, maxY, z),
+        } { }
+};
+
+static void TestEmptyBuffer()
+{
+    const OcclusionCuller uninitialized;
+    NV_TEST_EXPECT(uninitialized.IsVisible(BoundingSphere { .Center = glm::vec3(0.0f, 0.0f, -20.0f), .Radius = 0.1f }));
+
+    OcclusionCuller culler(c_Width, c_Height);
+    culler.Rasterize(c_Orthographic);
+
+    NV_TEST_EXPECT(culler.GetTriangleCount() == 0);
+    NV_TEST_EXPECT(std::ranges::all_of(culler.GetDepth(), [](float depth) { return depth == 1.0f; }));
+    NV_TEST_EXPECT(culler.IsVisible(BoundingSphere { .Center = glm::vec3(0.0f, 0.0f, -20.0f), .Radius = 0.1f }));
+
+    const std::array<float, 1> coordinates { 0.0f };
+    const std::array<float, 1> depths { -20.0f };
+    const std::array<float, 1> radii { 0.1f };
+    std::vector<uint32_t> indices { 0 };
+    NV_TEST_EXPECT(culler.RemoveOccluded(BoundingSphereBatch { coordinates, coordinates, depths, radii }, indices) == 0);
+    NV_TEST_EXPECT(indices.size() == 1);
+}
+
+static void TestFullyHidden()
+{
+    const Quad wall(-2.0f, -2.0f, 2.0f, 2.0f, -5.0f);
+
+    OcclusionCuller culler(c_Width, c_Height);
+    culler.AddOccluder(wall.Vertices, c_QuadIndices, glm::mat4(1.0f));
+    culler.Rasterize(c_Orthographic);
+
+    NV_TEST_EXPECT(culler.GetTriangleCount() == 2);
+    NV_TEST_EXPECT(!culler.IsVisible(BoundingSphere { .Center = glm::vec3(0.5f, -0.5f, -20.0f), .Radius = 0.1f }));
+    NV_TEST_EXPECT(!culler.IsVisible(BoundingSphere { .Center = glm::vec3(0.9f, -0.9f, -50.0f), .Radius = 0.5f }));
+
+    // pixels on the diagonal shared by both triangles are only partially covered by each, so they stay empty
+    NV_TEST_EXPECT(culler.IsVisible(BoundingSphere { .Center = glm::vec3(0.0f, 0.0f, -20.0f), .Radius = 0.01f }));
+
+    // in front of the occluder
+    NV_TEST_EXPECT(culler.IsVisible(BoundingSphere { .Center = glm::vec3(0.0f, 0.0f, -2.0f), .Radius = 0.1f }));
+
+    // occluders are cleared between frames
+    culler.Clear();
+    culler.Rasterize(c_Orthographic);
+    NV_TEST_EXPECT(culler.IsVisible(BoundingSphere { .Center = glm::vec3(0.5f, -0.5f, -20.0f), .Radius = 0.1f }));
+}
+
+static void TestPartlyVisible()
+{
+    // right edge of the wall crosses pixel 64 at 64.7, so the pixel's center is covered, but its right part isn't
+    constexpr float c_EdgeX = 0.7f / 64.0f;
+    const Quad wall(-2.0f, -2.0f, c_EdgeX, 2.0f, -5.0f);
+
+    OcclusionCuller culler(c_Width, c_Height);
+    culler.AddOccluder(wall.Vertices, c_QuadIndices, glm::mat4(1.0f));
+    culler.Rasterize(c_Orthographic);
+
+    NV_TEST_EXPECT(!culler.IsVisible(BoundingSphere { .Center = glm::vec3(-0.5f, 0.0f, -20.0f), .Radius = 0.1f }));
+    NV_TEST_EXPECT(culler.IsVisible(BoundingSphere { .Center = glm::vec3(0.5f, 0.0f, -20.0f), .Radius = 0.1f }));
+    NV_TEST_EXPECT(culler.IsVisible(BoundingSphere { .Center = glm::vec3(0.0f, 0.0f, -20.0f), .Radius = 0.1f }));
+
+    // bounds spanning pixel 64 from 64.75 to 64.95 lie only in its uncovered part
+    NV_TEST_EXPECT(culler.IsVisible(BoundingSphere { .Center = glm::vec3(0.85f / 64.0f, 0.0f, -20.0f), .Radius = 0.1f / 64.0f }));
+
+    // occluded spheres are removed while order of the rest is kept
+    const std::array<float, 4> centerX { 0.5f, -0.5f, 0.0f, -0.9f };
+    const std::array<float, 4> centerY { 0.0f, 0.0f, 0.0f, 0.5f };
+    const std::array<float, 4> centerZ { -20.0f, -20.0f, -20.0f, -20.0f };
+    const std::array<float, 4> radii { 0.1f, 0.1f, 0.1f, 0.05f };
+    std::vector<uint32_t> indices { 0, 1, 2, 3 };
+    NV_TEST_EXPECT(culler.RemoveOccluded(BoundingSphereBatch { centerX, centerY, centerZ, radii }, indices) == 2);
+    NV_TEST_EXPECT((indices == std::vector<uint32_t> { 0, 2 }));
+}
+
+static void TestBehindNearPlane()
+{
+    const auto perspective = glm::perspective(glm::radians(60.0f), (float)c_Width / c_Height, 0.1f, 100.0f);
+
+    // wall crossing the near plane is skipped, even though its visible part would hide spheres behind it
+    const Quad crossingWall(-10.0f, -10.0f, 10.0f, 10.0f, 0.0f);
+    std::array<glm::vec3, 4> tiltedVertices = crossingWall.Vertices;
+    tiltedVertices[0].z = tiltedVertices[1].z = 1.0f;
+    tiltedVertices[2].z = tiltedVertices[3].z = -10.0f;
+
+    OcclusionCuller culler(c_Width, c_Height);
+    culler.AddOccluder(tiltedVertices, c_QuadIndices, glm::mat4(1.0f));
+    culler.Rasterize(perspective);
+
+    NV_TEST_EXPECT(culler.GetTriangleCount() == 0);
+    NV_TEST_EXPECT(culler.IsVisible(BoundingSphere { .Center = glm::vec3(0.0f, 0.0f, -20.0f), .Radius = 0.5f }));
+
+    // sphere reaching in front of the near plane is always visible, even behind an occluder
+    const Quad wall(-10.0f, -10.0f, 10.0f, 10.0f, -5.0f);
+    culler.Clear();
+    culler.AddOccluder(wall.Vertices, c_QuadIndices, glm::mat4(1.0f));
+    culler.Rasterize(perspective);
+
+    NV_TEST_EXPECT(!culler.IsVisible(BoundingSphere { .Center = glm::vec3(2.0f, -1.0f, -20.0f), .Radius = 0.5f }));
+    NV_TEST_EXPECT(culler.IsVisible(BoundingSphere { .Center = glm::vec3(0.0f, 0.0f, 0.0f), .Radius = 0.5f }));
+    NV_TEST_EXPECT(culler.IsVisible(BoundingSphere { .Center = glm::vec3(0.0f, 0.0f, 2.0f), .Radius = 0.5f }));
+}
+
+int main()
+{
+    Test::Run("EmptyBuffer", TestEmptyBuffer);
+    Test::Run("FullyHidden", TestFullyHidden);
+    Test::Run("PartlyVisible", TestPartlyVisible);
+    Test::Run("BehindNearPlane", TestBehindNearPlane);
+
+    return Test::GetResult();
+}
@@ -0,0 +1,144 @@
+#include "Test.hpp"
+#include <Nova/graphics/RenderQueue.hpp>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace Nova;
+
+// reference order, equal keys keep order in which they were pushed
+static std::vector<RenderQueueEntry> SortReference(std::vector<RenderQueueEntry> entries)
+{
+    std::stable_sort(
+        entries.begin(),
+        entries.end(),
+        [](const RenderQueueEntry& a, const RenderQueueEntry& b) { return a.Key < b.Key; });
+
+    return entries;
+}
+
+static bool IsSameOrder(std::span<const RenderQueueEntry> a, std::span<const RenderQueueEntry> b)
+{
+    return std::equal(
+        a.begin(),
+        a.end(),
+        b.begin(),
+        b.end(),
+        [](const RenderQueueEntry& x, const RenderQueueEntry& y) { return x.Key == y.Key && x.PayloadIndex == y.PayloadIndex; });
+}
+
+static void TestStableOrder()
+{
+    // few distinct keys, so that most of them repeat
+    std::mt19937_64 random(7);
+    std::uniform_int_distribution<uint32_t> pass(0, 3);
+    std::uniform_int_distribution<uint32_t> model(0, 15);
+    std::uniform_int_distribution<uint32_t> material(0, 7);
+
+    RenderQueue<uint32_t> queue;
+    std::vector<RenderQueueEntry> pushed;
+    for (uint32_t i = 0; i < 10000; i++)
+    {
+        const auto key = RenderSortKey::Make(pass(random), model(random), material(random), 0);
+        queue.Push(key, i);
+        pushed.push_back(RenderQueueEntry { key, i });
+    }
+
+    queue.Sort();
+
+    NV_TEST_EXPECT(IsSameOrder(queue.GetEntries(), SortReference(pushed)));
+    for (const auto& entry : queue.GetEntries())
+        NV_TEST_EXPECT(queue.GetPayload(entry) == entry.PayloadIndex);
+}
+
+static void TestFullKeys()
+{
+    std::mt19937_64 random(11);
+
+    std::vector<RenderQueueEntry> entries;
+    for (uint32_t i = 0; i < 4096; i++)
+        entries.push_back(RenderQueueEntry { random(), i });
+
+    // duplicates of existing keys check stability with every digit in use
+    for (uint32_t i = 0; i < 512; i++)
+        entries.push_back(RenderQueueEntry { entries[i * 3].Key, 4096 + i });
+
+    const auto expected = SortReference(entries);
+
+    std::vector<RenderQueueEntry> scratch;
+    RadixSort(entries, scratch);
+
+    NV_TEST_EXPECT(IsSameOrder(entries, expected));
+}
+
+static void TestSkippedDigits()
+{
+    // keys differ in a single byte, so that seven of eight passes are skipped and result stays in scratch
+    std::vector<RenderQueueEntry> entries;
+    for (uint32_t i = 0; i < 300; i++)
+        entries.push_back(RenderQueueEntry { 0x0123456789000000ull | (uint64_t)((i * 37) % 256) << 16, i });
+
+    const auto expected = SortReference(entries);
+
+    std::vector<RenderQueueEntry> scratch;
+    RadixSort(entries, scratch);
+
+    NV_TEST_EXPECT(IsSameOrder(entries, expected));
+}
+
+static void TestSmallQueues()
+{
+    std::vector<RenderQueueEntry> scratch;
+
+    std::vector<RenderQueueEntry> empty;
+    RadixSort(empty, scratch);
+    NV_TEST_EXPECT(empty.empty());
+
+    std::vector<RenderQueueEntry> single { RenderQueueEntry { 42, 0 } };
+    RadixSort(single, scratch);
+    NV_TEST_EXPECT(single.size() == 1 && single[0].Key == 42);
+
+    std::vector<RenderQueueEntry> equal(5, RenderQueueEntry { 9, 0 });
+    for (uint32_t i = 0; i < equal.size(); i++)
+        equal[i].PayloadIndex = i;
+    RadixSort(equal, scratch);
+    for (uint32_t i = 0; i < equal.size(); i++)
+        NV_TEST_EXPECT(equal[i].PayloadIndex == i);
+}
+
+static void TestKeyLayout()
+{
+    // pass dominates every other field, so passes form contiguous ranges
+    NV_TEST_EXPECT(RenderSortKey::Make(1, 0, 0, 0) > RenderSortKey::Make(0, RenderSortKey::MaxModels - 1, 0xFFFF, 0xFFFFFF));
+    NV_TEST_EXPECT(RenderSortKey::MakeDepthMajor(1, 0, 0, 0) > RenderSortKey::MakeDepthMajor(0, 0xFFFFFF, RenderSortKey::MaxModels - 1, 0xFFFF));
+
+    const auto key = RenderSortKey::Make(3, 1234, 56, 789);
+    NV_TEST_EXPECT(RenderSortKey::GetPass(key) == 3);
+    NV_TEST_EXPECT(RenderSortKey::GetModel(key) == 1234);
+
+    const auto depthMajorKey = RenderSortKey::MakeDepthMajor(2, 789, 1234, 56);
+    NV_TEST_EXPECT(RenderSortKey::GetPass(depthMajorKey) == 2);
+    NV_TEST_EXPECT(RenderSortKey::GetDepthMajorModel(depthMajorKey) == 1234);
+
+    // quantized depth keeps ordering of distances, inverted depth reverses it
+    auto previous = RenderSortKey::QuantizeDepth(0.0f);
+    for (const auto distance : { 0.001f, 0.5f, 1.0f, 10.0f, 1000.0f, 1e6f })
+    {
+        const auto quantized = RenderSortKey::QuantizeDepth(distance);
+        NV_TEST_EXPECT(quantized > previous);
+        NV_TEST_EXPECT(RenderSortKey::InvertDepth(quantized) < RenderSortKey::InvertDepth(previous));
+        previous = quantized;
+    }
+    NV_TEST_EXPECT(RenderSortKey::QuantizeDepth(-1.0f) == RenderSortKey::QuantizeDepth(0.0f));
+}
+
+int main()
+{
+    Test::Run("StableOrder", TestStableOrder);
+    Test::Run("FullKeys", TestFullKeys);
+    Test::Run("SkippedDigits", TestSkippedDigits);
+    Test::Run("SmallQueues", TestSmallQueues);
+    Test::Run("KeyLayout", TestKeyLayout);
+
+    return Test::GetResult();
+}
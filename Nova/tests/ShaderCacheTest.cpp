@@ -0,0 +1,143 @@
+#include "Test.hpp"
+#include "GLContext.hpp"
+#include <Nova/graphics/ShaderCache.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+
+using namespace Nova;
+
+static const auto c_Directory = std::filesystem::temp_directory_path() / "NovaShaderCacheTest";
+
+constexpr std::string_view c_VertexSource =
+    "#version 450 core\n"
+    "void main() { gl_Position = vec4(float(gl_VertexID), 0.0, 0.0, 1.0); }\n";
+
+constexpr std::string_view c_FragmentSource =
+    "#version 450 core\n"
+    "out vec4 oColor;\n"
+    "void main() { oColor = vec4(1.0); }\n";
+
+static void WriteText(const std::filesystem::path& filepath, std::string_view text)
+{
+    std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+    file << text;
+}
+
+static ShaderProgram LoadTestProgram(ShaderCache& cache)
+{
+    return cache.LoadProgram(
+        "Test",
+        {
+            ShaderStageSource { .Type = ShaderType::Vertex, .Filepath = c_Directory / "test.vert" },
+            ShaderStageSource { .Type = ShaderType::Fragment, .Filepath = c_Directory / "test.frag" },
+        });
+}
+
+static void TestUnusableDirectory()
+{
+    // regular file in place of the directory
+    const auto filepath = c_Directory / "NotADirectory";
+    WriteText(filepath, "");
+
+    auto isThrown = false;
+    try
+    {
+        ShaderCache cache(filepath, Test::GetRendererInfo());
+        NV_TEST_EXPECT(!cache.IsEnabled());
+
+        auto program = LoadTestProgram(cache);
+        program.Delete();
+        NV_TEST_EXPECT(cache.GetStats().Misses == 1);
+    }
+    catch (const std::exception&)
+    {
+        isThrown = true;
+    }
+
+    NV_TEST_EXPECT(!isThrown);
+}
+
+static void TestHitAfterMiss()
+{
+    {
+        ShaderCache cache(c_Directory / "Cache", Test::GetRendererInfo());
+        cache.Clear(true);
+
+        auto program = LoadTestProgram(cache);
+        program.Delete();
+        NV_TEST_EXPECT(cache.GetStats().Misses == 1);
+        NV_TEST_EXPECT(cache.GetStats().Hits == 0);
+    }
+
+    // registry is read back by the next cache, as on the next launch
+    ShaderCache cache(c_Directory / "Cache", Test::GetRendererInfo());
+    auto program = LoadTestProgram(cache);
+    program.Delete();
+    NV_TEST_EXPECT(cache.GetStats().Hits == 1);
+    NV_TEST_EXPECT(cache.GetStats().Misses == 0);
+}
+
+static void TestSourceChangeMisses()
+{
+    ShaderCache cache(c_Directory / "Cache", Test::GetRendererInfo());
+    auto program = LoadTestProgram(cache);
+    program.Delete();
+    NV_TEST_EXPECT(cache.GetStats().Hits == 1);
+
+    WriteText(c_Directory / "test.frag", "#version 450 core\nout vec4 oColor;\nvoid main() { oColor = vec4(0.5); }\n");
+    program = LoadTestProgram(cache);
+    program.Delete();
+    NV_TEST_EXPECT(cache.GetStats().Misses == 1);
+
+    WriteText(c_Directory / "test.frag", c_FragmentSource);
+}
+
+static void TestCorruptedBinaryIsRejected()
+{
+    ShaderCache cache(c_Directory / "Cache", Test::GetRendererInfo());
+    cache.Clear(true);
+
+    auto program = LoadTestProgram(cache);
+    program.Delete();
+
+    for (const auto& entry : std::filesystem::directory_iterator(c_Directory / "Cache"))
+    {
+        if (entry.path().extension() == ".bin")
+            WriteText(entry.path(), "corrupted");
+    }
+
+    program = LoadTestProgram(cache);
+    program.Delete();
+    NV_TEST_EXPECT(cache.GetStats().Rejected == 1);
+    NV_TEST_EXPECT(cache.GetStats().Misses == 2);
+    NV_TEST_EXPECT(cache.GetStats().Hits == 0);
+}
+
+int main()
+{
+    if (!Test::CreateGLContext("ShaderCacheTest"))
+        return Test::c_SkipResult;
+
+    std::filesystem::remove_all(c_Directory);
+    std::filesystem::create_directories(c_Directory);
+    WriteText(c_Directory / "test.vert", c_VertexSource);
+    WriteText(c_Directory / "test.frag", c_FragmentSource);
+
+    Test::Run("UnusableDirectory", TestUnusableDirectory);
+
+    // remaining cases need a driver which can return program binaries
+    if (ShaderProgram::IsProgramBinarySupported())
+    {
+        Test::Run("HitAfterMiss", TestHitAfterMiss);
+        Test::Run("SourceChangeMisses", TestSourceChangeMisses);
+        Test::Run("CorruptedBinaryIsRejected", TestCorruptedBinaryIsRejected);
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(c_Directory, error);
+
+    Window::Shutdown_();
+
+    return Test::GetResult();
+}
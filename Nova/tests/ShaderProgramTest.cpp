@@ -0,0 +1,135 @@
+#include "Test.hpp"
+#include "GLContext.hpp"
+#include <Nova/graphics/opengl/ShaderProgram.hpp>
+#include <string_view>
+#include <vector>
+
+using namespace Nova;
+
+constexpr std::string_view c_VertexSource =
+    "#version 450 core\n"
+    "void main() { gl_Position = vec4(float(gl_VertexID), 0.0, 0.0, 1.0); }\n";
+
+constexpr std::string_view c_FragmentSource =
+    "#version 450 core\n"
+    "out vec4 oColor;\n"
+    "void main() { oColor = vec4(1.0); }\n";
+
+// compiles, but vertex stage without main can't be linked
+constexpr std::string_view c_VertexSourceWithoutMain =
+    "#version 450 core\n"
+    "vec4 GetPosition() { return vec4(0.0); }\n";
+
+constexpr std::string_view c_BrokenFragmentSource =
+    "#version 450 core\n"
+    "void main() { undeclared = 1.0; }\n";
+
+static PendingShaderProgram BeginProgram(std::string_view vertexSource, std::string_view fragmentSource)
+{
+    std::vector<ShaderStage> stages;
+    stages.push_back(ShaderStage::BeginFromGLSL(ShaderType::Vertex, vertexSource));
+    stages.push_back(ShaderStage::BeginFromGLSL(ShaderType::Fragment, fragmentSource));
+
+    return PendingShaderProgram(std::move(stages));
+}
+
+static bool IsGetThrowing(PendingShaderProgram& pending)
+{
+    try
+    {
+        auto program = pending.Get();
+        program.Delete();
+    }
+    catch (const std::exception&)
+    {
+        return true;
+    }
+
+    return false;
+}
+
+static void TestValidProgram()
+{
+    auto pending = BeginProgram(c_VertexSource, c_FragmentSource);
+    NV_TEST_EXPECT(!IsGetThrowing(pending));
+}
+
+static void TestCompileFailure()
+{
+    auto pending = BeginProgram(c_VertexSource, c_BrokenFragmentSource);
+    NV_TEST_EXPECT(IsGetThrowing(pending));
+
+    // failure isn't forgotten, which would hand out an empty program
+    NV_TEST_EXPECT(IsGetThrowing(pending));
+    NV_TEST_EXPECT(pending.IsReady());
+}
+
+static void TestLinkFailure()
+{
+    auto pending = BeginProgram(c_VertexSourceWithoutMain, c_FragmentSource);
+    NV_TEST_EXPECT(IsGetThrowing(pending));
+    NV_TEST_EXPECT(IsGetThrowing(pending));
+}
+
+static void TestFailureMovesWithProgram()
+{
+    auto pending = BeginProgram(c_VertexSource, c_BrokenFragmentSource);
+    NV_TEST_EXPECT(IsGetThrowing(pending));
+
+    auto moved = std::move(pending);
+    NV_TEST_EXPECT(IsGetThrowing(moved));
+
+    PendingShaderProgram assigned;
+    assigned = std::move(moved);
+    NV_TEST_EXPECT(IsGetThrowing(assigned));
+}
+
+static void TestMovesKeepOwnership()
+{
+    // moved-from programs are empty, so destroying them doesn't delete the program they handed over
+    PendingShaderProgram assigned;
+    {
+        auto pending = BeginProgram(c_VertexSource, c_FragmentSource);
+        auto moved = std::move(pending);
+        assigned = std::move(moved);
+    }
+    NV_TEST_EXPECT(!IsGetThrowing(assigned));
+
+    // program replaced by assignment is deleted, the assigned one stays usable
+    auto replaced = BeginProgram(c_VertexSource, c_FragmentSource);
+    replaced = BeginProgram(c_VertexSource, c_BrokenFragmentSource);
+    NV_TEST_EXPECT(IsGetThrowing(replaced));
+
+    replaced = BeginProgram(c_VertexSource, c_FragmentSource);
+    NV_TEST_EXPECT(!IsGetThrowing(replaced));
+}
+
+static void TestConcurrentPrograms()
+{
+    // every program is issued before any is waited for, broken one doesn't affect the others
+    std::vector<PendingShaderProgram> pending;
+    for (int i = 0; i < 8; i++)
+        pending.push_back(BeginProgram(c_VertexSource, i == 3 ? c_BrokenFragmentSource : c_FragmentSource));
+
+    for (size_t i = 0; i < pending.size(); i++)
+        NV_TEST_EXPECT(IsGetThrowing(pending[i]) == (i == 3));
+}
+
+int main()
+{
+    if (!Test::CreateGLContext("ShaderProgramTest"))
+        return Test::c_SkipResult;
+
+    std::printf("Parallel shader compile %s\n", ShaderProgram::IsParallelCompileSupported() ? "supported" : "not supported");
+
+    Test::Run("ValidProgram", TestValidProgram);
+    Test::Run("CompileFailure", TestCompileFailure);
+    Test::Run("LinkFailure", TestLinkFailure);
+    Test::Run("FailureMovesWithProgram", TestFailureMovesWithProgram);
+    Test::Run("MovesKeepOwnership", TestMovesKeepOwnership);
+    Test::Run("ConcurrentPrograms", TestConcurrentPrograms);
+
+    Window::Shutdown_();
+
+    return Test::GetResult();
+}
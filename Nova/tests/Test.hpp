@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdio>
+
+namespace Nova::Test
+{
+    inline int& GetFailureCount() noexcept
+    {
+        static int failureCount = 0;
+        return failureCount;
+    }
+
+    /// @brief Runs test case and reports whether its checks passed.
+    template<typename Function>
+    void Run(const char* name, Function&& function)
+    {
+        const auto previousFailureCount = GetFailureCount();
+        function();
+        std::printf("[%s] %s\n", GetFailureCount() == previousFailureCount ? "PASS" : "FAIL", name);
+    }
+
+    /// @brief Exit code of test executable.
+    inline int GetResult() noexcept
+    {
+        return GetFailureCount() == 0 ? 0 : 1;
+    }
+}
+
+// failed checks are reported but don't stop the test case, so that all of its failures are listed at once
+#define NV_TEST_EXPECT(condition) \
+    do \
+    { \
+        if (!(condition)) \
+        { \
+            std::printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            Nova::Test::GetFailureCount()++; \
+        } \
+    } while (false)
@@ -0,0 +1,217 @@
+#include "Test.hpp"
+#include <Nova/assets/TextureCompressor.hpp>
+#include <Nova/assets/TextureFile.hpp>
+#include <Nova/debug/Log.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
+
+using namespace Nova;
+
+constexpr uint32_t c_BlocksPerRow = 4;
+constexpr uint32_t c_ImageSize = c_BlocksPerRow * 4;
+
+struct FormatBounds
+{
+    BlockFormat Format;
+    const char* Name;
+    uint32_t ChannelCount;
+    // lowest PSNR in dB accepted for every quality, a little below what the encoder reaches on the test image
+    double MinPSNR;
+};
+
+// BC1 is measured on opaque image, since texels with alpha below one half are stored as transparent black,
+// BC5 only on red and green, which are the channels it stores
+constexpr std::array<FormatBounds, 4> c_Formats = {
+    FormatBounds { BlockFormat::BC1, "BC1", 3, 26.0 },
+    FormatBounds { BlockFormat::BC3, "BC3", 4, 27.0 },
+    FormatBounds { BlockFormat::BC5, "BC5", 2, 32.0 },
+    FormatBounds { BlockFormat::BC7, "BC7", 4, 48.0 },
+};
+
+// with endpoints from bounding box, fast quality may be only a little worse than normal one
+constexpr double c_MaxFastQualityLoss = 3.0;
+
+constexpr std::array<CompressionQuality, 3> c_Qualities = {
+    CompressionQuality::Fast,
+    CompressionQuality::Normal,
+    CompressionQuality::High,
+};
+
+static void SetPixel(Image& image, uint32_t x, uint32_t y, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    auto* pixel = &image.Pixels[((size_t)y * image.Width + x) * 4];
+    pixel[0] = r;
+    pixel[1] = g;
+    pixel[2] = b;
+    pixel[3] = a;
+}
+
+// 16 fixed blocks: flat colors, gradients with channels rising and falling, two-color edges and low-amplitude noise,
+// alpha follows the colors where it isn't opaque
+static Image CreateTestImage(bool isOpaque)
+{
+    Image image { .Width = c_ImageSize, .Height = c_ImageSize, .Pixels = std::vector<uint8_t>(c_ImageSize * c_ImageSize * 4) };
+
+    uint32_t state = 12345;
+    for (uint32_t block = 0; block < c_BlocksPerRow * c_BlocksPerRow; block++)
+    {
+        const auto blockX = block % c_BlocksPerRow * 4;
+        const auto blockY = block / c_BlocksPerRow * 4;
+        for (uint32_t y = 0; y < 4; y++)
+        {
+            for (uint32_t x = 0; x < 4; x++)
+            {
+                state = state * 1664525u + 1013904223u;
+                const auto noise = (uint8_t)(state >> 28);
+                const auto t = (uint8_t)((x + y * 4) * 17);
+
+                switch (block % 4)
+                {
+                case 0:
+                    SetPixel(image, blockX + x, blockY + y, (uint8_t)(block * 16), 128, (uint8_t)(255 - block * 16), 255);
+                    break;
+                case 1:
+                    SetPixel(image, blockX + x, blockY + y, t, (uint8_t)(255 - t), (uint8_t)(t / 2), isOpaque ? 255 : (uint8_t)(64 + t / 2));
+                    break;
+                case 2:
+                    SetPixel(
+                        image,
+                        blockX + x,
+                        blockY + y,
+                        x < 2 ? 200 : 40,
+                        x < 2 ? 60 : 180,
+                        (uint8_t)(block * 12),
+                        isOpaque || x < 2 ? 255 : 128);
+                    break;
+                default:
+                    SetPixel(image, blockX + x, blockY + y, (uint8_t)(96 + noise), (uint8_t)(160 - noise), (uint8_t)(32 + noise * 2), 255);
+                    break;
+                }
+            }
+        }
+    }
+
+    return image;
+}
+
+static void TestRoundTripPSNR()
+{
+    for (const auto& format : c_Formats)
+    {
+        const auto image = CreateTestImage(format.Format == BlockFormat::BC1);
+
+        std::array<double, c_Qualities.size()> qualityPSNR {};
+        for (const auto quality : c_Qualities)
+        {
+            const auto compressed = CompressImage(image, format.Format, quality);
+            NV_TEST_EXPECT(compressed.Width == image.Width && compressed.Height == image.Height);
+            NV_TEST_EXPECT(compressed.Blocks.size() == c_BlocksPerRow * c_BlocksPerRow * GetBlockSize(format.Format));
+
+            const auto decompressed = DecompressImage(compressed, format.Format);
+            const auto psnr = ComputePSNR(image, decompressed, format.ChannelCount);
+
+            std::printf("%s quality %u: %.2f dB\n", format.Name, (uint32_t)quality, psnr);
+            NV_TEST_EXPECT(psnr >= format.MinPSNR);
+            qualityPSNR[(size_t)quality] = psnr;
+        }
+
+        // refinement only keeps endpoints which lower the error, so higher quality is never worse
+        const auto normalPSNR = qualityPSNR[(size_t)CompressionQuality::Normal];
+        NV_TEST_EXPECT(qualityPSNR[(size_t)CompressionQuality::Fast] >= normalPSNR - c_MaxFastQualityLoss);
+        NV_TEST_EXPECT(qualityPSNR[(size_t)CompressionQuality::High] >= normalPSNR);
+    }
+}
+
+static void TestFlatBlocksAreNearlyExact()
+{
+    Image image { .Width = 4, .Height = 4, .Pixels = std::vector<uint8_t>(4 * 4 * 4) };
+    for (uint32_t i = 0; i < 16; i++)
+        SetPixel(image, i % 4, i / 4, 32, 96, 224, 255);
+
+    // flat color lies on both endpoints after quantization to the endpoint precision of each format
+    for (const auto& format : c_Formats)
+    {
+        const auto decompressed = DecompressImage(CompressImage(image, format.Format, CompressionQuality::Normal), format.Format);
+        NV_TEST_EXPECT(ComputePSNR(image, decompressed, format.ChannelCount) >= 45.0);
+    }
+}
+
+static Image CropImage(const Image& source, uint32_t width, uint32_t height)
+{
+    // coordinates past the source repeat its edge texels
+    Image image { .Width = width, .Height = height, .Pixels = std::vector<uint8_t>((size_t)width * height * 4) };
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            const auto sourceX = std::min(x, source.Width - 1);
+            const auto sourceY = std::min(y, source.Height - 1);
+            std::copy_n(&source.Pixels[((size_t)sourceY * source.Width + sourceX) * 4], 4, &image.Pixels[((size_t)y * width + x) * 4]);
+        }
+    }
+
+    return image;
+}
+
+static void TestPartialBlocks()
+{
+    // partial blocks are filled by repeating edge texels, so they decode like the same image padded that way
+    const auto image = CropImage(CreateTestImage(true), 6, 5);
+    const auto padded = CropImage(image, 8, 8);
+
+    for (const auto& format : c_Formats)
+    {
+        const auto compressed = CompressImage(image, format.Format, CompressionQuality::Normal);
+        NV_TEST_EXPECT(compressed.Blocks.size() == 2 * 2 * GetBlockSize(format.Format));
+        NV_TEST_EXPECT(compressed.Blocks == CompressImage(padded, format.Format, CompressionQuality::Normal).Blocks);
+
+        const auto decompressed = DecompressImage(compressed, format.Format);
+        NV_TEST_EXPECT(decompressed.Width == image.Width && decompressed.Height == image.Height);
+        NV_TEST_EXPECT(decompressed.Pixels.size() == GetImageSize(image));
+    }
+}
+
+static void TestTextureFileRoundTrip()
+{
+    const auto filepath = std::filesystem::temp_directory_path() / "NovaTextureCompressorTest.nvtex";
+    const auto levels = GenerateMipChain(CreateTestImage(false), MipFilter::Box, false);
+
+    for (const auto& format : c_Formats)
+    {
+        std::vector<CompressedImage> compressedLevels;
+        for (const auto& level : levels)
+            compressedLevels.push_back(CompressImage(level, format.Format, CompressionQuality::Fast));
+
+        WriteTextureFile(filepath, compressedLevels, format.Format, false);
+
+        const TextureFile file(filepath);
+        NV_TEST_EXPECT(file.GetFormat() == format.Format);
+        NV_TEST_EXPECT(file.GetLevels().size() == compressedLevels.size());
+        for (uint32_t i = 0; i < std::min(file.GetLevels().size(), compressedLevels.size()); i++)
+        {
+            const auto data = file.GetLevelData(i);
+            NV_TEST_EXPECT(data.size() == compressedLevels[i].Blocks.size());
+            NV_TEST_EXPECT(std::equal(
+                compressedLevels[i].Blocks.begin(),
+                compressedLevels[i].Blocks.end(),
+                reinterpret_cast<const uint8_t*>(data.data())));
+        }
+    }
+
+    std::filesystem::remove(filepath);
+}
+
+int main()
+{
+    NV_LOG_INITIALIZE(std::nullopt);
+
+    Test::Run("RoundTripPSNR", TestRoundTripPSNR);
+    Test::Run("FlatBlocksAreNearlyExact", TestFlatBlocksAreNearlyExact);
+    Test::Run("PartialBlocks", TestPartialBlocks);
+    Test::Run("TextureFileRoundTrip", TestTextureFileRoundTrip);
+
+    return Test::GetResult();
+}
@@ -0,0 +1,234 @@
+#include "Test.hpp"
+#include <Nova/core/TransformBatch.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Nova;
+
+constexpr float c_Tolerance = 1e-4f;
+
+struct Objects
+{
+    std::vector<float> PositionX, PositionY, PositionZ;
+    std::vector<float> RotationX, RotationY, RotationZ, RotationW;
+    std::vector<float> ScaleX, ScaleY, ScaleZ;
+
+    void Add(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        PositionX.push_back(position.x);
+        PositionY.push_back(position.y);
+        PositionZ.push_back(position.z);
+        RotationX.push_back(rotation.x);
+        RotationY.push_back(rotation.y);
+        RotationZ.push_back(rotation.z);
+        RotationW.push_back(rotation.w);
+        ScaleX.push_back(scale.x);
+        ScaleY.push_back(scale.y);
+        ScaleZ.push_back(scale.z);
+    }
+
+    size_t GetCount() const noexcept { return PositionX.size(); }
+
+    TransformBatch GetBatch(size_t first, size_t count) const noexcept
+    {
+        return TransformBatch {
+            .PositionX = std::span(PositionX).subspan(first, count),
+            .PositionY = std::span(PositionY).subspan(first, count),
+            .PositionZ = std::span(PositionZ).subspan(first, count),
+            .RotationX = std::span(RotationX).subspan(first, count),
+            .RotationY = std::span(RotationY).subspan(first, count),
+            .RotationZ = std::span(RotationZ).subspan(first, count),
+            .RotationW = std::span(RotationW).subspan(first, count),
+            .ScaleX = std::span(ScaleX).subspan(first, count),
+            .ScaleY = std::span(ScaleY).subspan(first, count),
+            .ScaleZ = std::span(ScaleZ).subspan(first, count),
+        };
+    }
+};
+
+static bool IsNear(const glm::mat3& a, const glm::mat3& b, float tolerance = c_Tolerance)
+{
+    for (int column = 0; column < 3; column++)
+    {
+        for (int row = 0; row < 3; row++)
+        {
+            if (std::abs(a[column][row] - b[column][row]) > tolerance)
+                return false;
+        }
+    }
+    return true;
+}
+
+static bool IsNear(const glm::mat4& a, const glm::mat4& b)
+{
+    for (int column = 0; column < 4; column++)
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            if (std::abs(a[column][row] - b[column][row]) > c_Tolerance)
+                return false;
+        }
+    }
+    return true;
+}
+
+// normal matrices only have to match inverse transpose up to a positive factor
+static bool IsPositiveMultipleOf(const glm::mat3& normalTransform, const glm::mat3& reference)
+{
+    float dotProduct = 0.0f;
+    float referenceLengthSquared = 0.0f;
+    for (int column = 0; column < 3; column++)
+    {
+        dotProduct += glm::dot(normalTransform[column], reference[column]);
+        referenceLengthSquared += glm::dot(reference[column], reference[column]);
+    }
+
+    const auto factor = dotProduct / referenceLengthSquared;
+    return factor > 0.0f && IsNear(normalTransform, reference * factor, c_Tolerance * std::max(factor, 1.0f));
+}
+
+static glm::mat3 GetInverseTranspose(const glm::mat4& transform)
+{
+    return glm::transpose(glm::inverse(glm::mat3(transform)));
+}
+
+// blocks of eight take the same branch in every lane of the AVX2 path, mixed blocks and the tail cover the rest
+static Objects CreateObjects()
+{
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> magnitude(0.25f, 4.0f);
+
+    const auto randomRotation = [&]
+    {
+        return glm::normalize(glm::quat(unit(random), unit(random), unit(random), unit(random)));
+    };
+    const auto randomPosition = [&] { return glm::vec3(unit(random), unit(random), unit(random)) * 10.0f; };
+
+    Objects objects;
+    for (int i = 0; i < 8; i++)
+        objects.Add(randomPosition(), randomRotation(), glm::vec3(magnitude(random)));
+    for (int i = 0; i < 8; i++)
+        objects.Add(randomPosition(), randomRotation(), glm::vec3(-magnitude(random)));
+    for (int i = 0; i < 8; i++)
+        objects.Add(randomPosition(), randomRotation(), glm::vec3(magnitude(random), -magnitude(random), magnitude(random)));
+    for (int i = 0; i < 8; i++)
+    {
+        const auto scale = magnitude(random);
+        objects.Add(randomPosition(), randomRotation(), i % 2 == 0 ? glm::vec3(scale) : glm::vec3(-scale));
+    }
+    for (int i = 0; i < 5; i++)
+        objects.Add(randomPosition(), randomRotation(), glm::vec3(-magnitude(random)));
+
+    return objects;
+}
+
+static void TestBatchedMatchesScalar()
+{
+    const auto objects = CreateObjects();
+    const auto count = objects.GetCount();
+
+    std::vector<glm::mat4> transforms(count);
+    std::vector<glm::mat3> normalTransforms(count);
+    BuildTransformMatrices(objects.GetBatch(0, count), transforms, normalTransforms);
+
+    // batch of a single object always goes through scalar code
+    for (size_t i = 0; i < count; i++)
+    {
+        glm::mat4 transform;
+        glm::mat3 normalTransform;
+        BuildTransformMatrices(objects.GetBatch(i, 1), std::span(&transform, 1), std::span(&normalTransform, 1));
+
+        NV_TEST_EXPECT(IsNear(transforms[i], transform));
+        NV_TEST_EXPECT(IsNear(normalTransforms[i], normalTransform));
+    }
+}
+
+static void TestNormalsMatchInverseTranspose()
+{
+    const auto objects = CreateObjects();
+    const auto count = objects.GetCount();
+
+    std::vector<glm::mat4> transforms(count);
+    std::vector<glm::mat3> normalTransforms(count);
+    BuildTransformMatrices(objects.GetBatch(0, count), transforms, normalTransforms);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const glm::quat rotation(objects.RotationW[i], objects.RotationX[i], objects.RotationY[i], objects.RotationZ[i]);
+        const auto rotationMatrix = glm::mat3_cast(rotation);
+        const glm::vec3 scale(objects.ScaleX[i], objects.ScaleY[i], objects.ScaleZ[i]);
+
+        glm::mat4 expected(1.0f);
+        expected[0] = glm::vec4(rotationMatrix[0] * scale.x, 0.0f);
+        expected[1] = glm::vec4(rotationMatrix[1] * scale.y, 0.0f);
+        expected[2] = glm::vec4(rotationMatrix[2] * scale.z, 0.0f);
+        expected[3] = glm::vec4(objects.PositionX[i], objects.PositionY[i], objects.PositionZ[i], 1.0f);
+
+        NV_TEST_EXPECT(IsNear(transforms[i], expected));
+        NV_TEST_EXPECT(IsPositiveMultipleOf(normalTransforms[i], GetInverseTranspose(expected)));
+    }
+}
+
+static void TestMirroredNormals()
+{
+    // eight equal negative scales made AVX2 path take the rotation shortcut
+    Objects objects;
+    for (int i = 0; i < 9; i++)
+        objects.Add(glm::vec3(0.0f), glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(-2.0f));
+
+    std::vector<glm::mat4> transforms(objects.GetCount());
+    std::vector<glm::mat3> normalTransforms(objects.GetCount());
+    BuildTransformMatrices(objects.GetBatch(0, objects.GetCount()), transforms, normalTransforms);
+
+    // point mirrored through origin keeps outward normals pointing away from it
+    for (const auto& normalTransform : normalTransforms)
+        NV_TEST_EXPECT((normalTransform * glm::vec3(0.0f, 0.0f, 1.0f)).z < 0.0f);
+}
+
+static void TestNormalMatricesOfArbitraryTransforms()
+{
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    // sheared and mirrored matrices, count isn't a multiple of eight
+    std::vector<glm::mat4> transforms(21);
+    for (auto& transform : transforms)
+    {
+        for (int column = 0; column < 3; column++)
+            transform[column] = glm::vec4(unit(random), unit(random), unit(random), 0.0f) * 3.0f;
+        transform[3] = glm::vec4(unit(random), unit(random), unit(random), 1.0f);
+    }
+
+    std::vector<glm::mat3> normalTransforms(transforms.size());
+    BuildNormalMatrices(transforms, normalTransforms);
+
+    for (size_t i = 0; i < transforms.size(); i++)
+    {
+        glm::mat3 normalTransform;
+        BuildNormalMatrices(std::span(&transforms[i], 1), std::span(&normalTransform, 1));
+
+        NV_TEST_EXPECT(IsNear(normalTransforms[i], normalTransform, c_Tolerance * 10.0f));
+        NV_TEST_EXPECT(IsPositiveMultipleOf(normalTransforms[i], GetInverseTranspose(transforms[i])));
+    }
+}
+
+int main()
+{
+#if defined(__AVX2__)
+    std::printf("Comparing AVX2 and scalar paths\n");
+#else
+    std::printf("AVX2 is disabled, only scalar path is tested, configure with NOVA_ENABLE_AVX2 to test both\n");
+#endif
+
+    Test::Run("BatchedMatchesScalar", TestBatchedMatchesScalar);
+    Test::Run("NormalsMatchInverseTranspose", TestNormalsMatchInverseTranspose);
+    Test::Run("MirroredNormals", TestMirroredNormals);
+    Test::Run("NormalMatricesOfArbitraryTransforms", TestNormalMatricesOfArbitraryTransforms);
+
+    return Test::GetResult();
+}
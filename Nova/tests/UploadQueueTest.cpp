@@ -0,0 +1,122 @@
+#include "Test.hpp"
+#include "GLContext.hpp"
+#include <Nova/graphics/UploadQueue.hpp>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+using namespace Nova;
+
+static std::vector<uint32_t> ReadBuffer(const Buffer& buffer, size_t count)
+{
+    std::vector<uint32_t> data(count);
+    glGetNamedBufferSubData((GLuint)buffer.GetID(), 0, (GLsizeiptr)(count * sizeof(uint32_t)), data.data());
+
+    return data;
+}
+
+static void TestBufferUpload(UploadQueue& queue)
+{
+    std::vector<uint32_t> data(1024);
+    std::iota(data.begin(), data.end(), 0u);
+
+    const auto upload = queue.UploadBuffer(std::as_bytes(std::span(data)));
+    auto buffer = queue.AcquireBuffer(upload);
+    NV_TEST_EXPECT(ReadBuffer(buffer, data.size()) == data);
+
+    buffer.Delete();
+}
+
+static void TestBufferRegions(UploadQueue& queue)
+{
+    // destination is created and cleared on main context, upload thread only writes parts of it
+    const std::vector<uint32_t> zeros(64, 0);
+    Buffer destination((GLsizeiptr)(zeros.size() * sizeof(uint32_t)), false, false, zeros.data());
+
+    const std::array<uint32_t, 4> first { 1, 2, 3, 4 };
+    const std::array<uint32_t, 2> second { 5, 6 };
+    const auto upload = queue.UploadBufferRegions({
+        BufferRegionUpload {
+            .Destination = (GLuint)destination.GetID(),
+            .Offset = 8 * sizeof(uint32_t),
+            .Data = std::as_bytes(std::span(first)),
+        },
+        BufferRegionUpload {
+            .Destination = (GLuint)destination.GetID(),
+            .Offset = 62 * sizeof(uint32_t),
+            .Data = std::as_bytes(std::span(second)),
+        },
+        BufferRegionUpload {
+            .Destination = (GLuint)destination.GetID(),
+            .Offset = 0,
+            .Data = {},
+        },
+    });
+    queue.AcquireBufferRegions(upload);
+
+    auto expected = zeros;
+    std::copy(first.begin(), first.end(), expected.begin() + 8);
+    std::copy(second.begin(), second.end(), expected.begin() + 62);
+    NV_TEST_EXPECT(ReadBuffer(destination, expected.size()) == expected);
+
+    // handle is released once acquired
+    bool isThrowing = false;
+    try
+    {
+        queue.AcquireBufferRegions(upload);
+    }
+    catch (const std::exception&)
+    {
+        isThrowing = true;
+    }
+    NV_TEST_EXPECT(isThrowing);
+
+    destination.Delete();
+}
+
+static void TestUploadsInOrder(UploadQueue& queue)
+{
+    // later upload into the same region wins, so freed ranges can be reused before earlier copies are acquired
+    const std::vector<uint32_t> zeros(16, 0);
+    Buffer destination((GLsizeiptr)(zeros.size() * sizeof(uint32_t)), false, false, zeros.data());
+
+    std::vector<std::vector<uint32_t>> data;
+    std::vector<UploadHandle> uploads;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        data.emplace_back(16, i + 1);
+        uploads.push_back(queue.UploadBufferRegions({
+            BufferRegionUpload {
+                .Destination = (GLuint)destination.GetID(),
+                .Offset = 0,
+                .Data = std::as_bytes(std::span(data.back())),
+            },
+        }));
+    }
+
+    for (const auto upload : uploads)
+        queue.AcquireBufferRegions(upload);
+
+    NV_TEST_EXPECT(ReadBuffer(destination, zeros.size()) == data.back());
+
+    destination.Delete();
+}
+
+int main()
+{
+    if (!Test::CreateGLContext("UploadQueueTest"))
+        return Test::c_SkipResult;
+
+    {
+        UploadQueue queue(Window::GetNativeHandle());
+
+        Test::Run("BufferUpload", [&] { TestBufferUpload(queue); });
+        Test::Run("BufferRegions", [&] { TestBufferRegions(queue); });
+        Test::Run("UploadsInOrder", [&] { TestUploadsInOrder(queue); });
+    }
+
+    Window::Shutdown_();
+
+    return Test::GetResult();
+}
@@ -3,6 +3,9 @@
 #include <Nova/graphics/Renderer.hpp>
 #include <Nova/input/Input.hpp>
 #include <Nova/core/Application.hpp>
+#include <Nova/core/TransformBatch.hpp>
+#include <Nova/core/ThreadPool.hpp>
+#include <Nova/assets/MeshFile.hpp>
 #include <Nova/ecs/components/NameComponent.hpp>
 #include <Nova/ecs/components/TransformComponent.hpp>
 #include <Nova/ecs/components/LightComponent.hpp>
@@ -10,11 +13,11 @@
 #include <Nova/ecs/components/CameraComponent.hpp>
 #include <Nova/ecs/components/RenderComponent.hpp>
 #include <Nova/ecs/components/ScriptComponent.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <imgui.h>
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
 #include <format>
-#include <fstream>
 #include <ranges>
 #include <random>
 #include <limits>
@@ -26,11 +29,25 @@ constexpr entt::entity InvalidEntity = (entt::entity)-1;
 struct HeartData
 {
     glm::mat4 Transform;
-    Nova::Material Material;
+    Nova::MaterialHandle Material;
+    Nova::InstanceHandle Instance;
 };
 
 static std::vector<HeartData> hearts_;
 
+// scene transforms are gathered as separate component arrays, so that their matrices can be built in one batch
+struct SceneRenderBatch
+{
+    std::vector<float> PositionX, PositionY, PositionZ;
+    std::vector<float> RotationX, RotationY, RotationZ, RotationW;
+    std::vector<float> ScaleX, ScaleY, ScaleZ;
+    std::vector<const RenderComponent*> Renders;
+    std::vector<glm::mat4> Transforms;
+    std::vector<glm::mat3> NormalTransforms;
+};
+
+static SceneRenderBatch sceneRenderBatch_;
+
 template <typename T>
 static T Random(T min = std::numeric_limits<T>::min(), T max = std::numeric_limits<T>::max()) noexcept
 {
@@ -57,108 +74,89 @@ static T& SelectRandomElement(std::span<T> container) noexcept
     return container[Random(0zu, container.size() - 1)];
 }
 
-static glm::mat4 BuildTransformMatrix(const glm::vec3& position, const glm::quat& rotation, const glm::vec3 scale) noexcept
+static void RenderSceneObjects(const entt::registry& scene)
 {
-    const auto rotationMatrix = glm::mat3_cast(rotation);
+    auto& batch = sceneRenderBatch_;
+    for (auto* components : {
+        &batch.PositionX, &batch.PositionY, &batch.PositionZ,
+        &batch.RotationX, &batch.RotationY, &batch.RotationZ, &batch.RotationW,
+        &batch.ScaleX, &batch.ScaleY, &batch.ScaleZ })
+    {
+        components->clear();
+    }
+    batch.Renders.clear();
 
-    glm::mat4 result;
-    result[0] = glm::vec4(rotationMatrix[0] * scale.x, 0.0f);
-    result[1] = glm::vec4(rotationMatrix[1] * scale.x, 0.0f);
-    result[2] = glm::vec4(rotationMatrix[2] * scale.x, 0.0f);
-    result[3] = glm::vec4(position, 1.0f);
+    scene.view<TransformComponent, RenderComponent>().each(
+        [&](auto entity, const auto& transform, const auto& render)
+        {
+            const glm::quat rotation(transform.Rotation);
+
+            batch.PositionX.push_back(transform.Position.x);
+            batch.PositionY.push_back(transform.Position.y);
+            batch.PositionZ.push_back(transform.Position.z);
+            batch.RotationX.push_back(rotation.x);
+            batch.RotationY.push_back(rotation.y);
+            batch.RotationZ.push_back(rotation.z);
+            batch.RotationW.push_back(rotation.w);
+            batch.ScaleX.push_back(transform.Scale.x);
+            batch.ScaleY.push_back(transform.Scale.y);
+            batch.ScaleZ.push_back(transform.Scale.z);
+            batch.Renders.push_back(&render);
+        });
 
-    return result;
+    batch.Transforms.resize(batch.Renders.size());
+    batch.NormalTransforms.resize(batch.Renders.size());
+
+    Nova::BuildTransformMatrices(
+        Nova::TransformBatch {
+            .PositionX = batch.PositionX,
+            .PositionY = batch.PositionY,
+            .PositionZ = batch.PositionZ,
+            .RotationX = batch.RotationX,
+            .RotationY = batch.RotationY,
+            .RotationZ = batch.RotationZ,
+            .RotationW = batch.RotationW,
+            .ScaleX = batch.ScaleX,
+            .ScaleY = batch.ScaleY,
+            .ScaleZ = batch.ScaleZ,
+        },
+        batch.Transforms,
+        batch.NormalTransforms);
+
+    for (size_t i = 0; i < batch.Renders.size(); i++)
+    {
+        Nova::Renderer::Render(
+            batch.Renders[i]->Model,
+            batch.Renders[i]->Material,
+            batch.Transforms[i],
+            batch.NormalTransforms[i]);
+    }
 }
 
-static Nova::Model LoadModelFromObjFile(const std::filesystem::path& filepath)
+// OBJ file is converted into .nvmesh next to it whenever the binary file is missing or older,
+// which is then mapped and uploaded without parsing
+static Nova::Model LoadModel(const std::filesystem::path& objFilepath)
 {
-    std::ifstream file(filepath);
-    if (!file.is_open())
-        throw std::runtime_error("Failed to open model file.");
+    auto meshFilepath = objFilepath;
+    meshFilepath.replace_extension(".nvmesh");
 
-    std::vector<glm::vec3> positionData;
-    std::vector<glm::vec2> textureCoordData;
-    std::vector<glm::vec3> normalData;
-    std::vector<Nova::ModelVertex> modelData;
-
-    std::string line;
-    while (std::getline(file, line))
+    bool isConverted = false;
+    if (!std::filesystem::exists(meshFilepath)
+        || std::filesystem::last_write_time(meshFilepath) < std::filesystem::last_write_time(objFilepath))
     {
-        switch (line[0])
-        {
-        case 'v':
-            if (line[1] == 't')
-            {
-                glm::vec2 data;
-                std::sscanf(
-                    line.data(),
-                    "vt %f %f\n",
-                    &data.x,
-                    &data.y);
-                textureCoordData.emplace_back(data);
-            }
-            else if (line[1] == 'n')
-            {
-                glm::vec3 data;
-                std::sscanf(
-                    line.data(),
-                    "vn %f %f %f\n",
-                    &data.x,
-                    &data.y,
-                    &data.z);
-                normalData.emplace_back(data);
-            }
-            else
-            {
-                glm::vec3 data;
-                std::sscanf(
-                    line.data(),
-                    "v %f %f %f\n",
-                    &data.x,
-                    &data.y,
-                    &data.z);
-                positionData.emplace_back(data);
-            }
-            
-            break;
-        case 'f':
-            int vertexIndices[3];
-            int textureIndices[3];
-            int normalIndices[3];
-            std::sscanf(
-                line.data(),
-                "f %d/%d/%d %d/%d/%d %d/%d/%d",
-                &vertexIndices[0],
-                &textureIndices[0],
-                &normalIndices[0],
-                &vertexIndices[1],
-                &textureIndices[1],
-                &normalIndices[1],
-                &vertexIndices[2],
-                &textureIndices[2],
-                &normalIndices[2]);
-            
-            for (int i = 0; i < 3; i++)
-            {
-                Nova::ModelVertex modelVertex{
-                    .Position = positionData[vertexIndices[i] - 1],
-                    .Normal = normalData[normalIndices[i] - 1],
-                    .TextureCoords = textureCoordData[textureIndices[i] - 1],
-                };
-                modelData.emplace_back(modelVertex);
-            }
-
-            break;
-        }
+        Nova::ThreadPool threadPool;
+        Nova::ConvertObjToMeshFile(objFilepath, meshFilepath, &threadPool);
+        isConverted = true;
     }
 
+    // mapping is kept alive by the upload, so mesh is copied into GPU buffers straight from the file
+    const auto meshFile = std::make_shared<const Nova::MeshFile>(meshFilepath, !isConverted);
+
     return Nova::Model(
         1,
-        Nova::Buffer(
-            modelData.size() * sizeof(Nova::ModelVertex),
-            false,
-            false,
-            modelData.data()));
+        Nova::Renderer::CreateMesh(meshFile->GetVertices(), meshFile->GetIndices(), meshFile),
+        meshFile->GetBounds(),
+        meshFile->GetLODs());
 }
 
 template <typename TComponent>
@@ -222,17 +220,7 @@ static void RenderScene(const entt::registry& scene, entt::entity cameraEntity)
         });
 
     // render objects
-    scene.view<TransformComponent, RenderComponent>().each(
-        [](auto entity, const auto& transform, const auto& render)
-        {
-            Nova::Renderer::Render(
-                render.Model,
-                *render.Material,
-                BuildTransformMatrix(
-                    transform.Position,
-                    transform.Rotation,
-                    transform.Scale));
-        });
+    RenderSceneObjects(scene);
 
     // draw
     // Nova::Renderer::Draw(glm::vec4(0.529f, 0.529f, 0.529f, 1.0f));
@@ -256,15 +244,16 @@ MainLayer::MainLayer()
 
     std::srand(std::time(nullptr));
 
-    std::vector<Nova::Material> randomMaterials_;
+    std::vector<Nova::MaterialHandle> randomMaterials_;
     randomMaterials_.reserve(8);
 
     for (size_t i = 0; i < 8; i++)
         randomMaterials_.emplace_back(
-            Nova::Material{
-                .Color = RandomColor(),
-                .SpecularIntensity = 1.0f,
-            });
+            Nova::Renderer::CreateMaterial(
+                Nova::Material{
+                    .Color = RandomColor(),
+                    .SpecularIntensity = 1.0f,
+                }));
     
     hearts_.reserve(5 * 5);
 
@@ -287,7 +276,11 @@ MainLayer::MainLayer()
         }
     }
             
-    model_ = LoadModelFromObjFile("./assets/heart.obj");
+    model_ = LoadModel("./assets/heart.obj");
+
+    // hearts never move, so they're retained by renderer instead of being submitted every frame
+    for (auto& heart : hearts_)
+        heart.Instance = Nova::Renderer::CreateInstance(&model_, heart.Material, heart.Transform);
 
     // initialize main camera
     mainCameraEntity_ = entities_.create();
@@ -409,9 +402,6 @@ void MainLayer::OnRender()
 {
     RenderScene(entities_, mainCameraEntity_);
 
-    for (const auto& heart : hearts_)
-        Nova::Renderer::Render(&model_, heart.Material, heart.Transform);
-
     Nova::Renderer::Draw(glm::vec4(0.529f, 0.529f, 0.529f, 1.0f));
 
     // Render GUI